@@ -135,10 +135,40 @@ typedef struct swicc_apdu_data_s
 typedef struct swicc_apdu_cmd_s
 {
     swicc_apdu_cmd_hdr_st *hdr;
-    uint8_t *p3;
+    /**
+     * Lc when data is present, otherwise the value of the Le field (0 when
+     * encoded as 0 or absent). This is wider than a byte to fit extended
+     * lengths.
+     */
+    uint16_t *p3;
     swicc_apdu_data_st *data;
 } swicc_apdu_cmd_st;
 
+/**
+ * Length fields of a raw command APDU, i.e. which of the cases from ISO/IEC
+ * 7816-4:2020 clause.5.2 it is.
+ */
+typedef struct swicc_apdu_cmd_len_s
+{
+    bool ext; /* Extended (true) or short (false) length fields. */
+    uint16_t lc;
+    uint8_t data_offset; /* Where the data starts in the raw command. */
+    bool le_present;
+    /* As encoded, so 0 stands for 256 (short) or 65536 (extended). */
+    uint16_t le;
+} swicc_apdu_cmd_len_st;
+
+/**
+ * Data of an APDU response. The buffer is owned by whoever creates the response
+ * (it is usually the buffer the raw response is sent from) and can always hold
+ * SWICC_DATA_MAX bytes.
+ */
+typedef struct swicc_apdu_res_data_s
+{
+    uint16_t len;
+    uint8_t *b;
+} swicc_apdu_res_data_st;
+
 /**
  * An internal format of the APDU response which is the result of parsing a raw
  * APDU response.
@@ -147,7 +177,7 @@ typedef struct swicc_apdu_res_s
 {
     swicc_apdu_sw1_et sw1;
     uint8_t sw2;
-    swicc_apdu_data_st data;
+    swicc_apdu_res_data_st data;
 } swicc_apdu_res_st;
 
 /**
@@ -157,12 +187,33 @@ typedef struct swicc_apdu_res_s
  */
 swicc_apdu_cla_st swicc_apdu_cmd_cla_parse(uint8_t const cla_raw);
 
+/**
+ * @brief Parse the length fields of a raw command APDU. Both short and
+ * extended lengths are accepted.
+ * @param[in] buf_raw Buffer containing the raw APDU message.
+ * @param[in] buf_raw_len Length of the raw APDU message.
+ * @param[out] len Where the parsed lengths will be written.
+ * @return Return code.
+ * @note Commands with more data than SWICC_DATA_MAX are rejected.
+ */
+swicc_ret_et swicc_apdu_cmd_len_parse(uint8_t const *const buf_raw,
+                                      uint16_t const buf_raw_len,
+                                      swicc_apdu_cmd_len_st *const len);
+
+/**
+ * @brief Get the maximum number of bytes expected in the response (Ne).
+ * @param[in] len
+ * @return Ne which is 0 when Le is absent.
+ */
+uint32_t swicc_apdu_cmd_len_ne(swicc_apdu_cmd_len_st const *const len);
+
 /**
  * @brief Given a buffer containing a raw interindustry APDU message, parse and
  * validate it into a more useful representation.
  * @param[in] buf_raw Buffer containing the raw APDU message.
  * @param[in] buf_raw_len Length of the raw APDU message.
- * @param[out] apdu_cmd Where the parsed APDU will be written.
+ * @param[out] apdu_cmd Where the parsed APDU will be written. P3 receives Lc
+ * or Le and the data receives only the data field.
  * @return Return code.
  */
 swicc_ret_et swicc_apdu_cmd_parse(uint8_t const *const buf_raw,
@@ -179,6 +230,8 @@ swicc_ret_et swicc_apdu_cmd_parse(uint8_t const *const buf_raw,
  * @param[in] cmd The command for which we are creating the response.
  * @param[in] res The response struct.
  * @return Return code.
+ * @note When the response data already is at the start of the raw buffer, it
+ * is not copied and only the status is appended to it.
  */
 swicc_ret_et swicc_apdu_res_deparse(uint8_t *const buf_raw,
                                     uint16_t *const buf_raw_len,
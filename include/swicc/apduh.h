@@ -20,6 +20,33 @@
     }                                                                          \
     while (0)
 
+/**
+ * Per-instruction handlers can be registered for the interindustry and the
+ * proprietary class.
+ */
+#define SWICC_APDUH_CLA_COUNT 2U
+
+/**
+ * SELECT responses (FCI, FCP, or FMD templates) are cached per card in a
+ * direct-mapped cache with this many entries.
+ */
+#define SWICC_APDUH_FCP_CACHE_COUNT 64U
+/* Longest response that is cached, enough for the longest FCI of any file. */
+#define SWICC_APDUH_FCP_LEN_MAX 64U
+
+/**
+ * A cached SELECT response, identified by the file it was created for and by
+ * what was requested in P2.
+ */
+typedef struct swicc_apduh_fcp_s
+{
+    struct swicc_disk_tree_s const *tree;
+    uint32_t offset_trel;
+    uint8_t data_req;
+    uint8_t len; /* Length of the response, 0 when the entry is empty. */
+    uint8_t buf[SWICC_APDUH_FCP_LEN_MAX];
+} swicc_apduh_fcp_st;
+
 /**
  * @brief APDU handler.
  * @param[in, out] swicc_state
@@ -53,6 +80,25 @@ typedef swicc_ret_et swicc_apduh_ft(swicc_st *const swicc_state,
 swicc_ret_et swicc_apduh_pro_register(swicc_st *const swicc_state,
                                       swicc_apduh_ft *const handler);
 
+/**
+ * @brief Register a handler for a single instruction of a class. Finding it
+ * takes one lookup in a table indexed by INS so applications do not need to
+ * do their own dispatch.
+ * @param[in, out] swicc_state
+ * @param[in] cla_type Either the interindustry or the proprietary class.
+ * @param[in] ins The instruction to handle.
+ * @param[in] handler Handler for the instruction or NULL to remove the one
+ * registered before.
+ * @return Return code.
+ * @note This handler runs before the one registered with
+ * 'swicc_apduh_pro_register' and before the interindustry handlers. When it
+ * returns SWICC_RET_APDU_UNHANDLED, these get to handle the command instead.
+ */
+swicc_ret_et swicc_apduh_ins_register(swicc_st *const swicc_state,
+                                      swicc_apdu_cla_type_et const cla_type,
+                                      uint8_t const ins,
+                                      swicc_apduh_ft *const handler);
+
 /**
  * @brief In some cases, the user may want to override what the card sends back
  * to the terminal even if the command received is handled completely within an
@@ -75,3 +121,25 @@ swicc_ret_et swicc_apduh_demux(swicc_st *const swicc_state,
                                swicc_apdu_cmd_st const *const cmd,
                                swicc_apdu_res_st *const res,
                                uint32_t const procedure_count);
+
+/**
+ * @brief Execute a whole command APDU in-process and get the whole response
+ * back, bypassing the transmission protocol (T=0 procedure bytes) entirely.
+ * @param[in, out] swicc_state
+ * @param[in] cmd_raw A raw command APDU with short or extended lengths.
+ * @param[in] cmd_raw_len Length of the raw command APDU.
+ * @param[out] res_raw Where to write the raw response APDU (data and status).
+ * @param[in, out] res_raw_len Should contain the size of the response buffer.
+ * This will receive the length of the response on success.
+ * @return Return code.
+ * @note When the handler indicates that more data is available (61XX), it is
+ * fetched with GET RESPONSE and appended, up to Le. When the handler indicates
+ * a wrong Le (6CXX), the command is run again with the correct one. The
+ * response buffer should be at least SWICC_DATA_MAX + 2 bytes long for
+ * handlers to write directly into it.
+ */
+swicc_ret_et swicc_apdu_exec(swicc_st *const swicc_state,
+                             uint8_t const *const cmd_raw,
+                             uint16_t const cmd_raw_len,
+                             uint8_t *const res_raw,
+                             uint16_t *const res_raw_len);
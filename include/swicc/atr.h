@@ -5,7 +5,7 @@
 
 #include "swicc/common.h"
 
-#define SWICC_ATR_LEN 25
+#define SWICC_ATR_LEN 27
 
 /**
  * Card ATR is the first thing sent in the comms between the terminal and ICC.
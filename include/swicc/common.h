@@ -4,11 +4,15 @@
 #include <stdint.h>
 
 /**
- * @warning Only short APDUs are supported for now.
+ * Most data in a command or response. Short length fields go up to 256 bytes
+ * and extended ones up to 65536 bytes, but all buffers are statically
+ * allocated (a few per card, including in each network message) and lengths
+ * are 16 bit so the extended maximum is kept much lower than that.
+ * ISO/IEC 7816-4:2020 clause.5.1
  */
 #define SWICC_DATA_MAX_SHRT 256U
-// #define SWICC_DATA_MAX_LONG 65536U
-#define SWICC_DATA_MAX SWICC_DATA_MAX_SHRT
+#define SWICC_DATA_MAX_LONG 4096U
+#define SWICC_DATA_MAX SWICC_DATA_MAX_LONG
 
 /**
  * All possible return codes that can get returned from the functions of this
@@ -32,6 +36,9 @@ typedef enum swicc_ret_e
     SWICC_RET_PPS_INVALID, /* E.g. the check byte is incorrect etc... */
     SWICC_RET_PPS_FAILED,  /* Request is handled but params are not accepted */
 
+    SWICC_RET_T1_INVALID, /* E.g. the block length is incorrect etc... */
+    SWICC_RET_T1_EDC,     /* Block is well-formed but the EDC is incorrect. */
+
     SWICC_RET_ATR_INVALID,  /* E.g. the ATR might not contain madatory fields or
                               is malformed. */
     SWICC_RET_FS_NOT_FOUND, /* Requested FS item is not present. */
@@ -43,6 +50,8 @@ typedef enum swicc_ret_e
                                        server. */
     SWICC_RET_NET_DISCONNECTED, /* Client connected to server and exchanged at
                                    least 1 message before getting an error. */
+    SWICC_RET_NET_INCOMPLETE,   /* Message was transferred only partially
+                                   because the socket would block. */
 } swicc_ret_et;
 
 /**
@@ -31,6 +31,54 @@
 static_assert(sizeof((uint8_t[])SWICC_DISK_MAGIC) == SWICC_DISK_MAGIC_LEN,
               "Magic length macro not equal to the magic array length");
 
+/**
+ * A disk file can optionally contain a LUT section after all the trees. It
+ * starts with a magic that is derived from the disk magic, followed by a LUT
+ * section header, the ID LUT, the name LUT, and lastly the SID LUT and the
+ * child LUT of every tree (in the same order as the trees). Each LUT is stored
+ * as its entry count (4B) followed by buffer 1 and buffer 2. When loading a
+ * disk, the LUTs are read directly from this section, if it is missing or does
+ * not match the trees (stale), the LUTs are rebuilt.
+ * @note The byte at which a tree stores the item type ('L') is not a valid tree
+ * type so the LUT section is never mistaken for a tree.
+ */
+#if __BYTE_ORDER == __LITTLE_ENDIAN
+#define SWICC_DISK_LUT_MAGIC                                                   \
+    {                                                                          \
+        0x00, 's', 'w', 'I', 'C', 'C', 0x91, 0xCC, 'L', 'U', 'T', '.', 'F',    \
+            'S', 0xF0, 0x0F                                                    \
+    }
+#elif __BYTE_ORDER == __BIG_ENDIAN
+#define SWICC_DISK_LUT_MAGIC                                                   \
+    {                                                                          \
+        0x00, 's', 'w', 'I', 'C', 'C', 0x91, 0xCC, 'L', 'U', 'T', '.', 'F',    \
+            'S', 0x0F, 0xF0                                                    \
+    }
+#else
+#error "Invalid endianness."
+#endif
+static_assert(sizeof((uint8_t[])SWICC_DISK_LUT_MAGIC) == SWICC_DISK_MAGIC_LEN,
+              "Magic length macro not equal to the LUT magic array length");
+
+/**
+ * Version of the LUT section layout. Must be incremented every time the layout
+ * of the LUT section (or of the LUTs) changes so that older LUT sections get
+ * rebuilt instead of being used.
+ */
+#define SWICC_DISK_LUT_VERSION 3U
+
+/* Header of the LUT section (comes right after the LUT magic). */
+typedef struct swicc_disk_lut_hdr_raw_s
+{
+    uint32_t version;
+    /**
+     * Number of trees and the sum of lengths of all trees of the disk for which
+     * the LUTs were created. Used to detect stale LUTs.
+     */
+    uint32_t tree_count;
+    uint32_t trees_len;
+} __attribute__((packed)) swicc_disk_lut_hdr_raw_st;
+
 /* Representation of a LUT (lookup table). */
 typedef struct swicc_disk_lut_s
 {
@@ -45,6 +93,50 @@ typedef struct swicc_disk_lut_s
     uint32_t size_item2; /* Size of item in buffer 2. */
 } swicc_disk_lut_st;
 
+/* A modified region of a shared tree kept outside of the tree buffer. */
+typedef struct swicc_disk_ovl_item_s
+{
+    uint32_t offset_trel; /* Tree-relative offset of the modified bytes. */
+    uint32_t len;
+    uint8_t *buf;
+} swicc_disk_ovl_item_st;
+
+/**
+ * Overlay of all modifications made to a shared tree. Items are sorted by
+ * offset and never overlap.
+ */
+typedef struct swicc_disk_ovl_s
+{
+    uint32_t count_max; /* Allocated size can hold this many items. */
+    uint32_t count;     /* Number of items in the buffer. */
+    swicc_disk_ovl_item_st *item;
+} swicc_disk_ovl_st;
+
+/**
+ * Decoded headers of all folders (MF, ADFs, and DFs) of a tree. Every file
+ * selection needs the root and the parent of the selected file, which are
+ * always folders, so keeping them decoded saves parsing their raw headers
+ * again. There are few folders compared to EFs so the table stays small. The
+ * folders are found by their offset using an open-addressing hash table. The
+ * decoded headers point into the tree buffer so the table is never saved to the
+ * disk file but built when the tree is loaded, and it is never modified after
+ * that.
+ */
+typedef struct swicc_disk_hdrtbl_s
+{
+    /* In the order in which they are in the tree so the root is the first. */
+    swicc_fs_file_st *folder;
+    uint32_t folder_count;
+
+    /**
+     * Each slot holds the index of a folder plus 1, or 0 when the slot is
+     * empty. The slot count is a power of 2 and always greater than the folder
+     * count.
+     */
+    uint32_t *slot;
+    uint32_t slot_count;
+} swicc_disk_hdrtbl_st;
+
 /* Representation of a tree in the root (forest). */
 typedef struct swicc_disk_tree_s swicc_disk_tree_st;
 struct swicc_disk_tree_s
@@ -58,14 +150,62 @@ struct swicc_disk_tree_s
     uint32_t len;  /* Occupied size. */
     uint8_t *buf;  /* This buffer holds the whole disk (including LUTs). */
     swicc_disk_lut_st lutsid;
+
+    /**
+     * Children of every folder in the tree, looked up by the offset of the
+     * folder followed by the ID of the child. The children of a folder are
+     * next to each other and sorted by ID.
+     */
+    swicc_disk_lut_st lutchild;
+
+    swicc_disk_hdrtbl_st hdrtbl; /* Decoded headers of folders in the tree. */
+
+    /**
+     * When true, the buffer points into the disk file mapping instead of being
+     * allocated so it must not be freed or resized.
+     */
+    bool buf_mapped;
+
+    /**
+     * When true, the buffer, the LUTs, and the header table belong to the tree
+     * of a base disk which is shared by many disks so they must never be
+     * modified nor freed. All modifications of a shared tree are kept in its
+     * overlay.
+     */
+    bool shared;
+    swicc_disk_ovl_st ovl;
 };
 
 /* The in-memory struct storing a swICC FS disk. */
-typedef struct swicc_disk_s
+typedef struct swicc_disk_s swicc_disk_st;
+struct swicc_disk_s
 {
     swicc_disk_tree_st *root;
-    swicc_disk_lut_st lutid; /* There is exactly one LUT for all IDs. */
-} swicc_disk_st;
+    swicc_disk_lut_st lutid;   /* There is exactly one LUT for all IDs. */
+    swicc_disk_lut_st lutname; /* Same as the ID LUT but for MF/DF names. */
+
+    /**
+     * AIDs of all ADFs at the root of the trees, sorted so that ADFs whose AIDs
+     * start with the same bytes are next to each other. It refers to the trees
+     * by pointer so it is never saved to the disk file but built when the disk
+     * gets mounted, and every disk (including overlays) has its own.
+     */
+    swicc_disk_lut_st lutaid;
+
+    /**
+     * When the disk is loaded by mapping the disk file into memory, this is the
+     * mapping (and its length) into which the tree buffers point.
+     */
+    uint8_t *map;
+    uint32_t map_len;
+
+    /**
+     * When the disk is an overlay on top of a base disk, this is the base disk.
+     * All trees of an overlay disk are shared and the ID and name LUTs belong
+     * to the base disk.
+     */
+    swicc_disk_st const *base;
+};
 
 /**
  * Looking up trees by index can be code-inefficient when trying to perform some
@@ -84,13 +224,47 @@ typedef struct swicc_disk_tree_iter_s
  * @param[in, out] disk
  * @param[in] disk_path Path to the disk file.
  * @return Return code.
+ * @note If the disk file contains a valid LUT section, the LUTs are loaded from
+ * it, otherwise they are rebuilt.
  */
 swicc_ret_et swicc_disk_load(swicc_disk_st *const disk,
                              char const *const disk_path);
 
+/**
+ * @brief Load a disk file by mapping it into memory. The tree buffers point
+ * straight into the mapping so no tree data is copied and processes that map
+ * the same disk file share the pages of the page cache.
+ * @param[in, out] disk
+ * @param[in] disk_path Path to the disk file.
+ * @return Return code.
+ * @note The mapping is private and copy-on-write so the disk can be modified
+ * like a loaded one (only modified pages get copied) but the modifications are
+ * never written back to the disk file.
+ * @note If the disk file contains a valid LUT section, the LUTs are loaded from
+ * it, otherwise they are rebuilt.
+ */
+swicc_ret_et swicc_disk_load_mmap(swicc_disk_st *const disk,
+                                  char const *const disk_path);
+
+/**
+ * @brief Create a disk on top of a base disk. The new disk shares the tree
+ * buffers and LUTs of the base disk and only allocates memory for the records
+ * that get modified (the overlay) so many disks can be created from a single
+ * base disk at little cost.
+ * @param[out] disk Where the overlay disk will be created.
+ * @param[in] disk_base The base disk. It must not be modified nor unloaded
+ * while any of its overlay disks exist.
+ * @return Return code.
+ * @note The base disk is only ever read so it can be shared by overlay disks
+ * used concurrently from different threads.
+ */
+swicc_ret_et swicc_disk_overlay(swicc_disk_st *const disk,
+                                swicc_disk_st const *const disk_base);
+
 /**
  * @brief Unload the in-memory disk and frees any memory used for storing the
- * FS.
+ * FS. This works for disks that were loaded, mapped, or created, and for
+ * overlay disks (in which case the base disk is left untouched).
  * @param[in, out] disk
  */
 void swicc_disk_unload(swicc_disk_st *const disk);
@@ -100,6 +274,10 @@ void swicc_disk_unload(swicc_disk_st *const disk);
  * @param[in] disk
  * @param[in] disk_path Path where to save the disk file.
  * @return Return code.
+ * @note If the disk has an ID LUT, all the LUTs are saved in the LUT section
+ * of the disk file.
+ * @note For overlay disks, the saved trees contain all the modifications kept
+ * in the overlay.
  */
 swicc_ret_et swicc_disk_save(swicc_disk_st const *const disk,
                              char const *const disk_path);
@@ -169,7 +347,8 @@ swicc_ret_et swicc_disk_tree_iter_idx(swicc_disk_tree_iter_st *const tree_iter,
                                       swicc_disk_tree_st **const tree);
 
 /**
- * @brief Dealloc all disk buffers that hold forest data.
+ * @brief Dealloc all disk buffers that hold forest data (and unmap the disk
+ * file if the disk was mapped).
  * @param[in, out] disk Disk for which to empty the forest/root.
  */
 void swicc_disk_root_empty(swicc_disk_st *const disk);
@@ -180,6 +359,18 @@ void swicc_disk_root_empty(swicc_disk_st *const disk);
  */
 void swicc_disk_lutsid_empty(swicc_disk_tree_st *const tree);
 
+/**
+ * @brief Remove the child LUT from a given tree.
+ * @param[in, out] tree The tree in which to empty the child LUT.
+ */
+void swicc_disk_lutchild_empty(swicc_disk_tree_st *const tree);
+
+/**
+ * @brief Remove the header table from a given tree.
+ * @param[in, out] tree The tree in which to empty the header table.
+ */
+void swicc_disk_hdrtbl_empty(swicc_disk_tree_st *const tree);
+
 /**
  * @brief Dealloc all disk buffers that hold ID LUT data.
  * @param[in, out] disk Disk for which to empty the ID LUT.
@@ -193,6 +384,32 @@ void swicc_disk_lutid_empty(swicc_disk_st *const disk);
  */
 swicc_ret_et swicc_disk_lutid_rebuild(swicc_disk_st *const disk);
 
+/**
+ * @brief Dealloc all disk buffers that hold name LUT data.
+ * @param[in, out] disk Disk for which to empty the name LUT.
+ */
+void swicc_disk_lutname_empty(swicc_disk_st *const disk);
+
+/**
+ * @brief Dealloc all disk buffers that hold AID LUT data.
+ * @param[in, out] disk Disk for which to empty the AID LUT.
+ */
+void swicc_disk_lutaid_empty(swicc_disk_st *const disk);
+
+/**
+ * @brief Create the LUT for names of the MF and DFs on the disk.
+ * @param[in, out] disk
+ * @return Return code.
+ */
+swicc_ret_et swicc_disk_lutname_rebuild(swicc_disk_st *const disk);
+
+/**
+ * @brief Create the LUT for AIDs of the ADFs on the disk.
+ * @param[in, out] disk
+ * @return Return code.
+ */
+swicc_ret_et swicc_disk_lutaid_rebuild(swicc_disk_st *const disk);
+
 /**
  * @brief Create a LUT for SIDs for a tree.
  * @param[in, out] disk
@@ -202,6 +419,40 @@ swicc_ret_et swicc_disk_lutid_rebuild(swicc_disk_st *const disk);
 swicc_ret_et swicc_disk_lutsid_rebuild(swicc_disk_st *const disk,
                                        swicc_disk_tree_st *const tree);
 
+/**
+ * @brief Create a LUT for the children of all folders of a tree.
+ * @param[in, out] disk
+ * @param[in, out] tree The tree for which to recreate the child LUT.
+ * @return Return code.
+ */
+swicc_ret_et swicc_disk_lutchild_rebuild(swicc_disk_st *const disk,
+                                         swicc_disk_tree_st *const tree);
+
+/**
+ * @brief Decode the headers of all folders of a tree into its header table.
+ * @param[in, out] disk
+ * @param[in, out] tree The tree for which to recreate the header table.
+ * @return Return code.
+ * @note Must be done again whenever the tree buffer gets moved or the headers
+ * in it get modified.
+ */
+swicc_ret_et swicc_disk_hdrtbl_rebuild(swicc_disk_st *const disk,
+                                       swicc_disk_tree_st *const tree);
+
+/**
+ * @brief Perform a lookup in the header table of a given tree.
+ * @param[in] tree
+ * @param[in] offset_trel Tree-relative offset of the folder.
+ * @param[out] file Gets a pointer to the decoded header of the folder inside
+ * the header table (only on success).
+ * @return Return code.
+ * @warning The decoded header must only be read, and only until the header
+ * table gets emptied or rebuilt.
+ */
+swicc_ret_et swicc_disk_hdrtbl_lookup(swicc_disk_tree_st const *const tree,
+                                      uint32_t const offset_trel,
+                                      swicc_fs_file_st const **const file);
+
 /**
  * @brief Perform a lookup in the SID LUT of a given tree.
  * @param[in] tree
@@ -214,6 +465,22 @@ swicc_ret_et swicc_disk_lutsid_lookup(swicc_disk_tree_st const *const tree,
                                       swicc_fs_sid_kt const sid,
                                       swicc_fs_file_st *const file);
 
+/**
+ * @brief Perform a lookup in the child LUT of a given tree.
+ * @param[in] tree
+ * @param[in] folder The folder in which to look for the child.
+ * @param[in] id ID of the child.
+ * @param[out] file Gets the header of the child that was found with the lookup
+ * (only on success).
+ * @return Return code.
+ * @note Only direct children are found, not the folder itself nor any files
+ * nested deeper.
+ */
+swicc_ret_et swicc_disk_lutchild_lookup(swicc_disk_tree_st const *const tree,
+                                        swicc_fs_file_st const *const folder,
+                                        swicc_fs_id_kt const id,
+                                        swicc_fs_file_st *const file);
+
 /**
  * @brief Perform a lookup in the ID LUT of a given disk.
  * @param[in] disk
@@ -229,6 +496,50 @@ swicc_ret_et swicc_disk_lutid_lookup(swicc_disk_st const *const disk,
                                      swicc_fs_id_kt const id,
                                      swicc_fs_file_st *const file);
 
+/**
+ * @brief Perform a lookup in the name LUT of a given disk.
+ * @param[in] disk
+ * @param[out] tree Gets a pointer to the tree in which the file is located
+ * (only on success).
+ * @param[in] name The name or the start of the name. No need for it to be
+ * NULL-terminated.
+ * @param[in] name_len Length of the name, at most the length of a name.
+ * @param[out] file Gets the MF or DF header that was found with the lookup
+ * (only on success).
+ * @return Return code.
+ * @note When more files have a name starting with the given name, the one with
+ * the lowest name is found.
+ */
+swicc_ret_et swicc_disk_lutname_lookup(swicc_disk_st const *const disk,
+                                       swicc_disk_tree_st **const tree,
+                                       uint8_t const *const name,
+                                       uint32_t const name_len,
+                                       swicc_fs_file_st *const file);
+
+/**
+ * @brief Perform a lookup in the AID LUT of a given disk.
+ * @param[in] disk
+ * @param[in] aid The AID or a right-truncated AID (i.e. the start of the AID).
+ * @param[in] aid_len Length of the AID. Must be at least as long as the RID.
+ * @param[in] occ Which of the ADFs whose AID starts with the given AID to find.
+ * @param[in] tree_cur Tree of the currently selected ADF, can be NULL. Used as
+ * the reference point for the next and previous occurrences, when it does not
+ * match the given AID, these are the same as the first and last occurrences.
+ * @param[out] tree Gets a pointer to the tree which has the ADF at its root
+ * (only on success).
+ * @param[out] file Gets the ADF header that was found with the lookup (only on
+ * success).
+ * @return Return code.
+ * @note ADFs whose AIDs start with the same bytes are ordered by their AIDs.
+ */
+swicc_ret_et swicc_disk_lutaid_lookup(swicc_disk_st const *const disk,
+                                      uint8_t const *const aid,
+                                      uint32_t const aid_len,
+                                      swicc_fs_occ_et const occ,
+                                      swicc_disk_tree_st const *const tree_cur,
+                                      swicc_disk_tree_st **const tree,
+                                      swicc_fs_file_st *const file);
+
 /**
  * @brief Obtain data contained in a record inside a file.
  * @param[in] tree The tree which contains the file.
@@ -237,12 +548,30 @@ swicc_ret_et swicc_disk_lutid_lookup(swicc_disk_st const *const disk,
  * @param[out] buf Where the pointer to the record buffer will be written.
  * @param[in] len Length of the record buffer.
  * @return Return code.
+ * @warning The record buffer must only be read, use
+ * 'swicc_disk_file_rcrd_write' to modify a record.
  */
 swicc_ret_et swicc_disk_file_rcrd(swicc_disk_tree_st const *const tree,
                                   swicc_fs_file_st const *const file,
                                   swicc_fs_rcrd_idx_kt const idx,
                                   uint8_t **const buf, uint8_t *const len);
 
+/**
+ * @brief Overwrite the contents of a record inside a file. For shared trees,
+ * the record is written to the overlay of the tree.
+ * @param[in, out] tree The tree which contains the file.
+ * @param[in] file The file which must contain the record.
+ * @param[in] idx Index of the record to overwrite.
+ * @param[in] buf New contents of the record.
+ * @param[in] len Length of the new contents. Must be equal to the record size.
+ * @return Return code.
+ */
+swicc_ret_et swicc_disk_file_rcrd_write(swicc_disk_tree_st *const tree,
+                                        swicc_fs_file_st const *const file,
+                                        swicc_fs_rcrd_idx_kt const idx,
+                                        uint8_t const *const buf,
+                                        uint8_t const len);
+
 /**
  * @brief Gets the number of records that a file holds.
  * @param[in] tree The tree which contains the file.
@@ -54,13 +54,18 @@ swicc_ret_et swicc_va_reset(swicc_fs_st *const fs);
  * @param[in] pix_len Length of the PIX component of the AID (the RID is always
  * the same length and the AID buffer must be guaranteed to contain at least the
  * RID plus as many PIX bytes as have been specified here).
+ * @param[in] occ Which of the ADFs matching the AID to select. The next and
+ * previous occurrences are relative to the current ADF.
  * @return Return code.
  * @note The provided AID can be right-truncated in which case the selection
- * will be made based.
+ * will be made based on the start of the AIDs of all ADFs.
+ * @note ADFs are looked up in the AID LUT of the disk which gets built when
+ * the disk is mounted.
  */
 swicc_ret_et swicc_va_select_adf(swicc_fs_st *const fs,
                                  uint8_t const *const aid,
-                                 uint32_t const pix_len);
+                                 uint32_t const pix_len,
+                                 swicc_fs_occ_et const occ);
 
 /**
  * @brief Select a file by DF name.
@@ -69,6 +74,8 @@ swicc_ret_et swicc_va_select_adf(swicc_fs_st *const fs,
  * NULL-terminated.
  * @param[in] df_name_len Length of the DF name string.
  * @return Return code.
+ * @note The given name can be the start of a DF name. DFs are looked up in the
+ * name LUT of the disk.
  */
 swicc_ret_et swicc_va_select_file_dfname(swicc_fs_st *const fs,
                                          uint8_t const *const df_name,
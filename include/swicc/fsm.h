@@ -138,6 +138,13 @@ typedef enum swicc_fsm_state_e
      * after just the header.
      */
     SWICC_FSM_STATE_CMD_DATA,
+
+    /**
+     * When T=1 was selected with a PPS, this replaces the 3 states above. Whole
+     * blocks are received here and every block gets a block in response.
+     * ISO/IEC 7816-3:2006 clause.11
+     */
+    SWICC_FSM_STATE_T1_BLOCK,
 } swicc_fsm_state_et;
 
 /**
@@ -5,7 +5,9 @@
 
 #include "swicc/common.h"
 #include <stdbool.h>
+#include <pthread.h>
 #include <stdint.h>
+#include <sys/epoll.h>
 
 /**
  * Maximum number of clients (cards) that can connect to one server. This is
@@ -14,6 +16,49 @@
  */
 #define SWICC_NET_CLIENT_COUNT_MAX 8U
 
+/**
+ * Maximum number of socket events the multi-card client handles in one poll.
+ * Cards with more pending events are handled in the following polls.
+ */
+#define SWICC_NET_MUX_EVT_COUNT_MAX 64U
+
+/**
+ * Maximum number of cards one multi-card client can serve when it uses the
+ * io_uring backend. With epoll there is no such limit.
+ */
+#define SWICC_NET_URING_CARD_COUNT_MAX 256U
+
+/* Size of the buffer each client uses to create debug strings. */
+#define SWICC_NET_DBG_BUF_SIZE 2048U
+
+/**
+ * How long a worker of a card pool waits for messages at most before checking
+ * if it has to stop.
+ */
+#define SWICC_NET_POOL_POLL_TIMEOUT_MS 100
+
+/* Maximum number of requests the server can send in one batch. */
+#define SWICC_NET_BATCH_COUNT_MAX 16U
+
+/**
+ * How many messages each direction of a shared memory transport can hold. Shall
+ * be a power of two.
+ */
+#define SWICC_NET_SHM_SLOT_COUNT 4U
+
+/**
+ * How many times a side of a shared memory transport checks for a message
+ * before it goes to sleep. Sleeping is done right away on single-CPU hosts
+ * since spinning would only delay the other side.
+ */
+#define SWICC_NET_SHM_SPIN_COUNT 8192U
+
+/* The indices of a shared memory ring never share a cache line. */
+#define SWICC_NET_SHM_CACHE_LINE_SIZE 64U
+
+/* Longest name of a shared memory segment (with the null-terminator). */
+#define SWICC_NET_SHM_NAME_LEN_MAX 64U
+
 /* If the keep-alive functionality of sockets should be used. */
 #define SWICC_NET_SERVER_CLIENT_KEEPALIVE 0U
 
@@ -30,6 +75,13 @@ typedef enum swicc_net_msg_ctrl_e
     SWICC_NET_MSG_CTRL_MOCK_RESET_WARM_PPS_Y,
     SWICC_NET_MSG_CTRL_MOCK_RESET_COLD_PPS_N,
     SWICC_NET_MSG_CTRL_MOCK_RESET_WARM_PPS_N,
+    /**
+     * The first byte of the data holds the number of requests that follow
+     * right after this message. The client responds to this message and to
+     * each request in one write once all of them are handled. Clients which
+     * don't support batches respond with a failure.
+     */
+    SWICC_NET_MSG_CTRL_BATCH,
 
     /* Control values for responses (client -> server). */
     SWICC_NET_MSG_CTRL_SUCCESS = 0xF0,
@@ -57,7 +109,8 @@ typedef struct swicc_net_msg_data_s
     uint8_t ctrl;
 
     /**
-     * +2 because we can have 256 bytes of response followed by 2 status bytes.
+     * +2 because we can have SWICC_DATA_MAX bytes of response followed by 2
+     * status bytes.
      */
     uint8_t buf[SWICC_DATA_MAX + 2U];
 } __attribute__((packed)) swicc_net_msg_data_st;
@@ -80,18 +133,182 @@ typedef struct swicc_net_client_s
     int32_t sock_client;
 } swicc_net_client_st;
 
+/**
+ * A lock-free single-producer single-consumer ring of messages in shared
+ * memory. The indices only ever increase (wrapping around) and they double as
+ * the futex words on which the other side sleeps.
+ */
+typedef struct swicc_net_shm_ring_s
+{
+    /* Written by the producer. */
+    uint32_t tail __attribute__((aligned(SWICC_NET_SHM_CACHE_LINE_SIZE)));
+    uint32_t producer_waiting;
+
+    /* Written by the consumer. */
+    uint32_t head __attribute__((aligned(SWICC_NET_SHM_CACHE_LINE_SIZE)));
+    uint32_t consumer_waiting;
+
+    swicc_net_msg_st slot[SWICC_NET_SHM_SLOT_COUNT]
+        __attribute__((aligned(SWICC_NET_SHM_CACHE_LINE_SIZE)));
+} swicc_net_shm_ring_st;
+
+/* Shared memory segment of one card: a ring for each direction. */
+typedef struct swicc_net_shm_seg_s
+{
+    swicc_net_shm_ring_st req; /* From the server (reader) to the card. */
+    swicc_net_shm_ring_st res; /* From the card to the server. */
+} swicc_net_shm_seg_st;
+
+/* One side of a shared memory transport. */
+typedef struct swicc_net_shm_s
+{
+    swicc_net_shm_seg_st *seg;
+    bool server; /* The server creates (and in the end removes) the segment. */
+    uint32_t spin_count;
+    char name[SWICC_NET_SHM_NAME_LEN_MAX];
+} swicc_net_shm_st;
+
 /**
  * @brief Basically a printf function.
  * @param fmt
  */
 typedef void swicc_net_logger_ft(char const *const fmt, ...);
 
+/**
+ * A batch of requests being handled by a client. The responses are created
+ * back-to-back in one buffer so they can all be sent at once.
+ */
+typedef struct swicc_net_batch_s
+{
+    bool active; /* From receiving the batch until its responses are sent. */
+    uint32_t count;   /* Number of requests in the batch. */
+    uint32_t idx;     /* Number of requests handled so far. */
+    uint32_t buf_len; /* Length of the responses created so far. */
+    uint8_t buf[sizeof(swicc_net_msg_st) * (SWICC_NET_BATCH_COUNT_MAX + 1U)];
+} swicc_net_batch_st;
+
+/* How the multi-card client waits for messages and does the socket I/O. */
+typedef enum swicc_net_backend_e
+{
+    /* Wait for readable sockets with epoll then receive and send directly. */
+    SWICC_NET_BACKEND_EPOLL,
+
+    /**
+     * Queue the receives and sends on an io_uring and submit them all at once
+     * together with waiting for completions, so one poll takes a single
+     * syscall no matter how many cards it serves. Requests are received into
+     * registered buffers.
+     */
+    SWICC_NET_BACKEND_URING,
+} swicc_net_backend_et;
+
+/* A card served by the multi-card client. */
+typedef struct swicc_net_mux_card_s
+{
+    /* Shall be set by the user before adding the card. */
+    swicc_st *swicc_state;
+    swicc_net_client_st client_ctx;
+
+    /**
+     * When the card stops being served by the multi-card client (because of a
+     * network error or a shutdown request), this holds the reason. It has the
+     * same meaning as the return code of the single-card client.
+     */
+    swicc_ret_et ret;
+
+    /* Internal. */
+    bool msg_received;
+    bool msg_tx_pending; /* Response waits for the socket to be writable. */
+    uint32_t msg_rx_len; /* Received part of the request. */
+    uint32_t msg_tx_len; /* Sent part of the response. */
+    uint32_t uring_slot; /* Index of the card in the io_uring backend. */
+    bool uring_fixed;    /* Card has a registered buffer in the io_uring. */
+    swicc_net_msg_st msg_rx;
+    swicc_net_msg_st msg_tx;
+    swicc_net_batch_st batch;
+} swicc_net_mux_card_st;
+
+typedef struct swicc_net_mux_s swicc_net_mux_st;
+
+/* State of the io_uring backend, only used inside the network module. */
+typedef struct swicc_net_uring_s swicc_net_uring_st;
+
+/**
+ * @brief Called when the multi-card client stops serving a card on its own.
+ * At this point, the card is already removed and can be destroyed.
+ * @param[in, out] mux
+ * @param[in, out] card The card that was removed.
+ */
+typedef void swicc_net_mux_card_rm_ft(swicc_net_mux_st *const mux,
+                                      swicc_net_mux_card_st *const card);
+
+/**
+ * A client which serves many cards (each with its own socket) from one thread
+ * by waiting on all the sockets at once.
+ */
+struct swicc_net_mux_s
+{
+    /**
+     * When set, the run loop returns (after the current poll). Can be set
+     * from a signal handler.
+     */
+    volatile bool shutdown;
+
+    /* Optional, called when a card is removed by the client itself. */
+    swicc_net_mux_card_rm_ft *card_rm_cb;
+
+    /* The backend in use (read-only), see 'swicc_net_mux_create'. */
+    swicc_net_backend_et backend;
+
+    /* Internal. */
+    int32_t fd_epoll;
+    swicc_net_uring_st *uring;
+    uint32_t card_count; /* Accessed atomically. */
+    uint32_t evt_count;
+    struct epoll_event evt[SWICC_NET_MUX_EVT_COUNT_MAX];
+    char dbg_buf[SWICC_NET_DBG_BUF_SIZE];
+};
+
+typedef struct swicc_net_pool_s swicc_net_pool_st;
+
+/* A worker of a card pool, i.e., a thread with its own multi-card client. */
+typedef struct swicc_net_pool_worker_s
+{
+    swicc_net_pool_st *pool;
+    pthread_t thread;
+    swicc_net_mux_st mux;
+    swicc_ret_et ret; /* Return code of the worker after it stopped. */
+} swicc_net_pool_worker_st;
+
+/**
+ * A pool of cards served by many threads (workers). Each card is pinned to one
+ * worker so its state is only ever touched by one thread, and each worker is
+ * pinned to one CPU.
+ */
+struct swicc_net_pool_s
+{
+    /**
+     * Optional, called when a card is removed by a worker. It is called from
+     * the thread of that worker.
+     */
+    swicc_net_mux_card_rm_ft *card_rm_cb;
+
+    /* Internal. */
+    bool running;
+    bool shutdown; /* Accessed atomically. */
+    swicc_net_logger_ft *logger;
+    uint32_t worker_count;
+    swicc_net_pool_worker_st *worker;
+};
+
 /**
  * @brief Since things can break in networking, and swICC does not log anything
  * ever (only provides debugging utilities that generate debug string), a logger
  * must be registered to get useful logging output from the network module.
  * @param[in] logger_func This function shall work like printf but output in
  * whatever way is most suited by the user.
+ * @note The logger is registered only for the calling thread. The workers of a
+ * card pool use the logger of the thread which created the pool.
  */
 void swicc_net_logger_register(swicc_net_logger_ft *const logger_func);
 
@@ -122,6 +339,19 @@ void swicc_net_client_sig_default(void);
 swicc_ret_et swicc_net_server_create(swicc_net_server_st *const server_ctx,
                                      char const *const port_str);
 
+/**
+ * @brief Create a network server on a Unix domain socket. Clients on the same
+ * host connect to it with less overhead than over TCP loopback.
+ * @param[out] server_ctx The server context that will be initialized.
+ * @param[in] path Path of the socket file. A path starting with '@' is a name
+ * in the abstract namespace (Linux only) so no file gets created.
+ * @return Return code.
+ * @note Server socket is non-blocking. A socket file left behind by an earlier
+ * server on the same path gets replaced.
+ */
+swicc_ret_et swicc_net_server_create_unix(swicc_net_server_st *const server_ctx,
+                                          char const *const path);
+
 /**
  * @brief Destroy the network server. This includes all the sockets (both server
  * and client).
@@ -140,6 +370,17 @@ void swicc_net_server_destroy(swicc_net_server_st *const server_ctx);
 swicc_ret_et swicc_net_client_create(swicc_net_client_st *const client_ctx,
                                      char const *const hostname_str,
                                      char const *const port_str);
+/**
+ * @brief Create a network client and connect it to a server on a Unix domain
+ * socket.
+ * @param[out] client_ctx The network client context that will be initialized.
+ * @param[in] path Path of the server socket, same as for creating the server.
+ * @return Return code.
+ * @note Client socket is blocking.
+ */
+swicc_ret_et swicc_net_client_create_unix(swicc_net_client_st *const client_ctx,
+                                          char const *const path);
+
 /**
  * @brief Destroy the network client.
  * @param[in, out] client_ctx The client to destroy.
@@ -151,6 +392,8 @@ void swicc_net_client_destroy(swicc_net_client_st *const client_ctx);
  * @param[in] sock Where to receive from.
  * @param[out] msg Where to write the received message.
  * @return Return code.
+ * @note Messages split over many reads (and non-blocking sockets) are handled
+ * by waiting for the rest of the message.
  */
 swicc_ret_et swicc_net_recv(int32_t const sock, swicc_net_msg_st *const msg);
 
@@ -163,6 +406,62 @@ swicc_ret_et swicc_net_recv(int32_t const sock, swicc_net_msg_st *const msg);
 swicc_ret_et swicc_net_send(int32_t const sock,
                             swicc_net_msg_st const *const msg);
 
+/**
+ * @brief Send many requests to a client in one write. The responses shall be
+ * received with 'swicc_net_batch_recv'.
+ * @param[in] sock Where to send the requests.
+ * @param[in] msg The requests.
+ * @param[in] count Number of requests, at most the max batch count. With 0
+ * requests, this can be used to check if the client supports batches.
+ * @return Return code.
+ * @note Requests can depend on the responses to the earlier requests of the
+ * batch (e.g. the data of a TPDU following its procedure byte) since the
+ * client handles them in order.
+ */
+swicc_ret_et swicc_net_batch_send(int32_t const sock,
+                                  swicc_net_msg_st const *const msg,
+                                  uint32_t const count);
+
+/**
+ * @brief Receive the responses to a batch of requests.
+ * @param[in] sock Where to receive from.
+ * @param[out] msg Where to write the responses.
+ * @param[in] count Number of requests that were sent in the batch.
+ * @return Return code. Fails also when the client does not support batches.
+ */
+swicc_ret_et swicc_net_batch_recv(int32_t const sock,
+                                  swicc_net_msg_st *const msg,
+                                  uint32_t const count);
+
+/**
+ * @brief Receive a part of a message on a given socket, e.g., for receiving a
+ * message on a non-blocking socket. The message is received directly into the
+ * given message so it must stay the same until it is received completely.
+ * @param[in] sock Where to receive from.
+ * @param[out] msg Where to write the received message.
+ * @param[in, out] recvd_len How many bytes of the message were received so far.
+ * Shall be 0 when starting to receive a new message.
+ * @return Return code. SWICC_RET_NET_INCOMPLETE when no more data is available
+ * yet, in which case this shall be called again when there is.
+ */
+swicc_ret_et swicc_net_recv_part(int32_t const sock,
+                                 swicc_net_msg_st *const msg,
+                                 uint32_t *const recvd_len);
+
+/**
+ * @brief Send a part of a message to some socket, e.g., for sending a message
+ * on a non-blocking socket.
+ * @param[in] sock Where to send message.
+ * @param[in] msg The message that will be sent.
+ * @param[in, out] sent_len How many bytes of the message were sent so far.
+ * Shall be 0 when starting to send a new message.
+ * @return Return code. SWICC_RET_NET_INCOMPLETE when the socket can't take
+ * more data yet, in which case this shall be called again when it can.
+ */
+swicc_ret_et swicc_net_send_part(int32_t const sock,
+                                 swicc_net_msg_st const *const msg,
+                                 uint32_t *const sent_len);
+
 /**
  * @brief Attempt to accept a client connection. Since the server socket is
  * non-blocking, this will indicate if no clients were present in queue, if a
@@ -176,6 +475,21 @@ swicc_ret_et swicc_net_send(int32_t const sock,
 swicc_ret_et swicc_net_server_client_connect(
     swicc_net_server_st *const server_ctx, uint16_t const slot);
 
+/**
+ * @brief Create a client which is connected to a server slot through a socket
+ * pair, i.e., without any network or listening socket. This is for running
+ * the server and the client in the same process (e.g. in tests).
+ * @param[in, out] server_ctx The server that gets the client. Its listening
+ * socket may be -1.
+ * @param[in] slot On which slot to connect the client.
+ * @param[out] client_ctx The network client context that will be initialized.
+ * @return Return code.
+ * @note Both sockets are blocking.
+ */
+swicc_ret_et swicc_net_server_client_pair(
+    swicc_net_server_st *const server_ctx, uint16_t const slot,
+    swicc_net_client_st *const client_ctx);
+
 /**
  * @brief Disconnect a client from a server.
  * @param[in, out] server_ctx
@@ -196,3 +510,182 @@ void swicc_net_server_client_disconnect(swicc_net_server_st *const server_ctx,
  */
 swicc_ret_et swicc_net_client(swicc_st *const swicc_state,
                               swicc_net_client_st *const client_ctx);
+
+/**
+ * @brief Create the server side of a shared memory transport for one card. This
+ * is for when the server (reader) and the card run on the same host and it
+ * carries the same messages as the sockets do.
+ * @param[out] shm
+ * @param[in] name Name of the shared memory segment (see shm_open), e.g.
+ * "/swicc-card-0". A stale segment with the same name is replaced.
+ * @return Return code.
+ */
+swicc_ret_et swicc_net_shm_server_create(swicc_net_shm_st *const shm,
+                                         char const *const name);
+
+/**
+ * @brief Create the card side of a shared memory transport by opening the
+ * segment created by the server.
+ * @param[out] shm
+ * @param[in] name Name of the shared memory segment.
+ * @return Return code.
+ */
+swicc_ret_et swicc_net_shm_client_create(swicc_net_shm_st *const shm,
+                                         char const *const name);
+
+/**
+ * @brief Destroy a side of a shared memory transport. The other side is told
+ * that this one went away and gets woken up if it is waiting. The server side
+ * also removes the segment name.
+ * @param[in, out] shm
+ */
+void swicc_net_shm_destroy(swicc_net_shm_st *const shm);
+
+/**
+ * @brief Send a message to the other side of a shared memory transport, waiting
+ * for room if the other side is behind.
+ * @param[in, out] shm
+ * @param[in] msg
+ * @return Return code. Fails once the other side went away.
+ */
+swicc_ret_et swicc_net_shm_send(swicc_net_shm_st *const shm,
+                                swicc_net_msg_st const *const msg);
+
+/**
+ * @brief Receive a message from the other side of a shared memory transport,
+ * waiting (without using the CPU after a short spin) until there is one.
+ * @param[in, out] shm
+ * @param[out] msg
+ * @return Return code. Fails once the other side went away and all its
+ * messages were received.
+ */
+swicc_ret_et swicc_net_shm_recv(swicc_net_shm_st *const shm,
+                                swicc_net_msg_st *const msg);
+
+/**
+ * @brief Same as the single-card client but over a shared memory transport.
+ * Requests are handled in place in the shared memory and responses are created
+ * right in it, so no message is ever copied. Batches are not supported since
+ * they are not needed without syscalls.
+ * @param[in, out] swicc_state An initialized swICC state.
+ * @param[in, out] shm The card side of a shared memory transport.
+ * @return Return code.
+ */
+swicc_ret_et swicc_net_client_shm(swicc_st *const swicc_state,
+                                  swicc_net_shm_st *const shm);
+
+/**
+ * @brief Create a multi-card client without any cards.
+ * @param[out] mux
+ * @param[in] backend Which backend to use. When io_uring is requested but is
+ * not available (e.g. the kernel is too old or io_uring is disabled), the
+ * client falls back to epoll and the backend in the client says so.
+ * @return Return code.
+ */
+swicc_ret_et swicc_net_mux_create(swicc_net_mux_st *const mux,
+                                  swicc_net_backend_et const backend);
+
+/**
+ * @brief Destroy a multi-card client. The cards are not destroyed since they
+ * are owned by the user.
+ * @param[in, out] mux
+ */
+void swicc_net_mux_destroy(swicc_net_mux_st *const mux);
+
+/**
+ * @brief Start serving a card. This can be done at any time, including from
+ * the card removal callback.
+ * @param[in, out] mux
+ * @param[in, out] card A card with an initialized swICC state and a connected
+ * network client. It must stay valid until it gets removed.
+ * @return Return code.
+ * @note With epoll, the socket of the card is switched to non-blocking mode so
+ * that one card sending a message in pieces never stalls the other cards. With
+ * io_uring, it is switched to blocking mode instead since the receives and
+ * sends wait inside the kernel, and the card only starts being served by the
+ * next poll (which this wakes up when it is done from another thread).
+ */
+swicc_ret_et swicc_net_mux_card_add(swicc_net_mux_st *const mux,
+                                    swicc_net_mux_card_st *const card);
+
+/**
+ * @brief Stop serving a card. This can be done at any time, including from
+ * the card removal callback.
+ * @param[in, out] mux
+ * @param[in, out] card
+ * @return Return code.
+ * @note The network client of the card is not destroyed. With io_uring, this
+ * must be done from the thread which polls the client.
+ */
+swicc_ret_et swicc_net_mux_card_remove(swicc_net_mux_st *const mux,
+                                       swicc_net_mux_card_st *const card);
+
+/**
+ * @brief Wait for messages on the sockets of all cards and handle them the
+ * same way the single-card client does.
+ * @param[in, out] mux
+ * @param[in] timeout_ms How long to wait for a message at most. Negative means
+ * to wait indefinitely.
+ * @return Return code.
+ * @note Cards whose network client fails, or which request a shutdown, get
+ * removed and the removal callback is called for them.
+ */
+swicc_ret_et swicc_net_mux_poll(swicc_net_mux_st *const mux,
+                                int32_t const timeout_ms);
+
+/**
+ * @brief Run the multi-card client, i.e., keep polling until a shutdown is
+ * requested or there are no cards left.
+ * @param[in, out] mux
+ * @return Return code.
+ */
+swicc_ret_et swicc_net_mux_run(swicc_net_mux_st *const mux);
+
+/**
+ * @brief Create a card pool. The workers are not started yet.
+ * @param[out] pool
+ * @param[in] worker_count How many workers to create. When 0, one worker is
+ * created for each online CPU.
+ * @param[in] backend Backend of the multi-card client of every worker.
+ * @return Return code.
+ */
+swicc_ret_et swicc_net_pool_create(swicc_net_pool_st *const pool,
+                                   uint32_t const worker_count,
+                                   swicc_net_backend_et const backend);
+
+/**
+ * @brief Destroy a card pool (stopping it first if it is running). The cards
+ * are not destroyed since they are owned by the user.
+ * @param[in, out] pool
+ */
+void swicc_net_pool_destroy(swicc_net_pool_st *const pool);
+
+/**
+ * @brief Start the workers of a card pool. Worker n is pinned to the n-th CPU
+ * the process is allowed to run on (wrapping around).
+ * @param[in, out] pool
+ * @return Return code.
+ */
+swicc_ret_et swicc_net_pool_start(swicc_net_pool_st *const pool);
+
+/**
+ * @brief Stop all the workers of a card pool and wait for them to finish. The
+ * cards that were not removed stay in the pool and will be served again once
+ * the pool is restarted.
+ * @param[in, out] pool
+ * @return Return code. When a worker failed, this is the return code of the
+ * first worker that failed.
+ */
+swicc_ret_et swicc_net_pool_stop(swicc_net_pool_st *const pool);
+
+/**
+ * @brief Add a card to a pool. The card is pinned to the worker with the least
+ * cards. This can be done at any time, also while the pool is running.
+ * @param[in, out] pool
+ * @param[in, out] card Same as for the multi-card client.
+ * @return Return code.
+ * @note Cards are removed only by their workers (e.g. when a card requests a
+ * shutdown) or by destroying the pool.
+ */
+swicc_ret_et swicc_net_pool_card_add(swicc_net_pool_st *const pool,
+                                     swicc_net_mux_card_st *const card);
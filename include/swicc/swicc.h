@@ -11,6 +11,7 @@
 #include "swicc/mock.h"
 #include "swicc/net.h"
 #include "swicc/pps.h"
+#include "swicc/t1.h"
 #include "swicc/tpdu.h"
 
 /* For holding transmission protocol configuration. */
@@ -29,8 +30,49 @@ typedef struct swicc_tp_s
     uint16_t fi;
     uint32_t fmax;
     uint8_t di;
+
+    /* The transmission protocol type (T=0 or T=1). */
+    uint8_t t;
 } swicc_tp_st;
 
+/* State of the T=1 block protocol (ISO/IEC 7816-3:2006 clause.11). */
+typedef struct swicc_t1_s
+{
+    /* A block is received in parts and held here until complete. */
+    uint8_t block_rx[SWICC_T1_BLOCK_MAX];
+    uint16_t block_rx_len;
+
+    /**
+     * The last block sent is kept so it can be sent again when the interface
+     * asks for it with an R-block.
+     */
+    uint8_t block_tx[SWICC_T1_BLOCK_MAX];
+    uint16_t block_tx_len;
+
+    /* Command APDU being received, possibly over multiple chained I-blocks. */
+    uint8_t cmd[SWICC_T1_APDU_CMD_MAX];
+    uint16_t cmd_len;
+    /* True when the chained command did not fit and will be rejected. */
+    bool cmd_overflow;
+
+    /**
+     * Response APDU being sent, possibly over multiple chained I-blocks. The
+     * offset is where the next I-block starts.
+     */
+    uint8_t res[SWICC_DATA_MAX + 2U];
+    uint16_t res_len;
+    uint16_t res_off;
+
+    /* Send-sequence number of the next I-block sent by the card. */
+    uint8_t ns;
+    /* Send-sequence number expected in the next I-block of the interface. */
+    uint8_t nr;
+
+    /* Information field size of the interface. */
+    uint8_t ifsd;
+    swicc_t1_edc_et edc;
+} swicc_t1_st;
+
 /* Anything that is part of the file system is held here. */
 typedef struct swicc_fs_s
 {
@@ -88,6 +130,13 @@ typedef struct swicc_s
     swicc_fs_st fs;
     swicc_apdu_rc_st apdu_rc;
 
+    /**
+     * Handlers registered per class and instruction (see
+     * 'swicc_apduh_ins_register'). This is outside of internal so that it is
+     * kept across resets.
+     */
+    swicc_apduh_ft *apduh_ins[SWICC_APDUH_CLA_COUNT][UINT8_MAX + 1U];
+
     /* This shall not be modified by anything other than the swICC framework. */
     struct
     {
@@ -123,6 +172,13 @@ typedef struct swicc_s
         swicc_fsm_state_et fsm_state;
 
         swicc_tp_st tp;
+        swicc_t1_st t1;
+
+        /**
+         * Responses of SELECT so they are encoded only once per file. Cleared
+         * on reset and when a disk gets mounted.
+         */
+        swicc_apduh_fcp_st apduh_fcp[SWICC_APDUH_FCP_CACHE_COUNT];
 
         swicc_apduh_ft *apduh_pro;      /* For all proprietary classes. */
         swicc_apduh_ft *apduh_override; /* For overriding responses before the
@@ -0,0 +1,141 @@
+#pragma once
+
+#include "swicc/common.h"
+
+/**
+ * T=1 = half-duplex block transmission protocol described in ISO/IEC
+ * 7816-3:2006 clause.11.
+ */
+
+/* Length of the prologue field (NAD, PCB, LEN). ISO/IEC 7816-3:2006 11.3.1 */
+#define SWICC_T1_PROLOGUE_LEN 3U
+
+/**
+ * Maximum length of the information field. LEN = 0xFF is RFU.
+ * ISO/IEC 7816-3:2006 clause.11.4.2
+ */
+#define SWICC_T1_IFS_MAX 254U
+
+/* Default IFSD until the interface says otherwise. ISO/IEC 7816-3:2006 11.4.2 */
+#define SWICC_T1_IFSD_DEFAULT 32U
+
+/**
+ * The IFSC and EDC offered by the card in its ATR (TA3 and TC3). The IFSC is
+ * chosen so that a whole block with an LRC fits in SWICC_DATA_MAX + 2 bytes
+ * i.e. in one network message.
+ * @warning The ATR check byte (TCK) has to be updated when changing these.
+ */
+#define SWICC_T1_IFSC SWICC_T1_IFS_MAX
+#define SWICC_T1_EDC SWICC_T1_EDC_LRC
+
+/* Longest possible block: prologue, longest INF, and a CRC. */
+#define SWICC_T1_BLOCK_MAX (SWICC_T1_PROLOGUE_LEN + SWICC_T1_IFS_MAX + 2U)
+
+/**
+ * Longest command APDU that can be sent over T=1: header, extended Lc, data,
+ * and extended Le.
+ */
+#define SWICC_T1_APDU_CMD_MAX (4U + 3U + SWICC_DATA_MAX + 2U)
+
+/**
+ * The PCB encodes the type of block in bits 8 and 7. ISO/IEC 7816-3:2006
+ * clause.11.3.2.2
+ */
+#define SWICC_T1_PCB_I_MASK 0b10000000
+#define SWICC_T1_PCB_I 0b00000000
+#define SWICC_T1_PCB_I_NS 0b01000000 /* Send-sequence number. */
+#define SWICC_T1_PCB_I_M 0b00100000  /* More-data bit (chaining). */
+
+#define SWICC_T1_PCB_RS_MASK 0b11000000
+#define SWICC_T1_PCB_R 0b10000000
+#define SWICC_T1_PCB_R_NR 0b00010000 /* Number of the expected I-block. */
+#define SWICC_T1_PCB_R_ERR_MASK 0b00001111
+#define SWICC_T1_PCB_R_ERR_NONE 0b00000000
+#define SWICC_T1_PCB_R_ERR_EDC 0b00000001   /* EDC or parity error. */
+#define SWICC_T1_PCB_R_ERR_OTHER 0b00000010 /* Any other error. */
+
+#define SWICC_T1_PCB_S 0b11000000
+#define SWICC_T1_PCB_S_RES 0b00100000 /* Response (=1) or request (=0). */
+#define SWICC_T1_PCB_S_TYPE_MASK 0b00011111
+#define SWICC_T1_PCB_S_RESYNCH 0b00000000
+#define SWICC_T1_PCB_S_IFS 0b00000001
+#define SWICC_T1_PCB_S_ABORT 0b00000010
+#define SWICC_T1_PCB_S_WTX 0b00000011
+
+/**
+ * Error detection code type, indicated by bit 1 of the first TC for T=1 in the
+ * ATR. ISO/IEC 7816-3:2006 clause.11.4.4
+ */
+typedef enum swicc_t1_edc_e
+{
+    SWICC_T1_EDC_LRC = 0,
+    SWICC_T1_EDC_CRC = 1,
+} swicc_t1_edc_et;
+
+/* A parsed T=1 block. */
+typedef struct swicc_t1_block_s
+{
+    uint8_t nad;
+    uint8_t pcb;
+    uint8_t len;
+    /* Points into the raw block when parsed. */
+    uint8_t const *inf;
+} swicc_t1_block_st;
+
+/**
+ * @brief Get the length of the epilogue field for an EDC type.
+ * @param[in] edc
+ * @return Length of the EDC in bytes.
+ */
+uint8_t swicc_t1_edc_len(swicc_t1_edc_et const edc);
+
+/**
+ * @brief Compute the CRC of a buffer as specified by ISO/IEC 13239
+ * (polynomial 0x1021, reflected, initial value 0xFFFF).
+ * @param[in] buf_raw Buffer.
+ * @param[in] buf_raw_len Length of the data in the buffer.
+ * @return The CRC. The most significant byte is sent first.
+ */
+uint16_t swicc_t1_crc(uint8_t const *const buf_raw, uint16_t const buf_raw_len);
+
+/**
+ * @brief Compute the expected length of a block from its prologue.
+ * @param[in] block_raw A complete or partial block. This must be at least as
+ * long as the prologue.
+ * @param[in] block_raw_len Length of the given block.
+ * @param[in] edc
+ * @param[out] block_len_exp Where the expected block length will be written.
+ * @return Return code.
+ */
+swicc_ret_et swicc_t1_block_len(uint8_t const *const block_raw,
+                                uint16_t const block_raw_len,
+                                swicc_t1_edc_et const edc,
+                                uint16_t *const block_len_exp);
+
+/**
+ * @brief Parse a raw block and verify its EDC.
+ * @param[in] block_raw
+ * @param[in] block_raw_len
+ * @param[in] edc
+ * @param[out] block Where the parsed block is written. The INF references the
+ * raw block.
+ * @return Return code. SWICC_RET_T1_EDC if only the EDC is wrong.
+ */
+swicc_ret_et swicc_t1_block_parse(uint8_t const *const block_raw,
+                                  uint16_t const block_raw_len,
+                                  swicc_t1_edc_et const edc,
+                                  swicc_t1_block_st *const block);
+
+/**
+ * @brief Create a raw block (including the EDC) from a block.
+ * @param[in] block
+ * @param[in] edc
+ * @param[out] block_raw Where to write the raw block.
+ * @param[in, out] block_raw_len Must contain the size of the raw block buffer.
+ * It will receive the length of the raw block.
+ * @return Return code.
+ */
+swicc_ret_et swicc_t1_block_deparse(swicc_t1_block_st const *const block,
+                                    swicc_t1_edc_et const edc,
+                                    uint8_t *const block_raw,
+                                    uint16_t *const block_raw_len);
@@ -14,8 +14,12 @@
 typedef struct swicc_tpdu_cmd_s
 {
     swicc_apdu_cmd_hdr_st hdr;
-    uint8_t p3; /* Separate because it is not contained in the APDU header (only
-                   in the TPDU). */
+    /**
+     * Separate because it is not contained in the APDU header (only in the
+     * TPDU). It is only a byte in a TPDU but APDU commands refer to it and
+     * those can have extended lengths.
+     */
+    uint16_t p3;
     swicc_apdu_data_st data;
 } swicc_tpdu_cmd_st;
 
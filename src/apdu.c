@@ -54,26 +54,121 @@ swicc_apdu_cla_st swicc_apdu_cmd_cla_parse(uint8_t const cla_raw)
     return cla;
 }
 
+swicc_ret_et swicc_apdu_cmd_len_parse(uint8_t const *const buf_raw,
+                                      uint16_t const buf_raw_len,
+                                      swicc_apdu_cmd_len_st *const len)
+{
+    if (buf_raw_len < sizeof(swicc_apdu_cmd_hdr_raw_st))
+    {
+        return SWICC_RET_APDU_HDR_TOO_SHORT;
+    }
+
+    /**
+     * Only a header, header and Le, header and Lc with data, or header and Lc
+     * with data and Le. Extended length fields start with a 0 byte (which is
+     * never a valid short Lc when followed by more bytes) and use 2 bytes for
+     * Lc and Le. ISO/IEC 7816-4:2020 clause.5.2
+     */
+    /* Safe cast due to check at the start. */
+    uint16_t const body_len =
+        (uint16_t)(buf_raw_len - sizeof(swicc_apdu_cmd_hdr_raw_st));
+    uint8_t const *const body = &buf_raw[sizeof(swicc_apdu_cmd_hdr_raw_st)];
+    *len = (swicc_apdu_cmd_len_st){
+        .ext = body_len > 1U && body[0U] == 0U,
+        .lc = 0U,
+        .data_offset = sizeof(swicc_apdu_cmd_hdr_raw_st),
+        .le_present = false,
+        .le = 0U,
+    };
+    if (body_len == 0U)
+    {
+        return SWICC_RET_SUCCESS;
+    }
+    else if (!len->ext)
+    {
+        if (body_len == 1U)
+        {
+            len->le_present = true;
+            len->le = body[0U];
+            return SWICC_RET_SUCCESS;
+        }
+        len->lc = body[0U];
+        len->data_offset = (uint8_t)(len->data_offset + 1U);
+        len->le_present = body_len == 1U + len->lc + 1U;
+        if (body_len != 1U + len->lc && !len->le_present)
+        {
+            return SWICC_RET_PARAM_BAD;
+        }
+        if (len->le_present)
+        {
+            len->le = body[body_len - 1U];
+        }
+        return SWICC_RET_SUCCESS;
+    }
+
+    if (body_len < 3U)
+    {
+        return SWICC_RET_PARAM_BAD;
+    }
+    /* Safe cast since just concatenating 2 bytes into a short. */
+    uint16_t const len_field = (uint16_t)((body[1U] << 8U) | body[2U]);
+    if (body_len == 3U)
+    {
+        len->le_present = true;
+        len->le = len_field;
+        return SWICC_RET_SUCCESS;
+    }
+    len->lc = len_field;
+    len->data_offset = (uint8_t)(len->data_offset + 3U);
+    if (len->lc == 0U || len->lc > SWICC_DATA_MAX)
+    {
+        return SWICC_RET_PARAM_BAD;
+    }
+    len->le_present = body_len == 3U + len->lc + 2U;
+    if (body_len != 3U + len->lc && !len->le_present)
+    {
+        return SWICC_RET_PARAM_BAD;
+    }
+    if (len->le_present)
+    {
+        /* Safe cast since just concatenating 2 bytes into a short. */
+        len->le = (uint16_t)((body[body_len - 2U] << 8U) | body[body_len - 1U]);
+    }
+    return SWICC_RET_SUCCESS;
+}
+
+uint32_t swicc_apdu_cmd_len_ne(swicc_apdu_cmd_len_st const *const len)
+{
+    if (!len->le_present)
+    {
+        return 0U;
+    }
+    if (len->le == 0U)
+    {
+        return len->ext ? UINT16_MAX + 1U : UINT8_MAX + 1U;
+    }
+    return len->le;
+}
+
 swicc_ret_et swicc_apdu_cmd_parse(uint8_t const *const buf_raw,
                                   uint16_t const buf_raw_len,
                                   swicc_apdu_cmd_st *const cmd)
 {
-    if (buf_raw_len < sizeof(swicc_apdu_cmd_hdr_raw_st) ||
-        buf_raw_len > sizeof(swicc_apdu_cmd_hdr_raw_st) + SWICC_DATA_MAX)
+    swicc_apdu_cmd_len_st len;
+    swicc_ret_et const ret =
+        swicc_apdu_cmd_len_parse(buf_raw, buf_raw_len, &len);
+    if (ret != SWICC_RET_SUCCESS)
     {
-        return SWICC_RET_APDU_HDR_TOO_SHORT;
+        return ret;
     }
 
     cmd->hdr->cla = swicc_apdu_cmd_cla_parse(buf_raw[0]);
     cmd->hdr->ins = buf_raw[1U];
     cmd->hdr->p1 = buf_raw[2U];
     cmd->hdr->p2 = buf_raw[3U];
-    cmd->data->len =
-        (uint16_t)(buf_raw_len -
-                   sizeof(swicc_apdu_cmd_hdr_raw_st)); /* Safe cast due to
-                                                         checks at the start. */
-    memcpy(cmd->data->b, &buf_raw[sizeof(swicc_apdu_cmd_hdr_raw_st)],
-           cmd->data->len);
+    *cmd->p3 = len.lc > 0U ? len.lc : len.le;
+    cmd->data->len = len.lc;
+    memcpy(cmd->data->b, &buf_raw[len.data_offset], cmd->data->len);
     return SWICC_RET_SUCCESS;
 }
 
@@ -98,7 +193,11 @@ swicc_ret_et swicc_apdu_res_deparse(uint8_t *const buf_raw,
         return SWICC_RET_ERROR;
     }
     *buf_raw_len = res->data.len;
-    memcpy(buf_raw, res->data.b, res->data.len);
+    /* Handlers usually write the data straight into the raw buffer. */
+    if (res->data.b != buf_raw)
+    {
+        memcpy(buf_raw, res->data.b, res->data.len);
+    }
     uint8_t *const status = &buf_raw[res->data.len];
     uint8_t const sw1_raw = (uint8_t)res->sw1;
 
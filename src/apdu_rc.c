@@ -5,7 +5,12 @@ void swicc_apdu_rc_reset(swicc_apdu_rc_st *const rc)
 {
     if (rc != NULL)
     {
-        memset(rc, 0U, sizeof(*rc));
+        /**
+         * The buffer is not cleared since it gets reset on every command and
+         * only what was enqueued is ever dequeued.
+         */
+        rc->len = 0U;
+        rc->offset = 0U;
     }
 }
 
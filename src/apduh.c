@@ -20,6 +20,82 @@ static swicc_ret_et apduh_unk(swicc_st *const swicc_state,
     return SWICC_RET_SUCCESS;
 }
 
+/**
+ * @brief Find the entry of the SELECT response cache that a response for a
+ * file would be kept in.
+ * @param[in, out] swicc_state
+ * @param[in] tree Tree containing the file.
+ * @param[in] offset_trel Tree-relative offset of the file.
+ * @param[in] data_req What was requested in P2.
+ * @return The cache entry.
+ */
+static swicc_apduh_fcp_st *apduh_fcp_entry(swicc_st *const swicc_state,
+                                           swicc_disk_tree_st const *const tree,
+                                           uint32_t const offset_trel,
+                                           uint8_t const data_req)
+{
+    /* Safe cast since only the low bits of the address are used. */
+    uint32_t const key = (offset_trel << 3U) ^ data_req ^
+                         (uint32_t)((uintptr_t)tree >> 4U);
+    /* Multiplicative hashing so files close to each other do not collide. */
+    return &swicc_state->internal
+                .apduh_fcp[((key * 0x9E3779B1U) >> 16U) %
+                           SWICC_APDUH_FCP_CACHE_COUNT];
+}
+
+/**
+ * @brief Drop all cached SELECT responses of a file.
+ * @param[in, out] swicc_state
+ * @param[in] tree Tree containing the file.
+ * @param[in] offset_trel Tree-relative offset of the file.
+ */
+static void apduh_fcp_invalidate(swicc_st *const swicc_state,
+                                 swicc_disk_tree_st const *const tree,
+                                 uint32_t const offset_trel)
+{
+    for (uint32_t fcp_idx = 0U; fcp_idx < SWICC_APDUH_FCP_CACHE_COUNT;
+         ++fcp_idx)
+    {
+        swicc_apduh_fcp_st *const fcp =
+            &swicc_state->internal.apduh_fcp[fcp_idx];
+        if (fcp->tree == tree && fcp->offset_trel == offset_trel)
+        {
+            fcp->len = 0U;
+        }
+    }
+}
+
+/**
+ * @brief Make the SELECT response data available through GET RESPONSE.
+ * @param[in, out] swicc_state
+ * @param[out] res
+ * @param[in] buf Response data.
+ * @param[in] buf_len Length of the response data.
+ */
+static void apduh_select_res(swicc_st *const swicc_state,
+                             swicc_apdu_res_st *const res,
+                             uint8_t const *const buf, uint32_t const buf_len)
+{
+    if (swicc_apdu_rc_enq(&swicc_state->apdu_rc, buf, buf_len) ==
+        SWICC_RET_SUCCESS)
+    {
+        res->sw1 = SWICC_APDU_SW1_NORM_BYTES_AVAILABLE;
+        /**
+         * With extended lengths the FCP might not fit in SW2, in that case the
+         * max is given the same way GET RESPONSE does it.
+         */
+        /* Safe cast due to the check against uint8 max. */
+        res->sw2 = (uint8_t)(buf_len > UINT8_MAX ? UINT8_MAX : buf_len);
+        res->data.len = 0U;
+    }
+    else
+    {
+        res->sw1 = SWICC_APDU_SW1_CHER_UNK;
+        res->sw2 = 0U;
+        res->data.len = 0U;
+    }
+}
+
 /**
  * @brief Handle the SELECT command in the interindustry class.
  * @note As described in ISO/IEC 7816-4:2020 clause.11.2.2.
@@ -242,8 +318,7 @@ static swicc_ret_et apduh_select(swicc_st *const swicc_state,
         case METH_DF_NAME:
             /* Check if maybe trying to select an ADF. */
             if (cmd->data->len > SWICC_FS_ADF_AID_LEN ||
-                cmd->data->len < SWICC_FS_ADF_AID_RID_LEN ||
-                occ != SWICC_FS_OCC_FIRST)
+                cmd->data->len < SWICC_FS_ADF_AID_RID_LEN)
             {
                 ret_select = SWICC_RET_ERROR;
             }
@@ -251,12 +326,14 @@ static swicc_ret_et apduh_select(swicc_st *const swicc_state,
             {
                 /**
                  * Try selecting an ADF by name, if that fails fall back to
-                 * selecting a DF by name.
+                 * selecting a DF by name (only the first occurrence of which
+                 * is supported).
                  */
-                ret_select = swicc_va_select_adf(&swicc_state->fs, cmd->data->b,
-                                                 cmd->data->len -
-                                                     SWICC_FS_ADF_AID_RID_LEN);
-                if (ret_select == SWICC_RET_FS_NOT_FOUND)
+                ret_select = swicc_va_select_adf(
+                    &swicc_state->fs, cmd->data->b,
+                    cmd->data->len - SWICC_FS_ADF_AID_RID_LEN, occ);
+                if (ret_select == SWICC_RET_FS_NOT_FOUND &&
+                    occ == SWICC_FS_OCC_FIRST)
                 {
                     ret_select = swicc_va_select_file_dfname(
                         &swicc_state->fs, cmd->data->b, cmd->data->len);
@@ -320,6 +397,21 @@ static swicc_ret_et apduh_select(swicc_st *const swicc_state,
         }
         else
         {
+            /**
+             * The response only depends on the file header so it is encoded
+             * once and then taken from the cache.
+             */
+            swicc_apduh_fcp_st *const fcp = apduh_fcp_entry(
+                swicc_state, swicc_state->fs.va.cur_tree,
+                file_selected->hdr_item.offset_trel, (uint8_t)data_req);
+            if (fcp->len > 0U && fcp->tree == swicc_state->fs.va.cur_tree &&
+                fcp->offset_trel == file_selected->hdr_item.offset_trel &&
+                fcp->data_req == data_req)
+            {
+                apduh_select_res(swicc_state, res, fcp->buf, fcp->len);
+                return SWICC_RET_SUCCESS;
+            }
+
             /**
              * Create tags for use in encoding.
              * ISO/IEC 7816-4:2020 clause.7.4.3 table.11.
@@ -381,7 +473,7 @@ static swicc_ret_et apduh_select(swicc_st *const swicc_state,
                 }
                 else
                 {
-                    if (enc.len > sizeof(res->data.b))
+                    if (enc.len > SWICC_DATA_MAX)
                     {
                         break;
                     }
@@ -526,36 +618,24 @@ static swicc_ret_et apduh_select(swicc_st *const swicc_state,
                 }
             }
 
-            /**
-             * Check if BER-TLV creation succeeded and if enqueueing of the
-             * BER-TLV DO succeeded.
-             */
-            if (ret_bertlv == SWICC_RET_SUCCESS &&
-                swicc_apdu_rc_enq(&swicc_state->apdu_rc, res->data.b,
-                                  bertlv_len) == SWICC_RET_SUCCESS)
-            {
-                res->sw1 = SWICC_APDU_SW1_NORM_BYTES_AVAILABLE;
-                /**
-                 * @todo What happens when extended APDUs are supported and
-                 * length of response does not fit in SW2? For now work
-                 * around is to static assert that only short APDUs are
-                 * used.
-                 */
-                static_assert(
-                    SWICC_DATA_MAX == SWICC_DATA_MAX_SHRT,
-                    "Response buffer length might not fit in SW2 if SW1 is 0x61");
-                /* Safe cast due to check inside the BER-TLV loop. */
-                res->sw2 = (uint8_t)bertlv_len;
-                res->data.len = 0U;
-                return SWICC_RET_SUCCESS;
-            }
-            else
+            if (ret_bertlv != SWICC_RET_SUCCESS)
             {
                 res->sw1 = SWICC_APDU_SW1_CHER_UNK;
                 res->sw2 = 0U;
                 res->data.len = 0U;
                 return SWICC_RET_SUCCESS;
             }
+            if (bertlv_len <= sizeof(fcp->buf))
+            {
+                fcp->tree = swicc_state->fs.va.cur_tree;
+                fcp->offset_trel = file_selected->hdr_item.offset_trel;
+                fcp->data_req = (uint8_t)data_req;
+                /* Safe cast since it fits in the cache entry. */
+                fcp->len = (uint8_t)bertlv_len;
+                memcpy(fcp->buf, res->data.b, bertlv_len);
+            }
+            apduh_select_res(swicc_state, res, res->data.b, bertlv_len);
+            return SWICC_RET_SUCCESS;
         }
     }
 }
@@ -608,7 +688,7 @@ static swicc_ret_et apduh_bin_read(swicc_st *const swicc_state,
         }
     }
 
-    uint8_t const len_expected = *cmd->p3;
+    uint16_t const len_expected = *cmd->p3;
     uint16_t offset;
     swicc_fs_file_st file;
 
@@ -694,9 +774,25 @@ static swicc_ret_et apduh_bin_read(swicc_st *const swicc_state,
         }
         else if (offset + len_expected > file.data_size)
         {
+            uint32_t const len_rem = file.data_size - offset;
+            if (len_rem > UINT8_MAX)
+            {
+                /**
+                 * Only possible with an extended Le and too much to indicate
+                 * in SW2 so whatever is left gets returned.
+                 */
+                memcpy(res->data.b, &file.data[offset], len_rem);
+                /* Safe cast since it is less than the expected length. */
+                res->data.len = (uint16_t)len_rem;
+                res->sw1 = SWICC_APDU_SW1_WARN_NVM_CHGN;
+                res->sw2 = 0x82; /* "End of file, record or DO reached
+                                    before reading Ne bytes, or unsuccessful
+                                    search" */
+                return SWICC_RET_SUCCESS;
+            }
             res->sw1 = SWICC_APDU_SW1_CHER_LE;
-            /* Safe cast since offset is less than data size. */
-            res->sw2 = (uint8_t)(file.data_size - offset);
+            /* Safe cast since it is at most uint8 max. */
+            res->sw2 = (uint8_t)len_rem;
             res->data.len = 0U;
             return SWICC_RET_SUCCESS;
         }
@@ -1270,7 +1366,19 @@ static swicc_ret_et apduh_rcrd_update(swicc_st *const swicc_state,
                         if (ret_rcrd_select == SWICC_RET_SUCCESS)
                         {
                             /* Update the record. */
-                            memcpy(rcrd_buf, cmd->data->b, rcrd_len);
+                            if (swicc_disk_file_rcrd_write(
+                                    swicc_state->fs.va.cur_tree, &ef_cur,
+                                    rcrd_idx, cmd->data->b,
+                                    rcrd_len) != SWICC_RET_SUCCESS)
+                            {
+                                res->sw1 = SWICC_APDU_SW1_EXER_NVM_CHGM;
+                                res->sw2 = 0x81; /* "Memory failure" */
+                                res->data.len = 0U;
+                                return SWICC_RET_SUCCESS;
+                            }
+                            apduh_fcp_invalidate(
+                                swicc_state, swicc_state->fs.va.cur_tree,
+                                ef_cur.hdr_item.offset_trel);
 
                             res->sw1 = SWICC_APDU_SW1_NORM_NONE;
                             res->sw2 = 0U;
@@ -1406,6 +1514,27 @@ swicc_ret_et swicc_apduh_override_register(swicc_st *const swicc_state,
     return SWICC_RET_SUCCESS;
 }
 
+swicc_ret_et swicc_apduh_ins_register(swicc_st *const swicc_state,
+                                      swicc_apdu_cla_type_et const cla_type,
+                                      uint8_t const ins,
+                                      swicc_apduh_ft *const handler)
+{
+    static_assert(SWICC_APDU_CLA_TYPE_PROPRIETARY -
+                          SWICC_APDU_CLA_TYPE_INTERINDUSTRY + 1U ==
+                      SWICC_APDUH_CLA_COUNT,
+                  "Classes with handlers must be next to each other.");
+    if (swicc_state == NULL ||
+        (cla_type != SWICC_APDU_CLA_TYPE_INTERINDUSTRY &&
+         cla_type != SWICC_APDU_CLA_TYPE_PROPRIETARY))
+    {
+        return SWICC_RET_PARAM_BAD;
+    }
+    swicc_state
+        ->apduh_ins[cla_type - SWICC_APDU_CLA_TYPE_INTERINDUSTRY][ins] =
+        handler;
+    return SWICC_RET_SUCCESS;
+}
+
 static __attribute__((unused)) void trace_custom(
     bool trace_cmd, bool trace_res, swicc_apdu_cmd_st const *const cmd,
     swicc_apdu_res_st *const res)
@@ -1437,6 +1566,28 @@ swicc_ret_et swicc_apduh_demux(swicc_st *const swicc_state,
                                swicc_apdu_res_st *const res,
                                uint32_t const procedure_count)
 {
+    /* Interindustry handlers indexed by INS. */
+    static swicc_apduh_ft *const apduh_ii[UINT8_MAX + 1U] = {
+        [0xA4] = apduh_select,
+        [0xB0] = apduh_bin_read,
+        [0xB1] = apduh_bin_read,
+        [0xB2] = apduh_rcrd_read,
+        [0xB3] = apduh_rcrd_read,
+        [0xC0] = apduh_res_get,
+        [0xDC] = apduh_rcrd_update,
+        [0xDD] = apduh_rcrd_update,
+    };
+
+    swicc_apduh_ft *apduh_ins_func = NULL;
+    if (cmd->hdr->cla.type == SWICC_APDU_CLA_TYPE_INTERINDUSTRY ||
+        cmd->hdr->cla.type == SWICC_APDU_CLA_TYPE_PROPRIETARY)
+    {
+        apduh_ins_func =
+            swicc_state->apduh_ins[cmd->hdr->cla.type -
+                                   SWICC_APDU_CLA_TYPE_INTERINDUSTRY]
+                                  [cmd->hdr->ins];
+    }
+
     swicc_ret_et ret = SWICC_RET_APDU_UNHANDLED;
     switch (cmd->hdr->cla.type)
     {
@@ -1458,6 +1609,14 @@ swicc_ret_et swicc_apduh_demux(swicc_st *const swicc_state,
          * Let the interindustry implementations to be overridden by proprietary
          * ones.
          */
+        if (apduh_ins_func != NULL)
+        {
+            ret = apduh_ins_func(swicc_state, cmd, res, procedure_count);
+            if (ret != SWICC_RET_APDU_UNHANDLED)
+            {
+                break;
+            }
+        }
         if (swicc_state->internal.apduh_pro != NULL)
         {
             ret = swicc_state->internal.apduh_pro(swicc_state, cmd, res,
@@ -1468,31 +1627,20 @@ swicc_ret_et swicc_apduh_demux(swicc_st *const swicc_state,
             }
         }
 
-        swicc_apduh_ft *apduh_func = apduh_unk;
-        switch (cmd->hdr->ins)
-        {
-        case 0xA4:
-            apduh_func = apduh_select;
-            break;
-        case 0xB0:
-        case 0xB1:
-            apduh_func = apduh_bin_read;
-            break;
-        case 0xB2:
-        case 0xB3:
-            apduh_func = apduh_rcrd_read;
-            break;
-        case 0xC0:
-            apduh_func = apduh_res_get;
-            break;
-        case 0xDC:
-        case 0xDD:
-            apduh_func = apduh_rcrd_update;
-            break;
-        }
+        swicc_apduh_ft *const apduh_func = apduh_ii[cmd->hdr->ins] != NULL
+                                               ? apduh_ii[cmd->hdr->ins]
+                                               : apduh_unk;
         ret = apduh_func(swicc_state, cmd, res, procedure_count);
         break;
     case SWICC_APDU_CLA_TYPE_PROPRIETARY:
+        if (apduh_ins_func != NULL)
+        {
+            ret = apduh_ins_func(swicc_state, cmd, res, procedure_count);
+            if (ret != SWICC_RET_APDU_UNHANDLED)
+            {
+                break;
+            }
+        }
         if (swicc_state->internal.apduh_pro == NULL)
         {
             ret = SWICC_RET_APDU_UNHANDLED;
@@ -1558,3 +1706,157 @@ swicc_ret_et swicc_apduh_demux(swicc_st *const swicc_state,
 
     return ret;
 }
+
+/**
+ * @brief Run a command through the handlers and give it its data whenever a
+ * handler sends back an ACK procedure, the same way the T=0 FSM would.
+ * @param[in, out] swicc_state
+ * @param[in, out] cmd Command to run. Its data is filled in as requested.
+ * @param[in] data Data of the command.
+ * @param[in] data_len Length of the data (Lc).
+ * @param[out] res Response which is never a procedure byte.
+ * @return Return code.
+ */
+static swicc_ret_et apdu_exec_cmd(swicc_st *const swicc_state,
+                                  swicc_apdu_cmd_st const *const cmd,
+                                  uint8_t const *const data,
+                                  uint16_t const data_len,
+                                  swicc_apdu_res_st *const res)
+{
+    cmd->data->len = 0U;
+    /**
+     * Every procedure after the first one is expected to ask for data, so this
+     * bounds how many a handler can send back.
+     */
+    for (uint32_t procedure_count = 0U; procedure_count <= data_len + 1U;
+         ++procedure_count)
+    {
+        swicc_ret_et const ret =
+            swicc_apduh_demux(swicc_state, cmd, res, procedure_count);
+        if (ret != SWICC_RET_SUCCESS)
+        {
+            return ret;
+        }
+        if (res->sw1 != SWICC_APDU_SW1_PROC_ACK_ONE &&
+            res->sw1 != SWICC_APDU_SW1_PROC_ACK_ALL)
+        {
+            return SWICC_RET_SUCCESS;
+        }
+
+        /**
+         * The data was received as a whole so a handler gets all it asks for,
+         * unless it asks for more than there is.
+         */
+        uint32_t const data_len_rem = data_len - (uint32_t)cmd->data->len;
+        uint32_t data_len_next =
+            res->sw1 == SWICC_APDU_SW1_PROC_ACK_ONE ? 1U : res->data.len;
+        if (data_len_next > data_len_rem)
+        {
+            data_len_next = data_len_rem;
+        }
+        memcpy(&cmd->data->b[cmd->data->len], &data[cmd->data->len],
+               data_len_next);
+        /* Safe cast since the total is at most the data length. */
+        cmd->data->len = (uint16_t)(cmd->data->len + data_len_next);
+    }
+    return SWICC_RET_ERROR;
+}
+
+swicc_ret_et swicc_apdu_exec(swicc_st *const swicc_state,
+                             uint8_t const *const cmd_raw,
+                             uint16_t const cmd_raw_len,
+                             uint8_t *const res_raw,
+                             uint16_t *const res_raw_len)
+{
+    swicc_apdu_cmd_len_st len;
+    if (swicc_state == NULL || cmd_raw == NULL || res_raw == NULL ||
+        res_raw_len == NULL ||
+        swicc_apdu_cmd_len_parse(cmd_raw, cmd_raw_len, &len) !=
+            SWICC_RET_SUCCESS)
+    {
+        return SWICC_RET_PARAM_BAD;
+    }
+    uint16_t lc = len.lc;
+    uint32_t le_rem = swicc_apdu_cmd_len_ne(&len);
+
+    swicc_apdu_cmd_hdr_st hdr = {
+        .cla = swicc_apdu_cmd_cla_parse(cmd_raw[0U]),
+        .ins = cmd_raw[1U],
+        .p1 = cmd_raw[2U],
+        .p2 = cmd_raw[3U],
+    };
+    /* Just like in a T=0 header, P3 is Lc if there is data and Le otherwise. */
+    uint16_t p3 = lc > 0U ? lc : len.le;
+    swicc_apdu_data_st data;
+    swicc_apdu_cmd_st const cmd = {.hdr = &hdr, .p3 = &p3, .data = &data};
+
+    uint8_t res_buf[SWICC_DATA_MAX];
+    uint16_t res_len = 0U;
+    bool le_retried = false;
+    bool res_get = false;
+    for (;;)
+    {
+        /**
+         * When the output can hold the largest response, handlers write their
+         * data directly into it.
+         */
+        swicc_apdu_res_st res = {.data.b = res_buf};
+        if (*res_raw_len >= res_len + SWICC_DATA_MAX + 2U)
+        {
+            res.data.b = &res_raw[res_len];
+        }
+        swicc_ret_et ret = apdu_exec_cmd(swicc_state, &cmd,
+                                         &cmd_raw[len.data_offset], lc, &res);
+        if (ret != SWICC_RET_SUCCESS)
+        {
+            return ret;
+        }
+
+        /**
+         * Wrong Le of a command without data, it gets resent with the Le given
+         * in SW2 as a terminal would do with T=0.
+         */
+        if (res.sw1 == SWICC_APDU_SW1_CHER_LE && lc == 0U && len.le_present &&
+            !le_retried)
+        {
+            le_retried = true;
+            p3 = res.sw2;
+            continue;
+        }
+
+        /* Safe cast since the response never grows past the output size. */
+        uint16_t res_part_len = (uint16_t)(*res_raw_len - res_len);
+        ret = swicc_apdu_res_deparse(&res_raw[res_len], &res_part_len, &cmd,
+                                     &res);
+        if (ret != SWICC_RET_SUCCESS)
+        {
+            return ret;
+        }
+        le_rem = res.data.len > le_rem ? 0U : le_rem - res.data.len;
+
+        /**
+         * More data is available, it is fetched with GET RESPONSE (as long as
+         * it is expected and each one makes progress) and its data replaces
+         * the status.
+         */
+        if (res.sw1 == SWICC_APDU_SW1_NORM_BYTES_AVAILABLE && le_rem > 0U &&
+            (!res_get || res.data.len > 0U))
+        {
+            /* Safe cast since a status follows the data. */
+            res_len = (uint16_t)(res_len + res_part_len - 2U);
+            /* P3 of 0 would request no data at all. */
+            uint32_t const len_next = res.sw2 == 0U ? UINT8_MAX : res.sw2;
+            hdr.ins = 0xC0;
+            hdr.p1 = 0U;
+            hdr.p2 = 0U;
+            /* Safe cast since SW2 is at most uint8 max. */
+            p3 = (uint16_t)(len_next < le_rem ? len_next : le_rem);
+            lc = 0U;
+            res_get = true;
+            continue;
+        }
+        /* Safe cast since it fits in the output. */
+        *res_raw_len = (uint16_t)(res_len + res_part_len);
+        return SWICC_RET_SUCCESS;
+    }
+}
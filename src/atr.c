@@ -43,31 +43,37 @@ uint8_t const swicc_atr[] = {
     0b00000000, /**
                  * TC1 = N (extra guard time) = 0 (default)
                  */
-    0b10010000, /**
+    0b10000000, /**
                  * LSB>MSB
                  * TD1 =   4b T  = 0 (half-duplex character-based protocol)
-                 *       + 4b Y2 = TA2 and TD2 are present
+                 *       + 4b Y2 = TD2 is present
                  */
-    0b00010000, /**
+    0b11010001, /**
                  * LSB>MSB
-                 * TA2 =   4b T       = 0 (half-duplex character-based protocol)
-                 *       + 1b F and D = 1 (implicit values)
-                 *       + 2b RFU     = 0
-                 *       + 1b Mode    = 0 (capable to change)
-                 */
+                 * TD2 =   4b T  = 1 (half-duplex block-based protocol)
+                 *       + 4b Y3 = TA3, TC3, and TD3 are present
+                 */
+    SWICC_T1_IFSC, /**
+                    * TA3 = IFSC (information field size of the card) for T=1
+                    */
+    SWICC_T1_EDC, /**
+                   * LSB>MSB
+                   * TC3 =   1b EDC = LRC (=0) or CRC (=1) for T=1
+                   *       + 7b RFU = 0
+                   */
     0b00111111, /**
                  * LSB>MSB
-                 * TD2 =   4b T  = 15
-                 *       + 4b Y3 = TA3 and TB3 are present
+                 * TD3 =   4b T  = 15
+                 *       + 4b Y4 = TA4 and TB4 are present
                  */
     0b00000111, /**
                  * LSB>MSB
-                 * TA3 =   6b Y = 7 = A, B, and C (class indicator)
+                 * TA4 =   6b Y = 7 = A, B, and C (class indicator)
                  *       + 2b X = 0 = Clock stop not supported
                  */
     0b00000000, /**
                  * LSB>MSB
-                 * TB3 =   7b SPU Purpose     = 0 (not used)
+                 * TB4 =   7b SPU Purpose     = 0 (not used)
                  *       + 1b SPU Proprietary = 0 (standard use of SPU)
                  */
 
@@ -126,7 +132,7 @@ uint8_t const swicc_atr[] = {
                  *    + 2b Write behavior = 1 (proprietary)
                  *    + 1b EFs of BER-TLV struct support = 0 (no)
                  */
-    0b00000000, /**
+    0b01000000, /**
                  * LSB>MSB
                  * Command chaining, length fields, and logical channels
                  *  =   1b t = 0
@@ -135,14 +141,14 @@ uint8_t const swicc_atr[] = {
                  *    + 2b Logical channel assignment
                  *      = 0 (only basic channel available)
                  *    + 1b Extended length info in EF.ATR/INFO = 0 (no)
-                 *    + 1b Extended Lc and Le fields = 0 (no)
+                 *    + 1b Extended Lc and Le fields = 1 (yes)
                  *    + 1b Command chaining = 0 (no)
                  *
                  * @note Maximum number of logical channels is calculated using
                  * 't', 'z', 'y' with: 4y + 2z + t + 1 (when not all =1, else it
                  * means 8 or more)
                  */
-    0x06,       /**
+    0x69,       /**
                  * Check byte (TCK)
                  *  = XOR of all bytes (with TCK=0)
                  */
@@ -17,12 +17,16 @@ static char const *const swicc_dbg_table_str_ret[] = {
     [SWICC_RET_PPS_INVALID] = "invalid PPS",
     [SWICC_RET_PPS_FAILED] = "PPS is valid but the parameters are not accepted",
 
+    [SWICC_RET_T1_INVALID] = "invalid T=1 block",
+    [SWICC_RET_T1_EDC] = "T=1 block EDC is incorrect",
+
     [SWICC_RET_ATR_INVALID] = "invalid ATR",
     [SWICC_RET_FS_NOT_FOUND] = "not found in FS",
 
     [SWICC_RET_DATO_END] = "DO end of data",
     [SWICC_RET_NET_CONN_QUEUE_EMPTY] = "connection queue is empty",
     [SWICC_RET_NET_DISCONNECTED] = "client got disconnected",
+    [SWICC_RET_NET_INCOMPLETE] = "message transferred only partially",
 };
 #endif
 
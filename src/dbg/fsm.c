@@ -13,6 +13,7 @@ static char const *const swicc_dbg_table_str_fsm_state[] = {
     [SWICC_FSM_STATE_CMD_WAIT] = "waiting for command",
     [SWICC_FSM_STATE_CMD_PROCEDURE] = "handling APDU and sending procedure",
     [SWICC_FSM_STATE_CMD_DATA] = "waiting for data",
+    [SWICC_FSM_STATE_T1_BLOCK] = "waiting for T=1 block",
 };
 #endif
 
@@ -85,6 +85,17 @@ swicc_ret_et swicc_fs_disk_mount(swicc_st *const swicc_state,
     if (swicc_state->fs.disk.root == NULL)
     {
         memcpy(&swicc_state->fs.disk, disk, sizeof(*disk));
+        /* The AID LUT is only built when mounting (unless already built). */
+        if (swicc_state->fs.disk.lutaid.buf1 == NULL &&
+            swicc_disk_lutaid_rebuild(&swicc_state->fs.disk) !=
+                SWICC_RET_SUCCESS)
+        {
+            memset(&swicc_state->fs.disk, 0U, sizeof(swicc_state->fs.disk));
+            return SWICC_RET_ERROR;
+        }
+        /* Cached responses might refer to trees of a previous disk. */
+        memset(swicc_state->internal.apduh_fcp, 0U,
+               sizeof(swicc_state->internal.apduh_fcp));
         return SWICC_RET_SUCCESS;
     }
     return SWICC_RET_ERROR;
@@ -1,19 +1,126 @@
 #include "swicc/fs/common.h"
+#include <fcntl.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <swicc/swicc.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 /**
  * Used when creating LUTs. The 'start' count determines that size of the
  * smallest created LUT (measured in entry counts). If the 'start' count is too
- * small, the LUT will be resized by the 'resize' amount.
+ * small, the LUT will be resized to 'growth' times its current size so that
+ * building a LUT takes an amortized constant number of reallocs per entry.
  */
 #define LUT_COUNT_START 64U
-#define LUT_COUNT_RESIZE 8U
+#define LUT_COUNT_GROWTH 2U
+
+/* Same as the LUT counts but for overlay items. */
+#define OVL_COUNT_START 16U
+#define OVL_COUNT_GROWTH 2U
+
+/* Item 1 of the child LUT: offset of the folder followed by ID of the child. */
+#define LUTCHILD_SIZE_ITEM1 (sizeof(uint32_t) + sizeof(swicc_fs_id_kt))
+
+/**
+ * Same as the LUT counts but for the decoded headers of a header table. The
+ * hash table of a header table has at least twice as many slots as there are
+ * folders so that probe sequences stay short.
+ */
+#define HDRTBL_COUNT_START 64U
+#define HDRTBL_COUNT_GROWTH 2U
+#define HDRTBL_SLOT_RATIO 2U
+
+/**
+ * @brief Compare item 1 of a LUT entry with some other item 1.
+ * @param item1_a
+ * @param item1_b
+ * @param size_item1 Size of item 1 in the LUT.
+ * @return Same as memcmp.
+ * @note Items 1 of the LUTs are only a couple bytes long so an inlined
+ * byte-wise comparison is a lot cheaper than calling memcmp.
+ */
+static inline int32_t lut_item1_cmp(uint8_t const *const item1_a,
+                                    uint8_t const *const item1_b,
+                                    uint32_t const size_item1)
+{
+    for (uint32_t byte_idx = 0U; byte_idx < size_item1; ++byte_idx)
+    {
+        if (item1_a[byte_idx] != item1_b[byte_idx])
+        {
+            return item1_a[byte_idx] - item1_b[byte_idx];
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Find the index of the first entry in a LUT whose item 1 is not less
+ * than the given item 1 (i.e. the lower bound).
+ * @param lut
+ * @param entry_item1 Must have size equal to the item size 1.
+ * @return Index of the first entry that is not less than the given item. If all
+ * entries are less, this will be equal to the number of entries in the LUT.
+ * @note This relies on item 1 of all entries being sorted in increasing order.
+ */
+static uint32_t lut_lower_bound(swicc_disk_lut_st const *const lut,
+                                uint8_t const *const entry_item1)
+{
+    if (lut->count == 0U)
+    {
+        return 0U;
+    }
+    /**
+     * The next half is picked with a conditional select instead of a branch so
+     * that the search does not suffer a misprediction at every level.
+     */
+    uint32_t base = 0U;
+    uint32_t len = lut->count;
+    while (len > 1U)
+    {
+        uint32_t const half = len / 2U;
+        /* value_mid < value_new */
+        base = lut_item1_cmp(&lut->buf1[lut->size_item1 * (base + half - 1U)],
+                             entry_item1, lut->size_item1) < 0
+                   ? base + half
+                   : base;
+        len -= half;
+    }
+    return lut_item1_cmp(&lut->buf1[lut->size_item1 * base], entry_item1,
+                         lut->size_item1) < 0
+               ? base + 1U
+               : base;
+}
+
+/**
+ * @brief Find an entry in a LUT by item 1 using a binary search.
+ * @param lut
+ * @param entry_item1 Must have size equal to the item size 1.
+ * @param entry_idx Where the index of the found entry will be written (only on
+ * success).
+ * @return Return code.
+ */
+static swicc_ret_et lut_lookup(swicc_disk_lut_st const *const lut,
+                               uint8_t const *const entry_item1,
+                               uint32_t *const entry_idx)
+{
+    uint32_t const idx = lut_lower_bound(lut, entry_item1);
+    if (idx >= lut->count ||
+        lut_item1_cmp(&lut->buf1[lut->size_item1 * idx], entry_item1,
+                      lut->size_item1) != 0)
+    {
+        return SWICC_RET_FS_NOT_FOUND;
+    }
+    *entry_idx = idx;
+    return SWICC_RET_SUCCESS;
+}
 
 /**
- * @brief Insert an entry into a LUT (resizes the LUT if needed).
+ * @brief Append an entry to the end of a LUT (resizes the LUT if needed). This
+ * is used to build LUTs in bulk so the entries are not kept sorted, once all
+ * entries are appended, the LUT must be sorted using 'lut_sort'.
  * @param lut
  * @param entry_item1 This will be placed in buffer 1 and must have size equal
  * to the item size 1.
@@ -21,57 +128,654 @@
  * to the item size 2.
  * @return Return code.
  */
-static swicc_ret_et lut_insert(swicc_disk_lut_st *const lut,
-                               uint8_t const *const entry_item1,
-                               uint8_t const *const entry_item2)
+static swicc_ret_et lut_append(swicc_disk_lut_st *const lut,
+                               uint8_t const *const entry_item1,
+                               uint8_t const *const entry_item2)
+{
+    /* Check if need to resize the LUT to fit more items. */
+    if (lut->count >= lut->count_max)
+    {
+        uint64_t const count_max_new =
+            lut->count_max == 0U ? LUT_COUNT_START
+                                 : (uint64_t)lut->count_max * LUT_COUNT_GROWTH;
+        if (count_max_new > UINT32_MAX)
+        {
+            return SWICC_RET_ERROR;
+        }
+        uint8_t *const buf1_new =
+            realloc(lut->buf1, count_max_new * lut->size_item1);
+        if (buf1_new == NULL)
+        {
+            return SWICC_RET_ERROR;
+        }
+        lut->buf1 = buf1_new;
+        uint8_t *const buf2_new =
+            realloc(lut->buf2, count_max_new * lut->size_item2);
+        if (buf2_new == NULL)
+        {
+            return SWICC_RET_ERROR;
+        }
+        lut->buf2 = buf2_new;
+        /* Safe cast due to the check against uint32 max. */
+        lut->count_max = (uint32_t)count_max_new;
+    }
+
+    memcpy(&lut->buf1[lut->size_item1 * lut->count], entry_item1,
+           lut->size_item1);
+    memcpy(&lut->buf2[lut->size_item2 * lut->count], entry_item2,
+           lut->size_item2);
+    lut->count += 1U;
+    return SWICC_RET_SUCCESS;
+}
+
+/**
+ * @brief Sort the entries of a LUT such that item 1 of all entries are arranged
+ * in increasing order. This is a byte-wise LSD radix sort so it runs in linear
+ * time in the number of entries.
+ * @param lut
+ * @return Return code.
+ * @note Entries with equal item 1 end up in the reverse order of how they were
+ * appended, i.e. a lookup will find the entry that was appended last.
+ */
+static swicc_ret_et lut_sort(swicc_disk_lut_st *const lut)
+{
+    if (lut->count < 2U)
+    {
+        return SWICC_RET_SUCCESS;
+    }
+
+    /**
+     * Entries are moved between the LUT buffers and these temporary buffers on
+     * every pass so they are allocated to have the same size as the LUT ones.
+     */
+    uint8_t *buf1_tmp = malloc(lut->count_max * lut->size_item1);
+    uint8_t *buf2_tmp = malloc(lut->count_max * lut->size_item2);
+    if (buf1_tmp == NULL || buf2_tmp == NULL)
+    {
+        free(buf1_tmp);
+        free(buf2_tmp);
+        return SWICC_RET_ERROR;
+    }
+
+    /* Sort from the least significant (last) byte to the most significant. */
+    for (uint32_t byte_idx = lut->size_item1; byte_idx-- > 0U;)
+    {
+        uint32_t bucket[256U] = {0U};
+        for (uint32_t entry_idx = 0U; entry_idx < lut->count; ++entry_idx)
+        {
+            bucket[lut->buf1[(lut->size_item1 * entry_idx) + byte_idx]] += 1U;
+        }
+        uint32_t bucket_start = 0U;
+        for (uint32_t bucket_idx = 0U; bucket_idx < 256U; ++bucket_idx)
+        {
+            uint32_t const bucket_count = bucket[bucket_idx];
+            bucket[bucket_idx] = bucket_start;
+            bucket_start += bucket_count;
+        }
+
+        /**
+         * The first pass takes the entries in reverse order and all other
+         * passes are stable. This is what makes entries with an equal item 1
+         * get sorted in reverse order of appending.
+         */
+        bool const reverse = byte_idx + 1U == lut->size_item1;
+        for (uint32_t entry_num = 0U; entry_num < lut->count; ++entry_num)
+        {
+            uint32_t const entry_idx =
+                reverse ? lut->count - 1U - entry_num : entry_num;
+            uint8_t const key =
+                lut->buf1[(lut->size_item1 * entry_idx) + byte_idx];
+            uint32_t const entry_idx_new = bucket[key]++;
+            memcpy(&buf1_tmp[lut->size_item1 * entry_idx_new],
+                   &lut->buf1[lut->size_item1 * entry_idx], lut->size_item1);
+            memcpy(&buf2_tmp[lut->size_item2 * entry_idx_new],
+                   &lut->buf2[lut->size_item2 * entry_idx], lut->size_item2);
+        }
+
+        /* The sorted entries become the new LUT contents. */
+        uint8_t *const buf1_old = lut->buf1;
+        uint8_t *const buf2_old = lut->buf2;
+        lut->buf1 = buf1_tmp;
+        lut->buf2 = buf2_tmp;
+        buf1_tmp = buf1_old;
+        buf2_tmp = buf2_old;
+    }
+
+    free(buf1_tmp);
+    free(buf2_tmp);
+    return SWICC_RET_SUCCESS;
+}
+
+/**
+ * @brief Check if item 1 of all entries in a LUT is arranged in increasing
+ * order.
+ * @param lut
+ * @return Return code.
+ */
+static swicc_ret_et lut_check_sorted(swicc_disk_lut_st const *const lut)
+{
+    for (uint32_t entry_idx = 1U; entry_idx < lut->count; ++entry_idx)
+    {
+        if (lut_item1_cmp(&lut->buf1[lut->size_item1 * (entry_idx - 1U)],
+                          &lut->buf1[lut->size_item1 * entry_idx],
+                          lut->size_item1) > 0)
+        {
+            return SWICC_RET_ERROR;
+        }
+    }
+    return SWICC_RET_SUCCESS;
+}
+
+/**
+ * @brief Write a LUT to a file as its entry count followed by buffer 1 and
+ * buffer 2.
+ * @param lut
+ * @param f
+ * @return Return code.
+ */
+static swicc_ret_et lut_write(swicc_disk_lut_st const *const lut, FILE *const f)
+{
+    if (fwrite(&lut->count, sizeof(lut->count), 1U, f) != 1U)
+    {
+        return SWICC_RET_ERROR;
+    }
+    if (lut->count > 0U &&
+        (fwrite(lut->buf1, lut->size_item1 * lut->count, 1U, f) != 1U ||
+         fwrite(lut->buf2, lut->size_item2 * lut->count, 1U, f) != 1U))
+    {
+        return SWICC_RET_ERROR;
+    }
+    return SWICC_RET_SUCCESS;
+}
+
+/**
+ * @brief Parse a LUT written by 'lut_write' from a buffer. The LUT buffers are
+ * allocated and the entries are copied into them.
+ * @param lut Must be empty. On failure, it may be left partially allocated so
+ * it has to be emptied by the caller.
+ * @param buf Buffer containing the LUT.
+ * @param buf_len Length of the buffer.
+ * @param buf_idx Index in the buffer where the LUT starts. This will be
+ * incremented by the number of bytes parsed.
+ * @param size_item1 Size of item 1 of the LUT.
+ * @param size_item2 Size of item 2 of the LUT.
+ * @return Return code.
+ */
+static swicc_ret_et lut_prs(swicc_disk_lut_st *const lut,
+                            uint8_t const *const buf, uint32_t const buf_len,
+                            uint32_t *const buf_idx, uint32_t const size_item1,
+                            uint32_t const size_item2)
+{
+    uint32_t count;
+    if (buf_len - *buf_idx < sizeof(count))
+    {
+        return SWICC_RET_ERROR;
+    }
+    memcpy(&count, &buf[*buf_idx], sizeof(count));
+    /* Safe cast since the remaining length was checked to fit the count. */
+    *buf_idx = (uint32_t)(*buf_idx + sizeof(count));
+
+    uint64_t const bufs_len = (uint64_t)count * (size_item1 + size_item2);
+    if (bufs_len > buf_len - *buf_idx)
+    {
+        return SWICC_RET_ERROR;
+    }
+
+    lut->size_item1 = size_item1;
+    lut->size_item2 = size_item2;
+    lut->count_max = count > LUT_COUNT_START ? count : LUT_COUNT_START;
+    lut->count = count;
+    lut->buf1 = malloc(lut->count_max * lut->size_item1);
+    lut->buf2 = malloc(lut->count_max * lut->size_item2);
+    if (lut->buf1 == NULL || lut->buf2 == NULL)
+    {
+        return SWICC_RET_ERROR;
+    }
+    memcpy(lut->buf1, &buf[*buf_idx], lut->size_item1 * count);
+    memcpy(lut->buf2, &buf[*buf_idx + (lut->size_item1 * count)],
+           lut->size_item2 * count);
+    /* Safe cast since this was checked to be at most the remaining length. */
+    *buf_idx = (uint32_t)(*buf_idx + bufs_len);
+    return SWICC_RET_SUCCESS;
+}
+
+/**
+ * @brief Write the LUT section (without the LUT magic) of a disk to a file.
+ * @param disk
+ * @param f
+ * @return Return code.
+ */
+static swicc_ret_et disk_lut_write(swicc_disk_st const *const disk,
+                                   FILE *const f)
+{
+    swicc_disk_lut_hdr_raw_st hdr = {
+        .version = SWICC_DISK_LUT_VERSION,
+        .tree_count = 0U,
+        .trees_len = 0U,
+    };
+    swicc_disk_tree_st *tree = disk->root;
+    while (tree != NULL)
+    {
+        if (hdr.trees_len + (uint64_t)tree->len > UINT32_MAX)
+        {
+            return SWICC_RET_ERROR;
+        }
+        hdr.trees_len += tree->len;
+        hdr.tree_count += 1U;
+        tree = tree->next;
+    }
+    if (fwrite(&hdr, sizeof(hdr), 1U, f) != 1U ||
+        lut_write(&disk->lutid, f) != SWICC_RET_SUCCESS ||
+        lut_write(&disk->lutname, f) != SWICC_RET_SUCCESS)
+    {
+        return SWICC_RET_ERROR;
+    }
+    tree = disk->root;
+    while (tree != NULL)
+    {
+        if (lut_write(&tree->lutsid, f) != SWICC_RET_SUCCESS ||
+            lut_write(&tree->lutchild, f) != SWICC_RET_SUCCESS)
+        {
+            return SWICC_RET_ERROR;
+        }
+        tree = tree->next;
+    }
+    return SWICC_RET_SUCCESS;
+}
+
+/**
+ * @brief Make sure a parsed disk-wide LUT (ID or name) is sorted and that all
+ * its entries point into existing trees.
+ * @param lut Its item 2 must be an offset followed by a tree index.
+ * @param tree_len Lengths of all trees.
+ * @param tree_count Number of trees.
+ * @return Return code.
+ */
+static swicc_ret_et disk_lut_check(swicc_disk_lut_st const *const lut,
+                                   uint32_t const *const tree_len,
+                                   uint32_t const tree_count)
+{
+    swicc_ret_et ret = lut_check_sorted(lut);
+    for (uint32_t entry_idx = 0U;
+         ret == SWICC_RET_SUCCESS && entry_idx < lut->count; ++entry_idx)
+    {
+        uint8_t const *const entry_item2 =
+            &lut->buf2[lut->size_item2 * entry_idx];
+        uint32_t offset;
+        memcpy(&offset, &entry_item2[0U], sizeof(offset));
+        uint8_t const tree_idx = entry_item2[sizeof(uint32_t)];
+        if (tree_idx >= tree_count || offset >= tree_len[tree_idx])
+        {
+            ret = SWICC_RET_ERROR;
+        }
+    }
+    return ret;
+}
+
+/**
+ * @brief Make sure a parsed LUT of a tree (SID or child) is sorted and that all
+ * its entries point into the tree.
+ * @param lut Its item 2 must be an offset.
+ * @param tree
+ * @return Return code.
+ */
+static swicc_ret_et tree_lut_check(swicc_disk_lut_st const *const lut,
+                                   swicc_disk_tree_st const *const tree)
+{
+    swicc_ret_et ret = lut_check_sorted(lut);
+    for (uint32_t entry_idx = 0U;
+         ret == SWICC_RET_SUCCESS && entry_idx < lut->count; ++entry_idx)
+    {
+        uint32_t offset;
+        memcpy(&offset, &lut->buf2[lut->size_item2 * entry_idx],
+               sizeof(offset));
+        if (offset >= tree->len)
+        {
+            ret = SWICC_RET_ERROR;
+        }
+    }
+    return ret;
+}
+
+/**
+ * @brief Parse the LUT section (without the LUT magic) of a disk from a buffer.
+ * All trees of the disk must already be loaded.
+ * @param disk
+ * @param buf Buffer containing the LUT section.
+ * @param buf_len Length of the buffer (all of it must belong to the LUT
+ * section).
+ * @return Return code. On failure, the disk will have no LUTs (they have to be
+ * rebuilt).
+ */
+static swicc_ret_et disk_lut_prs(swicc_disk_st *const disk,
+                                 uint8_t const *const buf,
+                                 uint32_t const buf_len)
+{
+    swicc_disk_lut_hdr_raw_st hdr;
+    if (buf_len < sizeof(hdr))
+    {
+        return SWICC_RET_ERROR;
+    }
+    memcpy(&hdr, buf, sizeof(hdr));
+    uint32_t buf_idx = sizeof(hdr);
+
+    /* Make sure the LUTs were created for exactly these trees. */
+    uint32_t tree_len[UINT8_MAX + 1U];
+    uint32_t tree_count = 0U;
+    uint64_t trees_len = 0U;
+    swicc_disk_tree_st *tree = disk->root;
+    while (tree != NULL)
+    {
+        if (tree_count > UINT8_MAX)
+        {
+            return SWICC_RET_ERROR;
+        }
+        tree_len[tree_count++] = tree->len;
+        trees_len += tree->len;
+        tree = tree->next;
+    }
+    if (hdr.version != SWICC_DISK_LUT_VERSION ||
+        hdr.tree_count != tree_count || hdr.trees_len != trees_len)
+    {
+        return SWICC_RET_ERROR;
+    }
+
+    swicc_ret_et ret =
+        lut_prs(&disk->lutid, buf, buf_len, &buf_idx, sizeof(swicc_fs_id_kt),
+                sizeof(uint32_t) + sizeof(uint8_t));
+    if (ret == SWICC_RET_SUCCESS)
+    {
+        ret = disk_lut_check(&disk->lutid, tree_len, tree_count);
+    }
+    if (ret == SWICC_RET_SUCCESS)
+    {
+        ret = lut_prs(&disk->lutname, buf, buf_len, &buf_idx,
+                      SWICC_FS_NAME_LEN, sizeof(uint32_t) + sizeof(uint8_t));
+    }
+    if (ret == SWICC_RET_SUCCESS)
+    {
+        ret = disk_lut_check(&disk->lutname, tree_len, tree_count);
+    }
+
+    tree = disk->root;
+    while (ret == SWICC_RET_SUCCESS && tree != NULL)
+    {
+        ret = lut_prs(&tree->lutsid, buf, buf_len, &buf_idx,
+                      sizeof(swicc_fs_sid_kt), sizeof(uint32_t));
+        if (ret == SWICC_RET_SUCCESS)
+        {
+            ret = tree_lut_check(&tree->lutsid, tree);
+        }
+        if (ret == SWICC_RET_SUCCESS)
+        {
+            ret = lut_prs(&tree->lutchild, buf, buf_len, &buf_idx,
+                          LUTCHILD_SIZE_ITEM1, sizeof(uint32_t));
+        }
+        if (ret == SWICC_RET_SUCCESS)
+        {
+            ret = tree_lut_check(&tree->lutchild, tree);
+        }
+        tree = tree->next;
+    }
+
+    /* The LUT section must be the last thing in the file. */
+    if (ret == SWICC_RET_SUCCESS && buf_idx != buf_len)
+    {
+        ret = SWICC_RET_ERROR;
+    }
+
+    if (ret != SWICC_RET_SUCCESS)
+    {
+        swicc_disk_lutid_empty(disk);
+        swicc_disk_lutname_empty(disk);
+        tree = disk->root;
+        while (tree != NULL)
+        {
+            swicc_disk_lutsid_empty(tree);
+            swicc_disk_lutchild_empty(tree);
+            tree = tree->next;
+        }
+    }
+    return ret;
+}
+
+/**
+ * @brief Read the LUT section (without the LUT magic) of a disk from a file.
+ * All trees of the disk must already be loaded.
+ * @param disk
+ * @param f
+ * @param len_rem Number of bytes left in the file (all of which must belong to
+ * the LUT section).
+ * @return Return code. On failure, the disk will have no LUTs (they have to be
+ * rebuilt).
+ */
+static swicc_ret_et disk_lut_read(swicc_disk_st *const disk, FILE *const f,
+                                  uint32_t const len_rem)
+{
+    swicc_ret_et ret = SWICC_RET_ERROR;
+    uint8_t *const buf = malloc(len_rem);
+    if (buf != NULL)
+    {
+        if (len_rem == 0U || fread(buf, len_rem, 1U, f) == 1U)
+        {
+            ret = disk_lut_prs(disk, buf, len_rem);
+        }
+        free(buf);
+    }
+    return ret;
+}
+
+/**
+ * @brief Rebuild the ID LUT, the name LUT, and the SID LUTs of all trees of a
+ * disk.
+ * @param disk
+ * @return Return code.
+ */
+static swicc_ret_et disk_lut_rebuild(swicc_disk_st *const disk)
+{
+    swicc_ret_et ret = SWICC_RET_ERROR;
+    swicc_disk_tree_st *tree = disk->root;
+    while (tree != NULL)
+    {
+        ret = swicc_disk_lutsid_rebuild(disk, tree);
+        if (ret == SWICC_RET_SUCCESS)
+        {
+            ret = swicc_disk_lutchild_rebuild(disk, tree);
+        }
+        if (ret != SWICC_RET_SUCCESS)
+        {
+            break;
+        }
+        tree = tree->next;
+    }
+    if (ret == SWICC_RET_SUCCESS)
+    {
+        ret = swicc_disk_lutid_rebuild(disk);
+    }
+    if (ret == SWICC_RET_SUCCESS)
+    {
+        ret = swicc_disk_lutname_rebuild(disk);
+    }
+    return ret;
+}
+
+/**
+ * @brief Rebuild the header tables of all trees of a disk.
+ * @param disk
+ * @return Return code.
+ */
+static swicc_ret_et disk_hdrtbl_rebuild(swicc_disk_st *const disk)
+{
+    swicc_ret_et ret = SWICC_RET_ERROR;
+    swicc_disk_tree_st *tree = disk->root;
+    while (tree != NULL)
+    {
+        ret = swicc_disk_hdrtbl_rebuild(disk, tree);
+        if (ret != SWICC_RET_SUCCESS)
+        {
+            break;
+        }
+        tree = tree->next;
+    }
+    return ret;
+}
+
+/**
+ * @brief Find the index of the first overlay item whose offset is not less
+ * than a given offset.
+ * @param ovl
+ * @param offset_trel Tree-relative offset.
+ * @return Index of the item, equal to the item count if there is no such item.
+ */
+static uint32_t ovl_lower_bound(swicc_disk_ovl_st const *const ovl,
+                                 uint32_t const offset_trel)
+{
+    uint32_t idx_lo = 0U;
+    uint32_t idx_hi = ovl->count;
+    while (idx_lo < idx_hi)
+    {
+        uint32_t const idx_mid = idx_lo + ((idx_hi - idx_lo) / 2U);
+        if (ovl->item[idx_mid].offset_trel < offset_trel)
+        {
+            idx_lo = idx_mid + 1U;
+        }
+        else
+        {
+            idx_hi = idx_mid;
+        }
+    }
+    return idx_lo;
+}
+
+/**
+ * @brief Find the overlay item which holds the modified bytes at a given
+ * offset.
+ * @param ovl
+ * @param offset_trel Tree-relative offset where the modified bytes start.
+ * @param len Length of the modified bytes.
+ * @return Pointer to the overlay item or NULL if the bytes were not modified.
+ */
+static swicc_disk_ovl_item_st *ovl_lookup(swicc_disk_ovl_st const *const ovl,
+                                          uint32_t const offset_trel,
+                                          uint32_t const len)
+{
+    uint32_t const item_idx = ovl_lower_bound(ovl, offset_trel);
+    if (item_idx < ovl->count &&
+        ovl->item[item_idx].offset_trel == offset_trel &&
+        ovl->item[item_idx].len == len)
+    {
+        return &ovl->item[item_idx];
+    }
+    return NULL;
+}
+
+/**
+ * @brief Write bytes into the overlay of a tree. If these exact bytes were
+ * modified before, the overlay item gets overwritten, otherwise a new item is
+ * inserted.
+ * @param ovl
+ * @param offset_trel Tree-relative offset of the bytes.
+ * @param buf New contents of the bytes.
+ * @param len Number of bytes to write.
+ * @return Return code.
+ * @note Writes must never partially overlap with earlier writes, this holds
+ * since only whole records get written.
+ */
+static swicc_ret_et ovl_write(swicc_disk_ovl_st *const ovl,
+                              uint32_t const offset_trel,
+                              uint8_t const *const buf, uint32_t const len)
 {
-    /* Check if need to resize the LUT to fit more items. */
-    if (lut->count >= lut->count_max)
+    swicc_disk_ovl_item_st *const item_found =
+        ovl_lookup(ovl, offset_trel, len);
+    if (item_found != NULL)
     {
-        lut->count_max += LUT_COUNT_RESIZE;
-        uint8_t *const buf1_new =
-            realloc(lut->buf1, lut->count_max * lut->size_item1);
-        uint8_t *const buf2_new =
-            realloc(lut->buf2, lut->count_max * lut->size_item2);
-        if (buf1_new == NULL || buf2_new == NULL)
+        memcpy(item_found->buf, buf, len);
+        return SWICC_RET_SUCCESS;
+    }
+
+    /* Check if need to resize the overlay to fit more items. */
+    if (ovl->count >= ovl->count_max)
+    {
+        uint64_t const count_max_new =
+            ovl->count_max == 0U ? OVL_COUNT_START
+                                 : (uint64_t)ovl->count_max * OVL_COUNT_GROWTH;
+        if (count_max_new > UINT32_MAX)
         {
-            free(buf1_new);
-            free(buf2_new);
             return SWICC_RET_ERROR;
         }
-        lut->buf1 = buf1_new;
-        lut->buf2 = buf2_new;
+        swicc_disk_ovl_item_st *const item_new =
+            realloc(ovl->item, count_max_new * sizeof(*ovl->item));
+        if (item_new == NULL)
+        {
+            return SWICC_RET_ERROR;
+        }
+        ovl->item = item_new;
+        /* Safe cast due to the check against uint32 max. */
+        ovl->count_max = (uint32_t)count_max_new;
     }
 
-    /**
-     * Insert such that item 1 of all entries are arranged in increasing order.
-     */
-    uint32_t start = 0U;
-    uint32_t end = lut->count;
-    uint32_t mid;
-    while (start < end)
+    uint8_t *const item_buf = malloc(len);
+    if (item_buf == NULL)
     {
-        mid = (start + end) / 2U;
-        /* value_mid < value_new */
-        if (memcmp(&lut->buf1[lut->size_item1 * mid], entry_item1,
-                   lut->size_item1) < 0)
-        {
-            start = mid + 1U;
-        }
-        else
+        return SWICC_RET_ERROR;
+    }
+    memcpy(item_buf, buf, len);
+
+    /* Keep the items sorted by offset. */
+    uint32_t const item_idx = ovl_lower_bound(ovl, offset_trel);
+    memmove(&ovl->item[item_idx + 1U], &ovl->item[item_idx],
+            (ovl->count - item_idx) * sizeof(*ovl->item));
+    ovl->item[item_idx] = (swicc_disk_ovl_item_st){
+        .offset_trel = offset_trel, .len = len, .buf = item_buf};
+    ovl->count += 1U;
+    return SWICC_RET_SUCCESS;
+}
+
+/**
+ * @brief Dealloc all overlay buffers.
+ * @param ovl
+ */
+static void ovl_empty(swicc_disk_ovl_st *const ovl)
+{
+    for (uint32_t item_idx = 0U; item_idx < ovl->count; ++item_idx)
+    {
+        free(ovl->item[item_idx].buf);
+    }
+    if (ovl->item != NULL)
+    {
+        free(ovl->item);
+    }
+    memset(ovl, 0U, sizeof(*ovl));
+}
+
+/**
+ * @brief Write a tree to a file with all the modifications from its overlay
+ * applied.
+ * @param tree
+ * @param f
+ * @return Return code.
+ */
+static swicc_ret_et tree_write(swicc_disk_tree_st const *const tree,
+                               FILE *const f)
+{
+    uint32_t offset = 0U;
+    for (uint32_t item_idx = 0U; item_idx < tree->ovl.count; ++item_idx)
+    {
+        swicc_disk_ovl_item_st const *const item = &tree->ovl.item[item_idx];
+        uint32_t const len_base = item->offset_trel - offset;
+        if ((len_base > 0U &&
+             fwrite(&tree->buf[offset], len_base, 1U, f) != 1U) ||
+            fwrite(item->buf, item->len, 1U, f) != 1U)
         {
-            end = mid;
+            return SWICC_RET_ERROR;
         }
+        offset = item->offset_trel + item->len;
+    }
+    if (offset < tree->len &&
+        fwrite(&tree->buf[offset], tree->len - offset, 1U, f) != 1U)
+    {
+        return SWICC_RET_ERROR;
     }
-    memmove(&lut->buf1[lut->size_item1 * (start + 1U)],
-            &lut->buf1[lut->size_item1 * (start)],
-            lut->size_item1 * (lut->count - start));
-    memmove(&lut->buf2[lut->size_item2 * (start + 1U)],
-            &lut->buf2[lut->size_item2 * (start)],
-            lut->size_item2 * (lut->count - start));
-    memcpy(&lut->buf1[lut->size_item1 * start], entry_item1, lut->size_item1);
-    memcpy(&lut->buf2[lut->size_item2 * start], entry_item2, lut->size_item2);
-    lut->count += 1U;
     return SWICC_RET_SUCCESS;
 }
 
@@ -93,6 +797,8 @@ swicc_ret_et swicc_disk_load(swicc_disk_st *const disk,
     /* Clear disk so that all the members have a known initial state. */
     memset(disk, 0U, sizeof(*disk));
 
+    /* If the LUTs were loaded from the disk file, they need no rebuilding. */
+    bool lut_loaded = false;
     FILE *f = fopen(disk_path, "rb");
     if (!(f == NULL))
     {
@@ -105,6 +811,8 @@ swicc_ret_et swicc_disk_load(swicc_disk_st *const disk,
                 {
                     uint8_t const magic_expected[SWICC_DISK_MAGIC_LEN] =
                         SWICC_DISK_MAGIC;
+                    uint8_t const lut_magic_expected[SWICC_DISK_MAGIC_LEN] =
+                        SWICC_DISK_LUT_MAGIC;
                     uint8_t magic[SWICC_DISK_MAGIC_LEN];
                     if (fread(&magic, SWICC_DISK_MAGIC_LEN, 1U, f) == 1U)
                     {
@@ -125,6 +833,49 @@ swicc_ret_et swicc_disk_load(swicc_disk_st *const disk,
                              */
                             while (data_idx < f_len)
                             {
+                                /**
+                                 * The LUT section (if present) comes after all
+                                 * the trees so there has to be at least one
+                                 * tree before it.
+                                 */
+                                if (tree != NULL &&
+                                    f_len - data_idx >= SWICC_DISK_MAGIC_LEN)
+                                {
+                                    uint8_t lut_magic[SWICC_DISK_MAGIC_LEN];
+                                    if (fread(&lut_magic, SWICC_DISK_MAGIC_LEN,
+                                              1U, f) != 1U)
+                                    {
+                                        ret_item = SWICC_RET_ERROR;
+                                        break;
+                                    }
+                                    if (memcmp(lut_magic, lut_magic_expected,
+                                               SWICC_DISK_MAGIC_LEN) == 0)
+                                    {
+                                        /**
+                                         * Safe cast since file length was
+                                         * checked to fit in a uint32.
+                                         */
+                                        uint32_t const lut_len =
+                                            (uint32_t)(f_len - data_idx -
+                                                       SWICC_DISK_MAGIC_LEN);
+                                        /**
+                                         * When the LUT section is invalid, the
+                                         * LUTs will just get rebuilt.
+                                         */
+                                        lut_loaded =
+                                            disk_lut_read(disk, f, lut_len) ==
+                                            SWICC_RET_SUCCESS;
+                                        break;
+                                    }
+                                    /* Not a LUT section so must be a tree. */
+                                    if (fseek(f, -(int32_t)SWICC_DISK_MAGIC_LEN,
+                                              SEEK_CUR) != 0)
+                                    {
+                                        ret_item = SWICC_RET_ERROR;
+                                        break;
+                                    }
+                                }
+
                                 /* Check if creating the first tree. */
                                 if (tree == NULL)
                                 {
@@ -233,30 +984,165 @@ swicc_ret_et swicc_disk_load(swicc_disk_st *const disk,
             ret = SWICC_RET_ERROR;
         }
     }
+    if (ret == SWICC_RET_SUCCESS)
+    {
+        /* Decode the folder headers of all trees. */
+        ret = disk_hdrtbl_rebuild(disk);
+    }
+    if (ret == SWICC_RET_SUCCESS && !lut_loaded)
+    {
+        /* Create all the LUTs. */
+        ret = disk_lut_rebuild(disk);
+    }
     if (ret != SWICC_RET_SUCCESS)
     {
         swicc_disk_root_empty(disk);
     }
-    else
+    return ret;
+}
+
+/**
+ * @brief Parse the trees (and the LUT section if present) of a disk file
+ * mapped into memory. The tree buffers will point into the mapping.
+ * @param disk The disk with the mapping set.
+ * @return Return code.
+ */
+static swicc_ret_et disk_map_prs(swicc_disk_st *const disk)
+{
+    uint8_t const magic_expected[SWICC_DISK_MAGIC_LEN] = SWICC_DISK_MAGIC;
+    uint8_t const lut_magic_expected[SWICC_DISK_MAGIC_LEN] =
+        SWICC_DISK_LUT_MAGIC;
+    uint8_t *const map = disk->map;
+    uint32_t const map_len = disk->map_len;
+    if (map_len < SWICC_DISK_MAGIC_LEN ||
+        memcmp(map, magic_expected, SWICC_DISK_MAGIC_LEN) != 0)
     {
-        /* Create all the LUTs. */
-        swicc_disk_tree_st *tree = disk->root;
+        return SWICC_RET_ERROR;
+    }
+
+    bool lut_loaded = false;
+    swicc_disk_tree_st *tree = NULL;
+    uint32_t data_idx = SWICC_DISK_MAGIC_LEN;
+    uint8_t tree_idx = 0U;
+    while (data_idx < map_len)
+    {
+        uint32_t const len_rem = map_len - data_idx;
+
+        /* The LUT section (if present) comes after all the trees. */
+        if (tree != NULL && len_rem >= SWICC_DISK_MAGIC_LEN &&
+            memcmp(&map[data_idx], lut_magic_expected, SWICC_DISK_MAGIC_LEN) ==
+                0)
+        {
+            /* When the LUT section is invalid, the LUTs will get rebuilt. */
+            lut_loaded = disk_lut_prs(disk,
+                                      &map[data_idx + SWICC_DISK_MAGIC_LEN],
+                                      len_rem - SWICC_DISK_MAGIC_LEN) ==
+                         SWICC_RET_SUCCESS;
+            break;
+        }
+
+        swicc_fs_item_hdr_raw_st item_hdr_raw;
+        swicc_fs_item_hdr_st item_hdr;
+        if (len_rem < sizeof(item_hdr_raw))
+        {
+            return SWICC_RET_ERROR;
+        }
+        memcpy(&item_hdr_raw, &map[data_idx], sizeof(item_hdr_raw));
+        swicc_fs_item_hdr_prs(&item_hdr_raw, 0U, &item_hdr);
+        /**
+         * Make sure all trees are valid, the first one is the MF, all other
+         * ones are ADFs, and that they fit inside the file.
+         */
+        if (item_hdr.type == SWICC_FS_ITEM_TYPE_INVALID ||
+            (tree_idx == 0 && item_hdr.type != SWICC_FS_ITEM_TYPE_FILE_MF) ||
+            (tree_idx != 0 && item_hdr.type != SWICC_FS_ITEM_TYPE_FILE_ADF) ||
+            item_hdr.size < sizeof(item_hdr_raw) || item_hdr.size > len_rem)
+        {
+            return SWICC_RET_ERROR;
+        }
+
+        swicc_disk_tree_st *const tree_new = malloc(sizeof(*tree_new));
+        if (tree_new == NULL)
+        {
+            return SWICC_RET_ERROR;
+        }
+        memset(tree_new, 0U, sizeof(*tree_new));
         if (tree == NULL)
         {
-            ret = SWICC_RET_ERROR;
+            disk->root = tree_new;
         }
-        while (tree != NULL)
+        else
+        {
+            tree->next = tree_new;
+        }
+        tree = tree_new;
+
+        tree->buf = &map[data_idx];
+        tree->buf_mapped = true;
+        tree->size = item_hdr.size;
+        tree->len = item_hdr.size;
+        data_idx += tree->len;
+
+        /* Unsafe cast that relies on there being fewer than 256 trees. */
+        tree_idx = (uint8_t)(tree_idx + 1U);
+    }
+
+    if (disk->root == NULL)
+    {
+        return SWICC_RET_ERROR;
+    }
+    /* Decode the folder headers of all trees. */
+    swicc_ret_et const ret = disk_hdrtbl_rebuild(disk);
+    if (ret == SWICC_RET_SUCCESS && !lut_loaded)
+    {
+        return disk_lut_rebuild(disk);
+    }
+    return ret;
+}
+
+swicc_ret_et swicc_disk_load_mmap(swicc_disk_st *const disk,
+                                  char const *const disk_path)
+{
+    if (disk == NULL || disk_path == NULL)
+    {
+        return SWICC_RET_PARAM_BAD;
+    }
+
+    swicc_ret_et ret = SWICC_RET_ERROR;
+    if (disk->root != NULL)
+    {
+        /* Get rid of the current disk first before loading a new one. */
+        return ret;
+    }
+
+    /* Clear disk so that all the members have a known initial state. */
+    memset(disk, 0U, sizeof(*disk));
+
+    int32_t const fd = open(disk_path, O_RDONLY);
+    if (fd >= 0)
+    {
+        struct stat fd_stat;
+        if (fstat(fd, &fd_stat) == 0 && fd_stat.st_size > 0 &&
+            fd_stat.st_size <= UINT32_MAX)
         {
-            ret = swicc_disk_lutsid_rebuild(disk, tree);
-            if (ret != SWICC_RET_SUCCESS)
+            /**
+             * The mapping is writable but private so pages are shared with the
+             * page cache until they get modified.
+             */
+            void *const map = mmap(NULL, (size_t)fd_stat.st_size,
+                                   PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+            if (map != MAP_FAILED)
             {
-                break;
+                disk->map = map;
+                /* Safe cast since size was checked to fit in a uint32. */
+                disk->map_len = (uint32_t)fd_stat.st_size;
+                ret = disk_map_prs(disk);
             }
-            tree = tree->next;
         }
-        if (ret == SWICC_RET_SUCCESS)
+        /* The mapping stays valid after the file is closed. */
+        if (close(fd) != 0)
         {
-            ret = swicc_disk_lutid_rebuild(disk);
+            ret = SWICC_RET_ERROR;
         }
     }
     if (ret != SWICC_RET_SUCCESS)
@@ -266,6 +1152,60 @@ swicc_ret_et swicc_disk_load(swicc_disk_st *const disk,
     return ret;
 }
 
+swicc_ret_et swicc_disk_overlay(swicc_disk_st *const disk,
+                                swicc_disk_st const *const disk_base)
+{
+    if (disk == NULL || disk_base == NULL)
+    {
+        return SWICC_RET_PARAM_BAD;
+    }
+
+    /**
+     * Get rid of the current disk first before creating a new one. The base
+     * must have all its LUTs and can't be an overlay itself.
+     */
+    if (disk->root != NULL || disk_base->root == NULL ||
+        disk_base->lutid.buf1 == NULL || disk_base->lutname.buf1 == NULL ||
+        disk_base->base != NULL)
+    {
+        return SWICC_RET_ERROR;
+    }
+
+    /* Clear disk so that all the members have a known initial state. */
+    memset(disk, 0U, sizeof(*disk));
+    disk->base = disk_base;
+    /* The LUTs are never modified so they are shared with the base as-is. */
+    disk->lutid = disk_base->lutid;
+    disk->lutname = disk_base->lutname;
+
+    swicc_disk_tree_st *tree = NULL;
+    swicc_disk_tree_st const *tree_base = disk_base->root;
+    while (tree_base != NULL)
+    {
+        swicc_disk_tree_st *const tree_new = malloc(sizeof(*tree_new));
+        if (tree_new == NULL)
+        {
+            swicc_disk_root_empty(disk);
+            return SWICC_RET_ERROR;
+        }
+        memcpy(tree_new, tree_base, sizeof(*tree_new));
+        tree_new->next = NULL;
+        tree_new->shared = true;
+        memset(&tree_new->ovl, 0U, sizeof(tree_new->ovl));
+        if (tree == NULL)
+        {
+            disk->root = tree_new;
+        }
+        else
+        {
+            tree->next = tree_new;
+        }
+        tree = tree_new;
+        tree_base = tree_base->next;
+    }
+    return SWICC_RET_SUCCESS;
+}
+
 void swicc_disk_unload(swicc_disk_st *const disk)
 {
     if (disk == NULL)
@@ -281,6 +1221,7 @@ void swicc_disk_unload(swicc_disk_st *const disk)
     swicc_disk_root_empty(disk);
 
     swicc_disk_lutid_empty(disk);
+    swicc_disk_lutname_empty(disk);
     memset(disk, 0U, sizeof(*disk));
 }
 
@@ -299,17 +1240,32 @@ swicc_ret_et swicc_disk_save(swicc_disk_st const *const disk,
         uint8_t magic[SWICC_DISK_MAGIC_LEN] = SWICC_DISK_MAGIC;
         if (fwrite(magic, SWICC_DISK_MAGIC_LEN, 1U, f) == 1U)
         {
+            /* Only save the LUTs when all of them exist. */
+            bool lut_save =
+                disk->lutid.buf1 != NULL && disk->lutname.buf1 != NULL;
             swicc_disk_tree_st *tree = disk->root;
             while (tree != NULL)
             {
-                if (fwrite(tree->buf, tree->len, 1U, f) != 1U)
+                if (tree_write(tree, f) != SWICC_RET_SUCCESS)
                 {
                     ret = SWICC_RET_ERROR;
                     break;
                 }
+                lut_save = lut_save && tree->lutsid.buf1 != NULL &&
+                           tree->lutchild.buf1 != NULL;
                 tree = tree->next;
                 ret = SWICC_RET_SUCCESS;
             }
+            if (ret == SWICC_RET_SUCCESS && lut_save)
+            {
+                uint8_t const lut_magic[SWICC_DISK_MAGIC_LEN] =
+                    SWICC_DISK_LUT_MAGIC;
+                if (fwrite(lut_magic, SWICC_DISK_MAGIC_LEN, 1U, f) != 1U ||
+                    disk_lut_write(disk, f) != SWICC_RET_SUCCESS)
+                {
+                    ret = SWICC_RET_ERROR;
+                }
+            }
         }
         if (fclose(f) != 0)
         {
@@ -354,13 +1310,6 @@ swicc_ret_et swicc_disk_file_foreach(swicc_disk_tree_st *const tree,
             break;
         }
 
-        /* Perform the per-file operation. */
-        ret = cb(tree, &file_nstd, userdata);
-        if (ret != SWICC_RET_SUCCESS)
-        {
-            break;
-        }
-
         switch (file_nstd.hdr_item.type)
         {
         case SWICC_FS_ITEM_TYPE_FILE_MF:
@@ -368,6 +1317,10 @@ swicc_ret_et swicc_disk_file_foreach(swicc_disk_tree_st *const tree,
         case SWICC_FS_ITEM_TYPE_FILE_DF:
             if (recurse)
             {
+                /**
+                 * The recursive call performs the operation on the folder
+                 * itself so it must not be done here too.
+                 */
                 ret = swicc_disk_file_foreach(tree, &file_nstd, cb, userdata,
                                               true);
                 break;
@@ -376,6 +1329,8 @@ swicc_ret_et swicc_disk_file_foreach(swicc_disk_tree_st *const tree,
         case SWICC_FS_ITEM_TYPE_FILE_EF_TRANSPARENT:
         case SWICC_FS_ITEM_TYPE_FILE_EF_LINEARFIXED:
         case SWICC_FS_ITEM_TYPE_FILE_EF_CYCLIC:
+            /* Perform the per-file operation. */
+            ret = cb(tree, &file_nstd, userdata);
             break;
         default:
             ret = SWICC_RET_ERROR;
@@ -456,69 +1411,190 @@ swicc_ret_et swicc_disk_tree_iter_idx(swicc_disk_tree_iter_st *const tree_iter,
     {
         *tree = tree_iter->tree;
     }
-    return SWICC_RET_SUCCESS;
+    return SWICC_RET_SUCCESS;
+}
+
+void swicc_disk_root_empty(swicc_disk_st *const disk)
+{
+    if (disk == NULL)
+    {
+        return;
+    }
+    swicc_disk_tree_st *tree = disk->root;
+    while (tree != NULL)
+    {
+        /**
+         * Mapped buffers get released all at once by unmapping the file and
+         * shared buffers belong to the base disk.
+         */
+        if (tree->buf != NULL && !tree->buf_mapped && !tree->shared)
+        {
+            free(tree->buf);
+        }
+        ovl_empty(&tree->ovl);
+
+        /* Free the SID and child LUTs, and the header table of this tree. */
+        swicc_disk_lutsid_empty(tree);
+        swicc_disk_lutchild_empty(tree);
+        swicc_disk_hdrtbl_empty(tree);
+
+        swicc_disk_tree_st *const tree_next = tree->next;
+        free(tree);
+        tree = tree_next;
+    }
+    disk->root = NULL;
+    if (disk->map != NULL)
+    {
+        munmap(disk->map, disk->map_len);
+        disk->map = NULL;
+        disk->map_len = 0U;
+    }
+    /**
+     * Since there will be no trees left, the ID, name, and AID LUTs shall also
+     * be destroyed.
+     */
+    swicc_disk_lutid_empty(disk);
+    swicc_disk_lutname_empty(disk);
+    swicc_disk_lutaid_empty(disk);
+    disk->base = NULL;
+}
+
+void swicc_disk_lutsid_empty(swicc_disk_tree_st *const tree)
+{
+    if (tree == NULL)
+    {
+        return;
+    }
+    swicc_disk_lut_st *lutsid = &tree->lutsid;
+    /* The SID LUT of a shared tree belongs to the base disk. */
+    if (tree->shared)
+    {
+        memset(&tree->lutsid, 0U, sizeof(tree->lutsid));
+        return;
+    }
+    if (lutsid->buf1 != NULL)
+    {
+        free(lutsid->buf1);
+    }
+    if (lutsid->buf2 != NULL)
+    {
+        free(lutsid->buf2);
+    }
+    memset(&tree->lutsid, 0U, sizeof(tree->lutsid));
+}
+
+void swicc_disk_lutchild_empty(swicc_disk_tree_st *const tree)
+{
+    if (tree == NULL)
+    {
+        return;
+    }
+    swicc_disk_lut_st *lutchild = &tree->lutchild;
+    /* The child LUT of a shared tree belongs to the base disk. */
+    if (tree->shared)
+    {
+        memset(&tree->lutchild, 0U, sizeof(tree->lutchild));
+        return;
+    }
+    if (lutchild->buf1 != NULL)
+    {
+        free(lutchild->buf1);
+    }
+    if (lutchild->buf2 != NULL)
+    {
+        free(lutchild->buf2);
+    }
+    memset(&tree->lutchild, 0U, sizeof(tree->lutchild));
+}
+
+void swicc_disk_hdrtbl_empty(swicc_disk_tree_st *const tree)
+{
+    if (tree == NULL)
+    {
+        return;
+    }
+    swicc_disk_hdrtbl_st *hdrtbl = &tree->hdrtbl;
+    /* The header table of a shared tree belongs to the base disk. */
+    if (tree->shared)
+    {
+        memset(&tree->hdrtbl, 0U, sizeof(tree->hdrtbl));
+        return;
+    }
+    if (hdrtbl->folder != NULL)
+    {
+        free(hdrtbl->folder);
+    }
+    if (hdrtbl->slot != NULL)
+    {
+        free(hdrtbl->slot);
+    }
+    memset(&tree->hdrtbl, 0U, sizeof(tree->hdrtbl));
 }
 
-void swicc_disk_root_empty(swicc_disk_st *const disk)
+void swicc_disk_lutid_empty(swicc_disk_st *const disk)
 {
     if (disk == NULL)
     {
         return;
     }
-    swicc_disk_tree_st *tree = disk->root;
-    while (tree != NULL)
+    swicc_disk_lut_st *lutid = &disk->lutid;
+    /* The ID LUT of an overlay disk belongs to the base disk. */
+    if (disk->base != NULL)
     {
-        if (tree->buf != NULL)
-        {
-            free(tree->buf);
-        }
-
-        /* Free the SID LUT of this tree. */
-        swicc_disk_lutsid_empty(tree);
-
-        swicc_disk_tree_st *const tree_next = tree->next;
-        free(tree);
-        tree = tree_next;
+        memset(&disk->lutid, 0U, sizeof(disk->lutid));
+        return;
     }
-    disk->root = NULL;
-    /* Since there will be no trees left, the ID LUT shall also be destroyed. */
-    swicc_disk_lutid_empty(disk);
+    if (lutid->buf1 != NULL)
+    {
+        free(lutid->buf1);
+    }
+    if (lutid->buf2 != NULL)
+    {
+        free(lutid->buf2);
+    }
+    memset(&disk->lutid, 0U, sizeof(disk->lutid));
 }
 
-void swicc_disk_lutsid_empty(swicc_disk_tree_st *const tree)
+void swicc_disk_lutname_empty(swicc_disk_st *const disk)
 {
-    if (tree == NULL)
+    if (disk == NULL)
     {
         return;
     }
-    swicc_disk_lut_st *lutsid = &tree->lutsid;
-    if (lutsid->buf1 != NULL)
+    swicc_disk_lut_st *lutname = &disk->lutname;
+    /* The name LUT of an overlay disk belongs to the base disk. */
+    if (disk->base != NULL)
     {
-        free(lutsid->buf1);
+        memset(&disk->lutname, 0U, sizeof(disk->lutname));
+        return;
     }
-    if (lutsid->buf2 != NULL)
+    if (lutname->buf1 != NULL)
     {
-        free(lutsid->buf2);
+        free(lutname->buf1);
     }
-    memset(&tree->lutsid, 0U, sizeof(tree->lutsid));
+    if (lutname->buf2 != NULL)
+    {
+        free(lutname->buf2);
+    }
+    memset(&disk->lutname, 0U, sizeof(disk->lutname));
 }
 
-void swicc_disk_lutid_empty(swicc_disk_st *const disk)
+void swicc_disk_lutaid_empty(swicc_disk_st *const disk)
 {
     if (disk == NULL)
     {
         return;
     }
-    swicc_disk_lut_st *lutid = &disk->lutid;
-    if (lutid->buf1 != NULL)
+    swicc_disk_lut_st *lutaid = &disk->lutaid;
+    if (lutaid->buf1 != NULL)
     {
-        free(lutid->buf1);
+        free(lutaid->buf1);
     }
-    if (lutid->buf2 != NULL)
+    if (lutaid->buf2 != NULL)
     {
-        free(lutid->buf2);
+        free(lutaid->buf2);
     }
-    memset(&disk->lutid, 0U, sizeof(disk->lutid));
+    memset(&disk->lutaid, 0U, sizeof(disk->lutaid));
 }
 
 typedef struct lutid_rebuild_cb_userdata_s
@@ -558,7 +1634,7 @@ static swicc_ret_et lutid_rebuild_cb(swicc_disk_tree_st *const tree,
     memcpy(&entry_item2[0U], &file->hdr_item.offset_trel, sizeof(uint32_t));
     memcpy(&entry_item2[sizeof(uint32_t)], &userdata_struct->tree_idx,
            sizeof(uint8_t));
-    return lut_insert(lutid, entry_item1, entry_item2);
+    return lut_append(lutid, entry_item1, entry_item2);
 }
 
 swicc_ret_et swicc_disk_lutid_rebuild(swicc_disk_st *const disk)
@@ -567,6 +1643,11 @@ swicc_ret_et swicc_disk_lutid_rebuild(swicc_disk_st *const disk)
     {
         return SWICC_RET_PARAM_BAD;
     }
+    /* The LUTs of an overlay disk belong to the base disk. */
+    if (disk->base != NULL)
+    {
+        return SWICC_RET_ERROR;
+    }
     swicc_ret_et ret = SWICC_RET_ERROR;
     /* Cleanup the old ID LUT before rebuilding it. */
     swicc_disk_lutid_empty(disk);
@@ -612,33 +1693,419 @@ swicc_ret_et swicc_disk_lutid_rebuild(swicc_disk_st *const disk)
          */
         tree_idx = (uint8_t)(tree_idx + 1U);
     }
+    if (ret == SWICC_RET_SUCCESS)
+    {
+        /* All entries were appended so they need to be sorted only once. */
+        ret = lut_sort(&disk->lutid);
+        if (ret != SWICC_RET_SUCCESS)
+        {
+            swicc_disk_lutid_empty(disk);
+        }
+    }
+    return ret;
+}
+
+swicc_ret_et swicc_disk_lutaid_rebuild(swicc_disk_st *const disk)
+{
+    if (disk == NULL)
+    {
+        return SWICC_RET_PARAM_BAD;
+    }
+    /* Cleanup the old AID LUT before rebuilding it. */
+    swicc_disk_lutaid_empty(disk);
+    disk->lutaid.size_item1 = SWICC_FS_ADF_AID_LEN;
+    disk->lutaid.size_item2 = sizeof(swicc_disk_tree_st *);
+    disk->lutaid.count_max = LUT_COUNT_START;
+    disk->lutaid.count = 0U;
+    disk->lutaid.buf1 =
+        malloc(disk->lutaid.count_max * disk->lutaid.size_item1);
+    disk->lutaid.buf2 =
+        malloc(disk->lutaid.count_max * disk->lutaid.size_item2);
+    if (disk->lutaid.buf1 == NULL || disk->lutaid.buf2 == NULL)
+    {
+        swicc_disk_lutaid_empty(disk);
+        return SWICC_RET_ERROR;
+    }
+
+    swicc_ret_et ret = SWICC_RET_SUCCESS;
+    for (swicc_disk_tree_st *tree = disk->root; tree != NULL;
+         tree = tree->next)
+    {
+        /* Only the root of a tree has to be parsed to get its AID. */
+        swicc_fs_file_st file_root;
+        ret = swicc_disk_tree_file_root(tree, &file_root);
+        if (ret != SWICC_RET_SUCCESS)
+        {
+            break;
+        }
+        if (file_root.hdr_item.type != SWICC_FS_ITEM_TYPE_FILE_ADF)
+        {
+            continue;
+        }
+
+        uint8_t entry_item1[SWICC_FS_ADF_AID_LEN];
+        memcpy(&entry_item1[0U], file_root.hdr_spec.adf.aid.rid,
+               SWICC_FS_ADF_AID_RID_LEN);
+        memcpy(&entry_item1[SWICC_FS_ADF_AID_RID_LEN],
+               file_root.hdr_spec.adf.aid.pix, SWICC_FS_ADF_AID_PIX_LEN);
+        ret = lut_append(&disk->lutaid, entry_item1, (uint8_t *)&tree);
+        if (ret != SWICC_RET_SUCCESS)
+        {
+            break;
+        }
+    }
+    if (ret == SWICC_RET_SUCCESS)
+    {
+        ret = lut_sort(&disk->lutaid);
+    }
+    if (ret != SWICC_RET_SUCCESS)
+    {
+        swicc_disk_lutaid_empty(disk);
+    }
+    return ret;
+}
+
+/**
+ * @brief Callback used when rebuilding the name LUT. It receives files and
+ * inserts the names of the MF and DFs into the name LUT.
+ * @param tree
+ * @param file
+ * @param userdata This must point to the userdata struct (same one as for the
+ * ID LUT).
+ * @return Return code.
+ */
+static swicc_disk_file_foreach_cb lutname_rebuild_cb;
+static swicc_ret_et lutname_rebuild_cb(swicc_disk_tree_st *const tree,
+                                       swicc_fs_file_st *const file,
+                                       void *const userdata)
+{
+    uint8_t const *name;
+    switch (file->hdr_item.type)
+    {
+    case SWICC_FS_ITEM_TYPE_FILE_MF:
+        name = file->hdr_spec.mf.name;
+        break;
+    case SWICC_FS_ITEM_TYPE_FILE_DF:
+        name = file->hdr_spec.df.name;
+        break;
+    default:
+        return SWICC_RET_SUCCESS;
+    }
+
+    /* Insert the name + offset into the name LUT. */
+    lutid_rebuild_cb_userdata_st const *const userdata_struct = userdata;
+    swicc_disk_lut_st *const lutname = userdata_struct->lut;
+    uint8_t entry_item2[lutname->size_item2];
+    memcpy(&entry_item2[0U], &file->hdr_item.offset_trel, sizeof(uint32_t));
+    memcpy(&entry_item2[sizeof(uint32_t)], &userdata_struct->tree_idx,
+           sizeof(uint8_t));
+    return lut_append(lutname, name, entry_item2);
+}
+
+swicc_ret_et swicc_disk_lutname_rebuild(swicc_disk_st *const disk)
+{
+    if (disk == NULL)
+    {
+        return SWICC_RET_PARAM_BAD;
+    }
+    /* The LUTs of an overlay disk belong to the base disk. */
+    if (disk->base != NULL)
+    {
+        return SWICC_RET_ERROR;
+    }
+    swicc_ret_et ret = SWICC_RET_SUCCESS;
+    /* Cleanup the old name LUT before rebuilding it. */
+    swicc_disk_lutname_empty(disk);
+    disk->lutname.size_item1 = SWICC_FS_NAME_LEN;
+    disk->lutname.size_item2 =
+        sizeof(uint32_t) + sizeof(uint8_t); /* Offset + tree index */
+    disk->lutname.count_max = LUT_COUNT_START;
+    disk->lutname.count = 0U;
+    disk->lutname.buf1 =
+        malloc(disk->lutname.count_max * disk->lutname.size_item1);
+    disk->lutname.buf2 =
+        malloc(disk->lutname.count_max * disk->lutname.size_item2);
+    if (disk->lutname.buf1 == NULL || disk->lutname.buf2 == NULL)
+    {
+        swicc_disk_lutname_empty(disk);
+        return SWICC_RET_ERROR;
+    }
+
+    swicc_disk_tree_st *tree = disk->root;
+    uint8_t tree_idx = 0U;
+    while (tree != NULL)
+    {
+        lutid_rebuild_cb_userdata_st userdata = {.lut = &disk->lutname,
+                                                 .tree_idx = tree_idx};
+        swicc_fs_file_st file_root;
+        ret = swicc_disk_tree_file_root(tree, &file_root);
+        if (ret != SWICC_RET_SUCCESS)
+        {
+            break;
+        }
+        ret = swicc_disk_file_foreach(tree, &file_root, lutname_rebuild_cb,
+                                      &userdata, true);
+        if (ret != SWICC_RET_SUCCESS)
+        {
+            break;
+        }
+        tree = tree->next;
+
+        /**
+         * Unsafe cast that relies on there being fewer than 256 trees in the
+         * forest.
+         */
+        tree_idx = (uint8_t)(tree_idx + 1U);
+    }
+    if (ret == SWICC_RET_SUCCESS)
+    {
+        /* All entries were appended so they need to be sorted only once. */
+        ret = lut_sort(&disk->lutname);
+    }
+    if (ret != SWICC_RET_SUCCESS)
+    {
+        swicc_disk_lutname_empty(disk);
+    }
+    return ret;
+}
+
+/**
+ * @brief Callback used when rebuilding the SID LUT. It receives files and
+ * inserts their info into the SID LUT.
+ * @param tree
+ * @param file
+ * @param userdata
+ * @return Return code.
+ */
+static swicc_disk_file_foreach_cb lutsid_rebuild_cb;
+static swicc_ret_et lutsid_rebuild_cb(swicc_disk_tree_st *const tree,
+                                      swicc_fs_file_st *const file,
+                                      void *const userdata)
+{
+    if (file->hdr_file.sid == SWICC_FS_SID_MISSING)
+    {
+        return SWICC_RET_SUCCESS;
+    }
+
+    /* Insert the SID + offset into the SID LUT. */
+    return lut_append(&tree->lutsid, (uint8_t *)&file->hdr_file.sid,
+                      (uint8_t *)&file->hdr_item.offset_trel);
+}
+
+swicc_ret_et swicc_disk_lutsid_rebuild(swicc_disk_st *const disk,
+                                       swicc_disk_tree_st *const tree)
+{
+    if (disk == NULL || tree == NULL)
+    {
+        return SWICC_RET_PARAM_BAD;
+    }
+
+    /* The SID LUT of a shared tree belongs to the base disk. */
+    if (tree->shared)
+    {
+        return SWICC_RET_ERROR;
+    }
+
+    /* Cleanup the old SID LUT before rebuilding it. */
+    swicc_disk_lutsid_empty(tree);
+    tree->lutsid.size_item1 = sizeof(swicc_fs_sid_kt);
+    tree->lutsid.size_item2 = sizeof(uint32_t);
+    tree->lutsid.count_max = LUT_COUNT_START;
+    tree->lutsid.count = 0U;
+    tree->lutsid.buf1 =
+        malloc(tree->lutsid.count_max * tree->lutsid.size_item1);
+    tree->lutsid.buf2 =
+        malloc(tree->lutsid.count_max * tree->lutsid.size_item2);
+    if (tree->lutsid.buf1 == NULL || tree->lutsid.buf2 == NULL)
+    {
+        swicc_disk_lutsid_empty(tree);
+        return SWICC_RET_ERROR;
+    }
+
+    swicc_fs_file_st file_root;
+    swicc_ret_et ret = swicc_disk_tree_file_root(tree, &file_root);
+    if (ret != SWICC_RET_SUCCESS)
+    {
+        swicc_disk_lutsid_empty(tree);
+        return ret;
+    }
+    ret = swicc_disk_file_foreach(tree, &file_root, lutsid_rebuild_cb, NULL,
+                                  true);
+    if (ret == SWICC_RET_SUCCESS)
+    {
+        /* All entries were appended so they need to be sorted only once. */
+        ret = lut_sort(&tree->lutsid);
+    }
+    if (ret != SWICC_RET_SUCCESS)
+    {
+        swicc_disk_lutsid_empty(tree);
+        return ret;
+    }
+    return ret;
+}
+
+/**
+ * @brief Create item 1 of a child LUT entry.
+ * @param offset_trel_folder Tree-relative offset of the folder.
+ * @param id ID of the child.
+ * @param entry_item1 Where item 1 will be written. Must be of the size of item
+ * 1 in the child LUT.
+ * @note Both are kept in big-endian inside the LUT so that children of the same
+ * folder are next to each other and sorted by ID.
+ */
+static void lutchild_item1(uint32_t const offset_trel_folder,
+                           swicc_fs_id_kt const id,
+                           uint8_t *const entry_item1)
+{
+    uint32_t const offset_be = htobe32(offset_trel_folder);
+    swicc_fs_id_kt const id_be = htobe16(id);
+    memcpy(&entry_item1[0U], &offset_be, sizeof(offset_be));
+    memcpy(&entry_item1[sizeof(offset_be)], &id_be, sizeof(id_be));
+}
+
+/**
+ * @brief Callback used when rebuilding the child LUT. It receives files and
+ * inserts them into the child LUT of their parent.
+ * @param tree
+ * @param file
+ * @param userdata
+ * @return Return code.
+ */
+static swicc_disk_file_foreach_cb lutchild_rebuild_cb;
+static swicc_ret_et lutchild_rebuild_cb(swicc_disk_tree_st *const tree,
+                                        swicc_fs_file_st *const file,
+                                        void *const userdata)
+{
+    /* The root has no parent and files without an ID can't be in a path. */
+    if (file->hdr_item.offset_trel == 0U ||
+        file->hdr_file.id == SWICC_FS_ID_MISSING)
+    {
+        return SWICC_RET_SUCCESS;
+    }
+
+    uint8_t entry_item1[LUTCHILD_SIZE_ITEM1];
+    lutchild_item1(file->hdr_item.offset_trel - file->hdr_item.offset_prel,
+                   file->hdr_file.id, entry_item1);
+    return lut_append(&tree->lutchild, entry_item1,
+                      (uint8_t *)&file->hdr_item.offset_trel);
+}
+
+swicc_ret_et swicc_disk_lutchild_rebuild(swicc_disk_st *const disk,
+                                         swicc_disk_tree_st *const tree)
+{
+    if (disk == NULL || tree == NULL)
+    {
+        return SWICC_RET_PARAM_BAD;
+    }
+
+    /* The child LUT of a shared tree belongs to the base disk. */
+    if (tree->shared)
+    {
+        return SWICC_RET_ERROR;
+    }
+
+    /* Cleanup the old child LUT before rebuilding it. */
+    swicc_disk_lutchild_empty(tree);
+    tree->lutchild.size_item1 = LUTCHILD_SIZE_ITEM1;
+    tree->lutchild.size_item2 = sizeof(uint32_t);
+    tree->lutchild.count_max = LUT_COUNT_START;
+    tree->lutchild.count = 0U;
+    tree->lutchild.buf1 =
+        malloc(tree->lutchild.count_max * tree->lutchild.size_item1);
+    tree->lutchild.buf2 =
+        malloc(tree->lutchild.count_max * tree->lutchild.size_item2);
+    if (tree->lutchild.buf1 == NULL || tree->lutchild.buf2 == NULL)
+    {
+        swicc_disk_lutchild_empty(tree);
+        return SWICC_RET_ERROR;
+    }
+
+    swicc_fs_file_st file_root;
+    swicc_ret_et ret = swicc_disk_tree_file_root(tree, &file_root);
+    if (ret == SWICC_RET_SUCCESS)
+    {
+        ret = swicc_disk_file_foreach(tree, &file_root, lutchild_rebuild_cb,
+                                      NULL, true);
+    }
+    if (ret == SWICC_RET_SUCCESS)
+    {
+        /* All entries were appended so they need to be sorted only once. */
+        ret = lut_sort(&tree->lutchild);
+    }
+    if (ret != SWICC_RET_SUCCESS)
+    {
+        swicc_disk_lutchild_empty(tree);
+    }
     return ret;
 }
 
 /**
- * @brief Callback used when rebuilding the SID LUT. It receives files and
- * inserts their info into the SID LUT.
+ * @brief Get the slot of a header table at which the search for a folder
+ * starts.
+ * @param hdrtbl
+ * @param offset_trel Tree-relative offset of the folder.
+ * @return Index of the slot.
+ * @note Offsets of folders are far from random (e.g. folders with the same
+ * contents are equally spaced) so they are mixed by a multiplicative hash whose
+ * high bits are used.
+ */
+static inline uint32_t hdrtbl_slot(swicc_disk_hdrtbl_st const *const hdrtbl,
+                                   uint32_t const offset_trel)
+{
+    /* Safe cast since only the upper 32 bits of the product are kept. */
+    uint32_t const hash =
+        (uint32_t)(((uint64_t)offset_trel * 0x9E3779B97F4A7C15U) >> 32U);
+    return hash & (hdrtbl->slot_count - 1U);
+}
+
+/**
+ * @brief Callback used when rebuilding the header table. It receives files and
+ * appends the decoded headers of folders to the header table (resizing it if
+ * needed).
  * @param tree
  * @param file
- * @param userdata
+ * @param userdata Pointer to how many decoded headers fit in the header table.
  * @return Return code.
  */
-static swicc_disk_file_foreach_cb lutsid_rebuild_cb;
-static swicc_ret_et lutsid_rebuild_cb(swicc_disk_tree_st *const tree,
+static swicc_disk_file_foreach_cb hdrtbl_rebuild_cb;
+static swicc_ret_et hdrtbl_rebuild_cb(swicc_disk_tree_st *const tree,
                                       swicc_fs_file_st *const file,
                                       void *const userdata)
 {
-    if (file->hdr_file.sid == SWICC_FS_SID_MISSING)
+    if (file->hdr_item.type != SWICC_FS_ITEM_TYPE_FILE_MF &&
+        file->hdr_item.type != SWICC_FS_ITEM_TYPE_FILE_ADF &&
+        file->hdr_item.type != SWICC_FS_ITEM_TYPE_FILE_DF)
     {
         return SWICC_RET_SUCCESS;
     }
 
-    /* Insert the SID + offset into the SID LUT. */
-    return lut_insert(&tree->lutsid, (uint8_t *)&file->hdr_file.sid,
-                      (uint8_t *)&file->hdr_item.offset_trel);
+    swicc_disk_hdrtbl_st *const hdrtbl = &tree->hdrtbl;
+    uint32_t *const folder_count_max = userdata;
+    if (hdrtbl->folder_count >= *folder_count_max)
+    {
+        uint64_t const count_max_new =
+            (uint64_t)*folder_count_max * HDRTBL_COUNT_GROWTH;
+        /* The slot count has to fit in a uint32 as well. */
+        if (count_max_new * HDRTBL_SLOT_RATIO > UINT32_MAX)
+        {
+            return SWICC_RET_ERROR;
+        }
+        swicc_fs_file_st *const folder_new =
+            realloc(hdrtbl->folder, count_max_new * sizeof(*folder_new));
+        if (folder_new == NULL)
+        {
+            return SWICC_RET_ERROR;
+        }
+        hdrtbl->folder = folder_new;
+        /* Safe cast due to the check against uint32 max. */
+        *folder_count_max = (uint32_t)count_max_new;
+    }
+    memcpy(&hdrtbl->folder[hdrtbl->folder_count], file, sizeof(*file));
+    hdrtbl->folder_count += 1U;
+    return SWICC_RET_SUCCESS;
 }
 
-swicc_ret_et swicc_disk_lutsid_rebuild(swicc_disk_st *const disk,
+swicc_ret_et swicc_disk_hdrtbl_rebuild(swicc_disk_st *const disk,
                                        swicc_disk_tree_st *const tree)
 {
     if (disk == NULL || tree == NULL)
@@ -646,39 +2113,103 @@ swicc_ret_et swicc_disk_lutsid_rebuild(swicc_disk_st *const disk,
         return SWICC_RET_PARAM_BAD;
     }
 
-    /* Cleanup the old SID LUT before rebuilding it. */
-    swicc_disk_lutsid_empty(tree);
-    tree->lutsid.size_item1 = sizeof(swicc_fs_sid_kt);
-    tree->lutsid.size_item2 = sizeof(uint32_t);
-    tree->lutsid.count_max = LUT_COUNT_START;
-    tree->lutsid.count = 0U;
-    tree->lutsid.buf1 =
-        malloc(tree->lutsid.count_max * tree->lutsid.size_item1);
-    tree->lutsid.buf2 =
-        malloc(tree->lutsid.count_max * tree->lutsid.size_item2);
-    if (tree->lutsid.buf1 == NULL || tree->lutsid.buf2 == NULL)
+    /* The header table of a shared tree belongs to the base disk. */
+    if (tree->shared)
+    {
+        return SWICC_RET_ERROR;
+    }
+
+    /**
+     * Cleanup the old header table before rebuilding it. This also makes sure
+     * that all the headers get parsed from the tree buffer while rebuilding.
+     */
+    swicc_disk_hdrtbl_empty(tree);
+    swicc_disk_hdrtbl_st *const hdrtbl = &tree->hdrtbl;
+    uint32_t folder_count_max = HDRTBL_COUNT_START;
+    hdrtbl->folder = malloc(folder_count_max * sizeof(*hdrtbl->folder));
+    if (hdrtbl->folder == NULL)
     {
-        swicc_disk_lutsid_empty(tree);
         return SWICC_RET_ERROR;
     }
 
     swicc_fs_file_st file_root;
     swicc_ret_et ret = swicc_disk_tree_file_root(tree, &file_root);
-    if (ret != SWICC_RET_SUCCESS)
+    if (ret == SWICC_RET_SUCCESS)
     {
-        swicc_disk_lutsid_empty(tree);
-        return ret;
+        ret = swicc_disk_file_foreach(tree, &file_root, hdrtbl_rebuild_cb,
+                                      &folder_count_max, true);
+    }
+    if (ret == SWICC_RET_SUCCESS)
+    {
+        /**
+         * Can't overflow since the folder count max times the slot ratio was
+         * checked to fit in a uint32.
+         */
+        uint32_t slot_count = HDRTBL_COUNT_START * HDRTBL_SLOT_RATIO;
+        while (slot_count < hdrtbl->folder_count * HDRTBL_SLOT_RATIO)
+        {
+            /* Must stay a power of 2. */
+            slot_count *= 2U;
+        }
+        hdrtbl->slot = calloc(slot_count, sizeof(*hdrtbl->slot));
+        if (hdrtbl->slot == NULL)
+        {
+            ret = SWICC_RET_ERROR;
+        }
+        else
+        {
+            hdrtbl->slot_count = slot_count;
+            for (uint32_t folder_idx = 0U; folder_idx < hdrtbl->folder_count;
+                 ++folder_idx)
+            {
+                uint32_t slot_idx = hdrtbl_slot(
+                    hdrtbl, hdrtbl->folder[folder_idx].hdr_item.offset_trel);
+                while (hdrtbl->slot[slot_idx] != 0U)
+                {
+                    slot_idx = (slot_idx + 1U) & (slot_count - 1U);
+                }
+                hdrtbl->slot[slot_idx] = folder_idx + 1U;
+            }
+        }
     }
-    ret = swicc_disk_file_foreach(tree, &file_root, lutsid_rebuild_cb, NULL,
-                                  true);
     if (ret != SWICC_RET_SUCCESS)
     {
-        swicc_disk_lutsid_empty(tree);
-        return ret;
+        swicc_disk_hdrtbl_empty(tree);
     }
     return ret;
 }
 
+swicc_ret_et swicc_disk_hdrtbl_lookup(swicc_disk_tree_st const *const tree,
+                                      uint32_t const offset_trel,
+                                      swicc_fs_file_st const **const file)
+{
+    if (tree == NULL || file == NULL)
+    {
+        return SWICC_RET_PARAM_BAD;
+    }
+
+    swicc_disk_hdrtbl_st const *const hdrtbl = &tree->hdrtbl;
+    if (hdrtbl->slot == NULL)
+    {
+        return SWICC_RET_ERROR;
+    }
+
+    /* There is always an empty slot so the search always ends. */
+    uint32_t slot_idx = hdrtbl_slot(hdrtbl, offset_trel);
+    while (hdrtbl->slot[slot_idx] != 0U)
+    {
+        swicc_fs_file_st const *const folder =
+            &hdrtbl->folder[hdrtbl->slot[slot_idx] - 1U];
+        if (folder->hdr_item.offset_trel == offset_trel)
+        {
+            *file = folder;
+            return SWICC_RET_SUCCESS;
+        }
+        slot_idx = (slot_idx + 1U) & (hdrtbl->slot_count - 1U);
+    }
+    return SWICC_RET_FS_NOT_FOUND;
+}
+
 swicc_ret_et swicc_disk_lutsid_lookup(swicc_disk_tree_st const *const tree,
                                       swicc_fs_sid_kt const sid,
                                       swicc_fs_file_st *const file)
@@ -697,19 +2228,12 @@ swicc_ret_et swicc_disk_lutsid_lookup(swicc_disk_tree_st const *const tree,
     }
 
     /* Find the file by SID. */
-    uint32_t entry_idx = 0U;
-    while (entry_idx < lutsid->count)
-    {
-        if (memcmp(&lutsid->buf1[lutsid->size_item1 * entry_idx], &sid,
-                   lutsid->size_item1) == 0)
-        {
-            break;
-        }
-        entry_idx += 1U;
-    }
-    if (entry_idx >= lutsid->count)
+    uint32_t entry_idx;
+    swicc_ret_et const ret_lookup =
+        lut_lookup(lutsid, (uint8_t const *)&sid, &entry_idx);
+    if (ret_lookup != SWICC_RET_SUCCESS)
     {
-        return SWICC_RET_FS_NOT_FOUND;
+        return ret_lookup;
     }
 
     uint32_t const offset =
@@ -726,47 +2250,70 @@ swicc_ret_et swicc_disk_lutsid_lookup(swicc_disk_tree_st const *const tree,
     return SWICC_RET_SUCCESS;
 }
 
-swicc_ret_et swicc_disk_lutid_lookup(swicc_disk_st const *const disk,
-                                     swicc_disk_tree_st **const tree,
-                                     swicc_fs_id_kt const id,
-                                     swicc_fs_file_st *const file)
+swicc_ret_et swicc_disk_lutchild_lookup(swicc_disk_tree_st const *const tree,
+                                        swicc_fs_file_st const *const folder,
+                                        swicc_fs_id_kt const id,
+                                        swicc_fs_file_st *const file)
 {
-    if (disk == NULL || tree == NULL || file == NULL)
+    if (tree == NULL || folder == NULL || file == NULL)
     {
         return SWICC_RET_PARAM_BAD;
     }
 
-    swicc_disk_lut_st const *const lutid = &disk->lutid;
-
-    /* Make sure the ID LUT is as expected. */
-    if (lutid->buf1 == NULL || lutid->size_item1 != sizeof(swicc_fs_id_kt) ||
-        lutid->size_item2 != sizeof(uint32_t) + sizeof(uint8_t))
+    swicc_disk_lut_st const *const lutchild = &tree->lutchild;
+    /* Make sure the child LUT is as expected. */
+    if (lutchild->buf1 == NULL ||
+        lutchild->size_item1 != LUTCHILD_SIZE_ITEM1 ||
+        lutchild->size_item2 != sizeof(uint32_t))
     {
         return SWICC_RET_ERROR;
     }
 
-    /* Find the file by ID. */
-    uint32_t entry_idx = 0U;
-    /* ID's are stored in big-endian inside the LUT. */
-    swicc_fs_id_kt const id_be = htobe16(id);
-    while (entry_idx < lutid->count)
+    uint8_t entry_item1[LUTCHILD_SIZE_ITEM1];
+    lutchild_item1(folder->hdr_item.offset_trel, id, entry_item1);
+    uint32_t entry_idx;
+    swicc_ret_et const ret_lookup =
+        lut_lookup(lutchild, entry_item1, &entry_idx);
+    if (ret_lookup != SWICC_RET_SUCCESS)
     {
-        if (memcmp(&lutid->buf1[lutid->size_item1 * entry_idx], &id_be,
-                   lutid->size_item1) == 0)
-        {
-            break;
-        }
-        entry_idx += 1U;
+        return ret_lookup;
     }
-    if (entry_idx >= lutid->count)
+
+    uint32_t offset;
+    memcpy(&offset, &lutchild->buf2[lutchild->size_item2 * entry_idx],
+           sizeof(offset));
+    /* Offset too large. */
+    if (offset >= tree->len)
     {
-        return SWICC_RET_FS_NOT_FOUND;
+        return SWICC_RET_ERROR;
+    }
+    if (swicc_fs_file_prs(tree, offset, file) != SWICC_RET_SUCCESS)
+    {
+        return SWICC_RET_ERROR;
     }
+    return SWICC_RET_SUCCESS;
+}
 
-    uint32_t const offset =
-        *(uint32_t *)&lutid->buf2[(lutid->size_item2 * entry_idx) + 0U];
+/**
+ * @brief Get the file an entry of a disk-wide LUT (ID or name) refers to.
+ * @param disk
+ * @param lut Its item 2 must be an offset followed by a tree index.
+ * @param entry_idx
+ * @param tree Gets a pointer to the tree in which the file is located.
+ * @param file Gets the file header.
+ * @return Return code.
+ */
+static swicc_ret_et disk_lut_entry_file(swicc_disk_st const *const disk,
+                                        swicc_disk_lut_st const *const lut,
+                                        uint32_t const entry_idx,
+                                        swicc_disk_tree_st **const tree,
+                                        swicc_fs_file_st *const file)
+{
+    uint32_t offset;
+    memcpy(&offset, &lut->buf2[(lut->size_item2 * entry_idx) + 0U],
+           sizeof(offset));
     uint8_t const tree_idx =
-        lutid->buf2[(lutid->size_item2 * entry_idx) + sizeof(uint32_t)];
+        lut->buf2[(lut->size_item2 * entry_idx) + sizeof(uint32_t)];
 
     /* Find the tree in which the file resides. */
     swicc_disk_tree_iter_st tree_iter;
@@ -790,16 +2337,191 @@ swicc_ret_et swicc_disk_lutid_lookup(swicc_disk_st const *const disk,
     return SWICC_RET_SUCCESS;
 }
 
-swicc_ret_et swicc_disk_file_rcrd(swicc_disk_tree_st const *const tree,
-                                  swicc_fs_file_st const *const file,
-                                  swicc_fs_rcrd_idx_kt const idx,
-                                  uint8_t **const buf, uint8_t *const len)
+swicc_ret_et swicc_disk_lutid_lookup(swicc_disk_st const *const disk,
+                                     swicc_disk_tree_st **const tree,
+                                     swicc_fs_id_kt const id,
+                                     swicc_fs_file_st *const file)
 {
-    if (tree == NULL || file == NULL || buf == NULL || len == NULL)
+    if (disk == NULL || tree == NULL || file == NULL)
+    {
+        return SWICC_RET_PARAM_BAD;
+    }
+
+    swicc_disk_lut_st const *const lutid = &disk->lutid;
+
+    /* Make sure the ID LUT is as expected. */
+    if (lutid->buf1 == NULL || lutid->size_item1 != sizeof(swicc_fs_id_kt) ||
+        lutid->size_item2 != sizeof(uint32_t) + sizeof(uint8_t))
+    {
+        return SWICC_RET_ERROR;
+    }
+
+    /* Find the file by ID. */
+    uint32_t entry_idx;
+    /* ID's are stored in big-endian inside the LUT. */
+    swicc_fs_id_kt const id_be = htobe16(id);
+    swicc_ret_et const ret_lookup =
+        lut_lookup(lutid, (uint8_t const *)&id_be, &entry_idx);
+    if (ret_lookup != SWICC_RET_SUCCESS)
+    {
+        return ret_lookup;
+    }
+
+    return disk_lut_entry_file(disk, lutid, entry_idx, tree, file);
+}
+
+swicc_ret_et swicc_disk_lutname_lookup(swicc_disk_st const *const disk,
+                                       swicc_disk_tree_st **const tree,
+                                       uint8_t const *const name,
+                                       uint32_t const name_len,
+                                       swicc_fs_file_st *const file)
+{
+    if (disk == NULL || tree == NULL || name == NULL || file == NULL ||
+        name_len > SWICC_FS_NAME_LEN)
+    {
+        return SWICC_RET_PARAM_BAD;
+    }
+
+    swicc_disk_lut_st const *const lutname = &disk->lutname;
+
+    /* Make sure the name LUT is as expected. */
+    if (lutname->buf1 == NULL || lutname->size_item1 != SWICC_FS_NAME_LEN ||
+        lutname->size_item2 != sizeof(uint32_t) + sizeof(uint8_t))
+    {
+        return SWICC_RET_ERROR;
+    }
+
+    /**
+     * A partial name padded with zeros is not greater than any name which
+     * starts with it so its lower bound is the first name that matches.
+     */
+    uint8_t name_min[SWICC_FS_NAME_LEN] = {0U};
+    memcpy(name_min, name, name_len);
+    uint32_t const entry_idx = lut_lower_bound(lutname, name_min);
+    if (entry_idx >= lutname->count ||
+        memcmp(&lutname->buf1[lutname->size_item1 * entry_idx], name,
+               name_len) != 0)
+    {
+        return SWICC_RET_FS_NOT_FOUND;
+    }
+    return disk_lut_entry_file(disk, lutname, entry_idx, tree, file);
+}
+
+
+swicc_ret_et swicc_disk_lutaid_lookup(swicc_disk_st const *const disk,
+                                      uint8_t const *const aid,
+                                      uint32_t const aid_len,
+                                      swicc_fs_occ_et const occ,
+                                      swicc_disk_tree_st const *const tree_cur,
+                                      swicc_disk_tree_st **const tree,
+                                      swicc_fs_file_st *const file)
+{
+    if (disk == NULL || aid == NULL || tree == NULL || file == NULL ||
+        aid_len < SWICC_FS_ADF_AID_RID_LEN || aid_len > SWICC_FS_ADF_AID_LEN)
+    {
+        return SWICC_RET_PARAM_BAD;
+    }
+
+    swicc_disk_lut_st const *const lutaid = &disk->lutaid;
+
+    /* Make sure the AID LUT is as expected. */
+    if (lutaid->buf1 == NULL || lutaid->size_item1 != SWICC_FS_ADF_AID_LEN ||
+        lutaid->size_item2 != sizeof(swicc_disk_tree_st *))
+    {
+        return SWICC_RET_ERROR;
+    }
+
+    /**
+     * A right-truncated AID padded with zeros is not greater than any AID
+     * which starts with it so its lower bound is the first AID that matches.
+     * All other matching AIDs come right after it.
+     */
+    uint8_t aid_min[SWICC_FS_ADF_AID_LEN] = {0U};
+    memcpy(aid_min, aid, aid_len);
+    uint32_t const entry_idx_first = lut_lower_bound(lutaid, aid_min);
+    uint32_t entry_idx_end = entry_idx_first;
+    uint32_t entry_idx_cur = 0U;
+    bool cur_found = false;
+    while (entry_idx_end < lutaid->count &&
+           memcmp(&lutaid->buf1[lutaid->size_item1 * entry_idx_end], aid,
+                  aid_len) == 0)
+    {
+        swicc_disk_tree_st const *tree_entry;
+        memcpy(&tree_entry, &lutaid->buf2[lutaid->size_item2 * entry_idx_end],
+               sizeof(tree_entry));
+        if (tree_cur != NULL && tree_entry == tree_cur)
+        {
+            entry_idx_cur = entry_idx_end;
+            cur_found = true;
+        }
+        entry_idx_end += 1U;
+    }
+    if (entry_idx_end == entry_idx_first)
+    {
+        return SWICC_RET_FS_NOT_FOUND;
+    }
+
+    uint32_t entry_idx;
+    switch (occ)
     {
+    case SWICC_FS_OCC_FIRST:
+        entry_idx = entry_idx_first;
+        break;
+    case SWICC_FS_OCC_LAST:
+        entry_idx = entry_idx_end - 1U;
+        break;
+    case SWICC_FS_OCC_NEXT:
+        if (!cur_found)
+        {
+            entry_idx = entry_idx_first;
+        }
+        else if (entry_idx_cur + 1U < entry_idx_end)
+        {
+            entry_idx = entry_idx_cur + 1U;
+        }
+        else
+        {
+            return SWICC_RET_FS_NOT_FOUND;
+        }
+        break;
+    case SWICC_FS_OCC_PREV:
+        if (!cur_found)
+        {
+            entry_idx = entry_idx_end - 1U;
+        }
+        else if (entry_idx_cur > entry_idx_first)
+        {
+            entry_idx = entry_idx_cur - 1U;
+        }
+        else
+        {
+            return SWICC_RET_FS_NOT_FOUND;
+        }
+        break;
+    default:
         return SWICC_RET_PARAM_BAD;
     }
 
+    memcpy(tree, &lutaid->buf2[lutaid->size_item2 * entry_idx], sizeof(*tree));
+    return swicc_disk_tree_file_root(*tree, file);
+}
+
+/**
+ * @brief Find where a record is located inside a tree.
+ * @param tree The tree which contains the file.
+ * @param file The file which must contain the record.
+ * @param idx Index of the record.
+ * @param offset_trel Where the tree-relative offset of the record will be
+ * written.
+ * @param len Where the length of the record will be written.
+ * @return Return code.
+ */
+static swicc_ret_et file_rcrd_locate(swicc_disk_tree_st const *const tree,
+                                     swicc_fs_file_st const *const file,
+                                     swicc_fs_rcrd_idx_kt const idx,
+                                     uint32_t *const offset_trel,
+                                     uint8_t *const len)
+{
     /* Only linear-fixed or cyclic files have records. */
     if (file->hdr_item.type == SWICC_FS_ITEM_TYPE_FILE_EF_LINEARFIXED ||
         file->hdr_item.type == SWICC_FS_ITEM_TYPE_FILE_EF_CYCLIC)
@@ -827,7 +2549,8 @@ swicc_ret_et swicc_disk_file_rcrd(swicc_disk_tree_st const *const tree,
             {
                 return SWICC_RET_ERROR;
             }
-            *buf = &file->data[rcrd_offset];
+            /* Safe cast since the file data is inside the tree buffer. */
+            *offset_trel = (uint32_t)(&file->data[rcrd_offset] - tree->buf);
             *len = rcrd_size;
             return SWICC_RET_SUCCESS;
         }
@@ -835,6 +2558,62 @@ swicc_ret_et swicc_disk_file_rcrd(swicc_disk_tree_st const *const tree,
     return SWICC_RET_ERROR;
 }
 
+swicc_ret_et swicc_disk_file_rcrd(swicc_disk_tree_st const *const tree,
+                                  swicc_fs_file_st const *const file,
+                                  swicc_fs_rcrd_idx_kt const idx,
+                                  uint8_t **const buf, uint8_t *const len)
+{
+    if (tree == NULL || file == NULL || buf == NULL || len == NULL)
+    {
+        return SWICC_RET_PARAM_BAD;
+    }
+
+    uint32_t offset_trel;
+    swicc_ret_et const ret_locate =
+        file_rcrd_locate(tree, file, idx, &offset_trel, len);
+    if (ret_locate != SWICC_RET_SUCCESS)
+    {
+        return ret_locate;
+    }
+    /* Modified records of a shared tree are found in the overlay. */
+    swicc_disk_ovl_item_st const *const item =
+        tree->shared ? ovl_lookup(&tree->ovl, offset_trel, *len) : NULL;
+    *buf = item != NULL ? item->buf : &tree->buf[offset_trel];
+    return SWICC_RET_SUCCESS;
+}
+
+swicc_ret_et swicc_disk_file_rcrd_write(swicc_disk_tree_st *const tree,
+                                        swicc_fs_file_st const *const file,
+                                        swicc_fs_rcrd_idx_kt const idx,
+                                        uint8_t const *const buf,
+                                        uint8_t const len)
+{
+    if (tree == NULL || file == NULL || buf == NULL)
+    {
+        return SWICC_RET_PARAM_BAD;
+    }
+
+    uint32_t offset_trel;
+    uint8_t rcrd_len;
+    swicc_ret_et const ret_locate =
+        file_rcrd_locate(tree, file, idx, &offset_trel, &rcrd_len);
+    if (ret_locate != SWICC_RET_SUCCESS)
+    {
+        return ret_locate;
+    }
+    if (len != rcrd_len)
+    {
+        return SWICC_RET_PARAM_BAD;
+    }
+    /* The buffer of a shared tree must never be modified. */
+    if (tree->shared)
+    {
+        return ovl_write(&tree->ovl, offset_trel, buf, len);
+    }
+    memcpy(&tree->buf[offset_trel], buf, len);
+    return SWICC_RET_SUCCESS;
+}
+
 swicc_ret_et swicc_disk_file_rcrd_cnt(swicc_disk_tree_st const *const tree,
                                       swicc_fs_file_st const *const file,
                                       uint32_t *const rcrd_cnt)
@@ -869,6 +2648,15 @@ swicc_ret_et swicc_disk_tree_file_root(swicc_disk_tree_st const *const tree,
         return SWICC_RET_PARAM_BAD;
     }
 
+    /**
+     * The root is the first file in the header table so it needs no lookup and
+     * it was checked to be an ADF or MF when the header table was built.
+     */
+    if (tree->hdrtbl.slot != NULL)
+    {
+        memcpy(file_root, &tree->hdrtbl.folder[0U], sizeof(*file_root));
+        return SWICC_RET_SUCCESS;
+    }
     if (swicc_fs_file_prs(tree, 0U, file_root) == SWICC_RET_SUCCESS)
     {
         if (file_root->hdr_item.type == SWICC_FS_ITEM_TYPE_FILE_ADF ||
@@ -889,6 +2677,14 @@ swicc_ret_et swicc_disk_tree_file_parent(swicc_disk_tree_st const *const tree,
         file->hdr_item.offset_trel - file->hdr_item.offset_prel;
     if (parent_offset_trel >= 0U && parent_offset_trel <= UINT32_MAX)
     {
+        /* The parent is a folder so it might have been decoded already. */
+        swicc_fs_file_st const *folder;
+        if (swicc_disk_hdrtbl_lookup(tree, (uint32_t)parent_offset_trel,
+                                     &folder) == SWICC_RET_SUCCESS)
+        {
+            memcpy(file_parent, folder, sizeof(*file_parent));
+            return SWICC_RET_SUCCESS;
+        }
         return swicc_fs_file_prs(tree, (uint32_t)parent_offset_trel,
                                  file_parent);
     }
@@ -1,8 +1,11 @@
-#include <cJSON.h>
+#include <fcntl.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <swicc/swicc.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 /**
  * @warning The following 2 arrays (and the count variable) must be kept in sync
@@ -44,11 +47,651 @@ static_assert(
 #define DISK_SIZE_START 4096U
 #define DISK_SIZE_RESIZE 4096U
 
+/**
+ * The disk JSON is never turned into a DOM. The whole text gets validated once
+ * and from then on every JSON value is a view into the text which is walked in
+ * place whenever an item parser asks for an object member or array element.
+ */
+typedef enum jsval_type_e
+{
+    JSVAL_TYPE_INVALID, /* Used for object members that are missing. */
+    JSVAL_TYPE_NULL,
+    JSVAL_TYPE_BOOL,
+    JSVAL_TYPE_NUMBER,
+    JSVAL_TYPE_STRING,
+    JSVAL_TYPE_ARRAY,
+    JSVAL_TYPE_OBJECT,
+} jsval_type_et;
+
+typedef struct jsval_s
+{
+    char const *str; /* First character of the value in the JSON text. */
+    uint32_t len;    /* Length of the value in the JSON text. */
+    jsval_type_et type;
+} jsval_st;
+
+/* Same nesting limit as cJSON uses. */
+#define JSON_NESTING_LIMIT 1000U
+
+/* Longest number (in characters) that gets parsed, same as in cJSON. */
+#define JSON_NUMBER_LEN_MAX 63U
+
+/**
+ * Object keys longer than this (before decoding) can't be any of the keys used
+ * in the disk JSON, even if every character were an escape sequence.
+ */
+#define JSON_KEY_LEN_MAX 64U
+
+/**
+ * @brief Skip whitespace in the JSON text.
+ * @param pos
+ * @param end One past the last character of the text.
+ * @return Position of the first non-whitespace character or end.
+ */
+static char const *json_ws(char const *pos, char const *const end)
+{
+    while (pos < end && (uint8_t)*pos <= ' ')
+    {
+        ++pos;
+    }
+    return pos;
+}
+
+/**
+ * @brief Parse 4 hex digits of a '\u' escape sequence.
+ * @param hex
+ * @param cp Where the code unit will be written.
+ * @return Return code.
+ */
+static swicc_ret_et json_str_dec_u(char const *const hex, uint32_t *const cp)
+{
+    *cp = 0U;
+    for (uint8_t hex_idx = 0U; hex_idx < 4U; ++hex_idx)
+    {
+        char const c = hex[hex_idx];
+        uint32_t nibble;
+        if (c >= '0' && c <= '9')
+        {
+            nibble = (uint32_t)(c - '0');
+        }
+        else if (c >= 'A' && c <= 'F')
+        {
+            nibble = (uint32_t)(0x0A + (c - 'A'));
+        }
+        else if (c >= 'a' && c <= 'f')
+        {
+            nibble = (uint32_t)(0x0A + (c - 'a'));
+        }
+        else
+        {
+            return SWICC_RET_ERROR;
+        }
+        *cp = (*cp << 4U) | nibble;
+    }
+    return SWICC_RET_SUCCESS;
+}
+
+/**
+ * @brief Decode the escape sequences of a JSON string the same way cJSON does.
+ * @param str First character after the opening quote.
+ * @param str_len Length of the string without the quotes.
+ * @param dec Where the decoded string will be written. The decoded string is
+ * never longer than the encoded one. May be NULL to only check that the escape
+ * sequences are valid.
+ * @param dec_len Where the length of the decoded string will be written.
+ * @return Return code.
+ */
+static swicc_ret_et json_str_dec(char const *const str, uint32_t const str_len,
+                                 char *const dec, uint32_t *const dec_len)
+{
+    uint32_t len = 0U;
+    uint32_t str_idx = 0U;
+    while (str_idx < str_len)
+    {
+        if (str[str_idx] != '\\')
+        {
+            if (dec != NULL)
+            {
+                dec[len] = str[str_idx];
+            }
+            ++len;
+            ++str_idx;
+            continue;
+        }
+        if (str_len - str_idx < 2U)
+        {
+            return SWICC_RET_ERROR;
+        }
+
+        char esc;
+        switch (str[str_idx + 1U])
+        {
+        case 'b':
+            esc = '\b';
+            break;
+        case 'f':
+            esc = '\f';
+            break;
+        case 'n':
+            esc = '\n';
+            break;
+        case 'r':
+            esc = '\r';
+            break;
+        case 't':
+            esc = '\t';
+            break;
+        case '"':
+        case '\\':
+        case '/':
+            esc = str[str_idx + 1U];
+            break;
+        case 'u':
+            esc = '\0';
+            break;
+        default:
+            return SWICC_RET_ERROR;
+        }
+        if (str[str_idx + 1U] != 'u')
+        {
+            if (dec != NULL)
+            {
+                dec[len] = esc;
+            }
+            ++len;
+            str_idx += 2U;
+            continue;
+        }
+
+        /* A UTF-16 code unit (or surrogate pair) encoded as UTF-8. */
+        uint32_t cp;
+        if (str_len - str_idx < 6U ||
+            json_str_dec_u(&str[str_idx + 2U], &cp) != SWICC_RET_SUCCESS ||
+            (cp >= 0xDC00U && cp <= 0xDFFFU))
+        {
+            return SWICC_RET_ERROR;
+        }
+        str_idx += 6U;
+        if (cp >= 0xD800U && cp <= 0xDBFFU)
+        {
+            uint32_t cp_low;
+            if (str_len - str_idx < 6U || str[str_idx] != '\\' ||
+                str[str_idx + 1U] != 'u' ||
+                json_str_dec_u(&str[str_idx + 2U], &cp_low) !=
+                    SWICC_RET_SUCCESS ||
+                cp_low < 0xDC00U || cp_low > 0xDFFFU)
+            {
+                return SWICC_RET_ERROR;
+            }
+            str_idx += 6U;
+            cp = 0x10000U + (((cp & 0x3FFU) << 10U) | (cp_low & 0x3FFU));
+        }
+
+        uint8_t utf8[4U];
+        uint8_t utf8_len;
+        /* Safe casts since every byte is masked or shifted to fit. */
+        if (cp < 0x80U)
+        {
+            utf8[0U] = (uint8_t)cp;
+            utf8_len = 1U;
+        }
+        else if (cp < 0x800U)
+        {
+            utf8[0U] = (uint8_t)(0xC0U | (cp >> 6U));
+            utf8[1U] = (uint8_t)(0x80U | (cp & 0x3FU));
+            utf8_len = 2U;
+        }
+        else if (cp < 0x10000U)
+        {
+            utf8[0U] = (uint8_t)(0xE0U | (cp >> 12U));
+            utf8[1U] = (uint8_t)(0x80U | ((cp >> 6U) & 0x3FU));
+            utf8[2U] = (uint8_t)(0x80U | (cp & 0x3FU));
+            utf8_len = 3U;
+        }
+        else
+        {
+            utf8[0U] = (uint8_t)(0xF0U | (cp >> 18U));
+            utf8[1U] = (uint8_t)(0x80U | ((cp >> 12U) & 0x3FU));
+            utf8[2U] = (uint8_t)(0x80U | ((cp >> 6U) & 0x3FU));
+            utf8[3U] = (uint8_t)(0x80U | (cp & 0x3FU));
+            utf8_len = 4U;
+        }
+        if (dec != NULL)
+        {
+            memcpy(&dec[len], utf8, utf8_len);
+        }
+        len += utf8_len;
+    }
+    *dec_len = len;
+    return SWICC_RET_SUCCESS;
+}
+
+/**
+ * @brief Find the end of a JSON string.
+ * @param pos Must point to the opening quote.
+ * @param end One past the last character of the text.
+ * @param check If the escape sequences in the string shall be validated.
+ * @return One past the closing quote, or NULL if the string is not terminated
+ * or contains an invalid escape sequence.
+ */
+static char const *json_str_skip(char const *const pos, char const *const end,
+                                 bool const check)
+{
+    char const *const str = pos + 1U;
+    char const *quote = str;
+    for (;;)
+    {
+        /* Safe cast since the text can't be longer than a uint32. */
+        quote = memchr(quote, '"', (size_t)(end - quote));
+        if (quote == NULL)
+        {
+            return NULL;
+        }
+        /* The quote is escaped if preceded by an odd number of backslashes. */
+        char const *bs = quote;
+        while (bs > str && bs[-1] == '\\')
+        {
+            --bs;
+        }
+        if ((quote - bs) % 2 == 0)
+        {
+            break;
+        }
+        ++quote;
+    }
+
+    /* Safe cast since the string is shorter than the text. */
+    uint32_t const str_len = (uint32_t)(quote - str);
+    uint32_t dec_len;
+    if (check && memchr(str, '\\', str_len) != NULL &&
+        json_str_dec(str, str_len, NULL, &dec_len) != SWICC_RET_SUCCESS)
+    {
+        return NULL;
+    }
+    return quote + 1U;
+}
+
+/**
+ * @brief Parse a JSON number the same way cJSON does.
+ * @param pos First character of the number.
+ * @param end One past the last character of the text.
+ * @param num Where the number will be written.
+ * @return One past the last character of the number or NULL if it's not a
+ * number.
+ */
+static char const *json_num_prs(char const *const pos, char const *const end,
+                                double *const num)
+{
+    char num_str[JSON_NUMBER_LEN_MAX + 1U];
+    uint32_t num_len = 0U;
+    while (num_len < JSON_NUMBER_LEN_MAX && pos + num_len < end &&
+           strchr("0123456789+-eE.", pos[num_len]) != NULL &&
+           pos[num_len] != '\0')
+    {
+        num_str[num_len] = pos[num_len];
+        ++num_len;
+    }
+    num_str[num_len] = '\0';
+
+    char *num_end;
+    *num = strtod(num_str, &num_end);
+    if (num_end == num_str)
+    {
+        return NULL;
+    }
+    return pos + (num_end - num_str);
+}
+
+/**
+ * @brief Validate a JSON value (recursively).
+ * @param pos First character of the value.
+ * @param end One past the last character of the text.
+ * @param depth How deeply the value is nested.
+ * @return One past the last character of the value, or NULL if the value is not
+ * valid JSON.
+ */
+static char const *json_val_check(char const *pos, char const *const end,
+                                  uint32_t const depth)
+{
+    if (pos >= end)
+    {
+        return NULL;
+    }
+
+    static char const *const literal[] = {"null", "true", "false"};
+    switch (*pos)
+    {
+    case '"':
+        return json_str_skip(pos, end, true);
+    case '[':
+    case '{': {
+        if (depth >= JSON_NESTING_LIMIT)
+        {
+            return NULL;
+        }
+        bool const obj = *pos == '{';
+        char const close = obj ? '}' : ']';
+        pos = json_ws(pos + 1U, end);
+        if (pos < end && *pos == close)
+        {
+            return pos + 1U;
+        }
+        for (;;)
+        {
+            if (obj)
+            {
+                if (pos >= end || *pos != '"' ||
+                    (pos = json_str_skip(pos, end, true)) == NULL)
+                {
+                    return NULL;
+                }
+                pos = json_ws(pos, end);
+                if (pos >= end || *pos != ':')
+                {
+                    return NULL;
+                }
+                pos = json_ws(pos + 1U, end);
+            }
+            pos = json_val_check(pos, end, depth + 1U);
+            if (pos == NULL)
+            {
+                return NULL;
+            }
+            pos = json_ws(pos, end);
+            if (pos < end && *pos == ',')
+            {
+                pos = json_ws(pos + 1U, end);
+            }
+            else if (pos < end && *pos == close)
+            {
+                return pos + 1U;
+            }
+            else
+            {
+                return NULL;
+            }
+        }
+    }
+    case 'n':
+    case 't':
+    case 'f':
+        for (uint8_t literal_idx = 0U;
+             literal_idx < sizeof(literal) / sizeof(literal[0U]);
+             ++literal_idx)
+        {
+            size_t const literal_len = strlen(literal[literal_idx]);
+            if ((size_t)(end - pos) >= literal_len &&
+                memcmp(pos, literal[literal_idx], literal_len) == 0)
+            {
+                return pos + literal_len;
+            }
+        }
+        return NULL;
+    default:
+        if (*pos == '-' || (*pos >= '0' && *pos <= '9'))
+        {
+            double num;
+            return json_num_prs(pos, end, &num);
+        }
+        return NULL;
+    }
+}
+
+/**
+ * @brief Find the end of an already validated JSON value.
+ * @param pos First character of the value.
+ * @param end One past the last character of the text.
+ * @return One past the last character of the value.
+ */
+static char const *json_val_skip(char const *pos, char const *const end)
+{
+    if (*pos == '"')
+    {
+        return json_str_skip(pos, end, false);
+    }
+    if (*pos != '{' && *pos != '[')
+    {
+        while (pos < end && (uint8_t)*pos > ' ' && *pos != ',' &&
+               *pos != ']' && *pos != '}')
+        {
+            ++pos;
+        }
+        return pos;
+    }
+
+    uint32_t depth = 0U;
+    while (pos < end)
+    {
+        switch (*pos)
+        {
+        case '"':
+            pos = json_str_skip(pos, end, false);
+            continue;
+        case '{':
+        case '[':
+            ++depth;
+            break;
+        case '}':
+        case ']':
+            if (--depth == 0U)
+            {
+                return pos + 1U;
+            }
+            break;
+        default:
+            break;
+        }
+        ++pos;
+    }
+    return pos;
+}
+
+/**
+ * @brief Create a view of an already validated JSON value.
+ * @param pos First character of the value.
+ * @param end One past the last character of the text.
+ * @param val
+ */
+static void jsval_at(char const *const pos, char const *const end,
+                     jsval_st *const val)
+{
+    val->str = pos;
+    /* Safe cast since the value is shorter than the text. */
+    val->len = (uint32_t)(json_val_skip(pos, end) - pos);
+    switch (*pos)
+    {
+    case '"':
+        val->type = JSVAL_TYPE_STRING;
+        break;
+    case '[':
+        val->type = JSVAL_TYPE_ARRAY;
+        break;
+    case '{':
+        val->type = JSVAL_TYPE_OBJECT;
+        break;
+    case 'n':
+        val->type = JSVAL_TYPE_NULL;
+        break;
+    case 't':
+    case 'f':
+        val->type = JSVAL_TYPE_BOOL;
+        break;
+    default:
+        val->type = JSVAL_TYPE_NUMBER;
+        break;
+    }
+}
+
+/**
+ * @brief Get the contents of a JSON string.
+ * @param val
+ * @param str Where a pointer to the string will be written. The string is not
+ * null-terminated.
+ * @param str_len Where the length of the string will be written.
+ * @param str_dec Where a pointer to the decoded copy of the string will be
+ * written. This must be freed by the caller. When the string contains no escape
+ * sequences this will be NULL and the string will point into the JSON text.
+ * @return Return code.
+ * @note Like with cJSON strings, the string ends at the first null character.
+ */
+static swicc_ret_et jsval_str(jsval_st const *const val, char const **const str,
+                              uint32_t *const str_len, char **const str_dec)
+{
+    if (val->type != JSVAL_TYPE_STRING)
+    {
+        return SWICC_RET_ERROR;
+    }
+    char const *const raw = val->str + 1U;
+    uint32_t const raw_len = val->len - 2U;
+    *str_dec = NULL;
+    if (memchr(raw, '\\', raw_len) == NULL)
+    {
+        *str = raw;
+        *str_len = raw_len;
+        return SWICC_RET_SUCCESS;
+    }
+
+    char *const dec = malloc(raw_len);
+    uint32_t dec_len;
+    if (dec == NULL ||
+        json_str_dec(raw, raw_len, dec, &dec_len) != SWICC_RET_SUCCESS)
+    {
+        if (dec != NULL)
+        {
+            free(dec);
+        }
+        return SWICC_RET_ERROR;
+    }
+    *str_dec = dec;
+    *str = dec;
+    /* Safe cast since the decoded string is not longer than the raw one. */
+    *str_len = (uint32_t)strnlen(dec, dec_len);
+    return SWICC_RET_SUCCESS;
+}
+
+/**
+ * @brief Get the value of a JSON number.
+ * @param val
+ * @return The number, or 0 if the value is not a number.
+ */
+static double jsval_num(jsval_st const *const val)
+{
+    double num = 0;
+    if (val->type != JSVAL_TYPE_NUMBER ||
+        json_num_prs(val->str, val->str + val->len, &num) == NULL)
+    {
+        return 0;
+    }
+    return num;
+}
+
+/**
+ * @brief Get a member of a JSON object. Like in cJSON, if the key appears more
+ * than once, the first member with that key is returned.
+ * @param obj
+ * @param key
+ * @param member Where the member value will be written. If the object has no
+ * such member, this will get the 'invalid' type.
+ * @return true if the object has this member, false otherwise.
+ */
+static bool jsobj_get(jsval_st const *const obj, char const *const key,
+                      jsval_st *const member)
+{
+    member->str = NULL;
+    member->len = 0U;
+    member->type = JSVAL_TYPE_INVALID;
+    if (obj->type != JSVAL_TYPE_OBJECT)
+    {
+        return false;
+    }
+    size_t const key_len = strlen(key);
+    char const *const end = obj->str + obj->len;
+    char const *pos = json_ws(obj->str + 1U, end);
+    while (pos < end && *pos == '"')
+    {
+        char const *const key_end = json_str_skip(pos, end, false);
+        /* Safe cast since the key is shorter than the text. */
+        uint32_t const key_raw_len = (uint32_t)(key_end - pos - 2);
+        bool key_match = false;
+        if (memchr(pos + 1U, '\\', key_raw_len) == NULL)
+        {
+            key_match = key_raw_len == key_len &&
+                        memcmp(pos + 1U, key, key_len) == 0;
+        }
+        else if (key_raw_len <= JSON_KEY_LEN_MAX)
+        {
+            char key_dec[JSON_KEY_LEN_MAX];
+            uint32_t key_dec_len;
+            if (json_str_dec(pos + 1U, key_raw_len, key_dec, &key_dec_len) ==
+                SWICC_RET_SUCCESS)
+            {
+                key_dec_len = (uint32_t)strnlen(key_dec, key_dec_len);
+                key_match = key_dec_len == key_len &&
+                            memcmp(key_dec, key, key_len) == 0;
+            }
+        }
+
+        /* Skip over the colon to the value. */
+        pos = json_ws(json_ws(key_end, end) + 1U, end);
+        jsval_at(pos, end, member);
+        if (key_match)
+        {
+            return true;
+        }
+        pos = json_ws(member->str + member->len, end);
+        if (pos >= end || *pos != ',')
+        {
+            break;
+        }
+        pos = json_ws(pos + 1U, end);
+    }
+    member->str = NULL;
+    member->len = 0U;
+    member->type = JSVAL_TYPE_INVALID;
+    return false;
+}
+
+/**
+ * @brief Get the next element of a JSON array.
+ * @param arr
+ * @param elem Shall contain the previous element, or have a NULL string to get
+ * the first element. The next element will be written here.
+ * @return true if there was a next element, false otherwise.
+ */
+static bool jsarr_next(jsval_st const *const arr, jsval_st *const elem)
+{
+    if (arr->type != JSVAL_TYPE_ARRAY)
+    {
+        return false;
+    }
+    char const *const end = arr->str + arr->len;
+    char const *pos;
+    if (elem->str == NULL)
+    {
+        pos = json_ws(arr->str + 1U, end);
+    }
+    else
+    {
+        pos = json_ws(elem->str + elem->len, end);
+        if (pos >= end || *pos != ',')
+        {
+            return false;
+        }
+        pos = json_ws(pos + 1U, end);
+    }
+    if (pos >= end || *pos == ']')
+    {
+        return false;
+    }
+    jsval_at(pos, end, elem);
+    return true;
+}
+
 /**
  * A function type for item type parsers i.e. parsers that parse a specific type
  * of item (encoded as a JSON object).
  */
-typedef swicc_ret_et jsitem_prs_ft(cJSON const *const item_json,
+typedef swicc_ret_et jsitem_prs_ft(jsval_st const *const item_json,
                                    uint32_t const offset_prel,
                                    uint8_t *const buf, uint32_t *const buf_len);
 /**
@@ -66,7 +709,7 @@ static jsitem_prs_ft *const jsitem_prs[];
  * of the file header.
  * @return Return code.
  */
-static swicc_ret_et jsitem_prs_file_raw(cJSON const *const item_json,
+static swicc_ret_et jsitem_prs_file_raw(jsval_st const *const item_json,
                                         swicc_fs_file_raw_st *const file_raw,
                                         uint32_t const offset_prel)
 {
@@ -80,18 +723,26 @@ static swicc_ret_et jsitem_prs_file_raw(cJSON const *const item_json,
      */
 
     swicc_ret_et ret = SWICC_RET_ERROR;
-    if (cJSON_IsObject(item_json) == true)
+    if (item_json->type == JSVAL_TYPE_OBJECT)
     {
         memset(file_raw, 0U, sizeof(*file_raw));
 
         swicc_ret_et ret_id = SWICC_RET_ERROR;
-        cJSON *const id_obj = cJSON_GetObjectItemCaseSensitive(item_json, "id");
-        if (id_obj != NULL && cJSON_IsString(id_obj) == true)
+        jsval_st id_obj;
+        if (jsobj_get(item_json, "id", &id_obj) &&
+            id_obj.type == JSVAL_TYPE_STRING)
         {
             /* Has ID. */
-            char *const id_str = cJSON_GetStringValue(id_obj);
+            char const *id_str;
+            uint32_t id_str_len;
+            char *id_str_dec;
             swicc_fs_id_kt id;
-            if (id_str != NULL && strlen(id_str) == sizeof(id) * 2U)
+            if (jsval_str(&id_obj, &id_str, &id_str_len, &id_str_dec) !=
+                SWICC_RET_SUCCESS)
+            {
+                fprintf(stderr, "File: Failed to decode the ID string.\n");
+            }
+            else if (id_str_len == sizeof(id) * 2U)
             {
                 uint32_t id_len = sizeof(id);
                 if (swicc_hexstr_bytearr(id_str, sizeof(id) * 2U,
@@ -114,8 +765,12 @@ static swicc_ret_et jsitem_prs_file_raw(cJSON const *const item_json,
             {
                 fprintf(
                     stderr,
-                    "File: ID ('%s') length invalid (got %lu, expected 4).\n",
-                    id_str, strlen(id_str));
+                    "File: ID ('%.*s') length invalid (got %u, expected 4).\n",
+                    id_str_len, id_str, id_str_len);
+            }
+            if (id_str_dec != NULL)
+            {
+                free(id_str_dec);
             }
         }
         else
@@ -126,14 +781,21 @@ static swicc_ret_et jsitem_prs_file_raw(cJSON const *const item_json,
         }
 
         swicc_ret_et ret_sid = SWICC_RET_ERROR;
-        cJSON *const sid_obj =
-            cJSON_GetObjectItemCaseSensitive(item_json, "sid");
-        if (sid_obj != NULL && cJSON_IsString(sid_obj) == true)
+        jsval_st sid_obj;
+        if (jsobj_get(item_json, "sid", &sid_obj) &&
+            sid_obj.type == JSVAL_TYPE_STRING)
         {
             /* Has SID. */
-            char *const sid_str = cJSON_GetStringValue(sid_obj);
+            char const *sid_str;
+            uint32_t sid_str_len;
+            char *sid_str_dec;
             swicc_fs_sid_kt sid;
-            if (sid_str != NULL && strlen(sid_str) == sizeof(sid) * 2U)
+            if (jsval_str(&sid_obj, &sid_str, &sid_str_len, &sid_str_dec) !=
+                SWICC_RET_SUCCESS)
+            {
+                fprintf(stderr, "File: Failed to decode the SID string.\n");
+            }
+            else if (sid_str_len == sizeof(sid) * 2U)
             {
                 uint32_t sid_len = sizeof(sid);
                 if (swicc_hexstr_bytearr(sid_str, sizeof(sid) * 2U,
@@ -156,8 +818,12 @@ static swicc_ret_et jsitem_prs_file_raw(cJSON const *const item_json,
             {
                 fprintf(
                     stderr,
-                    "File: SID ('%s') length invalid (got %lu, expected 2).\n",
-                    sid_str, strlen(sid_str));
+                    "File: SID ('%.*s') length invalid (got %u, expected 2).\n",
+                    sid_str_len, sid_str, sid_str_len);
+            }
+            if (sid_str_dec != NULL)
+            {
+                free(sid_str_dec);
             }
         }
         else
@@ -223,7 +889,7 @@ static swicc_ret_et jsitem_prs_type_str(char const *const type_str,
  * @return Return code.
  */
 static jsitem_prs_ft jsitem_prs_demux;
-static swicc_ret_et jsitem_prs_demux(cJSON const *const item_json,
+static swicc_ret_et jsitem_prs_demux(jsval_st const *const item_json,
                                      uint32_t const offset_prel,
                                      uint8_t *const buf,
                                      uint32_t *const buf_len)
@@ -234,16 +900,27 @@ static swicc_ret_et jsitem_prs_demux(cJSON const *const item_json,
     }
 
     swicc_ret_et ret = SWICC_RET_ERROR;
-    cJSON *const type_obj = cJSON_GetObjectItemCaseSensitive(item_json, "type");
-    if (cJSON_IsObject(item_json) == true && type_obj != NULL &&
-        cJSON_IsString(type_obj) == true)
+    jsval_st type_obj;
+    if (jsobj_get(item_json, "type", &type_obj) &&
+        type_obj.type == JSVAL_TYPE_STRING)
     {
-        char *const type_str = cJSON_GetStringValue(type_obj);
-        if (type_str != NULL)
+        char const *type_str;
+        uint32_t type_str_len;
+        char *type_str_dec;
+        if (jsval_str(&type_obj, &type_str, &type_str_len, &type_str_dec) ==
+            SWICC_RET_SUCCESS)
         {
-            swicc_fs_item_type_et type;
-            ret = jsitem_prs_type_str(type_str, (uint16_t)strlen(type_str),
-                                      &type);
+            swicc_fs_item_type_et type = SWICC_FS_ITEM_TYPE_INVALID;
+            if (type_str_len <= UINT16_MAX)
+            {
+                /* Safe cast due to the check. */
+                ret = jsitem_prs_type_str(type_str, (uint16_t)type_str_len,
+                                          &type);
+            }
+            if (type_str_dec != NULL)
+            {
+                free(type_str_dec);
+            }
             if (ret == SWICC_RET_SUCCESS && type != SWICC_FS_ITEM_TYPE_INVALID)
             {
                 ret = jsitem_prs[type](item_json, offset_prel, buf, buf_len);
@@ -270,12 +947,12 @@ static swicc_ret_et jsitem_prs_demux(cJSON const *const item_json,
  * @note Expects the JSON object to be a folder blindly.
  */
 static jsitem_prs_ft jsitem_prs_file_folder;
-static swicc_ret_et jsitem_prs_file_folder(cJSON const *const item_json,
+static swicc_ret_et jsitem_prs_file_folder(jsval_st const *const item_json,
                                            uint32_t const offset_prel,
                                            uint8_t *const buf,
                                            uint32_t *const buf_len)
 {
-    if (item_json == NULL || cJSON_IsObject(item_json) != true || buf == NULL ||
+    if (item_json == NULL || item_json->type != JSVAL_TYPE_OBJECT || buf == NULL ||
         buf_len == NULL)
     {
         return SWICC_RET_PARAM_BAD;
@@ -286,19 +963,19 @@ static swicc_ret_et jsitem_prs_file_folder(cJSON const *const item_json,
      */
 
     swicc_ret_et ret = SWICC_RET_ERROR;
-    cJSON *const contents_obj =
-        cJSON_GetObjectItemCaseSensitive(item_json, "contents");
-    if (contents_obj != NULL && cJSON_IsNull(contents_obj) == true)
+    jsval_st contents_obj;
+    jsobj_get(item_json, "contents", &contents_obj);
+    if (contents_obj.type == JSVAL_TYPE_NULL)
     {
         *buf_len = 0;
         ret = SWICC_RET_SUCCESS;
     }
-    else if (contents_obj != NULL && cJSON_IsArray(contents_obj) == true)
+    else if (contents_obj.type == JSVAL_TYPE_ARRAY)
     {
-        cJSON *item;
+        jsval_st item = {.str = NULL};
         uint32_t items_len = 0U; /* Parsed length. */
-        swicc_ret_et ret_item;
-        cJSON_ArrayForEach(item, contents_obj)
+        swicc_ret_et ret_item = SWICC_RET_SUCCESS;
+        while (jsarr_next(&contents_obj, &item))
         {
             uint32_t item_size = *buf_len - items_len;
             if (offset_prel + items_len > UINT32_MAX)
@@ -307,7 +984,7 @@ static swicc_ret_et jsitem_prs_file_folder(cJSON const *const item_json,
             }
             /* Safe cast because this is checked to not overflow. */
             ret_item =
-                jsitem_prs_demux(item, (uint32_t)(offset_prel + items_len),
+                jsitem_prs_demux(&item, (uint32_t)(offset_prel + items_len),
                                  &buf[items_len], &item_size);
             if (ret_item != SWICC_RET_SUCCESS)
             {
@@ -355,12 +1032,12 @@ static swicc_ret_et jsitem_prs_file_folder(cJSON const *const item_json,
  * @return Return code.
  */
 static jsitem_prs_ft jsitem_prs_file_mf;
-static swicc_ret_et jsitem_prs_file_mf(cJSON const *const item_json,
+static swicc_ret_et jsitem_prs_file_mf(jsval_st const *const item_json,
                                        uint32_t const offset_prel,
                                        uint8_t *const buf,
                                        uint32_t *const buf_len)
 {
-    if (item_json == NULL || cJSON_IsObject(item_json) != true || buf == NULL ||
+    if (item_json == NULL || item_json->type != JSVAL_TYPE_OBJECT || buf == NULL ||
         buf_len == NULL)
     {
         return SWICC_RET_PARAM_BAD;
@@ -388,12 +1065,12 @@ static swicc_ret_et jsitem_prs_file_mf(cJSON const *const item_json,
  * @return Return code.
  */
 static jsitem_prs_ft jsitem_prs_file_adf;
-static swicc_ret_et jsitem_prs_file_adf(cJSON const *const item_json,
+static swicc_ret_et jsitem_prs_file_adf(jsval_st const *const item_json,
                                         uint32_t const offset_prel,
                                         uint8_t *const buf,
                                         uint32_t *const buf_len)
 {
-    if (item_json == NULL || cJSON_IsObject(item_json) != true || buf == NULL ||
+    if (item_json == NULL || item_json->type != JSVAL_TYPE_OBJECT || buf == NULL ||
         buf_len == NULL)
     {
         return SWICC_RET_PARAM_BAD;
@@ -407,8 +1084,9 @@ static swicc_ret_et jsitem_prs_file_adf(cJSON const *const item_json,
     uint32_t const hdr_size =
         swicc_fs_item_hdr_raw_size[SWICC_FS_ITEM_TYPE_FILE_ADF];
 
-    cJSON *const aid_obj = cJSON_GetObjectItemCaseSensitive(item_json, "name");
-    if (aid_obj != NULL && cJSON_IsObject(aid_obj) == true)
+    jsval_st aid_obj;
+    if (jsobj_get(item_json, "name", &aid_obj) &&
+        aid_obj.type == JSVAL_TYPE_OBJECT)
     {
         if (*buf_len < hdr_size)
         {
@@ -420,7 +1098,7 @@ static swicc_ret_et jsitem_prs_file_adf(cJSON const *const item_json,
             memset(&adf_hdr_raw->aid, 0U, sizeof(adf_hdr_raw->aid));
 
             uint32_t aid_len = sizeof(adf_hdr_raw->aid);
-            ret = jsitem_prs_demux(aid_obj, 0U /* Not used. */,
+            ret = jsitem_prs_demux(&aid_obj, 0U /* Not used. */,
                                    (uint8_t *)&adf_hdr_raw->aid, &aid_len);
             if (ret == SWICC_RET_SUCCESS)
             {
@@ -486,12 +1164,12 @@ static swicc_ret_et jsitem_prs_file_adf(cJSON const *const item_json,
  * @return Return code.
  */
 static jsitem_prs_ft jsitem_prs_file_df;
-static swicc_ret_et jsitem_prs_file_df(cJSON const *const item_json,
+static swicc_ret_et jsitem_prs_file_df(jsval_st const *const item_json,
                                        uint32_t const offset_prel,
                                        uint8_t *const buf,
                                        uint32_t *const buf_len)
 {
-    if (item_json == NULL || cJSON_IsObject(item_json) != true || buf == NULL ||
+    if (item_json == NULL || item_json->type != JSVAL_TYPE_OBJECT || buf == NULL ||
         buf_len == NULL)
     {
         return SWICC_RET_PARAM_BAD;
@@ -504,8 +1182,9 @@ static swicc_ret_et jsitem_prs_file_df(cJSON const *const item_json,
     uint32_t const hdr_size =
         swicc_fs_item_hdr_raw_size[SWICC_FS_ITEM_TYPE_FILE_DF];
 
-    cJSON *const name_obj = cJSON_GetObjectItemCaseSensitive(item_json, "name");
-    if (name_obj != NULL && cJSON_IsObject(name_obj) == true)
+    jsval_st name_obj;
+    if (jsobj_get(item_json, "name", &name_obj) &&
+        name_obj.type == JSVAL_TYPE_OBJECT)
     {
         /* Check that DF headers will fit inside the buffer. */
         if (*buf_len >= hdr_size)
@@ -514,7 +1193,7 @@ static swicc_ret_et jsitem_prs_file_df(cJSON const *const item_json,
             memset(&df_hdr_raw->name, 0U, sizeof(df_hdr_raw->name));
 
             uint32_t name_len = sizeof(df_hdr_raw->name);
-            ret = jsitem_prs_demux(name_obj, 0U /* Not used. */,
+            ret = jsitem_prs_demux(&name_obj, 0U /* Not used. */,
                                    df_hdr_raw->name, &name_len);
             if (ret == SWICC_RET_SUCCESS)
             {
@@ -567,12 +1246,12 @@ static swicc_ret_et jsitem_prs_file_df(cJSON const *const item_json,
  * @return Return code.
  */
 static jsitem_prs_ft jsitem_prs_file_ef_transparent;
-static swicc_ret_et jsitem_prs_file_ef_transparent(cJSON const *const item_json,
+static swicc_ret_et jsitem_prs_file_ef_transparent(jsval_st const *const item_json,
                                                    uint32_t const offset_prel,
                                                    uint8_t *const buf,
                                                    uint32_t *const buf_len)
 {
-    if (item_json == NULL || cJSON_IsObject(item_json) != true || buf == NULL ||
+    if (item_json == NULL || item_json->type != JSVAL_TYPE_OBJECT || buf == NULL ||
         buf_len == NULL)
     {
         return SWICC_RET_PARAM_BAD;
@@ -594,9 +1273,9 @@ static swicc_ret_et jsitem_prs_file_ef_transparent(cJSON const *const item_json,
             /* Safe cast due to check of buffer length to header size. */
             uint32_t contents_len = (uint32_t)(*buf_len - hdr_len);
             swicc_ret_et ret_data = SWICC_RET_ERROR;
-            cJSON *const contents_obj =
-                cJSON_GetObjectItemCaseSensitive(item_json, "contents");
-            if (contents_obj != NULL && cJSON_IsObject(contents_obj) == true)
+            jsval_st contents_obj;
+            jsobj_get(item_json, "contents", &contents_obj);
+            if (contents_obj.type == JSVAL_TYPE_OBJECT)
             {
                 /**
                  * In theory, this call to demux allows the contents of a
@@ -604,10 +1283,10 @@ static swicc_ret_et jsitem_prs_file_ef_transparent(cJSON const *const item_json,
                  * will become a byte array and will be interpreted as one
                  * by the FS anyways.
                  */
-                ret_data = jsitem_prs_demux(contents_obj, hdr_len,
+                ret_data = jsitem_prs_demux(&contents_obj, hdr_len,
                                             &buf[hdr_len], &contents_len);
             }
-            else if (contents_obj != NULL && cJSON_IsNull(contents_obj) == true)
+            else if (contents_obj.type == JSVAL_TYPE_NULL)
             {
                 contents_len = 0U;
                 ret_data = SWICC_RET_SUCCESS;
@@ -649,12 +1328,12 @@ static swicc_ret_et jsitem_prs_file_ef_transparent(cJSON const *const item_json,
  * @return Return code.
  */
 static jsitem_prs_ft jsitem_prs_file_ef_linearfixed;
-static swicc_ret_et jsitem_prs_file_ef_linearfixed(cJSON const *const item_json,
+static swicc_ret_et jsitem_prs_file_ef_linearfixed(jsval_st const *const item_json,
                                                    uint32_t const offset_prel,
                                                    uint8_t *const buf,
                                                    uint32_t *const buf_len)
 {
-    if (item_json == NULL || cJSON_IsObject(item_json) != true || buf == NULL ||
+    if (item_json == NULL || item_json->type != JSVAL_TYPE_OBJECT || buf == NULL ||
         buf_len == NULL)
     {
         return SWICC_RET_PARAM_BAD;
@@ -671,36 +1350,36 @@ static swicc_ret_et jsitem_prs_file_ef_linearfixed(cJSON const *const item_json,
         ret = jsitem_prs_file_raw(item_json, file_raw, offset_prel);
         if (ret == SWICC_RET_SUCCESS)
         {
-            cJSON *const rcrd_size_obj =
-                cJSON_GetObjectItemCaseSensitive(item_json, "rcrd_size");
-            if (rcrd_size_obj != NULL && cJSON_IsNumber(rcrd_size_obj) == true)
+            jsval_st rcrd_size_obj;
+            if (jsobj_get(item_json, "rcrd_size", &rcrd_size_obj) &&
+                rcrd_size_obj.type == JSVAL_TYPE_NUMBER)
             {
                 /**
                  * Forcing this cast because the number in the JSON should
                  * have been a natural number.
                  */
                 size_t const rcrd_size__unlimited =
-                    (size_t)cJSON_GetNumberValue(rcrd_size_obj);
+                    (size_t)jsval_num(&rcrd_size_obj);
                 if (rcrd_size__unlimited <= UINT8_MAX)
                 {
                     uint8_t const rcrd_size = (uint8_t)rcrd_size__unlimited;
                     ef_hdr_raw->rcrd_size = rcrd_size;
 
-                    cJSON *const contents_arr =
-                        cJSON_GetObjectItemCaseSensitive(item_json, "contents");
+                    jsval_st contents_arr;
+                    jsobj_get(item_json, "contents", &contents_arr);
                     swicc_ret_et ret_item = SWICC_RET_ERROR;
                     uint32_t contents_len = 0U; /* Parsed length. */
-                    if (contents_arr != NULL &&
-                        cJSON_IsNull(contents_arr) == true)
+                    if (contents_arr.type == JSVAL_TYPE_NULL)
                     {
                         contents_len = 0U;
                         ret_item = SWICC_RET_SUCCESS;
                     }
-                    else if (contents_arr != NULL &&
-                             cJSON_IsArray(contents_arr) == true)
+                    else if (contents_arr.type == JSVAL_TYPE_ARRAY)
                     {
-                        cJSON *item = NULL;
-                        cJSON_ArrayForEach(item, contents_arr)
+                        jsval_st item = {.str = NULL};
+                        /* Stays successful if the contents array is empty. */
+                        ret_item = SWICC_RET_SUCCESS;
+                        while (jsarr_next(&contents_arr, &item))
                         {
                             /* Make sure another record can fit. */
                             if (hdr_len + contents_len + ef_hdr_raw->rcrd_size >
@@ -719,7 +1398,7 @@ static swicc_ret_et jsitem_prs_file_ef_linearfixed(cJSON const *const item_json,
                             memset(&buf[hdr_len + contents_len], 0xFF,
                                    ef_hdr_raw->rcrd_size);
                             ret_item = jsitem_prs_demux(
-                                item, hdr_len + contents_len,
+                                &item, hdr_len + contents_len,
                                 &buf[hdr_len + contents_len], &item_size);
                             if (ret_item != SWICC_RET_SUCCESS ||
                                 item_size > ef_hdr_raw->rcrd_size)
@@ -731,12 +1410,6 @@ static swicc_ret_et jsitem_prs_file_ef_linearfixed(cJSON const *const item_json,
                             /* Every item must have the same length. */
                             contents_len += ef_hdr_raw->rcrd_size;
                         }
-                        /* This would mean the contents array is empty. */
-                        if (item == NULL)
-                        {
-                            ret_item = SWICC_RET_SUCCESS;
-                        }
-
                         /**
                          * Enusre the buffer is not overflown with the parsed
                          * items.
@@ -804,12 +1477,12 @@ static swicc_ret_et jsitem_prs_file_ef_linearfixed(cJSON const *const item_json,
  * @return Return code.
  */
 static jsitem_prs_ft jsitem_prs_file_ef_cyclic;
-static swicc_ret_et jsitem_prs_file_ef_cyclic(cJSON const *const item_json,
+static swicc_ret_et jsitem_prs_file_ef_cyclic(jsval_st const *const item_json,
                                               uint32_t const offset_prel,
                                               uint8_t *const buf,
                                               uint32_t *const buf_len)
 {
-    if (item_json == NULL || cJSON_IsObject(item_json) != true || buf == NULL ||
+    if (item_json == NULL || item_json->type != JSVAL_TYPE_OBJECT || buf == NULL ||
         buf_len == NULL)
     {
         return SWICC_RET_PARAM_BAD;
@@ -834,32 +1507,31 @@ static swicc_ret_et jsitem_prs_file_ef_cyclic(cJSON const *const item_json,
  * @param enc
  * @return Return code.
  */
-static swicc_ret_et prs_bertlv(cJSON const *const bertlv_json,
+static swicc_ret_et prs_bertlv(jsval_st const *const bertlv_json,
                                swicc_dato_bertlv_enc_st *const enc)
 {
-    if (bertlv_json != NULL && cJSON_IsObject(bertlv_json) == true)
-    {
-        cJSON *const tag_obj =
-            cJSON_GetObjectItemCaseSensitive(bertlv_json, "tag");
-        cJSON *const val_obj =
-            cJSON_GetObjectItemCaseSensitive(bertlv_json, "val");
-        if (tag_obj != NULL && cJSON_IsObject(tag_obj) && val_obj != NULL &&
-            (cJSON_IsString(val_obj) == true || cJSON_IsNull(val_obj) == true ||
-             cJSON_IsArray(val_obj) == true))
+    if (bertlv_json != NULL && bertlv_json->type == JSVAL_TYPE_OBJECT)
+    {
+        jsval_st tag_obj;
+        jsval_st val_obj;
+        jsobj_get(bertlv_json, "tag", &tag_obj);
+        jsobj_get(bertlv_json, "val", &val_obj);
+        if (tag_obj.type == JSVAL_TYPE_OBJECT &&
+            (val_obj.type == JSVAL_TYPE_STRING ||
+             val_obj.type == JSVAL_TYPE_NULL ||
+             val_obj.type == JSVAL_TYPE_ARRAY))
         {
-            cJSON *const tag_class_obj =
-                cJSON_GetObjectItemCaseSensitive(tag_obj, "class");
-            cJSON *const tag_number_obj =
-                cJSON_GetObjectItemCaseSensitive(tag_obj, "number");
-            if (tag_class_obj != NULL &&
-                cJSON_IsNumber(tag_class_obj) == true &&
-                tag_number_obj != NULL &&
-                cJSON_IsNumber(tag_number_obj) == true)
+            jsval_st tag_class_obj;
+            jsval_st tag_number_obj;
+            jsobj_get(&tag_obj, "class", &tag_class_obj);
+            jsobj_get(&tag_obj, "number", &tag_number_obj);
+            if (tag_class_obj.type == JSVAL_TYPE_NUMBER &&
+                tag_number_obj.type == JSVAL_TYPE_NUMBER)
             {
-                bool const dato_constr = cJSON_IsArray(val_obj) == true;
+                bool const dato_constr = val_obj.type == JSVAL_TYPE_ARRAY;
 
                 /* Make sure the class number is in a valid range. */
-                double const cla_raw = cJSON_GetNumberValue(tag_class_obj);
+                double const cla_raw = jsval_num(&tag_class_obj);
                 if (cla_raw > UINT32_MAX || cla_raw < 0)
                 {
                     fprintf(
@@ -891,7 +1563,7 @@ static swicc_ret_et prs_bertlv(cJSON const *const bertlv_json,
                 }
                 swicc_dato_bertlv_tag_st const tag = {
                     .cla = cla,
-                    .num = (uint32_t)cJSON_GetNumberValue(tag_number_obj),
+                    .num = (uint32_t)jsval_num(&tag_number_obj),
                     .pc = dato_constr,
                 };
                 if (dato_constr)
@@ -906,30 +1578,45 @@ static swicc_ret_et prs_bertlv(cJSON const *const bertlv_json,
                         SWICC_RET_SUCCESS)
                     {
                         swicc_ret_et ret_env = SWICC_RET_ERROR;
-                        int32_t const val_obj_cnt = cJSON_GetArraySize(val_obj);
-                        if (val_obj_cnt < 0)
+                        /**
+                         * The array can only be walked forwards so collect the
+                         * nested DOs first.
+                         */
+                        uint32_t val_obj_cnt = 0U;
+                        jsval_st val_obj_nstd = {.str = NULL};
+                        while (jsarr_next(&val_obj, &val_obj_nstd))
+                        {
+                            ++val_obj_cnt;
+                        }
+                        jsval_st *const val_obj_arr =
+                            malloc(sizeof(*val_obj_arr) * val_obj_cnt);
+                        if (val_obj_cnt > 0U && val_obj_arr == NULL)
                         {
-                            /* Length of the value should never be negative. */
                             return SWICC_RET_ERROR;
                         }
+                        val_obj_nstd.str = NULL;
+                        for (uint32_t val_obj_idx = 0U;
+                             jsarr_next(&val_obj, &val_obj_nstd);
+                             ++val_obj_idx)
+                        {
+                            val_obj_arr[val_obj_idx] = val_obj_nstd;
+                        }
 
                         /* Iterate from the last to the first element. */
-                        /* Safe cast since count was checked to be positive. */
-                        for (int32_t val_obj_idx = val_obj_cnt - 1;
-                             val_obj_idx >= 0; --val_obj_idx)
+                        for (uint32_t val_obj_idx = val_obj_cnt;
+                             val_obj_idx > 0U; --val_obj_idx)
                         {
-                            /**
-                             * Safe cast since the idx will never surpass a
-                             * value of int32.
-                             */
-                            cJSON *const val_obj_nstd = cJSON_GetArrayItem(
-                                val_obj, (int32_t)val_obj_idx);
-                            ret_env = prs_bertlv(val_obj_nstd, &enc_nstd);
+                            ret_env = prs_bertlv(&val_obj_arr[val_obj_idx - 1U],
+                                                 &enc_nstd);
                             if (ret_env != SWICC_RET_SUCCESS)
                             {
                                 break;
                             }
                         }
+                        if (val_obj_arr != NULL)
+                        {
+                            free(val_obj_arr);
+                        }
                         if (ret_env == SWICC_RET_SUCCESS)
                         {
                             if (swicc_dato_bertlv_enc_nstd_end(
@@ -948,25 +1635,24 @@ static swicc_ret_et prs_bertlv(cJSON const *const bertlv_json,
                      * For primitive DOs, encode that data then header and
                      * return.
                      */
-                    if (cJSON_IsString(val_obj) == true)
+                    if (val_obj.type == JSVAL_TYPE_STRING)
                     {
-                        char *const val_str = cJSON_GetStringValue(val_obj);
-                        uint64_t const val_str_len = strlen(val_str);
-                        if (val_str_len > UINT32_MAX)
+                        char const *val_str;
+                        uint32_t val_str_len;
+                        char *val_str_dec;
+                        if (jsval_str(&val_obj, &val_str, &val_str_len,
+                                      &val_str_dec) != SWICC_RET_SUCCESS)
                         {
-                            /* Value length should never be this large. */
                             return SWICC_RET_ERROR;
                         }
                         swicc_ret_et ret_enc = SWICC_RET_ERROR;
-                        /* Safe cast since len was checked to fit in uint32. */
-                        uint32_t bytearr_len = (uint32_t)val_str_len / 2U;
+                        uint32_t bytearr_len = val_str_len / 2U;
                         uint8_t *bytearr = malloc(bytearr_len);
                         if (bytearr != NULL)
                         {
-                            /* Safe cast since val len was checked. */
-                            if (swicc_hexstr_bytearr(
-                                    val_str, (uint32_t)val_str_len, bytearr,
-                                    &bytearr_len) == SWICC_RET_SUCCESS)
+                            if (swicc_hexstr_bytearr(val_str, val_str_len,
+                                                     bytearr, &bytearr_len) ==
+                                SWICC_RET_SUCCESS)
                             {
                                 if (swicc_dato_bertlv_enc_data(enc, bytearr,
                                                                bytearr_len) ==
@@ -982,10 +1668,14 @@ static swicc_ret_et prs_bertlv(cJSON const *const bertlv_json,
                                 fprintf(
                                     stderr,
                                     "Item dato BER-TLV: Failed to convert value hex string to a byte array: '%.*s'.\n",
-                                    (uint32_t)val_str_len, val_str);
+                                    val_str_len, val_str);
                             }
                             free(bytearr);
                         }
+                        if (val_str_dec != NULL)
+                        {
+                            free(val_str_dec);
+                        }
                         if (ret_enc == SWICC_RET_SUCCESS)
                         {
                             return ret_enc;
@@ -1033,26 +1723,26 @@ static swicc_ret_et prs_bertlv(cJSON const *const bertlv_json,
  * @return Return code.
  */
 static jsitem_prs_ft jsitem_prs_item_dato_bertlv;
-static swicc_ret_et jsitem_prs_item_dato_bertlv(cJSON const *const item_json,
+static swicc_ret_et jsitem_prs_item_dato_bertlv(jsval_st const *const item_json,
                                                 uint32_t const offset_prel,
                                                 uint8_t *const buf,
                                                 uint32_t *const buf_len)
 {
-    if (item_json == NULL || cJSON_IsObject(item_json) != true || buf == NULL ||
+    if (item_json == NULL || item_json->type != JSVAL_TYPE_OBJECT || buf == NULL ||
         buf_len == NULL)
     {
         return SWICC_RET_PARAM_BAD;
     }
 
     swicc_ret_et ret = SWICC_RET_ERROR;
-    cJSON *const contents_obj =
-        cJSON_GetObjectItemCaseSensitive(item_json, "contents");
-    if (contents_obj != NULL && cJSON_IsNull(contents_obj) == true)
+    jsval_st contents_obj;
+    jsobj_get(item_json, "contents", &contents_obj);
+    if (contents_obj.type == JSVAL_TYPE_NULL)
     {
         *buf_len = 0U;
         ret = SWICC_RET_SUCCESS;
     }
-    else if (contents_obj != NULL && cJSON_IsObject(contents_obj) == true)
+    else if (contents_obj.type == JSVAL_TYPE_OBJECT)
     {
         swicc_dato_bertlv_enc_st enc;
         uint8_t *enc_buf;
@@ -1075,7 +1765,7 @@ static swicc_ret_et jsitem_prs_item_dato_bertlv(cJSON const *const item_json,
                 enc_buf_len = enc.len;
             }
             swicc_dato_bertlv_enc_init(&enc, enc_buf, enc_buf_len);
-            ret_enc = prs_bertlv(contents_obj, &enc);
+            ret_enc = prs_bertlv(&contents_obj, &enc);
             if (ret_enc != SWICC_RET_SUCCESS)
             {
                 break;
@@ -1119,37 +1809,38 @@ static swicc_ret_et jsitem_prs_item_dato_bertlv(cJSON const *const item_json,
  * @return Return code.
  */
 static jsitem_prs_ft jsitem_prs_item_hex;
-static swicc_ret_et jsitem_prs_item_hex(cJSON const *const item_json,
+static swicc_ret_et jsitem_prs_item_hex(jsval_st const *const item_json,
                                         uint32_t const offset_prel,
                                         uint8_t *const buf,
                                         uint32_t *const buf_len)
 {
-    if (item_json == NULL || cJSON_IsObject(item_json) != true || buf == NULL ||
+    if (item_json == NULL || item_json->type != JSVAL_TYPE_OBJECT || buf == NULL ||
         buf_len == NULL)
     {
         return SWICC_RET_PARAM_BAD;
     }
 
     swicc_ret_et ret = SWICC_RET_ERROR;
-    cJSON *const contents_obj =
-        cJSON_GetObjectItemCaseSensitive(item_json, "contents");
-    if (contents_obj != NULL && cJSON_IsNull(contents_obj) == true)
+    jsval_st contents_obj;
+    jsobj_get(item_json, "contents", &contents_obj);
+    if (contents_obj.type == JSVAL_TYPE_NULL)
     {
         *buf_len = 0U;
         ret = SWICC_RET_SUCCESS;
     }
-    else if (contents_obj != NULL && cJSON_IsString(contents_obj) == true)
+    else if (contents_obj.type == JSVAL_TYPE_STRING)
     {
-        char *const contents_str = cJSON_GetStringValue(contents_obj);
-        if (contents_str != NULL)
+        char const *contents_str;
+        uint32_t hexstr_len;
+        char *contents_str_dec;
+        if (jsval_str(&contents_obj, &contents_str, &hexstr_len,
+                      &contents_str_dec) == SWICC_RET_SUCCESS)
         {
-            uint64_t const hexstr_len = strlen(contents_str);
-            if (hexstr_len <= UINT32_MAX && hexstr_len % 2U == 0U)
+            if (hexstr_len % 2U == 0U)
             {
                 uint32_t bytearr_len = *buf_len;
-                /* Safe cast due to the boundary check. */
-                ret = swicc_hexstr_bytearr(contents_str, (uint32_t)hexstr_len,
-                                           buf, &bytearr_len);
+                ret = swicc_hexstr_bytearr(contents_str, hexstr_len, buf,
+                                           &bytearr_len);
                 if (ret == SWICC_RET_SUCCESS)
                 {
                     if (*buf_len >= bytearr_len)
@@ -1166,16 +1857,20 @@ static swicc_ret_et jsitem_prs_item_hex(cJSON const *const item_json,
                     fprintf(
                         stderr,
                         "Item hex: Failed to convert hex string to a byte array: '%.*s'.\n",
-                        (uint32_t)hexstr_len, contents_str);
+                        hexstr_len, contents_str);
                 }
             }
             else
             {
                 fprintf(
                     stderr,
-                    "Item hex: Hex string has an invalid length (got %lu, expected <=%u and multiple of 2).\n",
+                    "Item hex: Hex string has an invalid length (got %u, expected <=%u and multiple of 2).\n",
                     hexstr_len, UINT32_MAX);
             }
+            if (contents_str_dec != NULL)
+            {
+                free(contents_str_dec);
+            }
         }
     }
     else
@@ -1197,51 +1892,46 @@ static swicc_ret_et jsitem_prs_item_hex(cJSON const *const item_json,
  * @return Return code.
  */
 static jsitem_prs_ft jsitem_prs_item_ascii;
-static swicc_ret_et jsitem_prs_item_ascii(cJSON const *const item_json,
+static swicc_ret_et jsitem_prs_item_ascii(jsval_st const *const item_json,
                                           uint32_t const offset_prel,
                                           uint8_t *const buf,
                                           uint32_t *const buf_len)
 {
-    if (item_json == NULL || cJSON_IsObject(item_json) != true || buf == NULL ||
+    if (item_json == NULL || item_json->type != JSVAL_TYPE_OBJECT || buf == NULL ||
         buf_len == NULL)
     {
         return SWICC_RET_PARAM_BAD;
     }
 
     swicc_ret_et ret = SWICC_RET_ERROR;
-    cJSON *const contents_obj =
-        cJSON_GetObjectItemCaseSensitive(item_json, "contents");
-    if (contents_obj != NULL && cJSON_IsNull(contents_obj) == true)
+    jsval_st contents_obj;
+    jsobj_get(item_json, "contents", &contents_obj);
+    if (contents_obj.type == JSVAL_TYPE_NULL)
     {
         *buf_len = 0U;
         ret = SWICC_RET_SUCCESS;
     }
-    else if (contents_obj != NULL && cJSON_IsString(contents_obj) == true)
+    else if (contents_obj.type == JSVAL_TYPE_STRING)
     {
-        char *const contents_str = cJSON_GetStringValue(contents_obj);
-        if (contents_str != NULL)
+        char const *contents_str;
+        uint32_t ascii_len;
+        char *contents_str_dec;
+        if (jsval_str(&contents_obj, &contents_str, &ascii_len,
+                      &contents_str_dec) == SWICC_RET_SUCCESS)
         {
-            uint64_t const ascii_len = strlen(contents_str);
-            if (ascii_len <= UINT32_MAX)
+            if (ascii_len <= *buf_len)
             {
-                if (ascii_len <= *buf_len)
-                {
-                    memcpy(buf, contents_str, ascii_len);
-                    *buf_len = (uint32_t)
-                        ascii_len; /* Safe cast due to the boundary check. */
-                    ret = SWICC_RET_SUCCESS;
-                }
-                else
-                {
-                    ret = SWICC_RET_BUFFER_TOO_SHORT;
-                }
+                memcpy(buf, contents_str, ascii_len);
+                *buf_len = ascii_len;
+                ret = SWICC_RET_SUCCESS;
             }
             else
             {
-                fprintf(
-                    stderr,
-                    "Item ASCII: ASCII string is too long (got %lu, expected <=%u).\n",
-                    ascii_len, UINT32_MAX);
+                ret = SWICC_RET_BUFFER_TOO_SHORT;
+            }
+            if (contents_str_dec != NULL)
+            {
+                free(contents_str_dec);
             }
         }
     }
@@ -1277,9 +1967,10 @@ static jsitem_prs_ft *const jsitem_prs[] = {
  * @return Return code.
  */
 static swicc_ret_et disk_json_prs(swicc_disk_st *const disk,
-                                  cJSON const *const disk_json)
+                                  jsval_st const *const disk_json)
 {
-    if (disk == NULL || disk_json == NULL || cJSON_IsObject(disk_json) != true)
+    if (disk == NULL || disk_json == NULL ||
+        disk_json->type != JSVAL_TYPE_OBJECT)
     {
         return SWICC_RET_PARAM_BAD;
     }
@@ -1292,12 +1983,13 @@ static swicc_ret_et disk_json_prs(swicc_disk_st *const disk,
     }
 
     uint8_t tree_count = 0U;
-    cJSON *const disk_obj = cJSON_GetObjectItemCaseSensitive(disk_json, "disk");
-    if (disk_obj != NULL && cJSON_IsArray(disk_obj) == true)
+    jsval_st disk_obj;
+    if (jsobj_get(disk_json, "disk", &disk_obj) &&
+        disk_obj.type == JSVAL_TYPE_ARRAY)
     {
-        cJSON *tree_obj;
+        jsval_st tree_obj = {.str = NULL};
         swicc_disk_tree_st *tree = NULL;
-        cJSON_ArrayForEach(tree_obj, disk_obj)
+        while (jsarr_next(&disk_obj, &tree_obj))
         {
             /**
              * Check if this is the first item in the root. If so, add a
@@ -1346,7 +2038,7 @@ static swicc_ret_et disk_json_prs(swicc_disk_st *const disk,
             do
             {
                 item_size = tree->size - tree->len;
-                ret = jsitem_prs_demux(tree_obj, 0U, &tree->buf[tree->len],
+                ret = jsitem_prs_demux(&tree_obj, 0U, &tree->buf[tree->len],
                                        &item_size);
                 if (ret == SWICC_RET_BUFFER_TOO_SHORT)
                 {
@@ -1404,6 +2096,22 @@ static swicc_ret_et disk_json_prs(swicc_disk_st *const disk,
              */
             tree->len = item_size;
 
+            /**
+             * The tree buffer won't be moved anymore so the folder headers can
+             * be decoded.
+             */
+            ret = swicc_disk_hdrtbl_rebuild(disk, tree);
+            if (ret != SWICC_RET_SUCCESS)
+            {
+                /**
+                 * No need to clean up the header table since this will be done
+                 * when the whole root gets emptied due to this error.
+                 */
+                fprintf(stderr,
+                        "Tree: Failed to create the header table: %s.\n",
+                        swicc_dbg_ret_str(ret));
+                break;
+            }
             ret = swicc_disk_lutsid_rebuild(disk, tree);
             if (ret != SWICC_RET_SUCCESS)
             {
@@ -1415,6 +2123,14 @@ static swicc_ret_et disk_json_prs(swicc_disk_st *const disk,
                         swicc_dbg_ret_str(ret));
                 break;
             }
+            ret = swicc_disk_lutchild_rebuild(disk, tree);
+            if (ret != SWICC_RET_SUCCESS)
+            {
+                /* Same as for the SID LUT. */
+                fprintf(stderr, "Tree: Failed to create the child LUT: %s.\n",
+                        swicc_dbg_ret_str(ret));
+                break;
+            }
 
             /**
              * Unsafe case which relies on there being fewer than 256 trees in
@@ -1443,6 +2159,15 @@ static swicc_ret_et disk_json_prs(swicc_disk_st *const disk,
                 swicc_disk_lutid_empty(disk);
             }
         }
+        if (ret == SWICC_RET_SUCCESS)
+        {
+            ret = swicc_disk_lutname_rebuild(disk);
+            if (ret != SWICC_RET_SUCCESS)
+            {
+                fprintf(stderr, "Root: Failed to rebuild name LUT.\n");
+                swicc_disk_lutname_empty(disk);
+            }
+        }
     }
     else
     {
@@ -1463,40 +2188,52 @@ swicc_ret_et swicc_diskjs_disk_create(swicc_disk_st *const disk,
     }
     memset(disk, 0U, sizeof(*disk));
     swicc_ret_et ret = SWICC_RET_ERROR;
-    FILE *f = fopen(disk_json_path, "rb");
-    if (f != NULL)
+    int32_t const fd = open(disk_json_path, O_RDONLY);
+    if (fd >= 0)
     {
-        /* Seek to end. */
-        if (fseek(f, 0, SEEK_END) == 0)
+        struct stat fd_stat;
+        if (fstat(fd, &fd_stat) == 0 && fd_stat.st_size > 0 &&
+            fd_stat.st_size <= UINT32_MAX)
         {
-            /* Get current position of read pointer to get file size. */
-            int64_t f_len_tmp = ftell(f);
-            if (f_len_tmp >= 0 && f_len_tmp <= UINT32_MAX)
+            /**
+             * The JSON is read straight from the page cache so memory use does
+             * not depend on how large the JSON is, only on the size of the
+             * disk being created.
+             */
+            /* Safe cast since size was checked to fit in a uint32. */
+            size_t const disk_json_raw_len = (size_t)fd_stat.st_size;
+            char const *const disk_json_raw =
+                mmap(NULL, disk_json_raw_len, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (disk_json_raw != MAP_FAILED)
             {
-                if (fseek(f, 0, SEEK_SET) == 0)
+                char const *const end = disk_json_raw + disk_json_raw_len;
+                char const *pos = disk_json_raw;
+                /* Skip the UTF-8 BOM like cJSON does. */
+                if (disk_json_raw_len >= 3U &&
+                    memcmp(pos, "\xEF\xBB\xBF", 3U) == 0)
                 {
-                    /* Safe cast due to the size checks before. */
-                    uint32_t const disk_json_raw_len = (uint32_t)f_len_tmp;
-                    char *const disk_json_raw = malloc(disk_json_raw_len);
-                    if (disk_json_raw != NULL)
-                    {
-                        if (fread(disk_json_raw, 1U, disk_json_raw_len, f) ==
-                            disk_json_raw_len)
-                        {
-                            cJSON *const disk_json = cJSON_ParseWithLength(
-                                disk_json_raw, disk_json_raw_len);
-                            if (disk_json != NULL)
-                            {
-                                ret = disk_json_prs(disk, disk_json);
-                                cJSON_Delete(disk_json);
-                            }
-                        }
-                    }
-                    free(disk_json_raw);
+                    pos += 3U;
+                }
+                pos = json_ws(pos, end);
+
+                /* Validate the whole JSON once before parsing any items. */
+                if (json_val_check(pos, end, 0U) != NULL)
+                {
+                    jsval_st disk_json;
+                    jsval_at(pos, end, &disk_json);
+                    ret = disk_json_prs(disk, &disk_json);
+                }
+                else
+                {
+                    fprintf(stderr, "Root: Disk JSON is not valid.\n");
+                }
+                if (munmap((void *)disk_json_raw, disk_json_raw_len) != 0)
+                {
+                    ret = SWICC_RET_ERROR;
                 }
             }
         }
-        if (fclose(f) != 0)
+        if (close(fd) != 0)
         {
             ret = SWICC_RET_ERROR;
         }
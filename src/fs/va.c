@@ -117,139 +117,38 @@ swicc_ret_et swicc_va_reset(swicc_fs_st *const fs)
 
 swicc_ret_et swicc_va_select_adf(swicc_fs_st *const fs,
                                  uint8_t const *const aid,
-                                 uint32_t const pix_len)
+                                 uint32_t const pix_len,
+                                 swicc_fs_occ_et const occ)
 {
-    swicc_disk_tree_iter_st tree_iter;
-    swicc_ret_et ret = swicc_disk_tree_iter(&fs->disk, &tree_iter);
-    if (ret == SWICC_RET_SUCCESS)
+    if (pix_len > SWICC_FS_ADF_AID_PIX_LEN)
     {
-        swicc_disk_tree_st *tree;
-        do
-        {
-            ret = swicc_disk_tree_iter_next(&tree_iter, &tree);
-            if (ret == SWICC_RET_SUCCESS)
-            {
-                swicc_fs_file_st file_root;
-                ret = swicc_disk_tree_file_root(tree, &file_root);
-                if (ret == SWICC_RET_SUCCESS)
-                {
-                    if (file_root.hdr_item.type == SWICC_FS_ITEM_TYPE_FILE_ADF)
-                    {
-                        if (memcmp(file_root.hdr_spec.adf.aid.rid, aid,
-                                   SWICC_FS_ADF_AID_RID_LEN) == 0U &&
-                            memcmp(file_root.hdr_spec.adf.aid.pix,
-                                   &aid[SWICC_FS_ADF_AID_RID_LEN],
-                                   pix_len) == 0U)
-                        {
-                            return va_select_file(fs, tree, file_root);
-                        }
-                    }
-                    else
-                    {
-                        ret = SWICC_RET_ERROR;
-                    }
-                }
-            }
-        } while (ret == SWICC_RET_SUCCESS);
+        return SWICC_RET_PARAM_BAD;
     }
-    return ret;
-}
-
-typedef struct va_select_file_dfname_userdata_s
-{
-    uint8_t const name[SWICC_FS_NAME_LEN];
-    uint32_t const name_len;
-    bool found;
-    swicc_fs_file_st file_found;
-} va_select_file_dfname_userdata_st;
-static swicc_disk_file_foreach_cb va_select_file_dfname_cb;
-static swicc_ret_et va_select_file_dfname_cb(swicc_disk_tree_st *const tree,
-                                             swicc_fs_file_st *const file,
-                                             void *const userdata)
-{
-    va_select_file_dfname_userdata_st *const ud = userdata;
-    uint8_t const *name = NULL;
-    switch (file->hdr_item.type)
-    {
-    case SWICC_FS_ITEM_TYPE_FILE_MF:
-        name = file->hdr_spec.mf.name;
-        break;
-    case SWICC_FS_ITEM_TYPE_FILE_DF:
-        name = file->hdr_spec.df.name;
-        break;
-    default:
-        break;
-    }
-    if (name != NULL)
+    swicc_disk_tree_st *tree;
+    swicc_fs_file_st file_adf;
+    swicc_ret_et const ret = swicc_disk_lutaid_lookup(
+        &fs->disk, aid, SWICC_FS_ADF_AID_RID_LEN + pix_len, occ,
+        fs->va.cur_tree_adf, &tree, &file_adf);
+    if (ret != SWICC_RET_SUCCESS)
     {
-        if (ud->name_len > SWICC_FS_NAME_LEN)
-        {
-            return SWICC_RET_PARAM_BAD;
-        }
-        if (memcmp(name, ud->name, ud->name_len) == 0)
-        {
-            ud->found = true;
-            ud->file_found = *file;
-            /* Make the foreach iterator stop early. */
-            return SWICC_RET_ERROR;
-        }
+        return ret;
     }
-    return SWICC_RET_SUCCESS;
+    return va_select_file(fs, tree, file_adf);
 }
 
 swicc_ret_et swicc_va_select_file_dfname(swicc_fs_st *const fs,
                                          uint8_t const *const df_name,
                                          uint32_t const df_name_len)
 {
-    va_select_file_dfname_userdata_st userdata = {
-        .name = {*df_name},
-        .name_len = df_name_len,
-        .found = false,
-    };
-    swicc_disk_tree_iter_st tree_iter;
-    swicc_ret_et ret = swicc_disk_tree_iter(&fs->disk, &tree_iter);
-    if (ret == SWICC_RET_SUCCESS)
+    swicc_disk_tree_st *tree;
+    swicc_fs_file_st file;
+    swicc_ret_et const ret = swicc_disk_lutname_lookup(
+        &fs->disk, &tree, df_name, df_name_len, &file);
+    if (ret != SWICC_RET_SUCCESS)
     {
-        swicc_disk_tree_st *tree;
-        do
-        {
-            ret = swicc_disk_tree_iter_next(&tree_iter, &tree);
-            if (ret == SWICC_RET_SUCCESS)
-            {
-                swicc_fs_file_st file_root;
-                ret = swicc_disk_tree_file_root(tree, &file_root);
-                if (ret == SWICC_RET_SUCCESS)
-                {
-                    ret = swicc_disk_file_foreach(tree, &file_root,
-                                                  va_select_file_dfname_cb,
-                                                  &userdata, true);
-                    if (ret == SWICC_RET_SUCCESS)
-                    {
-                        /**
-                         * No DF/MF with the name was found and foreach did not
-                         * fail.
-                         */
-                        ret = SWICC_RET_FS_NOT_FOUND;
-                        continue;
-                    }
-                    else
-                    {
-                        if (userdata.found == true)
-                        {
-                            ret = va_select_file(fs, tree, userdata.file_found);
-                            if (ret == SWICC_RET_SUCCESS)
-                            {
-                                return SWICC_RET_SUCCESS;
-                            }
-                        }
-                        /* Stop looking on any non-successful return. */
-                        return ret;
-                    }
-                }
-            }
-        } while (ret == SWICC_RET_SUCCESS);
+        return ret;
     }
-    return ret;
+    return va_select_file(fs, tree, file);
 }
 
 swicc_ret_et swicc_va_select_file_id(swicc_fs_st *const fs,
@@ -278,34 +177,12 @@ swicc_ret_et swicc_va_select_file_sid(swicc_fs_st *const fs,
     return ret;
 }
 
-typedef struct va_select_file_path_userdata_s
-{
-    swicc_fs_id_kt fid_search;
-    bool found;
-    swicc_fs_file_st file_found;
-} va_select_file_path_userdata_st;
-static swicc_disk_file_foreach_cb va_select_file_path_cb;
-static swicc_ret_et va_select_file_path_cb(swicc_disk_tree_st *const tree,
-                                           swicc_fs_file_st *const file,
-                                           void *const userdata)
-{
-    va_select_file_path_userdata_st *const ud = userdata;
-    if (file->hdr_file.id == ud->fid_search)
-    {
-        ud->found = true;
-        ud->file_found = *file;
-        return SWICC_RET_ERROR;
-    }
-    return SWICC_RET_SUCCESS;
-}
-
 swicc_ret_et swicc_va_select_file_path(swicc_fs_st *const fs,
                                        swicc_fs_path_st const path)
 {
     swicc_ret_et ret = SWICC_RET_ERROR;
     swicc_fs_file_st file_root;
     swicc_disk_tree_st *tree = NULL;
-    va_select_file_path_userdata_st userdata = {0U};
 
     switch (path.type)
     {
@@ -343,36 +220,33 @@ swicc_ret_et swicc_va_select_file_path(swicc_fs_st *const fs,
         break;
     }
 
-    /* Traverse path. */
+    if (tree == NULL)
+    {
+        return SWICC_RET_ERROR;
+    }
+
+    /* Traverse path, each step is a lookup in the child LUT of the tree. */
     for (uint32_t path_idx = 0U; path_idx < path.len; ++path_idx)
     {
-        swicc_fs_id_kt fid_next = path.b[path_idx];
-        userdata.fid_search = fid_next;
-        userdata.found = false;
-        ret = swicc_disk_file_foreach(tree, &file_root, va_select_file_path_cb,
-                                      &userdata, false);
-        if (ret == SWICC_RET_ERROR && userdata.found == true)
+        swicc_fs_id_kt const fid_next = path.b[path_idx];
+        /**
+         * A folder can also be referenced by its own ID e.g. the MF or the
+         * current application at the start of a path.
+         */
+        if (fid_next == file_root.hdr_file.id)
         {
-            file_root = userdata.file_found;
-            ret = SWICC_RET_SUCCESS;
+            continue;
         }
-        else if (ret == SWICC_RET_SUCCESS)
-        {
-            return SWICC_RET_FS_NOT_FOUND;
-        }
-        else
+        ret = swicc_disk_lutchild_lookup(tree, &file_root, fid_next,
+                                         &file_root);
+        if (ret != SWICC_RET_SUCCESS)
         {
             return ret;
         }
     }
 
     /* After traversing path, try select it. */
-    if (ret == SWICC_RET_SUCCESS && userdata.found && tree != NULL)
-    {
-        ret = va_select_file(fs, tree, userdata.file_found);
-        return ret;
-    }
-    return ret;
+    return va_select_file(fs, tree, file_root);
 }
 
 swicc_ret_et swicc_va_select_record_idx(swicc_fs_st *const fs,
@@ -167,6 +167,18 @@ static void fsm_handle_s_reset_warm(swicc_st *const swicc_state)
     return;
 }
 
+/**
+ * @brief Reset the T=1 protocol to its initial state i.e. the one right after
+ * the PPS.
+ * @param[in, out] swicc_state
+ */
+static void fsm_t1_reset(swicc_st *const swicc_state)
+{
+    memset(&swicc_state->internal.t1, 0U, sizeof(swicc_state->internal.t1));
+    swicc_state->internal.t1.ifsd = SWICC_T1_IFSD_DEFAULT;
+    swicc_state->internal.t1.edc = SWICC_T1_EDC;
+}
+
 static swicc_fsmh_ft fsm_handle_s_pps_req;
 static void fsm_handle_s_pps_req(swicc_st *const swicc_state)
 {
@@ -257,6 +269,13 @@ static void fsm_handle_s_pps_req(swicc_st *const swicc_state)
                               swicc_state->internal.tp.fi,
                               swicc_state->internal.tp.di,
                               swicc_state->internal.tp.fmax);
+                    swicc_state->internal.tp.t = pps_params.t;
+                    if (pps_params.t == 1U)
+                    {
+                        fsm_t1_reset(swicc_state);
+                        swicc_state->internal.fsm_state =
+                            SWICC_FSM_STATE_T1_BLOCK;
+                    }
                     swicc_state->internal.tpdu_processed = false;
                     swicc_state->buf_rx_len = 0U;
                     return;
@@ -300,8 +319,14 @@ static void fsm_handle_s_cmd_wait(swicc_st *const swicc_state)
         /* Reset any state left-over from handling the previous APDU. */
         if (swicc_state->internal.tpdu_processed == true)
         {
-            memset(&swicc_state->internal.tpdu_cur, 0U,
-                   sizeof(swicc_state->internal.tpdu_cur));
+            /**
+             * The data buffer is not cleared since it is large and only as
+             * much of it as its length says is ever used.
+             */
+            memset(&swicc_state->internal.tpdu_cur.hdr, 0U,
+                   sizeof(swicc_state->internal.tpdu_cur.hdr));
+            swicc_state->internal.tpdu_cur.p3 = 0U;
+            swicc_state->internal.tpdu_cur.data.len = 0U;
             memset(swicc_state->internal.tpdu_hdr, 0U,
                    sizeof(swicc_state->internal.tpdu_hdr));
             swicc_state->internal.tpdu_hdr_len = 0U;
@@ -388,7 +413,16 @@ static void fsm_handle_s_cmd_procedure(swicc_st *const swicc_state)
 {
     if (swicc_state->cont_state_rx == FSM_STATE_CONT_READY)
     {
-        swicc_apdu_res_st apdu_res;
+        /**
+         * When the TX buffer can hold the largest response, handlers write the
+         * response data directly into it so it never has to be copied.
+         */
+        uint8_t res_buf[SWICC_DATA_MAX];
+        swicc_apdu_res_st apdu_res = {.data.b = res_buf};
+        if (swicc_state->buf_tx_len >= SWICC_DATA_MAX + 2U)
+        {
+            apdu_res.data.b = swicc_state->buf_tx;
+        }
         swicc_ret_et const apdu_handle_ret =
             swicc_apduh_demux(swicc_state, &swicc_state->internal.apdu_cur,
                               &apdu_res, swicc_state->internal.procedure_count);
@@ -519,6 +553,308 @@ static void fsm_handle_s_cmd_data(swicc_st *const swicc_state)
     return;
 }
 
+/**
+ * @brief Create a block to send and keep it in case it has to be sent again.
+ * @param[in, out] swicc_state
+ * @param[in] pcb
+ * @param[in] inf
+ * @param[in] inf_len
+ */
+static void fsm_t1_send(swicc_st *const swicc_state, uint8_t const pcb,
+                        uint8_t const *const inf, uint8_t const inf_len)
+{
+    swicc_t1_st *const t1 = &swicc_state->internal.t1;
+    swicc_t1_block_st const block = {
+        .nad = 0U,
+        .pcb = pcb,
+        .len = inf_len,
+        .inf = inf,
+    };
+    t1->block_tx_len = sizeof(t1->block_tx);
+    if (swicc_t1_block_deparse(&block, t1->edc, t1->block_tx,
+                               &t1->block_tx_len) != SWICC_RET_SUCCESS)
+    {
+        t1->block_tx_len = 0U;
+    }
+}
+
+/**
+ * @brief Send an R-block which asks for the next expected I-block.
+ * @param[in, out] swicc_state
+ * @param[in] err Error code to put in the PCB.
+ */
+static void fsm_t1_send_r(swicc_st *const swicc_state, uint8_t const err)
+{
+    /* Safe cast since all the bits fit in a byte. */
+    uint8_t const pcb = (uint8_t)(SWICC_T1_PCB_R |
+                                  (swicc_state->internal.t1.nr != 0U
+                                       ? SWICC_T1_PCB_R_NR
+                                       : 0U) |
+                                  err);
+    fsm_t1_send(swicc_state, pcb, NULL, 0U);
+}
+
+/**
+ * @brief Send the next part of the response APDU in an I-block. The part is as
+ * large as the IFSD and the TX buffer allow and if more remains, the I-block
+ * is chained.
+ * @param[in, out] swicc_state
+ */
+static void fsm_t1_send_res(swicc_st *const swicc_state)
+{
+    swicc_t1_st *const t1 = &swicc_state->internal.t1;
+    uint32_t const overhead = SWICC_T1_PROLOGUE_LEN + swicc_t1_edc_len(t1->edc);
+    if (swicc_state->buf_tx_len <= overhead)
+    {
+        /* Not even a single byte of the response could be sent. */
+        t1->block_tx_len = 0U;
+        return;
+    }
+    uint32_t inf_len = (uint32_t)(t1->res_len - t1->res_off);
+    if (inf_len > t1->ifsd)
+    {
+        inf_len = t1->ifsd;
+    }
+    if (inf_len > swicc_state->buf_tx_len - overhead)
+    {
+        inf_len = swicc_state->buf_tx_len - overhead;
+    }
+    bool const more = t1->res_off + inf_len < t1->res_len;
+
+    /* Safe cast since all the bits fit in a byte. */
+    uint8_t const pcb =
+        (uint8_t)(SWICC_T1_PCB_I | (t1->ns != 0U ? SWICC_T1_PCB_I_NS : 0U) |
+                  (more ? SWICC_T1_PCB_I_M : 0U));
+    /* Safe cast since the IFSD is at most 254. */
+    fsm_t1_send(swicc_state, pcb, &t1->res[t1->res_off], (uint8_t)inf_len);
+    t1->ns ^= 1U;
+    /* Safe cast since this is at most the response length. */
+    t1->res_off = (uint16_t)(t1->res_off + inf_len);
+}
+
+/**
+ * @brief Handle an I-block: collect the command APDU and, once the last block
+ * of the chain arrives, execute it and send back the response.
+ * @param[in, out] swicc_state
+ * @param[in] block
+ */
+static void fsm_t1_i_handle(swicc_st *const swicc_state,
+                            swicc_t1_block_st const *const block)
+{
+    swicc_t1_st *const t1 = &swicc_state->internal.t1;
+    uint8_t const ns = (block->pcb & SWICC_T1_PCB_I_NS) != 0U ? 1U : 0U;
+    if (ns != t1->nr)
+    {
+        fsm_t1_send_r(swicc_state, SWICC_T1_PCB_R_ERR_OTHER);
+        return;
+    }
+    t1->nr ^= 1U;
+
+    /**
+     * The interface sends a new command instead of acknowledging the rest of
+     * the response so the rest is dropped.
+     */
+    t1->res_len = 0U;
+    t1->res_off = 0U;
+
+    if (t1->cmd_len + block->len <= sizeof(t1->cmd))
+    {
+        memcpy(&t1->cmd[t1->cmd_len], block->inf, block->len);
+        /* Safe cast due to the check of the command buffer size. */
+        t1->cmd_len = (uint16_t)(t1->cmd_len + block->len);
+    }
+    else
+    {
+        t1->cmd_overflow = true;
+    }
+
+    if ((block->pcb & SWICC_T1_PCB_I_M) != 0U)
+    {
+        /* Acknowledge this part and ask for the next one. */
+        fsm_t1_send_r(swicc_state, SWICC_T1_PCB_R_ERR_NONE);
+        return;
+    }
+
+    t1->res_len = sizeof(t1->res);
+    swicc_ret_et const ret =
+        t1->cmd_overflow
+            ? SWICC_RET_PARAM_BAD
+            : swicc_apdu_exec(swicc_state, t1->cmd, t1->cmd_len, t1->res,
+                              &t1->res_len);
+    if (ret != SWICC_RET_SUCCESS)
+    {
+        /**
+         * A malformed command gets a status word like any other so the
+         * interface is not left waiting for a response.
+         */
+        t1->res[0U] = ret == SWICC_RET_PARAM_BAD ? SWICC_APDU_SW1_CHER_LEN
+                                                 : SWICC_APDU_SW1_CHER_UNK;
+        t1->res[1U] = 0x00;
+        t1->res_len = 2U;
+    }
+    t1->cmd_len = 0U;
+    t1->cmd_overflow = false;
+    fsm_t1_send_res(swicc_state);
+}
+
+/**
+ * @brief Handle an R-block: send the next part of a chained response or send
+ * the last block again.
+ * @param[in, out] swicc_state
+ * @param[in] block
+ */
+static void fsm_t1_r_handle(swicc_st *const swicc_state,
+                            swicc_t1_block_st const *const block)
+{
+    swicc_t1_st *const t1 = &swicc_state->internal.t1;
+    uint8_t const nr = (block->pcb & SWICC_T1_PCB_R_NR) != 0U ? 1U : 0U;
+    if (t1->res_off < t1->res_len && nr == t1->ns)
+    {
+        fsm_t1_send_res(swicc_state);
+    }
+    else if (t1->block_tx_len == 0U)
+    {
+        /* Nothing was sent yet so there is nothing to send again. */
+        fsm_t1_send_r(swicc_state, SWICC_T1_PCB_R_ERR_OTHER);
+    }
+    /* Otherwise the last block is sent again as-is. */
+}
+
+/**
+ * @brief Handle an S-block request. The card never sends requests so it never
+ * expects a response.
+ * @param[in, out] swicc_state
+ * @param[in] block
+ */
+static void fsm_t1_s_handle(swicc_st *const swicc_state,
+                            swicc_t1_block_st const *const block)
+{
+    swicc_t1_st *const t1 = &swicc_state->internal.t1;
+    if ((block->pcb & SWICC_T1_PCB_S_RES) != 0U)
+    {
+        fsm_t1_send_r(swicc_state, SWICC_T1_PCB_R_ERR_OTHER);
+        return;
+    }
+    /* Safe cast since all the bits fit in a byte. */
+    uint8_t const pcb_res = (uint8_t)(block->pcb | SWICC_T1_PCB_S_RES);
+    switch (block->pcb & SWICC_T1_PCB_S_TYPE_MASK)
+    {
+    case SWICC_T1_PCB_S_IFS:
+        if (block->len == 1U && block->inf[0U] >= 1U &&
+            block->inf[0U] <= SWICC_T1_IFS_MAX)
+        {
+            t1->ifsd = block->inf[0U];
+            fsm_t1_send(swicc_state, pcb_res, block->inf, block->len);
+            return;
+        }
+        break;
+    case SWICC_T1_PCB_S_RESYNCH:
+        if (block->len == 0U)
+        {
+            fsm_t1_reset(swicc_state);
+            fsm_t1_send(swicc_state, pcb_res, NULL, 0U);
+            return;
+        }
+        break;
+    case SWICC_T1_PCB_S_ABORT:
+        if (block->len == 0U)
+        {
+            t1->cmd_len = 0U;
+            t1->cmd_overflow = false;
+            t1->res_len = 0U;
+            t1->res_off = 0U;
+            fsm_t1_send(swicc_state, pcb_res, NULL, 0U);
+            return;
+        }
+        break;
+    }
+    /* Includes WTX which only the card may request. */
+    fsm_t1_send_r(swicc_state, SWICC_T1_PCB_R_ERR_OTHER);
+}
+
+static swicc_fsmh_ft fsm_handle_s_t1_block;
+static void fsm_handle_s_t1_block(swicc_st *const swicc_state)
+{
+    if (swicc_state->cont_state_rx == FSM_STATE_CONT_READY)
+    {
+        swicc_t1_st *const t1 = &swicc_state->internal.t1;
+        if (t1->block_rx_len + swicc_state->buf_rx_len <= sizeof(t1->block_rx))
+        {
+            memcpy(&t1->block_rx[t1->block_rx_len], swicc_state->buf_rx,
+                   swicc_state->buf_rx_len);
+            /* Safe cast due to the check of the block buffer size. */
+            t1->block_rx_len =
+                (uint16_t)(t1->block_rx_len + swicc_state->buf_rx_len);
+
+            uint16_t block_len_exp;
+            if (swicc_t1_block_len(t1->block_rx, t1->block_rx_len, t1->edc,
+                                   &block_len_exp) != SWICC_RET_SUCCESS)
+            {
+                /* Get as many bytes as possible until (and including) LEN. */
+                /* Safe cast since the prologue is not complete here. */
+                swicc_state->buf_rx_len =
+                    (uint16_t)(SWICC_T1_PROLOGUE_LEN - t1->block_rx_len);
+                swicc_state->buf_tx_len = 0U;
+                return;
+            }
+            if (t1->block_rx_len < block_len_exp)
+            {
+                /* Get the INF and EDC. */
+                /* Safe cast since the block is not complete here. */
+                swicc_state->buf_rx_len =
+                    (uint16_t)(block_len_exp - t1->block_rx_len);
+                swicc_state->buf_tx_len = 0U;
+                return;
+            }
+
+            swicc_t1_block_st block;
+            swicc_ret_et const ret = swicc_t1_block_parse(
+                t1->block_rx, t1->block_rx_len, t1->edc, &block);
+            if (ret != SWICC_RET_SUCCESS || block.nad != 0U)
+            {
+                /* Ask for the block again. */
+                fsm_t1_send_r(swicc_state, ret == SWICC_RET_T1_EDC
+                                               ? SWICC_T1_PCB_R_ERR_EDC
+                                               : SWICC_T1_PCB_R_ERR_OTHER);
+            }
+            else if ((block.pcb & SWICC_T1_PCB_I_MASK) == SWICC_T1_PCB_I)
+            {
+                fsm_t1_i_handle(swicc_state, &block);
+            }
+            else if ((block.pcb & SWICC_T1_PCB_RS_MASK) == SWICC_T1_PCB_R)
+            {
+                fsm_t1_r_handle(swicc_state, &block);
+            }
+            else
+            {
+                fsm_t1_s_handle(swicc_state, &block);
+            }
+        }
+        else
+        {
+            /* Longer than any block could be. */
+            fsm_t1_send_r(swicc_state, SWICC_T1_PCB_R_ERR_OTHER);
+        }
+
+        t1->block_rx_len = 0U;
+        if (t1->block_tx_len <= swicc_state->buf_tx_len)
+        {
+            memcpy(swicc_state->buf_tx, t1->block_tx, t1->block_tx_len);
+            swicc_state->buf_tx_len = t1->block_tx_len;
+        }
+        else
+        {
+            swicc_state->buf_tx_len = 0U;
+        }
+        swicc_state->buf_rx_len = SWICC_T1_PROLOGUE_LEN; /* Next prologue. */
+        return;
+    }
+    swicc_state->internal.fsm_state = SWICC_FSM_STATE_OFF;
+    swicc_state->buf_tx_len = 0U;
+    swicc_state->buf_rx_len = 0U;
+    return;
+}
+
 static swicc_fsmh_ft *const swicc_fsmh[] = {
     [SWICC_FSM_STATE_OFF] = fsm_handle_s_off,
     [SWICC_FSM_STATE_ACTIVATION] = fsm_handle_s_activation,
@@ -530,6 +866,7 @@ static swicc_fsmh_ft *const swicc_fsmh[] = {
     [SWICC_FSM_STATE_CMD_WAIT] = fsm_handle_s_cmd_wait,
     [SWICC_FSM_STATE_CMD_PROCEDURE] = fsm_handle_s_cmd_procedure,
     [SWICC_FSM_STATE_CMD_DATA] = fsm_handle_s_cmd_data,
+    [SWICC_FSM_STATE_T1_BLOCK] = fsm_handle_s_t1_block,
 };
 
 void swicc_fsm(swicc_st *const swicc_state)
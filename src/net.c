@@ -1,7 +1,13 @@
+#define _GNU_SOURCE
 #include <arpa/inet.h>
 #include <errno.h>
 #include <fcntl.h>
+#include <linux/futex.h>
+#include <linux/io_uring.h>
 #include <netinet/tcp.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
 #include <signal.h>
 #include <stdarg.h>
 #include <stddef.h>
@@ -9,7 +15,14 @@
 #include <stdlib.h>
 #include <string.h>
 #include <swicc/swicc.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
 #include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <sys/un.h>
 #include <unistd.h>
 
 static swicc_net_logger_ft logger_default;
@@ -23,23 +36,65 @@ static void logger_default(char const *const fmt, ...)
     va_end(argptr);
 #endif
 }
-swicc_net_logger_ft *logger = logger_default;
+/**
+ * Every thread has its own logger so that threads serving cards never share
+ * any mutable state.
+ */
+static _Thread_local swicc_net_logger_ft *logger = logger_default;
 
 /**
- * @brief Send a message to a given socket.
- * @param sock The socket where the message will be sent.
- * @param msg Message to send.
- * @return Number of byte that were sent on success, -1 on failure.
+ * @brief Send (the rest of) a buffer to a given socket. The data is sent
+ * straight from the buffer, continuing after any earlier short writes.
+ * @param sock The socket where the data will be sent.
+ * @param buf Data to send.
+ * @param buf_len Length of the data.
+ * @param sent_len How many bytes of the data were already sent. This is
+ * updated with every byte that gets sent.
+ * @return Return code. SWICC_RET_NET_INCOMPLETE if the socket would block.
  */
-static swicc_ret_et msg_send(int32_t const sock,
-                             swicc_net_msg_st const *const msg)
+static swicc_ret_et buf_send_part(int32_t const sock, uint8_t const *const buf,
+                                  uint32_t const buf_len,
+                                  uint32_t *const sent_len)
 {
-    if (sock < 0)
+    while (*sent_len < buf_len)
     {
-        logger("Invalid socket FD, expected >=0 got %i.", sock);
-        return SWICC_RET_PARAM_BAD;
+        /**
+         * A peer that went away must not kill the whole process with a
+         * SIGPIPE, it is reported as a failure to send instead.
+         */
+        ssize_t const sent_bytes =
+            send(sock, &buf[*sent_len], buf_len - *sent_len, MSG_NOSIGNAL);
+        if (sent_bytes < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+            {
+                return SWICC_RET_NET_INCOMPLETE;
+            }
+            logger("Call to send() failed: %s.", strerror(errno));
+            return SWICC_RET_ERROR;
+        }
+        /* Safe cast since at most the requested number of bytes is sent. */
+        *sent_len += (uint32_t)sent_bytes;
     }
+    return SWICC_RET_SUCCESS;
+}
 
+/**
+ * @brief Send (the rest of) a message to a given socket.
+ * @param sock The socket where the message will be sent.
+ * @param msg Message to send.
+ * @param sent_len How many bytes of the message were already sent. This is
+ * updated with every byte that gets sent.
+ * @return Return code. SWICC_RET_NET_INCOMPLETE if the socket would block.
+ */
+static swicc_ret_et msg_send_part(int32_t const sock,
+                                  swicc_net_msg_st const *const msg,
+                                  uint32_t *const sent_len)
+{
     if (msg->hdr.size > sizeof(msg->data))
     {
         logger(
@@ -50,95 +105,185 @@ static swicc_ret_et msg_send(int32_t const sock,
     /* Safe cast since the target type can fit the sum of cast ones. */
     uint32_t const size_msg =
         (uint32_t)sizeof(swicc_net_msg_hdr_st) + msg->hdr.size;
-    int64_t const sent_bytes = send(sock, &msg->hdr, size_msg, 0U);
-    if (sent_bytes == size_msg)
-    {
-        /* Success. */
-    }
-    else if (sent_bytes < 0)
-    {
-        logger("Call to send() failed: %s.", strerror(errno));
-    }
-    else
-    {
-        logger("Failed to send message.");
-        return SWICC_RET_ERROR;
-    }
+    return buf_send_part(sock, (uint8_t const *)msg, size_msg, sent_len);
+}
 
-    if (sent_bytes != size_msg)
+/**
+ * @brief Get the size of a message that is being received.
+ * @param msg The message being received.
+ * @param recvd_len How many bytes of the message were already received.
+ * @param size_msg Where the size gets written. Until the whole header is
+ * received, this is only the size of the header.
+ * @return Return code.
+ */
+static swicc_ret_et msg_recv_size(swicc_net_msg_st const *const msg,
+                                  uint32_t const recvd_len,
+                                  uint32_t *const size_msg)
+{
+    *size_msg = sizeof(swicc_net_msg_hdr_st);
+    if (recvd_len >= *size_msg)
     {
-        logger("Failed to send all the message bytes.");
-        return SWICC_RET_ERROR;
+        /**
+         * Check if the indicated size is too large for the static message data
+         * buffer.
+         */
+        if (msg->hdr.size > sizeof(msg->data) ||
+            msg->hdr.size < offsetof(swicc_net_msg_data_st, buf))
+        {
+            logger(
+                "Value of the size field in the message header is too large. Got %u, expected %lu >= n <= %lu.",
+                msg->hdr.size, offsetof(swicc_net_msg_data_st, buf),
+                sizeof(msg->data));
+            return SWICC_RET_ERROR;
+        }
+        *size_msg += msg->hdr.size;
     }
-
     return SWICC_RET_SUCCESS;
 }
 
 /**
- * @brief Receive a message from a given socket.
+ * @brief Receive (the rest of) a message from a given socket. The message is
+ * received straight into its destination, continuing after any earlier short
+ * reads. It never reads past the end of the message so the next one stays in
+ * the socket.
  * @param sock The socket from which to receive a message.
  * @param msg Where to write the received message.
- * @return Number of received bytes on success, -1 on failure.
+ * @param recvd_len How many bytes of the message were already received. This
+ * is updated with every byte that gets received.
+ * @return Return code. SWICC_RET_NET_INCOMPLETE if the socket would block.
  */
-static swicc_ret_et msg_recv(int32_t const sock, swicc_net_msg_st *const msg)
+static swicc_ret_et msg_recv_part(int32_t const sock,
+                                  swicc_net_msg_st *const msg,
+                                  uint32_t *const recvd_len)
 {
-    if (sock < 0)
+    uint8_t *const msg_raw = (uint8_t *)msg;
+    while (true)
     {
-        logger("Invalid socket FD, expected >=0 got %i.", sock);
-        return SWICC_RET_PARAM_BAD;
+        /* The size of the message is known only once the header is in. */
+        uint32_t size_msg;
+        if (msg_recv_size(msg, *recvd_len, &size_msg) != SWICC_RET_SUCCESS)
+        {
+            return SWICC_RET_ERROR;
+        }
+        if (*recvd_len == size_msg)
+        {
+            return SWICC_RET_SUCCESS;
+        }
+
+        ssize_t const recvd_bytes =
+            recv(sock, &msg_raw[*recvd_len], size_msg - *recvd_len, 0);
+        if (recvd_bytes < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+            {
+                return SWICC_RET_NET_INCOMPLETE;
+            }
+            logger("Call to recv() failed: %s.", strerror(errno));
+            return SWICC_RET_ERROR;
+        }
+        else if (recvd_bytes == 0)
+        {
+            logger("Peer closed the connection: recvd_bytes=%u msg_len=%u.",
+                   *recvd_len, size_msg);
+            return SWICC_RET_ERROR;
+        }
+        /* Safe cast since at most the requested number of bytes is received. */
+        *recvd_len += (uint32_t)recvd_bytes;
     }
+}
 
-    bool recv_failure = false;
-    int64_t recvd_bytes;
-    recvd_bytes = recv(sock, &msg->hdr, sizeof(swicc_net_msg_hdr_st), 0U);
-    if (recvd_bytes < 0)
+/**
+ * @brief Wait until a socket is ready, for when a non-blocking socket is used
+ * with the blocking send and receive.
+ * @param sock
+ * @param events The poll events to wait for.
+ * @return Return code.
+ */
+static swicc_ret_et sock_wait(int32_t const sock, int16_t const events)
+{
+    struct pollfd pfd = {.fd = sock, .events = events, .revents = 0};
+    while (poll(&pfd, 1U, -1) < 0)
     {
-        logger("Call to recv() failed: %s.", strerror(errno));
-        return SWICC_RET_ERROR;
+        if (errno != EINTR)
+        {
+            logger("Call to poll() failed: %s.", strerror(errno));
+            return SWICC_RET_ERROR;
+        }
     }
-    do
+    return SWICC_RET_SUCCESS;
+}
+
+/**
+ * @brief Send a whole buffer to a given socket, waiting for the socket as
+ * needed.
+ * @param sock The socket where the data will be sent.
+ * @param buf Data to send.
+ * @param buf_len Length of the data.
+ * @return Return code.
+ */
+static swicc_ret_et buf_send(int32_t const sock, uint8_t const *const buf,
+                             uint32_t const buf_len)
+{
+    uint32_t sent_len = 0U;
+    swicc_ret_et ret;
+    while ((ret = buf_send_part(sock, buf, buf_len, &sent_len)) ==
+           SWICC_RET_NET_INCOMPLETE)
     {
-        /* Check if succeeded. */
-        if (recvd_bytes == sizeof(swicc_net_msg_hdr_st))
+        if (sock_wait(sock, POLLOUT) != SWICC_RET_SUCCESS)
         {
-            /**
-             * Check if the indicated size is too large for the static
-             * message data buffer.
-             */
-            if (msg->hdr.size > sizeof(msg->data) ||
-                msg->hdr.size < offsetof(swicc_net_msg_data_st, buf))
+            return SWICC_RET_ERROR;
+        }
+    }
+    return ret;
+}
+
+/**
+ * @brief Send a whole scattered buffer to a given socket with as few syscalls
+ * as possible, waiting for the socket as needed.
+ * @param sock The socket where the data will be sent.
+ * @param iov Parts of the data. These are modified to skip what was sent.
+ * @param iov_count Number of parts.
+ * @return Return code.
+ */
+static swicc_ret_et iov_send(int32_t const sock, struct iovec *iov,
+                             size_t iov_count)
+{
+    while (iov_count > 0U)
+    {
+        struct msghdr const msg_hdr = {.msg_iov = iov, .msg_iovlen = iov_count};
+        ssize_t const sent_bytes = sendmsg(sock, &msg_hdr, MSG_NOSIGNAL);
+        if (sent_bytes < 0)
+        {
+            if (errno == EINTR)
             {
-                logger(
-                    "Value of the size field in the message header is too large. Got %u, expected %lu >= n <= %lu.",
-                    msg->hdr.size, offsetof(swicc_net_msg_data_st, buf),
-                    sizeof(msg->data));
-                recv_failure = true;
-                break;
+                continue;
             }
-            recvd_bytes = recv(sock, &msg->data, msg->hdr.size, 0);
-            /**
-             * Make sure we received the whole message also the cast here is
-             * safe.
-             */
-            if (recvd_bytes != (int64_t)msg->hdr.size)
+            if ((errno == EAGAIN || errno == EWOULDBLOCK) &&
+                sock_wait(sock, POLLOUT) == SWICC_RET_SUCCESS)
             {
-                logger("Failed to receive the whole message.");
-                recv_failure = true;
-                break;
+                continue;
             }
+            logger("Call to sendmsg() failed: %s.", strerror(errno));
+            return SWICC_RET_ERROR;
         }
-        else
+
+        /* Skip the parts that were sent completely. */
+        size_t sent_len = (size_t)sent_bytes;
+        while (iov_count > 0U && sent_len >= iov->iov_len)
         {
-            logger(
-                "Failed to receive message header: recvd_bytes=%u header_len=%u.",
-                recvd_bytes, sizeof(swicc_net_msg_hdr_st));
-            recv_failure = true;
-            break;
+            sent_len -= iov->iov_len;
+            ++iov;
+            --iov_count;
+        }
+        if (iov_count > 0U)
+        {
+            iov->iov_base = (uint8_t *)iov->iov_base + sent_len;
+            iov->iov_len -= sent_len;
         }
-    } while (0U);
-    if (recv_failure)
-    {
-        return SWICC_RET_ERROR;
     }
     return SWICC_RET_SUCCESS;
 }
@@ -267,6 +412,42 @@ void swicc_net_client_sig_default()
     assert(signal(SIGTERM, SIG_DFL) != SIG_ERR);
 }
 
+/**
+ * @brief Create the address of a Unix domain socket.
+ * @param path Path of the socket. When it starts with '@', the rest of it is a
+ * name in the abstract namespace.
+ * @param sock_addr Where to write the address.
+ * @param sock_addr_len Where to write the length of the address.
+ * @return Return code.
+ */
+static swicc_ret_et unix_addr(char const *const path,
+                              struct sockaddr_un *const sock_addr,
+                              socklen_t *const sock_addr_len)
+{
+    size_t const path_len = strlen(path);
+    if (path_len == 0U || path_len >= sizeof(sock_addr->sun_path))
+    {
+        logger("Bad Unix socket path was given.");
+        return SWICC_RET_PARAM_BAD;
+    }
+
+    memset(sock_addr, 0U, sizeof(*sock_addr));
+    sock_addr->sun_family = AF_UNIX;
+    memcpy(sock_addr->sun_path, path, path_len);
+    /**
+     * Abstract names are not NUL-terminated so the length is what tells
+     * where they end.
+     */
+    if (path[0U] == '@')
+    {
+        sock_addr->sun_path[0U] = '\0';
+    }
+    /* Safe cast since the path is shorter than the path buffer. */
+    *sock_addr_len =
+        (socklen_t)(offsetof(struct sockaddr_un, sun_path) + path_len);
+    return SWICC_RET_SUCCESS;
+}
+
 swicc_ret_et swicc_net_server_create(swicc_net_server_st *const server_ctx,
                                      char const *const port_str)
 {
@@ -325,6 +506,66 @@ swicc_ret_et swicc_net_server_create(swicc_net_server_st *const server_ctx,
     return SWICC_RET_ERROR;
 }
 
+swicc_ret_et swicc_net_server_create_unix(swicc_net_server_st *const server_ctx,
+                                          char const *const path)
+{
+    struct sockaddr_un sock_addr;
+    socklen_t sock_addr_len;
+    if (unix_addr(path, &sock_addr, &sock_addr_len) != SWICC_RET_SUCCESS)
+    {
+        return SWICC_RET_PARAM_BAD;
+    }
+
+    /* Only ever remove sockets, never some other file at the same path. */
+    struct stat path_stat;
+    if (path[0U] != '@' && stat(path, &path_stat) == 0 &&
+        S_ISSOCK(path_stat.st_mode) && unlink(path) != 0)
+    {
+        logger("Call to unlink() failed: %s.", strerror(errno));
+    }
+
+    int32_t const sock = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (sock != -1)
+    {
+        if (bind(sock, (struct sockaddr *)&sock_addr, sock_addr_len) != -1)
+        {
+            if (listen(sock, SWICC_NET_CLIENT_COUNT_MAX) != -1)
+            {
+                if (fcntl(sock, F_SETFL, O_NONBLOCK) == 0U)
+                {
+                    logger("Listening on '%s'.", path);
+                    server_ctx->sock_server = sock;
+                    return SWICC_RET_SUCCESS;
+                }
+                else
+                {
+                    logger(
+                        "Failed to set listening socket to non-blocking: %s.",
+                        strerror(errno));
+                }
+            }
+            else
+            {
+                logger("Call to listen() failed: %s.", strerror(errno));
+            }
+        }
+        else
+        {
+            logger("Call to bind() failed: %s.", strerror(errno));
+        }
+        if (close(sock) == -1)
+        {
+            logger("Call to close() failed: %s.", strerror(errno));
+        }
+    }
+    else
+    {
+        logger("Call to socket() failed: %s.", strerror(errno));
+    }
+    logger("Failed to create a server socket.");
+    return SWICC_RET_ERROR;
+}
+
 void swicc_net_server_destroy(swicc_net_server_st *const server_ctx)
 {
     swicc_net_sock_close(server_ctx->sock_server);
@@ -388,6 +629,40 @@ swicc_ret_et swicc_net_client_create(swicc_net_client_st *const client_ctx,
     return SWICC_RET_ERROR;
 }
 
+swicc_ret_et swicc_net_client_create_unix(swicc_net_client_st *const client_ctx,
+                                          char const *const path)
+{
+    struct sockaddr_un sock_addr;
+    socklen_t sock_addr_len;
+    if (unix_addr(path, &sock_addr, &sock_addr_len) != SWICC_RET_SUCCESS)
+    {
+        return SWICC_RET_PARAM_BAD;
+    }
+
+    int32_t const sock = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (sock != -1)
+    {
+        if (connect(sock, (struct sockaddr *)&sock_addr, sock_addr_len) == 0)
+        {
+            client_ctx->sock_client = sock;
+            return SWICC_RET_SUCCESS;
+        }
+        else
+        {
+            logger("Call to connect() failed: %s.", strerror(errno));
+        }
+        if (close(sock) == -1)
+        {
+            logger("Call to close() failed: %s.", strerror(errno));
+        }
+    }
+    else
+    {
+        logger("Call to socket() failed: %s.", strerror(errno));
+    }
+    return SWICC_RET_ERROR;
+}
+
 void swicc_net_client_destroy(swicc_net_client_st *const client_ctx)
 {
     if (client_ctx->sock_client >= 0)
@@ -405,7 +680,17 @@ swicc_ret_et swicc_net_recv(int32_t const sock, swicc_net_msg_st *const msg)
         return SWICC_RET_PARAM_BAD;
     }
 
-    if (msg_recv(sock, msg) == SWICC_RET_SUCCESS)
+    uint32_t recvd_len = 0U;
+    swicc_ret_et ret;
+    while ((ret = msg_recv_part(sock, msg, &recvd_len)) ==
+           SWICC_RET_NET_INCOMPLETE)
+    {
+        if (sock_wait(sock, POLLIN) != SWICC_RET_SUCCESS)
+        {
+            break;
+        }
+    }
+    if (ret == SWICC_RET_SUCCESS)
     {
         return SWICC_RET_SUCCESS;
     }
@@ -423,7 +708,17 @@ swicc_ret_et swicc_net_send(int32_t const sock,
         return SWICC_RET_PARAM_BAD;
     }
 
-    if (msg_send(sock, msg) == SWICC_RET_SUCCESS)
+    if (msg->hdr.size > sizeof(msg->data))
+    {
+        logger(
+            "Message header indicates a data size larger than the buffer itself.");
+        return SWICC_RET_PARAM_BAD;
+    }
+
+    /* Safe cast since the target type can fit the sum of cast ones. */
+    uint32_t const size_msg =
+        (uint32_t)sizeof(swicc_net_msg_hdr_st) + msg->hdr.size;
+    if (buf_send(sock, (uint8_t const *)msg, size_msg) == SWICC_RET_SUCCESS)
     {
         return SWICC_RET_SUCCESS;
     }
@@ -432,6 +727,105 @@ swicc_ret_et swicc_net_send(int32_t const sock,
     return SWICC_RET_ERROR;
 }
 
+swicc_ret_et swicc_net_recv_part(int32_t const sock,
+                                 swicc_net_msg_st *const msg,
+                                 uint32_t *const recvd_len)
+{
+    if (sock < 0 || msg == NULL || recvd_len == NULL)
+    {
+        return SWICC_RET_PARAM_BAD;
+    }
+    return msg_recv_part(sock, msg, recvd_len);
+}
+
+swicc_ret_et swicc_net_send_part(int32_t const sock,
+                                 swicc_net_msg_st const *const msg,
+                                 uint32_t *const sent_len)
+{
+    if (sock < 0 || msg == NULL || sent_len == NULL)
+    {
+        return SWICC_RET_PARAM_BAD;
+    }
+    return msg_send_part(sock, msg, sent_len);
+}
+
+swicc_ret_et swicc_net_batch_send(int32_t const sock,
+                                  swicc_net_msg_st const *const msg,
+                                  uint32_t const count)
+{
+    if (sock < 0 || (msg == NULL && count > 0U) ||
+        count > SWICC_NET_BATCH_COUNT_MAX)
+    {
+        return SWICC_RET_PARAM_BAD;
+    }
+
+    /**
+     * The batch request is followed by all the requests, they are sent
+     * together straight from where they are without copying them.
+     */
+    struct iovec iov[SWICC_NET_BATCH_COUNT_MAX + 1U];
+    swicc_net_msg_st msg_batch;
+    memset(&msg_batch, 0U, sizeof(msg_batch));
+    msg_batch.hdr.size = offsetof(swicc_net_msg_data_st, buf) + 1U;
+    msg_batch.data.ctrl = SWICC_NET_MSG_CTRL_BATCH;
+    /* Safe cast since the count is not larger than the max batch count. */
+    msg_batch.data.buf[0U] = (uint8_t)count;
+    iov[0U].iov_base = &msg_batch;
+    iov[0U].iov_len = sizeof(msg_batch.hdr) + msg_batch.hdr.size;
+    for (uint32_t msg_idx = 0U; msg_idx < count; ++msg_idx)
+    {
+        if (msg[msg_idx].hdr.size > sizeof(msg[msg_idx].data))
+        {
+            logger(
+                "Message header indicates a data size larger than the buffer itself.");
+            return SWICC_RET_PARAM_BAD;
+        }
+        /* Sending does not modify the messages. */
+        iov[msg_idx + 1U].iov_base = (swicc_net_msg_st *)&msg[msg_idx];
+        iov[msg_idx + 1U].iov_len =
+            sizeof(swicc_net_msg_hdr_st) + msg[msg_idx].hdr.size;
+    }
+
+    if (iov_send(sock, iov, count + 1U) == SWICC_RET_SUCCESS)
+    {
+        return SWICC_RET_SUCCESS;
+    }
+    logger("Failed to send batch.");
+    return SWICC_RET_ERROR;
+}
+
+swicc_ret_et swicc_net_batch_recv(int32_t const sock,
+                                  swicc_net_msg_st *const msg,
+                                  uint32_t const count)
+{
+    if (sock < 0 || (msg == NULL && count > 0U) ||
+        count > SWICC_NET_BATCH_COUNT_MAX)
+    {
+        return SWICC_RET_PARAM_BAD;
+    }
+
+    swicc_net_msg_st msg_batch;
+    if (swicc_net_recv(sock, &msg_batch) != SWICC_RET_SUCCESS)
+    {
+        return SWICC_RET_ERROR;
+    }
+    if (msg_batch.data.ctrl != SWICC_NET_MSG_CTRL_SUCCESS ||
+        msg_batch.hdr.size != offsetof(swicc_net_msg_data_st, buf) + 1U ||
+        msg_batch.data.buf[0U] != count)
+    {
+        logger("Client did not accept the batch.");
+        return SWICC_RET_ERROR;
+    }
+    for (uint32_t msg_idx = 0U; msg_idx < count; ++msg_idx)
+    {
+        if (swicc_net_recv(sock, &msg[msg_idx]) != SWICC_RET_SUCCESS)
+        {
+            return SWICC_RET_ERROR;
+        }
+    }
+    return SWICC_RET_SUCCESS;
+}
+
 swicc_ret_et swicc_net_server_client_connect(
     swicc_net_server_st *const server_ctx, uint16_t const slot)
 {
@@ -449,7 +843,13 @@ swicc_ret_et swicc_net_server_client_connect(
     int32_t const sock = accept(server_ctx->sock_server, NULL, NULL);
     if (sock >= 0)
     {
-        if (SWICC_NET_SERVER_CLIENT_KEEPALIVE == 1)
+        int32_t sock_domain = AF_INET;
+        socklen_t sock_domain_len = sizeof(sock_domain);
+        /* Keep-alive only exists for TCP, not for Unix domain sockets. */
+        if (SWICC_NET_SERVER_CLIENT_KEEPALIVE == 1 &&
+            getsockopt(sock, SOL_SOCKET, SO_DOMAIN, &sock_domain,
+                       &sock_domain_len) == 0 &&
+            sock_domain == AF_INET)
         {
             /**
              * Enable keep-alive to detect when the ICC is ejected as soon as
@@ -499,18 +899,44 @@ swicc_ret_et swicc_net_server_client_connect(
     }
 }
 
-void swicc_net_server_client_disconnect(swicc_net_server_st *const server_ctx,
-                                        uint16_t const slot)
+swicc_ret_et swicc_net_server_client_pair(
+    swicc_net_server_st *const server_ctx, uint16_t const slot,
+    swicc_net_client_st *const client_ctx)
 {
-    if (slot > SWICC_NET_CLIENT_COUNT_MAX)
+    if (slot >= SWICC_NET_CLIENT_COUNT_MAX)
     {
         logger("Requested slot is not present.");
-        return;
+        return SWICC_RET_PARAM_BAD;
     }
-    if (server_ctx->sock_client[slot] < 0)
+    if (server_ctx->sock_client[slot] != -1)
     {
-        logger("Invalid socket FD, expected >=0 got %i.",
-               server_ctx->sock_client[slot]);
+        logger("Value of socket must be -1 before pairing.");
+        return SWICC_RET_PARAM_BAD;
+    }
+
+    int32_t sock_pair[2U];
+    if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sock_pair) != 0)
+    {
+        logger("Call to socketpair() failed: %s.", strerror(errno));
+        return SWICC_RET_ERROR;
+    }
+    server_ctx->sock_client[slot] = sock_pair[0U];
+    client_ctx->sock_client = sock_pair[1U];
+    return SWICC_RET_SUCCESS;
+}
+
+void swicc_net_server_client_disconnect(swicc_net_server_st *const server_ctx,
+                                        uint16_t const slot)
+{
+    if (slot > SWICC_NET_CLIENT_COUNT_MAX)
+    {
+        logger("Requested slot is not present.");
+        return;
+    }
+    if (server_ctx->sock_client[slot] < 0)
+    {
+        logger("Invalid socket FD, expected >=0 got %i.",
+               server_ctx->sock_client[slot]);
         return;
     }
 
@@ -524,16 +950,282 @@ void swicc_net_server_client_disconnect(swicc_net_server_st *const server_ctx,
     return;
 }
 
+/**
+ * @brief Handle a message received by a client, i.e., perform the requested
+ * control operation or pass the data to swICC, and create the response.
+ * @param swicc_state The card which received the message.
+ * @param msg_rx The received message.
+ * @param msg_tx Where the response will be written.
+ * @param dbg_buf Buffer of the client for creating debug strings. Must have
+ * the size of a network debug buffer.
+ * @return Return code. On success, the response shall be sent back.
+ */
+static swicc_ret_et client_msg_handle(swicc_st *const swicc_state,
+                                      swicc_net_msg_st *const msg_rx,
+                                      swicc_net_msg_st *const msg_tx,
+                                      char *const dbg_buf)
+{
+    uint16_t dbg_buf_len;
+
+    if (SWICC_NET_CLIENT_LOG_KEEPALIVE ||
+        msg_rx->data.ctrl != SWICC_NET_MSG_CTRL_KEEPALIVE)
+    {
+        dbg_buf_len = SWICC_NET_DBG_BUF_SIZE;
+        if (swicc_dbg_net_msg_str(dbg_buf, &dbg_buf_len, "RX:\n", msg_rx) ==
+            SWICC_RET_SUCCESS)
+        {
+            logger("%.*s", dbg_buf_len, dbg_buf);
+        }
+    }
+
+    static_assert(
+        offsetof(swicc_net_msg_data_st, buf) < UINT8_MAX,
+        "Data buffer is offset further than 255 bytes into message data which leads to an unsafe cast.");
+    /**
+     * Safe cast since buf is not offset further than 255 bytes (as
+     * asserted).
+     */
+    uint32_t const buf_rx_len =
+        msg_rx->hdr.size - (uint8_t)offsetof(swicc_net_msg_data_st, buf);
+    if (buf_rx_len > UINT16_MAX)
+    {
+        return SWICC_RET_ERROR;
+    }
+
+    /* Perform control operations first. */
+    if (msg_rx->data.ctrl != 0U)
+    {
+        /**
+         * Control operations may send back data and have to indicate
+         * success or failure hence these values are set to defaults
+         * before performing the requested operation.
+         */
+        msg_tx->data.ctrl = SWICC_NET_MSG_CTRL_FAILURE;
+        msg_tx->hdr.size = offsetof(swicc_net_msg_data_st, buf);
+
+        switch (msg_rx->data.ctrl)
+        {
+        case SWICC_NET_MSG_CTRL_KEEPALIVE:
+            msg_tx->data.ctrl = SWICC_NET_MSG_CTRL_SUCCESS;
+            break;
+        case SWICC_NET_MSG_CTRL_MOCK_RESET_WARM_PPS_Y:
+        case SWICC_NET_MSG_CTRL_MOCK_RESET_WARM_PPS_N:
+            /**
+             * A warm reset is not a cold reset but functionally they
+             * are the same.
+             */
+        case SWICC_NET_MSG_CTRL_MOCK_RESET_COLD_PPS_Y:
+        case SWICC_NET_MSG_CTRL_MOCK_RESET_COLD_PPS_N:
+            if (swicc_mock_reset_cold(
+                    swicc_state,
+                    msg_rx->data.ctrl ==
+                            SWICC_NET_MSG_CTRL_MOCK_RESET_WARM_PPS_Y ||
+                        msg_rx->data.ctrl ==
+                            SWICC_NET_MSG_CTRL_MOCK_RESET_COLD_PPS_Y) ==
+                SWICC_RET_SUCCESS)
+            {
+                static_assert(
+                    sizeof(swicc_atr) <= sizeof(msg_tx->data.buf),
+                    "Card ATR does not fit in the message data buffer.");
+                memcpy(msg_tx->data.buf, swicc_atr, sizeof(swicc_atr));
+                msg_tx->hdr.size =
+                    offsetof(swicc_net_msg_data_st, buf) + sizeof(swicc_atr);
+                msg_tx->data.ctrl = SWICC_NET_MSG_CTRL_SUCCESS;
+            }
+            break;
+        }
+
+        /**
+         * These data members shall not be modified by the control
+         * operations because they represent the state of the ICC after
+         * the request.
+         */
+        msg_tx->data.cont_state = swicc_state->cont_state_tx;
+        msg_tx->data.buf_len_exp = swicc_state->buf_rx_len;
+    }
+    else
+    {
+        /* Handle data. */
+        swicc_state->buf_rx = msg_rx->data.buf;
+        swicc_state->buf_rx_len =
+            (uint16_t)buf_rx_len; /* Safe cast due to bound check. */
+        /* The card writes its response straight into the message. */
+        swicc_state->buf_tx = msg_tx->data.buf;
+        swicc_state->buf_tx_len = sizeof(msg_tx->data.buf);
+#ifdef DEBUG_NET_MSG
+        static_assert(
+            offsetof(swicc_net_msg_data_st, buf) < UINT16_MAX,
+            "Unsafe cast since offset is larger than what uint16 can hold.");
+        swicc_tpdu_cmd_st tpdu_debug;
+        if (swicc_tpdu_cmd_parse(
+                msg_rx->data.buf,
+                (uint16_t)(msg_rx->hdr.size -
+                           offsetof(swicc_net_msg_data_st, buf)),
+                &tpdu_debug) == SWICC_RET_SUCCESS)
+        {
+            dbg_buf_len = SWICC_NET_DBG_BUF_SIZE;
+            if (swicc_dbg_tpdu_cmd_str(dbg_buf, &dbg_buf_len, &tpdu_debug) ==
+                SWICC_RET_SUCCESS)
+            {
+                logger("%.*s", dbg_buf_len, dbg_buf);
+            }
+            else
+            {
+                logger("Failed to create debug string of TPDU.");
+            }
+        }
+        else
+        {
+            logger("Failed to parse data as a TPDU.");
+        }
+#endif
+        swicc_io(swicc_state);
+
+        /* Prepare response. */
+        if (sizeof(msg_tx->data.cont_state) + swicc_state->buf_tx_len >
+            UINT32_MAX)
+        {
+            return SWICC_RET_ERROR;
+        }
+        /* Safe cast because it was checked. */
+        msg_tx->hdr.size = (uint32_t)(offsetof(swicc_net_msg_data_st, buf) +
+                                      swicc_state->buf_tx_len);
+        msg_tx->data.cont_state = swicc_state->cont_state_tx;
+        msg_tx->data.ctrl = SWICC_NET_MSG_CTRL_SUCCESS;
+        msg_tx->data.buf_len_exp = swicc_state->buf_rx_len;
+    }
+
+    if (SWICC_NET_CLIENT_LOG_KEEPALIVE ||
+        msg_rx->data.ctrl != SWICC_NET_MSG_CTRL_KEEPALIVE)
+    {
+        dbg_buf_len = SWICC_NET_DBG_BUF_SIZE;
+        if (swicc_dbg_net_msg_str(dbg_buf, &dbg_buf_len, "TX:\n", msg_tx) ==
+            SWICC_RET_SUCCESS)
+        {
+            logger("%.*s", dbg_buf_len, dbg_buf);
+        }
+    }
+    return SWICC_RET_SUCCESS;
+}
+
+/**
+ * @brief Start handling a batch of requests. The response to the batch request
+ * itself is created at the start of the batch buffer.
+ * @param swicc_state The card which received the batch.
+ * @param batch The batch to start.
+ * @param msg_rx The batch request.
+ * @return Return code.
+ * @note A bad batch request is not an error, it gets a failure response (same
+ * as unknown control requests) and the batch ends right away.
+ */
+static swicc_ret_et batch_begin(swicc_st const *const swicc_state,
+                                swicc_net_batch_st *const batch,
+                                swicc_net_msg_st const *const msg_rx)
+{
+    swicc_net_msg_st *const msg_tx = (swicc_net_msg_st *)batch->buf;
+    msg_tx->hdr.size = offsetof(swicc_net_msg_data_st, buf) + 1U;
+    msg_tx->data.cont_state = swicc_state->cont_state_tx;
+    msg_tx->data.buf_len_exp = swicc_state->buf_rx_len;
+    msg_tx->data.ctrl = SWICC_NET_MSG_CTRL_FAILURE;
+    msg_tx->data.buf[0U] = 0U;
+
+    batch->active = true;
+    batch->count = 0U;
+    batch->idx = 0U;
+    batch->buf_len = sizeof(msg_tx->hdr) + msg_tx->hdr.size;
+    if (msg_rx->hdr.size != offsetof(swicc_net_msg_data_st, buf) + 1U ||
+        msg_rx->data.buf[0U] > SWICC_NET_BATCH_COUNT_MAX)
+    {
+        logger("Received an invalid batch request.");
+        return SWICC_RET_SUCCESS;
+    }
+    msg_tx->data.ctrl = SWICC_NET_MSG_CTRL_SUCCESS;
+    msg_tx->data.buf[0U] = msg_rx->data.buf[0U];
+    batch->count = msg_rx->data.buf[0U];
+    return SWICC_RET_SUCCESS;
+}
+
+/**
+ * @brief Handle one request of a batch. The response is created in place
+ * right after the earlier responses of the batch.
+ * @param swicc_state The card which received the batch.
+ * @param batch The batch which the request is part of.
+ * @param msg_rx The request.
+ * @param dbg_buf Same as for handling a single message.
+ * @return Return code.
+ */
+static swicc_ret_et batch_msg_handle(swicc_st *const swicc_state,
+                                     swicc_net_batch_st *const batch,
+                                     swicc_net_msg_st *const msg_rx,
+                                     char *const dbg_buf)
+{
+    if (msg_rx->data.ctrl == SWICC_NET_MSG_CTRL_BATCH)
+    {
+        logger("Batches can not be nested.");
+        return SWICC_RET_ERROR;
+    }
+
+    /**
+     * There is always room for a whole message after the earlier responses
+     * since every response is at most the size of a message.
+     */
+    swicc_net_msg_st *const msg_tx =
+        (swicc_net_msg_st *)&batch->buf[batch->buf_len];
+    swicc_ret_et const ret =
+        client_msg_handle(swicc_state, msg_rx, msg_tx, dbg_buf);
+    if (ret != SWICC_RET_SUCCESS)
+    {
+        return ret;
+    }
+    batch->buf_len += (uint32_t)sizeof(msg_tx->hdr) + msg_tx->hdr.size;
+    batch->idx += 1U;
+    return SWICC_RET_SUCCESS;
+}
+
+/**
+ * @brief Receive and handle all requests of a batch then send back all the
+ * responses in one write.
+ * @param swicc_state The card which received the batch.
+ * @param client_ctx The client which received the batch.
+ * @param batch Where the batch is handled.
+ * @param msg_rx The batch request, it is reused for receiving the requests.
+ * @param dbg_buf Same as for handling a single message.
+ * @return Return code.
+ */
+static swicc_ret_et client_batch(swicc_st *const swicc_state,
+                                 swicc_net_client_st *const client_ctx,
+                                 swicc_net_batch_st *const batch,
+                                 swicc_net_msg_st *const msg_rx,
+                                 char *const dbg_buf)
+{
+    if (batch_begin(swicc_state, batch, msg_rx) != SWICC_RET_SUCCESS)
+    {
+        return SWICC_RET_ERROR;
+    }
+    while (batch->idx < batch->count)
+    {
+        if (swicc_net_recv(client_ctx->sock_client, msg_rx) !=
+                SWICC_RET_SUCCESS ||
+            batch_msg_handle(swicc_state, batch, msg_rx, dbg_buf) !=
+                SWICC_RET_SUCCESS)
+        {
+            return SWICC_RET_ERROR;
+        }
+    }
+    batch->active = false;
+    return buf_send(client_ctx->sock_client, batch->buf, batch->buf_len);
+}
+
 swicc_ret_et swicc_net_client(swicc_st *const swicc_state,
                               swicc_net_client_st *const client_ctx)
 {
     /* For debugging. */
-    static char dbg_buf[2048U];
-    uint16_t dbg_buf_len;
+    char dbg_buf[SWICC_NET_DBG_BUF_SIZE];
 
     swicc_ret_et ret = SWICC_RET_ERROR;
     swicc_net_msg_st msg_rx;
     swicc_net_msg_st msg_tx;
+    swicc_net_batch_st batch;
 
     swicc_state->buf_rx = msg_rx.data.buf;
     swicc_state->buf_rx_len = 0U;
@@ -545,174 +1237,1877 @@ swicc_ret_et swicc_net_client(swicc_st *const swicc_state,
            swicc_net_recv(client_ctx->sock_client, &msg_rx) ==
                SWICC_RET_SUCCESS)
     {
-        if (SWICC_NET_CLIENT_LOG_KEEPALIVE ||
-            msg_rx.data.ctrl != SWICC_NET_MSG_CTRL_KEEPALIVE)
+        if (msg_rx.data.ctrl == SWICC_NET_MSG_CTRL_BATCH)
         {
-            dbg_buf_len = sizeof(dbg_buf);
-            if (swicc_dbg_net_msg_str(dbg_buf, &dbg_buf_len, "RX:\n",
-                                      &msg_rx) == SWICC_RET_SUCCESS)
+            if (client_batch(swicc_state, client_ctx, &batch, &msg_rx,
+                             dbg_buf) != SWICC_RET_SUCCESS)
             {
-                logger("%.*s", dbg_buf_len, dbg_buf);
+                ret = SWICC_RET_ERROR;
+                break;
             }
         }
+        else if (client_msg_handle(swicc_state, &msg_rx, &msg_tx, dbg_buf) !=
+                     SWICC_RET_SUCCESS ||
+                 swicc_net_send(client_ctx->sock_client, &msg_tx) !=
+                     SWICC_RET_SUCCESS)
+        {
+            ret = SWICC_RET_ERROR;
+            break;
+        }
 
-        static_assert(
-            offsetof(swicc_net_msg_data_st, buf) < UINT8_MAX,
-            "Data buffer is offset further than 255 bytes into message data which leads to an unsafe cast.");
         /**
-         * Safe cast since buf is not offset further than 255 bytes (as
-         * asserted).
+         * Useful to see if client got disconnected or failed to connect at
+         * all.
          */
-        uint32_t const buf_rx_len =
-            msg_rx.hdr.size - (uint8_t)offsetof(swicc_net_msg_data_st, buf);
+        msg_received = true;
+    }
 
-        if (buf_rx_len <= UINT16_MAX)
-        {
-            /* Perform control operations first. */
-            if (msg_rx.data.ctrl != 0U)
-            {
-                /**
-                 * Control operations may send back data and have to indicate
-                 * success or failure hence these values are set to defaults
-                 * before performing the requested operation.
-                 */
-                msg_tx.data.ctrl = SWICC_NET_MSG_CTRL_FAILURE;
-                msg_tx.hdr.size = offsetof(swicc_net_msg_data_st, buf);
-
-                switch (msg_rx.data.ctrl)
-                {
-                case SWICC_NET_MSG_CTRL_KEEPALIVE:
-                    msg_tx.data.ctrl = SWICC_NET_MSG_CTRL_SUCCESS;
-                    break;
-                case SWICC_NET_MSG_CTRL_MOCK_RESET_WARM_PPS_Y:
-                case SWICC_NET_MSG_CTRL_MOCK_RESET_WARM_PPS_N:
-                    /**
-                     * A warm reset is not a cold reset but functionally they
-                     * are the same.
-                     */
-                case SWICC_NET_MSG_CTRL_MOCK_RESET_COLD_PPS_Y:
-                case SWICC_NET_MSG_CTRL_MOCK_RESET_COLD_PPS_N:
-                    if (swicc_mock_reset_cold(
-                            swicc_state,
-                            msg_rx.data.ctrl ==
-                                    SWICC_NET_MSG_CTRL_MOCK_RESET_WARM_PPS_Y ||
-                                msg_rx.data.ctrl ==
-                                    SWICC_NET_MSG_CTRL_MOCK_RESET_COLD_PPS_Y) ==
-                        SWICC_RET_SUCCESS)
-                    {
-                        static_assert(
-                            sizeof(swicc_atr) <= sizeof(msg_tx.data.buf),
-                            "Card ATR does not fit in the message data buffer.");
-                        memcpy(msg_tx.data.buf, swicc_atr, sizeof(swicc_atr));
-                        msg_tx.hdr.size = offsetof(swicc_net_msg_data_st, buf) +
-                                          sizeof(swicc_atr);
-                        msg_tx.data.ctrl = SWICC_NET_MSG_CTRL_SUCCESS;
-                    }
-                    break;
-                }
+    if (swicc_state->shutdown == true)
+    {
+        return SWICC_RET_SUCCESS;
+    }
+    if (ret != SWICC_RET_SUCCESS && msg_received)
+    {
+        return SWICC_RET_NET_DISCONNECTED;
+    }
+    return ret;
+}
 
-                /**
-                 * These data members shall not be modified by the control
-                 * operations because they represent the state of the ICC after
-                 * the request.
-                 */
-                msg_tx.data.cont_state = swicc_state->cont_state_tx;
-                msg_tx.data.buf_len_exp = swicc_state->buf_rx_len;
+/**
+ * The top bit of a shared memory ring index is set when the side which writes
+ * the index goes away. Since the other side sleeps on the index, this wakes it
+ * up without any chance of missing the wake-up.
+ */
+#define SHM_IDX_CLOSED 0x80000000U
+#define SHM_IDX_MASK 0x7FFFFFFFU
+static_assert((SWICC_NET_SHM_SLOT_COUNT & (SWICC_NET_SHM_SLOT_COUNT - 1U)) ==
+                  0U,
+              "Count of slots of a shared memory ring is not a power of two.");
 
-                if (swicc_net_send(client_ctx->sock_client, &msg_tx) !=
-                    SWICC_RET_SUCCESS)
-                {
-                    ret = SWICC_RET_ERROR;
-                    break;
-                }
-            }
-            else
-            {
-                /* Handle data. */
-                swicc_state->buf_rx = msg_rx.data.buf;
-                swicc_state->buf_rx_len =
-                    (uint16_t)buf_rx_len; /* Safe cast due to bound check. */
-                swicc_state->buf_tx = msg_tx.data.buf;
-                swicc_state->buf_tx_len = sizeof(msg_tx.data.buf);
-#ifdef DEBUG_NET_MSG
-                static_assert(
-                    offsetof(swicc_net_msg_data_st, buf) < UINT16_MAX,
-                    "Unsafe cast since offset is larger than what uint16 can hold.");
-                swicc_tpdu_cmd_st tpdu_debug;
-                if (swicc_tpdu_cmd_parse(
-                        msg_rx.data.buf,
-                        (uint16_t)(msg_rx.hdr.size -
-                                   offsetof(swicc_net_msg_data_st, buf)),
-                        &tpdu_debug) == SWICC_RET_SUCCESS)
-                {
-                    dbg_buf_len = sizeof(dbg_buf);
-                    if (swicc_dbg_tpdu_cmd_str(dbg_buf, &dbg_buf_len,
-                                               &tpdu_debug) ==
-                        SWICC_RET_SUCCESS)
-                    {
-                        logger("%.*s", dbg_buf_len, dbg_buf);
-                    }
-                    else
-                    {
-                        logger("Failed to create debug string of TPDU.");
-                    }
-                }
-                else
-                {
-                    logger("Failed to parse data as a TPDU.");
-                }
+/**
+ * @brief Tell the CPU that this is a spin-wait loop.
+ */
+static void shm_spin_pause(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    __asm__ volatile("yield");
 #endif
-                swicc_io(swicc_state);
+}
 
-                /* Prepare response. */
-                if (sizeof(msg_tx.data.cont_state) + swicc_state->buf_tx_len >
-                    UINT32_MAX)
-                {
-                    break;
-                }
-                /* Safe cast because it was checked. */
-                msg_tx.hdr.size =
-                    (uint32_t)(offsetof(swicc_net_msg_data_st, buf) +
-                               swicc_state->buf_tx_len);
-                msg_tx.data.cont_state = swicc_state->cont_state_tx;
-                msg_tx.data.ctrl = SWICC_NET_MSG_CTRL_SUCCESS;
-                msg_tx.data.buf_len_exp = swicc_state->buf_rx_len;
-                memcpy(msg_tx.data.buf, swicc_state->buf_tx,
-                       swicc_state->buf_tx_len);
-                if (swicc_net_send(client_ctx->sock_client, &msg_tx) !=
-                    SWICC_RET_SUCCESS)
-                {
-                    ret = SWICC_RET_ERROR;
-                    break;
-                }
-            }
+/**
+ * @brief Wake up the other side of a shared memory transport sleeping on an
+ * index.
+ * @param idx
+ * @param count How many sleepers to wake up at most.
+ */
+static void shm_wake(uint32_t *const idx, int32_t const count)
+{
+    if (syscall(SYS_futex, idx, FUTEX_WAKE, count, NULL, NULL, 0) < 0)
+    {
+        logger("Call to futex() failed: %s.", strerror(errno));
+    }
+}
 
-            /**
-             * Useful to see if client got disconnected or failed to connect at
-             * all.
-             */
-            msg_received = true;
+/**
+ * @brief Wait until the other side of a shared memory transport changes an
+ * index. It spins for a short while first and then sleeps.
+ * @param shm
+ * @param idx The index written by the other side.
+ * @param idx_old Value of the index which means there is nothing to do yet.
+ * @param waiting Flag telling the other side to wake this side up.
+ * @return Return code.
+ */
+static swicc_ret_et shm_wait(swicc_net_shm_st const *const shm,
+                             uint32_t *const idx, uint32_t const idx_old,
+                             uint32_t *const waiting)
+{
+    for (uint32_t spin_idx = 0U; spin_idx < shm->spin_count; ++spin_idx)
+    {
+        if (__atomic_load_n(idx, __ATOMIC_ACQUIRE) != idx_old)
+        {
+            return SWICC_RET_SUCCESS;
+        }
+        shm_spin_pause();
+    }
 
-            if (SWICC_NET_CLIENT_LOG_KEEPALIVE ||
-                msg_rx.data.ctrl != SWICC_NET_MSG_CTRL_KEEPALIVE)
-            {
-                dbg_buf_len = sizeof(dbg_buf);
-                if (swicc_dbg_net_msg_str(dbg_buf, &dbg_buf_len, "TX:\n",
-                                          &msg_tx) == SWICC_RET_SUCCESS)
-                {
-                    logger("%.*s", dbg_buf_len, dbg_buf);
-                }
-            }
+    swicc_ret_et ret = SWICC_RET_SUCCESS;
+    /**
+     * The other side first moves the index then checks the flag, so either
+     * this sees the new index or the other side sees the flag.
+     */
+    __atomic_store_n(waiting, 1U, __ATOMIC_SEQ_CST);
+    while (__atomic_load_n(idx, __ATOMIC_SEQ_CST) == idx_old)
+    {
+        if (syscall(SYS_futex, idx, FUTEX_WAIT, idx_old, NULL, NULL, 0) < 0 &&
+            errno != EAGAIN && errno != EINTR)
+        {
+            logger("Call to futex() failed: %s.", strerror(errno));
+            ret = SWICC_RET_ERROR;
+            break;
         }
     }
+    __atomic_store_n(waiting, 0U, __ATOMIC_RELAXED);
+    return ret;
+}
 
-    if (swicc_state->shutdown == true)
+/**
+ * @brief Get the oldest message in a ring, waiting for one if there is none.
+ * The message stays in the ring until it is released.
+ * @param shm
+ * @param ring A ring this side consumes.
+ * @param msg Where the pointer to the message gets written.
+ * @return Return code. Fails when the ring is empty and the producer went away.
+ */
+static swicc_ret_et shm_ring_msg_get(swicc_net_shm_st const *const shm,
+                                     swicc_net_shm_ring_st *const ring,
+                                     swicc_net_msg_st **const msg)
+{
+    uint32_t const head = ring->head;
+    uint32_t tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+    while ((tail & SHM_IDX_MASK) == head)
     {
-        return SWICC_RET_SUCCESS;
+        if ((tail & SHM_IDX_CLOSED) != 0U)
+        {
+            logger("Peer closed the shared memory transport.");
+            return SWICC_RET_ERROR;
+        }
+        if (shm_wait(shm, &ring->tail, tail, &ring->consumer_waiting) !=
+            SWICC_RET_SUCCESS)
+        {
+            return SWICC_RET_ERROR;
+        }
+        tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
     }
-    if (ret != SWICC_RET_SUCCESS && msg_received)
+
+    *msg = &ring->slot[head % SWICC_NET_SHM_SLOT_COUNT];
+    uint32_t size_msg;
+    return msg_recv_size(*msg, sizeof((*msg)->hdr), &size_msg);
+}
+
+/**
+ * @brief Release the oldest message in a ring so its slot can be reused.
+ * @param ring
+ */
+static void shm_ring_msg_release(swicc_net_shm_ring_st *const ring)
+{
+    __atomic_store_n(&ring->head, (ring->head + 1U) & SHM_IDX_MASK,
+                     __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&ring->producer_waiting, __ATOMIC_SEQ_CST) != 0U)
     {
-        return SWICC_RET_NET_DISCONNECTED;
+        shm_wake(&ring->head, 1);
     }
-    return ret;
+}
+
+/**
+ * @brief Get the next free slot of a ring, waiting for one if the ring is
+ * full. The message in it is sent once the slot is committed.
+ * @param shm
+ * @param ring A ring this side produces.
+ * @param msg Where the pointer to the slot gets written.
+ * @return Return code. Fails when the consumer went away.
+ */
+static swicc_ret_et shm_ring_slot_get(swicc_net_shm_st const *const shm,
+                                      swicc_net_shm_ring_st *const ring,
+                                      swicc_net_msg_st **const msg)
+{
+    uint32_t const tail = ring->tail;
+    uint32_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    while ((head & SHM_IDX_CLOSED) != 0U ||
+           ((tail - head) & SHM_IDX_MASK) >= SWICC_NET_SHM_SLOT_COUNT)
+    {
+        if ((head & SHM_IDX_CLOSED) != 0U)
+        {
+            logger("Peer closed the shared memory transport.");
+            return SWICC_RET_ERROR;
+        }
+        if (shm_wait(shm, &ring->head, head, &ring->producer_waiting) !=
+            SWICC_RET_SUCCESS)
+        {
+            return SWICC_RET_ERROR;
+        }
+        head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    }
+    *msg = &ring->slot[tail % SWICC_NET_SHM_SLOT_COUNT];
+    return SWICC_RET_SUCCESS;
+}
+
+/**
+ * @brief Commit the next free slot of a ring, i.e., send the message in it.
+ * @param ring
+ */
+static void shm_ring_slot_commit(swicc_net_shm_ring_st *const ring)
+{
+    __atomic_store_n(&ring->tail, (ring->tail + 1U) & SHM_IDX_MASK,
+                     __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&ring->consumer_waiting, __ATOMIC_SEQ_CST) != 0U)
+    {
+        shm_wake(&ring->tail, 1);
+    }
+}
+
+/**
+ * @brief Finish creating a side of a shared memory transport once its segment
+ * is open.
+ * @param shm
+ * @param fd The open segment.
+ * @return Return code.
+ */
+static swicc_ret_et shm_map(swicc_net_shm_st *const shm, int32_t const fd)
+{
+    void *const seg = mmap(NULL, sizeof(*shm->seg), PROT_READ | PROT_WRITE,
+                           MAP_SHARED, fd, 0);
+    if (close(fd) == -1)
+    {
+        logger("Call to close() failed: %s.", strerror(errno));
+    }
+    if (seg == MAP_FAILED)
+    {
+        logger("Call to mmap() failed: %s.", strerror(errno));
+        return SWICC_RET_ERROR;
+    }
+    shm->seg = seg;
+    /* Spinning on a single CPU would only keep the other side from running. */
+    shm->spin_count =
+        sysconf(_SC_NPROCESSORS_ONLN) > 1 ? SWICC_NET_SHM_SPIN_COUNT : 0U;
+    return SWICC_RET_SUCCESS;
+}
+
+swicc_ret_et swicc_net_shm_server_create(swicc_net_shm_st *const shm,
+                                         char const *const name)
+{
+    if (shm == NULL || name == NULL ||
+        strlen(name) >= SWICC_NET_SHM_NAME_LEN_MAX)
+    {
+        return SWICC_RET_PARAM_BAD;
+    }
+
+    memset(shm, 0U, sizeof(*shm));
+    strcpy(shm->name, name);
+    /* A segment left behind by a server which did not exit cleanly. */
+    if (shm_unlink(name) != 0 && errno != ENOENT)
+    {
+        logger("Call to shm_unlink() failed: %s.", strerror(errno));
+        return SWICC_RET_ERROR;
+    }
+    int32_t const fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC,
+                                S_IRUSR | S_IWUSR);
+    if (fd < 0)
+    {
+        logger("Call to shm_open() failed: %s.", strerror(errno));
+        return SWICC_RET_ERROR;
+    }
+    /* The segment starts zeroed, i.e., with empty rings. */
+    /* Safe cast since the segment is small. */
+    if (ftruncate(fd, (off_t)sizeof(*shm->seg)) != 0)
+    {
+        logger("Call to ftruncate() failed: %s.", strerror(errno));
+        close(fd);
+        shm_unlink(name);
+        return SWICC_RET_ERROR;
+    }
+    if (shm_map(shm, fd) != SWICC_RET_SUCCESS)
+    {
+        shm_unlink(name);
+        return SWICC_RET_ERROR;
+    }
+    shm->server = true;
+    return SWICC_RET_SUCCESS;
+}
+
+swicc_ret_et swicc_net_shm_client_create(swicc_net_shm_st *const shm,
+                                         char const *const name)
+{
+    if (shm == NULL || name == NULL ||
+        strlen(name) >= SWICC_NET_SHM_NAME_LEN_MAX)
+    {
+        return SWICC_RET_PARAM_BAD;
+    }
+
+    memset(shm, 0U, sizeof(*shm));
+    strcpy(shm->name, name);
+    int32_t const fd = shm_open(name, O_RDWR | O_CLOEXEC, 0U);
+    if (fd < 0)
+    {
+        logger("Call to shm_open() failed: %s.", strerror(errno));
+        return SWICC_RET_ERROR;
+    }
+    struct stat fd_stat;
+    if (fstat(fd, &fd_stat) != 0 || fd_stat.st_size < 0 ||
+        (uint64_t)fd_stat.st_size != sizeof(*shm->seg))
+    {
+        logger("Shared memory segment is not one of a swICC transport.");
+        close(fd);
+        return SWICC_RET_ERROR;
+    }
+    return shm_map(shm, fd);
+}
+
+void swicc_net_shm_destroy(swicc_net_shm_st *const shm)
+{
+    if (shm == NULL || shm->seg == NULL)
+    {
+        return;
+    }
+
+    swicc_net_shm_ring_st *const ring_tx =
+        shm->server ? &shm->seg->req : &shm->seg->res;
+    swicc_net_shm_ring_st *const ring_rx =
+        shm->server ? &shm->seg->res : &shm->seg->req;
+    __atomic_or_fetch(&ring_tx->tail, SHM_IDX_CLOSED, __ATOMIC_SEQ_CST);
+    __atomic_or_fetch(&ring_rx->head, SHM_IDX_CLOSED, __ATOMIC_SEQ_CST);
+    shm_wake(&ring_tx->tail, INT32_MAX);
+    shm_wake(&ring_rx->head, INT32_MAX);
+
+    if (munmap(shm->seg, sizeof(*shm->seg)) != 0)
+    {
+        logger("Call to munmap() failed: %s.", strerror(errno));
+    }
+    if (shm->server && shm_unlink(shm->name) != 0 && errno != ENOENT)
+    {
+        logger("Call to shm_unlink() failed: %s.", strerror(errno));
+    }
+    memset(shm, 0U, sizeof(*shm));
+}
+
+swicc_ret_et swicc_net_shm_send(swicc_net_shm_st *const shm,
+                                swicc_net_msg_st const *const msg)
+{
+    if (shm == NULL || shm->seg == NULL || msg == NULL)
+    {
+        return SWICC_RET_PARAM_BAD;
+    }
+    if (msg->hdr.size > sizeof(msg->data))
+    {
+        logger(
+            "Message header indicates a data size larger than the buffer itself.");
+        return SWICC_RET_PARAM_BAD;
+    }
+
+    swicc_net_shm_ring_st *const ring =
+        shm->server ? &shm->seg->req : &shm->seg->res;
+    swicc_net_msg_st *slot;
+    if (shm_ring_slot_get(shm, ring, &slot) != SWICC_RET_SUCCESS)
+    {
+        return SWICC_RET_ERROR;
+    }
+    memcpy(slot, msg, sizeof(msg->hdr) + msg->hdr.size);
+    shm_ring_slot_commit(ring);
+    return SWICC_RET_SUCCESS;
+}
+
+swicc_ret_et swicc_net_shm_recv(swicc_net_shm_st *const shm,
+                                swicc_net_msg_st *const msg)
+{
+    if (shm == NULL || shm->seg == NULL || msg == NULL)
+    {
+        return SWICC_RET_PARAM_BAD;
+    }
+
+    swicc_net_shm_ring_st *const ring =
+        shm->server ? &shm->seg->res : &shm->seg->req;
+    swicc_net_msg_st *slot;
+    if (shm_ring_msg_get(shm, ring, &slot) != SWICC_RET_SUCCESS)
+    {
+        return SWICC_RET_ERROR;
+    }
+    memcpy(msg, slot, sizeof(slot->hdr) + slot->hdr.size);
+    shm_ring_msg_release(ring);
+    return SWICC_RET_SUCCESS;
+}
+
+swicc_ret_et swicc_net_client_shm(swicc_st *const swicc_state,
+                                  swicc_net_shm_st *const shm)
+{
+    if (swicc_state == NULL || shm == NULL || shm->seg == NULL || shm->server)
+    {
+        return SWICC_RET_PARAM_BAD;
+    }
+
+    /* For debugging. */
+    char dbg_buf[SWICC_NET_DBG_BUF_SIZE];
+
+    swicc_ret_et ret = SWICC_RET_ERROR;
+    swicc_net_shm_ring_st *const ring_rx = &shm->seg->req;
+    swicc_net_shm_ring_st *const ring_tx = &shm->seg->res;
+    swicc_state->buf_rx_len = 0U;
+
+    bool msg_received = false;
+    while (swicc_state->shutdown == false)
+    {
+        swicc_net_msg_st *msg_rx;
+        swicc_net_msg_st *msg_tx;
+        if (shm_ring_msg_get(shm, ring_rx, &msg_rx) != SWICC_RET_SUCCESS ||
+            shm_ring_slot_get(shm, ring_tx, &msg_tx) != SWICC_RET_SUCCESS)
+        {
+            break;
+        }
+
+        /* Handle the request and create the response in place. */
+        swicc_state->buf_rx = msg_rx->data.buf;
+        swicc_state->buf_tx = msg_tx->data.buf;
+        swicc_state->buf_tx_len = sizeof(msg_tx->data.buf);
+        if (client_msg_handle(swicc_state, msg_rx, msg_tx, dbg_buf) !=
+            SWICC_RET_SUCCESS)
+        {
+            break;
+        }
+        shm_ring_msg_release(ring_rx);
+        shm_ring_slot_commit(ring_tx);
+        msg_received = true;
+    }
+
+    if (swicc_state->shutdown == true)
+    {
+        return SWICC_RET_SUCCESS;
+    }
+    if (ret != SWICC_RET_SUCCESS && msg_received)
+    {
+        return SWICC_RET_NET_DISCONNECTED;
+    }
+    return ret;
+}
+
+/**
+ * @brief Get the response of a card which is to be sent, i.e., all the
+ * responses of a batch or the one response to a single request.
+ * @param card
+ * @param buf Where the pointer to the response gets written.
+ * @param buf_len Where the length of the response gets written.
+ * @return Return code.
+ */
+static swicc_ret_et mux_card_tx_buf(swicc_net_mux_card_st const *const card,
+                                    uint8_t const **const buf,
+                                    uint32_t *const buf_len)
+{
+    if (card->batch.active)
+    {
+        *buf = card->batch.buf;
+        *buf_len = card->batch.buf_len;
+        return SWICC_RET_SUCCESS;
+    }
+    if (card->msg_tx.hdr.size > sizeof(card->msg_tx.data))
+    {
+        logger(
+            "Message header indicates a data size larger than the buffer itself.");
+        return SWICC_RET_PARAM_BAD;
+    }
+    *buf = (uint8_t const *)&card->msg_tx;
+    /* Safe cast since the target type can fit the sum of cast ones. */
+    *buf_len = (uint32_t)sizeof(card->msg_tx.hdr) + card->msg_tx.hdr.size;
+    return SWICC_RET_SUCCESS;
+}
+
+/**
+ * @brief Handle a request of a card which was received completely.
+ * @param mux The client serving the card.
+ * @param card The card which received the request.
+ * @return Return code. SWICC_RET_NET_INCOMPLETE when the request is part of a
+ * batch and the rest of the batch is yet to be received, otherwise the
+ * response is ready to be sent on success.
+ */
+static swicc_ret_et mux_card_msg_handle(swicc_net_mux_st *const mux,
+                                        swicc_net_mux_card_st *const card)
+{
+    swicc_ret_et ret;
+    card->msg_rx_len = 0U;
+    if (card->batch.active)
+    {
+        ret = batch_msg_handle(card->swicc_state, &card->batch, &card->msg_rx,
+                               mux->dbg_buf);
+    }
+    else if (card->msg_rx.data.ctrl == SWICC_NET_MSG_CTRL_BATCH)
+    {
+        ret = batch_begin(card->swicc_state, &card->batch, &card->msg_rx);
+    }
+    else
+    {
+        ret = client_msg_handle(card->swicc_state, &card->msg_rx,
+                                &card->msg_tx, mux->dbg_buf);
+    }
+    if (ret != SWICC_RET_SUCCESS)
+    {
+        return ret;
+    }
+    if (card->batch.active && card->batch.idx < card->batch.count)
+    {
+        return SWICC_RET_NET_INCOMPLETE;
+    }
+    card->msg_tx_len = 0U;
+    return SWICC_RET_SUCCESS;
+}
+
+/* Tag of the completion of the wake-up read, no card ever gets this tag. */
+#define URING_TAG_WAKE UINT64_MAX
+
+/**
+ * Most rounds of submitting the queued I/O and handling its completions in one
+ * poll, so that a card which never stops sending can't keep the poll going.
+ */
+#define URING_POLL_ROUND_COUNT_MAX 64U
+
+struct swicc_net_uring_s
+{
+    int32_t fd;
+    int32_t fd_wake; /* Signaled when cards get added. */
+    uint64_t wake_val;
+
+    /* Both queues are in one mapping of the ring. */
+    void *ring;
+    size_t ring_size;
+
+    /* Submission queue. */
+    uint32_t sq_entry_count;
+    uint32_t sq_pending; /* Queued but not submitted yet. */
+    uint32_t *sq_head;
+    uint32_t *sq_tail;
+    uint32_t *sq_mask;
+    uint32_t *sq_array;
+    struct io_uring_sqe *sqe;
+
+    /* Completion queue. */
+    uint32_t *cq_head;
+    uint32_t *cq_tail;
+    uint32_t *cq_mask;
+    struct io_uring_cqe *cqe;
+
+    /**
+     * Cards being served, by slot. The generation of a slot changes whenever
+     * a card starts or stops using it, so completions for a removed card are
+     * recognized even when its memory already belongs to another card.
+     */
+    swicc_net_mux_card_st *card[SWICC_NET_URING_CARD_COUNT_MAX];
+    uint32_t card_gen[SWICC_NET_URING_CARD_COUNT_MAX];
+
+    /* Cards that were added (possibly by other threads) but are not served. */
+    pthread_mutex_t add_mutex;
+    uint32_t add_count; /* Accessed atomically. */
+    swicc_net_mux_card_st *add[SWICC_NET_URING_CARD_COUNT_MAX];
+};
+
+/**
+ * @brief Call io_uring_register() on the io_uring of a client. There is no
+ * wrapper for it in libc.
+ * @param uring
+ * @param opcode
+ * @param arg
+ * @param arg_count
+ * @return Same as the syscall.
+ */
+static int32_t uring_register(swicc_net_uring_st const *const uring,
+                              uint32_t const opcode, void const *const arg,
+                              uint32_t const arg_count)
+{
+    /* Safe cast since the syscall returns an int. */
+    return (int32_t)syscall(__NR_io_uring_register, uring->fd, opcode, arg,
+                            arg_count);
+}
+
+/**
+ * @brief Get the tag of the I/O of a card, identifying both the card and the
+ * slot generation.
+ * @param uring
+ * @param slot Slot of the card.
+ * @return The tag.
+ */
+static uint64_t uring_card_tag(swicc_net_uring_st const *const uring,
+                               uint32_t const slot)
+{
+    return ((uint64_t)uring->card_gen[slot] << 32U) | slot;
+}
+
+/**
+ * @brief Submit all queued I/O and optionally wait for completions.
+ * @param uring
+ * @param timeout_ms How long to wait for a completion at most. 0 means to not
+ * wait at all and negative means to wait indefinitely.
+ * @return Return code.
+ */
+static swicc_ret_et uring_submit(swicc_net_uring_st *const uring,
+                                 int32_t const timeout_ms)
+{
+    struct __kernel_timespec const timeout = {
+        .tv_sec = timeout_ms / 1000,
+        .tv_nsec = (timeout_ms % 1000) * 1000000,
+    };
+    struct io_uring_getevents_arg const arg = {
+        .ts = (uint64_t)(uintptr_t)&timeout,
+    };
+    uint32_t flags = 0U;
+    uint32_t complete_min = 0U;
+    if (timeout_ms != 0)
+    {
+        flags |= IORING_ENTER_GETEVENTS;
+        complete_min = 1U;
+    }
+    if (timeout_ms > 0)
+    {
+        flags |= IORING_ENTER_EXT_ARG;
+    }
+
+    /* Safe cast since the syscall returns an int. */
+    int32_t const submitted = (int32_t)syscall(
+        __NR_io_uring_enter, uring->fd, uring->sq_pending, complete_min, flags,
+        (flags & IORING_ENTER_EXT_ARG) != 0U ? &arg : NULL,
+        (flags & IORING_ENTER_EXT_ARG) != 0U ? sizeof(arg) : 0U);
+    if (submitted < 0)
+    {
+        /**
+         * Timing out and getting interrupted by a signal (e.g., the one
+         * requesting a shutdown) are expected while waiting.
+         */
+        if (errno == ETIME || errno == EINTR)
+        {
+            return SWICC_RET_SUCCESS;
+        }
+        logger("Call to io_uring_enter() failed: %s.", strerror(errno));
+        return SWICC_RET_ERROR;
+    }
+    /* Safe cast since the count was checked to not be negative. */
+    uring->sq_pending -= (uint32_t)submitted;
+    return SWICC_RET_SUCCESS;
+}
+
+/**
+ * @brief Queue I/O on the io_uring. It gets submitted with the next submit.
+ * @param uring
+ * @param sqe The I/O to queue.
+ * @return Return code.
+ */
+static swicc_ret_et uring_queue(swicc_net_uring_st *const uring,
+                                struct io_uring_sqe const *const sqe)
+{
+    uint32_t const tail = *uring->sq_tail;
+    if (tail - __atomic_load_n(uring->sq_head, __ATOMIC_ACQUIRE) >=
+        uring->sq_entry_count)
+    {
+        logger("The io_uring submission queue is full.");
+        return SWICC_RET_ERROR;
+    }
+    uint32_t const sqe_idx = tail & *uring->sq_mask;
+    uring->sqe[sqe_idx] = *sqe;
+    uring->sq_array[sqe_idx] = sqe_idx;
+    __atomic_store_n(uring->sq_tail, tail + 1U, __ATOMIC_RELEASE);
+    uring->sq_pending += 1U;
+    return SWICC_RET_SUCCESS;
+}
+
+/**
+ * @brief Queue a read of the wake-up event.
+ * @param uring
+ * @return Return code.
+ */
+static swicc_ret_et uring_wake_rx(swicc_net_uring_st *const uring)
+{
+    struct io_uring_sqe const sqe = {
+        .opcode = IORING_OP_READ,
+        .fd = uring->fd_wake,
+        .addr = (uint64_t)(uintptr_t)&uring->wake_val,
+        .len = sizeof(uring->wake_val),
+        .user_data = URING_TAG_WAKE,
+    };
+    return uring_queue(uring, &sqe);
+}
+
+/**
+ * @brief Queue the receiving of (the rest of) the request of a card. Same as
+ * with epoll, it never reads past the end of the request.
+ * @param uring
+ * @param card
+ * @return Return code.
+ */
+static swicc_ret_et uring_card_rx(swicc_net_uring_st *const uring,
+                                  swicc_net_mux_card_st *const card)
+{
+    uint32_t size_msg;
+    if (msg_recv_size(&card->msg_rx, card->msg_rx_len, &size_msg) !=
+        SWICC_RET_SUCCESS)
+    {
+        return SWICC_RET_ERROR;
+    }
+
+    /**
+     * The whole card is registered so the request is received straight into
+     * a registered buffer.
+     */
+    uint8_t *const msg_raw = (uint8_t *)&card->msg_rx;
+    struct io_uring_sqe sqe = {
+        .opcode = IORING_OP_READ,
+        .fd = card->client_ctx.sock_client,
+        .addr = (uint64_t)(uintptr_t)&msg_raw[card->msg_rx_len],
+        .len = size_msg - card->msg_rx_len,
+        .user_data = uring_card_tag(uring, card->uring_slot),
+    };
+    if (card->uring_fixed)
+    {
+        sqe.opcode = IORING_OP_READ_FIXED;
+        /* Safe cast since the slot is less than the max card count. */
+        sqe.buf_index = (uint16_t)card->uring_slot;
+    }
+    return uring_queue(uring, &sqe);
+}
+
+/**
+ * @brief Queue the sending of (the rest of) the response of a card.
+ * @param uring
+ * @param card
+ * @return Return code.
+ * @note This is a send (not a write of the registered buffer) so a peer that
+ * went away is reported as a failure instead of raising SIGPIPE.
+ */
+static swicc_ret_et uring_card_tx(swicc_net_uring_st *const uring,
+                                  swicc_net_mux_card_st *const card)
+{
+    uint8_t const *buf;
+    uint32_t buf_len;
+    swicc_ret_et const ret = mux_card_tx_buf(card, &buf, &buf_len);
+    if (ret != SWICC_RET_SUCCESS)
+    {
+        return ret;
+    }
+    struct io_uring_sqe const sqe = {
+        .opcode = IORING_OP_SEND,
+        .fd = card->client_ctx.sock_client,
+        .addr = (uint64_t)(uintptr_t)&buf[card->msg_tx_len],
+        .len = buf_len - card->msg_tx_len,
+        .msg_flags = MSG_NOSIGNAL,
+        .user_data = uring_card_tag(uring, card->uring_slot),
+    };
+    return uring_queue(uring, &sqe);
+}
+
+/**
+ * @brief Make progress on the messages of a card whose receive or send
+ * completed: queue the rest of a short transfer, or once a request is complete,
+ * handle it and queue the response, or once a response is sent, queue the
+ * receiving of the next request.
+ * @param mux The client serving the card.
+ * @param card The card whose I/O completed.
+ * @param res Result of the I/O, i.e., number of bytes transferred or a negative
+ * error number.
+ * @return Return code.
+ */
+static swicc_ret_et uring_card_io(swicc_net_mux_st *const mux,
+                                  swicc_net_mux_card_st *const card,
+                                  int32_t const res)
+{
+    if (card->swicc_state->shutdown)
+    {
+        return SWICC_RET_SUCCESS;
+    }
+
+    swicc_ret_et ret = SWICC_RET_SUCCESS;
+    if (res == 0)
+    {
+        logger("Peer closed the connection.");
+        ret = SWICC_RET_ERROR;
+    }
+    else if (res < 0 && res != -EINTR && res != -EAGAIN)
+    {
+        logger("Card I/O on the io_uring failed: %s.", strerror(-res));
+        ret = SWICC_RET_ERROR;
+    }
+    else if (card->msg_tx_pending)
+    {
+        /* Safe cast since the result was checked to not be negative. */
+        card->msg_tx_len += res > 0 ? (uint32_t)res : 0U;
+        uint8_t const *buf;
+        uint32_t buf_len;
+        ret = mux_card_tx_buf(card, &buf, &buf_len);
+        if (ret == SWICC_RET_SUCCESS && card->msg_tx_len < buf_len)
+        {
+            ret = uring_card_tx(mux->uring, card);
+        }
+        else if (ret == SWICC_RET_SUCCESS)
+        {
+            card->batch.active = false;
+            card->msg_received = true;
+            card->msg_tx_pending = false;
+            ret = uring_card_rx(mux->uring, card);
+        }
+    }
+    else
+    {
+        /* Safe cast since the result was checked to not be negative. */
+        card->msg_rx_len += res > 0 ? (uint32_t)res : 0U;
+        uint32_t size_msg;
+        ret = msg_recv_size(&card->msg_rx, card->msg_rx_len, &size_msg);
+        if (ret == SWICC_RET_SUCCESS && card->msg_rx_len < size_msg)
+        {
+            ret = uring_card_rx(mux->uring, card);
+        }
+        else if (ret == SWICC_RET_SUCCESS)
+        {
+            ret = mux_card_msg_handle(mux, card);
+            if (ret == SWICC_RET_NET_INCOMPLETE)
+            {
+                ret = uring_card_rx(mux->uring, card);
+            }
+            else if (ret == SWICC_RET_SUCCESS)
+            {
+                card->msg_tx_pending = true;
+                ret = uring_card_tx(mux->uring, card);
+            }
+        }
+    }
+
+    if (ret == SWICC_RET_SUCCESS)
+    {
+        return SWICC_RET_SUCCESS;
+    }
+    return card->msg_received ? SWICC_RET_NET_DISCONNECTED : SWICC_RET_ERROR;
+}
+
+/**
+ * @brief Start serving a card: give it a slot and a registered buffer, then
+ * queue the receiving of its first request.
+ * @param mux
+ * @param card
+ * @return Return code.
+ */
+static swicc_ret_et uring_card_start(swicc_net_mux_st *const mux,
+                                     swicc_net_mux_card_st *const card)
+{
+    swicc_net_uring_st *const uring = mux->uring;
+    uint32_t slot = 0U;
+    while (slot < SWICC_NET_URING_CARD_COUNT_MAX && uring->card[slot] != NULL)
+    {
+        ++slot;
+    }
+    if (slot >= SWICC_NET_URING_CARD_COUNT_MAX)
+    {
+        logger("No free io_uring slot for a card.");
+        return SWICC_RET_ERROR;
+    }
+
+    int32_t const sock_flags = fcntl(card->client_ctx.sock_client, F_GETFL);
+    if (sock_flags < 0 || fcntl(card->client_ctx.sock_client, F_SETFL,
+                                sock_flags & ~O_NONBLOCK) != 0)
+    {
+        logger("Failed to set card socket to blocking: %s.", strerror(errno));
+        return SWICC_RET_ERROR;
+    }
+
+    /**
+     * Registering fails e.g. when over the locked memory limit, the card is
+     * then served the same way only without the registered buffer.
+     */
+    struct iovec const iov = {.iov_base = card, .iov_len = sizeof(*card)};
+    struct io_uring_rsrc_update2 const update = {
+        .offset = slot,
+        .data = (uint64_t)(uintptr_t)&iov,
+        .nr = 1U,
+    };
+    card->uring_fixed = uring_register(uring, IORING_REGISTER_BUFFERS_UPDATE,
+                                       &update, sizeof(update)) == 1;
+    if (!card->uring_fixed)
+    {
+        logger("Failed to register the buffer of a card: %s.",
+               strerror(errno));
+    }
+
+    card->uring_slot = slot;
+    uring->card[slot] = card;
+    uring->card_gen[slot] += 1U;
+    return uring_card_rx(uring, card);
+}
+
+/**
+ * @brief Stop serving a card. Its I/O may still be in flight and the card can
+ * be freed right after, so the I/O gets cancelled and this waits until the
+ * kernel is done with the card.
+ * @param mux
+ * @param card
+ * @return Return code.
+ */
+static swicc_ret_et uring_card_stop(swicc_net_mux_st *const mux,
+                                    swicc_net_mux_card_st *const card)
+{
+    swicc_net_uring_st *const uring = mux->uring;
+    if (__atomic_load_n(&uring->add_count, __ATOMIC_RELAXED) > 0U)
+    {
+        /* The card may not be served yet. */
+        bool found = false;
+        pthread_mutex_lock(&uring->add_mutex);
+        uint32_t const add_count = uring->add_count;
+        for (uint32_t add_idx = 0U; add_idx < add_count; ++add_idx)
+        {
+            if (uring->add[add_idx] == card)
+            {
+                uring->add[add_idx] = uring->add[add_count - 1U];
+                __atomic_store_n(&uring->add_count, add_count - 1U,
+                                 __ATOMIC_RELAXED);
+                found = true;
+                break;
+            }
+        }
+        pthread_mutex_unlock(&uring->add_mutex);
+        if (found)
+        {
+            __atomic_sub_fetch(&mux->card_count, 1U, __ATOMIC_RELAXED);
+            return SWICC_RET_SUCCESS;
+        }
+    }
+
+    uint32_t const slot = card->uring_slot;
+    if (slot >= SWICC_NET_URING_CARD_COUNT_MAX || uring->card[slot] != card)
+    {
+        logger("Card is not served by the multi-card client.");
+        return SWICC_RET_ERROR;
+    }
+
+    /* Only submitted I/O can be found and cancelled. */
+    while (uring->sq_pending > 0U)
+    {
+        if (uring_submit(uring, 0) != SWICC_RET_SUCCESS)
+        {
+            return SWICC_RET_ERROR;
+        }
+    }
+    struct io_uring_sync_cancel_reg const cancel = {
+        .addr = uring_card_tag(uring, slot),
+        .timeout = {.tv_sec = -1, .tv_nsec = -1},
+    };
+    if (uring_register(uring, IORING_REGISTER_SYNC_CANCEL, &cancel, 1U) != 0 &&
+        errno != ENOENT)
+    {
+        logger("Failed to cancel the I/O of a card: %s.", strerror(errno));
+        return SWICC_RET_ERROR;
+    }
+
+    if (card->uring_fixed)
+    {
+        struct iovec const iov = {.iov_base = NULL, .iov_len = 0U};
+        struct io_uring_rsrc_update2 const update = {
+            .offset = slot,
+            .data = (uint64_t)(uintptr_t)&iov,
+            .nr = 1U,
+        };
+        if (uring_register(uring, IORING_REGISTER_BUFFERS_UPDATE, &update,
+                           sizeof(update)) != 1)
+        {
+            logger("Failed to unregister the buffer of a card: %s.",
+                   strerror(errno));
+        }
+        card->uring_fixed = false;
+    }
+    uring->card[slot] = NULL;
+    uring->card_gen[slot] += 1U;
+    card->uring_slot = SWICC_NET_URING_CARD_COUNT_MAX;
+    __atomic_sub_fetch(&mux->card_count, 1U, __ATOMIC_RELAXED);
+    return SWICC_RET_SUCCESS;
+}
+
+/**
+ * @brief Remove a card which is no longer served and call the removal
+ * callback for it.
+ * @param mux
+ * @param card
+ * @return Return code.
+ */
+static swicc_ret_et mux_card_drop(swicc_net_mux_st *const mux,
+                                  swicc_net_mux_card_st *const card)
+{
+    /**
+     * Removing the card before the callback lets the user free it inside the
+     * callback.
+     */
+    if (swicc_net_mux_card_remove(mux, card) != SWICC_RET_SUCCESS)
+    {
+        return SWICC_RET_ERROR;
+    }
+    if (mux->card_rm_cb != NULL)
+    {
+        mux->card_rm_cb(mux, card);
+    }
+    return SWICC_RET_SUCCESS;
+}
+
+/**
+ * @brief Start serving all cards that were added since this was last done.
+ * @param mux
+ * @return Return code.
+ */
+static swicc_ret_et uring_card_start_added(swicc_net_mux_st *const mux)
+{
+    swicc_net_uring_st *const uring = mux->uring;
+    swicc_net_mux_card_st *add[SWICC_NET_URING_CARD_COUNT_MAX];
+    pthread_mutex_lock(&uring->add_mutex);
+    uint32_t const add_count = uring->add_count;
+    memcpy(add, uring->add, add_count * sizeof(add[0U]));
+    __atomic_store_n(&uring->add_count, 0U, __ATOMIC_RELAXED);
+    pthread_mutex_unlock(&uring->add_mutex);
+
+    for (uint32_t add_idx = 0U; add_idx < add_count; ++add_idx)
+    {
+        swicc_net_mux_card_st *const card = add[add_idx];
+        if (uring_card_start(mux, card) == SWICC_RET_SUCCESS)
+        {
+            continue;
+        }
+        card->ret = SWICC_RET_ERROR;
+        if (card->uring_slot < SWICC_NET_URING_CARD_COUNT_MAX &&
+            uring->card[card->uring_slot] == card)
+        {
+            if (mux_card_drop(mux, card) != SWICC_RET_SUCCESS)
+            {
+                return SWICC_RET_ERROR;
+            }
+            continue;
+        }
+        __atomic_sub_fetch(&mux->card_count, 1U, __ATOMIC_RELAXED);
+        if (mux->card_rm_cb != NULL)
+        {
+            mux->card_rm_cb(mux, card);
+        }
+    }
+    return SWICC_RET_SUCCESS;
+}
+
+/**
+ * @brief Handle all the completions which are ready.
+ * @param mux
+ * @return Return code.
+ */
+static swicc_ret_et uring_cqe_handle(swicc_net_mux_st *const mux)
+{
+    swicc_net_uring_st *const uring = mux->uring;
+    uint32_t cq_head = *uring->cq_head;
+    while (cq_head != __atomic_load_n(uring->cq_tail, __ATOMIC_ACQUIRE))
+    {
+        /* The entry is released first since handling it queues more I/O. */
+        struct io_uring_cqe const cqe = uring->cqe[cq_head & *uring->cq_mask];
+        cq_head += 1U;
+        __atomic_store_n(uring->cq_head, cq_head, __ATOMIC_RELEASE);
+
+        if (cqe.user_data == URING_TAG_WAKE)
+        {
+            if (uring_card_start_added(mux) != SWICC_RET_SUCCESS ||
+                uring_wake_rx(uring) != SWICC_RET_SUCCESS)
+            {
+                return SWICC_RET_ERROR;
+            }
+            continue;
+        }
+
+        /* Safe cast since the low half of the tag is the slot. */
+        uint32_t const slot = (uint32_t)(cqe.user_data & UINT32_MAX);
+        if (slot >= SWICC_NET_URING_CARD_COUNT_MAX ||
+            uring->card[slot] == NULL ||
+            cqe.user_data != uring_card_tag(uring, slot))
+        {
+            /* I/O of a card that was removed in the meantime. */
+            continue;
+        }
+        swicc_net_mux_card_st *const card = uring->card[slot];
+        card->ret = uring_card_io(mux, card, cqe.res);
+        if ((card->ret != SWICC_RET_SUCCESS || card->swicc_state->shutdown) &&
+            mux_card_drop(mux, card) != SWICC_RET_SUCCESS)
+        {
+            return SWICC_RET_ERROR;
+        }
+    }
+    return SWICC_RET_SUCCESS;
+}
+
+/**
+ * @brief Same as polling with epoll except all the I/O queued while handling
+ * messages is submitted together with waiting.
+ * @param mux
+ * @param timeout_ms
+ * @return Return code.
+ */
+static swicc_ret_et uring_poll(swicc_net_mux_st *const mux,
+                               int32_t const timeout_ms)
+{
+    swicc_net_uring_st *const uring = mux->uring;
+    if (__atomic_load_n(&uring->add_count, __ATOMIC_RELAXED) > 0U &&
+        uring_card_start_added(mux) != SWICC_RET_SUCCESS)
+    {
+        return SWICC_RET_ERROR;
+    }
+
+    /**
+     * Handling completions queues more I/O (e.g. the body after the header or
+     * the response after the request) and a receive of data that is already
+     * there completes right when it is submitted, so keep going while there is
+     * something to submit.
+     */
+    int32_t timeout_round_ms = timeout_ms;
+    for (uint32_t round = 0U; round < URING_POLL_ROUND_COUNT_MAX; ++round)
+    {
+        if (uring_submit(uring, timeout_round_ms) != SWICC_RET_SUCCESS ||
+            uring_cqe_handle(mux) != SWICC_RET_SUCCESS)
+        {
+            return SWICC_RET_ERROR;
+        }
+        if (uring->sq_pending == 0U)
+        {
+            break;
+        }
+        timeout_round_ms = 0;
+    }
+    return SWICC_RET_SUCCESS;
+}
+
+/**
+ * @brief Destroy the io_uring backend of a client (also a partially created
+ * one).
+ * @param mux
+ */
+static void uring_destroy(swicc_net_mux_st *const mux)
+{
+    swicc_net_uring_st *const uring = mux->uring;
+    if (uring->fd >= 0)
+    {
+        /* The cards may be freed right after so the kernel must be done. */
+        struct io_uring_sync_cancel_reg const cancel = {
+            .flags = IORING_ASYNC_CANCEL_ANY,
+            .timeout = {.tv_sec = -1, .tv_nsec = -1},
+        };
+        if (uring->ring != NULL &&
+            uring_register(uring, IORING_REGISTER_SYNC_CANCEL, &cancel, 1U) <
+                0 &&
+            errno != ENOENT)
+        {
+            logger("Failed to cancel the I/O of the io_uring: %s.",
+                   strerror(errno));
+        }
+        if (close(uring->fd) == -1)
+        {
+            logger("Call to close() failed: %s.", strerror(errno));
+        }
+    }
+    if (uring->sqe != NULL)
+    {
+        munmap(uring->sqe, uring->sq_entry_count * sizeof(*uring->sqe));
+    }
+    if (uring->ring != NULL)
+    {
+        munmap(uring->ring, uring->ring_size);
+    }
+    if (uring->fd_wake >= 0 && close(uring->fd_wake) == -1)
+    {
+        logger("Call to close() failed: %s.", strerror(errno));
+    }
+    pthread_mutex_destroy(&uring->add_mutex);
+    free(uring);
+    mux->uring = NULL;
+}
+
+/**
+ * @brief Create the io_uring backend of a client.
+ * @param mux
+ * @return Return code. On failure, the backend is already destroyed.
+ */
+static swicc_ret_et uring_create(swicc_net_mux_st *const mux)
+{
+    swicc_net_uring_st *const uring = malloc(sizeof(*uring));
+    if (uring == NULL)
+    {
+        return SWICC_RET_ERROR;
+    }
+    memset(uring, 0U, sizeof(*uring));
+    uring->fd = -1;
+    uring->fd_wake = -1;
+    if (pthread_mutex_init(&uring->add_mutex, NULL) != 0)
+    {
+        free(uring);
+        return SWICC_RET_ERROR;
+    }
+    mux->uring = uring;
+
+    /**
+     * Every card has at most one receive or send queued at a time so the
+     * queues always have room for all the cards.
+     */
+    struct io_uring_params params;
+    memset(&params, 0U, sizeof(params));
+    /**
+     * Completions are only ever reaped by the polling thread so it does not
+     * need to be interrupted when they are ready. Older kernels don't know
+     * this flag so they get a ring without it.
+     */
+    params.flags = IORING_SETUP_COOP_TASKRUN;
+    /* Safe cast since the syscall returns an int. */
+    uring->fd = (int32_t)syscall(__NR_io_uring_setup,
+                                 SWICC_NET_URING_CARD_COUNT_MAX * 2U, &params);
+    if (uring->fd < 0 && errno == EINVAL)
+    {
+        memset(&params, 0U, sizeof(params));
+        uring->fd = (int32_t)syscall(
+            __NR_io_uring_setup, SWICC_NET_URING_CARD_COUNT_MAX * 2U, &params);
+    }
+    if (uring->fd < 0)
+    {
+        logger("Call to io_uring_setup() failed: %s.", strerror(errno));
+        uring_destroy(mux);
+        return SWICC_RET_ERROR;
+    }
+    uint32_t const features = IORING_FEAT_SINGLE_MMAP | IORING_FEAT_NODROP |
+                              IORING_FEAT_SUBMIT_STABLE | IORING_FEAT_EXT_ARG;
+    if ((params.features & features) != features)
+    {
+        logger("The io_uring of the kernel lacks required features.");
+        uring_destroy(mux);
+        return SWICC_RET_ERROR;
+    }
+
+    size_t const ring_sq_size =
+        params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+    size_t const ring_cq_size =
+        params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    uring->ring_size =
+        ring_sq_size > ring_cq_size ? ring_sq_size : ring_cq_size;
+    uring->sq_entry_count = params.sq_entries;
+    void *const ring =
+        mmap(NULL, uring->ring_size, PROT_READ | PROT_WRITE,
+             MAP_SHARED | MAP_POPULATE, uring->fd, IORING_OFF_SQ_RING);
+    void *const sqe = mmap(NULL, params.sq_entries * sizeof(*uring->sqe),
+                           PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                           uring->fd, IORING_OFF_SQES);
+    uring->ring = ring == MAP_FAILED ? NULL : ring;
+    uring->sqe = sqe == MAP_FAILED ? NULL : sqe;
+    if (uring->ring == NULL || uring->sqe == NULL)
+    {
+        logger("Call to mmap() failed: %s.", strerror(errno));
+        uring_destroy(mux);
+        return SWICC_RET_ERROR;
+    }
+    uint8_t *const ring_raw = uring->ring;
+    uring->sq_head = (uint32_t *)&ring_raw[params.sq_off.head];
+    uring->sq_tail = (uint32_t *)&ring_raw[params.sq_off.tail];
+    uring->sq_mask = (uint32_t *)&ring_raw[params.sq_off.ring_mask];
+    uring->sq_array = (uint32_t *)&ring_raw[params.sq_off.array];
+    uring->cq_head = (uint32_t *)&ring_raw[params.cq_off.head];
+    uring->cq_tail = (uint32_t *)&ring_raw[params.cq_off.tail];
+    uring->cq_mask = (uint32_t *)&ring_raw[params.cq_off.ring_mask];
+    uring->cqe = (struct io_uring_cqe *)&ring_raw[params.cq_off.cqes];
+
+    /* Cards get their registered buffers when they start being served. */
+    struct io_uring_rsrc_register const buf_table = {
+        .nr = SWICC_NET_URING_CARD_COUNT_MAX,
+        .flags = IORING_RSRC_REGISTER_SPARSE,
+    };
+    if (uring_register(uring, IORING_REGISTER_BUFFERS2, &buf_table,
+                       sizeof(buf_table)) != 0)
+    {
+        logger("Failed to register the io_uring buffer table: %s.",
+               strerror(errno));
+        uring_destroy(mux);
+        return SWICC_RET_ERROR;
+    }
+
+    /**
+     * Removing cards relies on synchronous cancellation, it is checked by
+     * cancelling I/O which does not exist.
+     */
+    struct io_uring_sync_cancel_reg const cancel = {
+        .addr = 0U,
+        .timeout = {.tv_sec = -1, .tv_nsec = -1},
+    };
+    if (uring_register(uring, IORING_REGISTER_SYNC_CANCEL, &cancel, 1U) == 0 ||
+        errno != ENOENT)
+    {
+        logger("The io_uring of the kernel can't cancel synchronously.");
+        uring_destroy(mux);
+        return SWICC_RET_ERROR;
+    }
+
+    uring->fd_wake = eventfd(0U, EFD_CLOEXEC);
+    if (uring->fd_wake < 0)
+    {
+        logger("Call to eventfd() failed: %s.", strerror(errno));
+        uring_destroy(mux);
+        return SWICC_RET_ERROR;
+    }
+    if (uring_wake_rx(uring) != SWICC_RET_SUCCESS)
+    {
+        uring_destroy(mux);
+        return SWICC_RET_ERROR;
+    }
+    return SWICC_RET_SUCCESS;
+}
+
+/**
+ * @brief Queue a card to start being served by the next poll and wake up the
+ * poll in case it is waiting in another thread.
+ * @param mux
+ * @param card
+ * @return Return code.
+ */
+static swicc_ret_et uring_card_add(swicc_net_mux_st *const mux,
+                                   swicc_net_mux_card_st *const card)
+{
+    swicc_net_uring_st *const uring = mux->uring;
+    pthread_mutex_lock(&uring->add_mutex);
+    if (__atomic_load_n(&mux->card_count, __ATOMIC_RELAXED) >=
+        SWICC_NET_URING_CARD_COUNT_MAX)
+    {
+        pthread_mutex_unlock(&uring->add_mutex);
+        logger("The multi-card client can't serve more than %u cards.",
+               SWICC_NET_URING_CARD_COUNT_MAX);
+        return SWICC_RET_ERROR;
+    }
+    uring->add[uring->add_count] = card;
+    __atomic_store_n(&uring->add_count, uring->add_count + 1U,
+                     __ATOMIC_RELAXED);
+    __atomic_add_fetch(&mux->card_count, 1U, __ATOMIC_RELAXED);
+    pthread_mutex_unlock(&uring->add_mutex);
+
+    uint64_t const wake_val = 1U;
+    if (write(uring->fd_wake, &wake_val, sizeof(wake_val)) !=
+        sizeof(wake_val))
+    {
+        /* Not fatal, the card is started by the next poll regardless. */
+        logger("Call to write() failed: %s.", strerror(errno));
+    }
+    return SWICC_RET_SUCCESS;
+}
+
+swicc_ret_et swicc_net_mux_create(swicc_net_mux_st *const mux,
+                                  swicc_net_backend_et const backend)
+{
+    if (mux == NULL)
+    {
+        return SWICC_RET_PARAM_BAD;
+    }
+
+    memset(mux, 0U, sizeof(*mux));
+    mux->fd_epoll = -1;
+    if (backend == SWICC_NET_BACKEND_URING)
+    {
+        if (uring_create(mux) == SWICC_RET_SUCCESS)
+        {
+            mux->backend = SWICC_NET_BACKEND_URING;
+            return SWICC_RET_SUCCESS;
+        }
+        logger("The io_uring backend is not available, falling back to epoll.");
+    }
+
+    mux->backend = SWICC_NET_BACKEND_EPOLL;
+    mux->fd_epoll = epoll_create1(EPOLL_CLOEXEC);
+    if (mux->fd_epoll < 0)
+    {
+        logger("Call to epoll_create1() failed: %s.", strerror(errno));
+        return SWICC_RET_ERROR;
+    }
+    return SWICC_RET_SUCCESS;
+}
+
+void swicc_net_mux_destroy(swicc_net_mux_st *const mux)
+{
+    if (mux == NULL)
+    {
+        return;
+    }
+    if (mux->uring != NULL)
+    {
+        uring_destroy(mux);
+    }
+    if (mux->fd_epoll >= 0 && close(mux->fd_epoll) == -1)
+    {
+        logger("Call to close() failed: %s.", strerror(errno));
+    }
+    memset(mux, 0U, sizeof(*mux));
+    mux->fd_epoll = -1;
+}
+
+swicc_ret_et swicc_net_mux_card_add(swicc_net_mux_st *const mux,
+                                    swicc_net_mux_card_st *const card)
+{
+    if (mux == NULL || card == NULL || card->swicc_state == NULL ||
+        card->client_ctx.sock_client < 0)
+    {
+        return SWICC_RET_PARAM_BAD;
+    }
+
+    /**
+     * Same as the single-card client, swICC works on the message buffers. The
+     * card must be ready before it is added since it may get served (by
+     * another thread) right away.
+     */
+    card->swicc_state->buf_rx = card->msg_rx.data.buf;
+    card->swicc_state->buf_rx_len = 0U;
+    card->swicc_state->buf_tx = card->msg_tx.data.buf;
+    card->swicc_state->buf_tx_len = sizeof(card->msg_tx.data.buf);
+    card->msg_received = false;
+    card->msg_tx_pending = false;
+    card->batch.active = false;
+    card->msg_rx_len = 0U;
+    card->msg_tx_len = 0U;
+    card->uring_slot = SWICC_NET_URING_CARD_COUNT_MAX;
+    card->uring_fixed = false;
+    card->ret = SWICC_RET_SUCCESS;
+
+    if (mux->backend == SWICC_NET_BACKEND_URING)
+    {
+        return uring_card_add(mux, card);
+    }
+
+    int32_t const sock_flags = fcntl(card->client_ctx.sock_client, F_GETFL);
+    if (sock_flags < 0 || fcntl(card->client_ctx.sock_client, F_SETFL,
+                                sock_flags | O_NONBLOCK) != 0)
+    {
+        logger("Failed to set card socket to non-blocking: %s.",
+               strerror(errno));
+        return SWICC_RET_ERROR;
+    }
+
+    struct epoll_event evt = {.events = EPOLLIN, .data.ptr = card};
+    if (epoll_ctl(mux->fd_epoll, EPOLL_CTL_ADD, card->client_ctx.sock_client,
+                  &evt) != 0)
+    {
+        logger("Call to epoll_ctl() failed: %s.", strerror(errno));
+        return SWICC_RET_ERROR;
+    }
+    __atomic_add_fetch(&mux->card_count, 1U, __ATOMIC_RELAXED);
+    return SWICC_RET_SUCCESS;
+}
+
+swicc_ret_et swicc_net_mux_card_remove(swicc_net_mux_st *const mux,
+                                       swicc_net_mux_card_st *const card)
+{
+    if (mux == NULL || card == NULL)
+    {
+        return SWICC_RET_PARAM_BAD;
+    }
+    if (mux->backend == SWICC_NET_BACKEND_URING)
+    {
+        return uring_card_stop(mux, card);
+    }
+
+    if (epoll_ctl(mux->fd_epoll, EPOLL_CTL_DEL, card->client_ctx.sock_client,
+                  NULL) != 0)
+    {
+        logger("Call to epoll_ctl() failed: %s.", strerror(errno));
+        return SWICC_RET_ERROR;
+    }
+    /**
+     * The card may still have an event waiting to be handled in the current
+     * poll which must be dropped since the card may get freed right after.
+     */
+    for (uint32_t evt_idx = 0U; evt_idx < mux->evt_count; ++evt_idx)
+    {
+        if (mux->evt[evt_idx].data.ptr == card)
+        {
+            mux->evt[evt_idx].data.ptr = NULL;
+        }
+    }
+    __atomic_sub_fetch(&mux->card_count, 1U, __ATOMIC_RELAXED);
+    return SWICC_RET_SUCCESS;
+}
+
+/**
+ * @brief Change which socket events of a card the multi-card client waits for.
+ * @param mux
+ * @param card
+ * @param events Epoll events.
+ * @return Return code.
+ */
+static swicc_ret_et mux_card_evt_set(swicc_net_mux_st *const mux,
+                                     swicc_net_mux_card_st *const card,
+                                     uint32_t const events)
+{
+    struct epoll_event evt = {.events = events, .data.ptr = card};
+    if (epoll_ctl(mux->fd_epoll, EPOLL_CTL_MOD, card->client_ctx.sock_client,
+                  &evt) != 0)
+    {
+        logger("Call to epoll_ctl() failed: %s.", strerror(errno));
+        return SWICC_RET_ERROR;
+    }
+    return SWICC_RET_SUCCESS;
+}
+
+/**
+ * @brief Send (the rest of) the response of a card. If it can't be sent
+ * completely, the card waits only for its socket to become writable so no new
+ * requests are received until the response is sent.
+ * @param mux The client serving the card.
+ * @param card The card with a response to send.
+ * @return Return code.
+ */
+static swicc_ret_et mux_card_tx(swicc_net_mux_st *const mux,
+                                swicc_net_mux_card_st *const card)
+{
+    uint8_t const *buf;
+    uint32_t buf_len;
+    swicc_ret_et ret = mux_card_tx_buf(card, &buf, &buf_len);
+    if (ret == SWICC_RET_SUCCESS)
+    {
+        ret = buf_send_part(card->client_ctx.sock_client, buf, buf_len,
+                            &card->msg_tx_len);
+    }
+
+    if (ret == SWICC_RET_NET_INCOMPLETE)
+    {
+        if (card->msg_tx_pending)
+        {
+            return SWICC_RET_SUCCESS;
+        }
+        card->msg_tx_pending = true;
+        return mux_card_evt_set(mux, card, EPOLLOUT);
+    }
+    else if (ret != SWICC_RET_SUCCESS)
+    {
+        return ret;
+    }
+
+    card->batch.active = false;
+    card->msg_received = true;
+    if (card->msg_tx_pending)
+    {
+        card->msg_tx_pending = false;
+        return mux_card_evt_set(mux, card, EPOLLIN);
+    }
+    return SWICC_RET_SUCCESS;
+}
+
+/**
+ * @brief Make progress on the messages of a card whose socket is ready:
+ * finish sending the last response, or receive (a part of) a request and once
+ * it is complete, handle it and send back the response.
+ * @param mux The client serving the card.
+ * @param card The card whose socket is ready.
+ * @return Return code.
+ */
+static swicc_ret_et mux_card_io(swicc_net_mux_st *const mux,
+                                swicc_net_mux_card_st *const card)
+{
+    if (card->swicc_state->shutdown)
+    {
+        return SWICC_RET_SUCCESS;
+    }
+
+    swicc_ret_et ret;
+    if (card->msg_tx_pending)
+    {
+        ret = mux_card_tx(mux, card);
+    }
+    else
+    {
+        /**
+         * All requests of a batch are usually sent together so they are all
+         * handled in one go.
+         */
+        do
+        {
+            ret = msg_recv_part(card->client_ctx.sock_client, &card->msg_rx,
+                                &card->msg_rx_len);
+            if (ret != SWICC_RET_SUCCESS)
+            {
+                break;
+            }
+            ret = mux_card_msg_handle(mux, card);
+        } while (ret == SWICC_RET_NET_INCOMPLETE);
+
+        if (ret == SWICC_RET_SUCCESS)
+        {
+            ret = mux_card_tx(mux, card);
+        }
+    }
+
+    if (ret == SWICC_RET_SUCCESS || ret == SWICC_RET_NET_INCOMPLETE)
+    {
+        return SWICC_RET_SUCCESS;
+    }
+    return card->msg_received ? SWICC_RET_NET_DISCONNECTED : SWICC_RET_ERROR;
+}
+
+swicc_ret_et swicc_net_mux_poll(swicc_net_mux_st *const mux,
+                                int32_t const timeout_ms)
+{
+    if (mux == NULL)
+    {
+        return SWICC_RET_PARAM_BAD;
+    }
+    if (mux->backend == SWICC_NET_BACKEND_URING)
+    {
+        return uring_poll(mux, timeout_ms);
+    }
+
+    int32_t const evt_count =
+        epoll_wait(mux->fd_epoll, mux->evt, SWICC_NET_MUX_EVT_COUNT_MAX,
+                   timeout_ms);
+    if (evt_count < 0)
+    {
+        if (errno == EINTR)
+        {
+            /* Interrupted by a signal, e.g., the one requesting a shutdown. */
+            return SWICC_RET_SUCCESS;
+        }
+        logger("Call to epoll_wait() failed: %s.", strerror(errno));
+        return SWICC_RET_ERROR;
+    }
+    /* Safe cast since the count was checked to not be negative. */
+    mux->evt_count = (uint32_t)evt_count;
+
+    for (uint32_t evt_idx = 0U; evt_idx < mux->evt_count; ++evt_idx)
+    {
+        swicc_net_mux_card_st *const card = mux->evt[evt_idx].data.ptr;
+        /* Card was removed while handling one of the earlier events. */
+        if (card == NULL)
+        {
+            continue;
+        }
+
+        card->ret = mux_card_io(mux, card);
+        if ((card->ret != SWICC_RET_SUCCESS || card->swicc_state->shutdown) &&
+            mux_card_drop(mux, card) != SWICC_RET_SUCCESS)
+        {
+            mux->evt_count = 0U;
+            return SWICC_RET_ERROR;
+        }
+    }
+    mux->evt_count = 0U;
+    return SWICC_RET_SUCCESS;
+}
+
+swicc_ret_et swicc_net_mux_run(swicc_net_mux_st *const mux)
+{
+    if (mux == NULL)
+    {
+        return SWICC_RET_PARAM_BAD;
+    }
+
+    while (mux->shutdown == false &&
+           __atomic_load_n(&mux->card_count, __ATOMIC_RELAXED) > 0U)
+    {
+        swicc_ret_et const ret = swicc_net_mux_poll(mux, -1);
+        if (ret != SWICC_RET_SUCCESS)
+        {
+            return ret;
+        }
+    }
+    return SWICC_RET_SUCCESS;
+}
+
+/**
+ * @brief Pin the calling thread to one of the CPUs the process may run on.
+ * @param cpu_idx Index of the CPU among the allowed CPUs (wraps around).
+ * @return Return code.
+ */
+static swicc_ret_et pool_worker_pin(uint32_t const cpu_idx)
+{
+    cpu_set_t cpu_set_allowed;
+    if (sched_getaffinity(0, sizeof(cpu_set_allowed), &cpu_set_allowed) != 0)
+    {
+        logger("Call to sched_getaffinity() failed: %s.", strerror(errno));
+        return SWICC_RET_ERROR;
+    }
+    /* Safe cast since the count is never negative. */
+    uint32_t const cpu_count = (uint32_t)CPU_COUNT(&cpu_set_allowed);
+    if (cpu_count == 0U)
+    {
+        return SWICC_RET_ERROR;
+    }
+
+    uint32_t cpu_allowed_idx = 0U;
+    for (uint32_t cpu = 0U; cpu < CPU_SETSIZE; ++cpu)
+    {
+        if (!CPU_ISSET(cpu, &cpu_set_allowed))
+        {
+            continue;
+        }
+        if (cpu_allowed_idx++ == cpu_idx % cpu_count)
+        {
+            cpu_set_t cpu_set;
+            CPU_ZERO(&cpu_set);
+            CPU_SET(cpu, &cpu_set);
+            int32_t const err = pthread_setaffinity_np(
+                pthread_self(), sizeof(cpu_set), &cpu_set);
+            if (err != 0)
+            {
+                logger("Call to pthread_setaffinity_np() failed: %s.",
+                       strerror(err));
+                return SWICC_RET_ERROR;
+            }
+            return SWICC_RET_SUCCESS;
+        }
+    }
+    return SWICC_RET_ERROR;
+}
+
+/**
+ * @brief Body of a worker thread of a card pool.
+ * @param arg The worker.
+ * @return Always NULL, the result is written to the worker.
+ */
+static void *pool_worker(void *const arg)
+{
+    swicc_net_pool_worker_st *const worker = arg;
+    swicc_net_pool_st *const pool = worker->pool;
+    logger = pool->logger;
+
+    /* Safe cast since the worker is inside the array of workers. */
+    uint32_t const worker_idx = (uint32_t)(worker - pool->worker);
+    if (pool_worker_pin(worker_idx) != SWICC_RET_SUCCESS)
+    {
+        /* Not fatal, the worker will only run less efficiently. */
+        logger("Failed to pin worker %u to a CPU.", worker_idx);
+    }
+
+    worker->ret = SWICC_RET_SUCCESS;
+    while (!__atomic_load_n(&pool->shutdown, __ATOMIC_RELAXED))
+    {
+        swicc_ret_et const ret =
+            swicc_net_mux_poll(&worker->mux, SWICC_NET_POOL_POLL_TIMEOUT_MS);
+        if (ret != SWICC_RET_SUCCESS)
+        {
+            worker->ret = ret;
+            break;
+        }
+    }
+    return NULL;
+}
+
+swicc_ret_et swicc_net_pool_create(swicc_net_pool_st *const pool,
+                                   uint32_t const worker_count,
+                                   swicc_net_backend_et const backend)
+{
+    if (pool == NULL)
+    {
+        return SWICC_RET_PARAM_BAD;
+    }
+
+    memset(pool, 0U, sizeof(*pool));
+    pool->worker_count = worker_count;
+    if (pool->worker_count == 0U)
+    {
+        int64_t const cpu_count = sysconf(_SC_NPROCESSORS_ONLN);
+        /* Safe cast since the count is checked to fit. */
+        pool->worker_count =
+            cpu_count > 0 && cpu_count <= UINT32_MAX ? (uint32_t)cpu_count : 1U;
+    }
+    pool->logger = logger;
+    pool->worker = malloc(pool->worker_count * sizeof(*pool->worker));
+    if (pool->worker == NULL)
+    {
+        return SWICC_RET_ERROR;
+    }
+    memset(pool->worker, 0U, pool->worker_count * sizeof(*pool->worker));
+    for (uint32_t worker_idx = 0U; worker_idx < pool->worker_count;
+         ++worker_idx)
+    {
+        swicc_net_pool_worker_st *const worker = &pool->worker[worker_idx];
+        worker->pool = pool;
+        if (swicc_net_mux_create(&worker->mux, backend) != SWICC_RET_SUCCESS)
+        {
+            /* Only destroy the workers created so far. */
+            pool->worker_count = worker_idx;
+            swicc_net_pool_destroy(pool);
+            return SWICC_RET_ERROR;
+        }
+    }
+    return SWICC_RET_SUCCESS;
+}
+
+void swicc_net_pool_destroy(swicc_net_pool_st *const pool)
+{
+    if (pool == NULL)
+    {
+        return;
+    }
+    swicc_net_pool_stop(pool);
+    for (uint32_t worker_idx = 0U; worker_idx < pool->worker_count;
+         ++worker_idx)
+    {
+        swicc_net_mux_destroy(&pool->worker[worker_idx].mux);
+    }
+    if (pool->worker != NULL)
+    {
+        free(pool->worker);
+    }
+    memset(pool, 0U, sizeof(*pool));
+}
+
+swicc_ret_et swicc_net_pool_start(swicc_net_pool_st *const pool)
+{
+    if (pool == NULL)
+    {
+        return SWICC_RET_PARAM_BAD;
+    }
+    if (pool->running)
+    {
+        return SWICC_RET_ERROR;
+    }
+
+    __atomic_store_n(&pool->shutdown, false, __ATOMIC_RELAXED);
+    for (uint32_t worker_idx = 0U; worker_idx < pool->worker_count;
+         ++worker_idx)
+    {
+        swicc_net_pool_worker_st *const worker = &pool->worker[worker_idx];
+        worker->mux.card_rm_cb = pool->card_rm_cb;
+        int32_t const err =
+            pthread_create(&worker->thread, NULL, pool_worker, worker);
+        if (err != 0)
+        {
+            logger("Call to pthread_create() failed: %s.", strerror(err));
+            /* Only stop the workers started so far. */
+            uint32_t const worker_count = pool->worker_count;
+            pool->worker_count = worker_idx;
+            pool->running = true;
+            swicc_net_pool_stop(pool);
+            pool->worker_count = worker_count;
+            return SWICC_RET_ERROR;
+        }
+    }
+    pool->running = true;
+    return SWICC_RET_SUCCESS;
+}
+
+swicc_ret_et swicc_net_pool_stop(swicc_net_pool_st *const pool)
+{
+    if (pool == NULL)
+    {
+        return SWICC_RET_PARAM_BAD;
+    }
+    if (!pool->running)
+    {
+        return SWICC_RET_SUCCESS;
+    }
+
+    swicc_ret_et ret = SWICC_RET_SUCCESS;
+    __atomic_store_n(&pool->shutdown, true, __ATOMIC_RELAXED);
+    for (uint32_t worker_idx = 0U; worker_idx < pool->worker_count;
+         ++worker_idx)
+    {
+        swicc_net_pool_worker_st *const worker = &pool->worker[worker_idx];
+        int32_t const err = pthread_join(worker->thread, NULL);
+        if (err != 0)
+        {
+            logger("Call to pthread_join() failed: %s.", strerror(err));
+            ret = ret == SWICC_RET_SUCCESS ? SWICC_RET_ERROR : ret;
+        }
+        else if (worker->ret != SWICC_RET_SUCCESS && ret == SWICC_RET_SUCCESS)
+        {
+            ret = worker->ret;
+        }
+    }
+    pool->running = false;
+    return ret;
+}
+
+swicc_ret_et swicc_net_pool_card_add(swicc_net_pool_st *const pool,
+                                     swicc_net_mux_card_st *const card)
+{
+    if (pool == NULL || card == NULL || pool->worker_count == 0U)
+    {
+        return SWICC_RET_PARAM_BAD;
+    }
+
+    /* Pin the card to the least loaded worker. */
+    swicc_net_pool_worker_st *worker = &pool->worker[0U];
+    for (uint32_t worker_idx = 1U; worker_idx < pool->worker_count;
+         ++worker_idx)
+    {
+        if (__atomic_load_n(&pool->worker[worker_idx].mux.card_count,
+                            __ATOMIC_RELAXED) <
+            __atomic_load_n(&worker->mux.card_count, __ATOMIC_RELAXED))
+        {
+            worker = &pool->worker[worker_idx];
+        }
+    }
+    return swicc_net_mux_card_add(&worker->mux, card);
 }
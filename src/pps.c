@@ -37,6 +37,11 @@ static swicc_ret_et pps_parse(swicc_pps_params_st *const pps_params,
         return SWICC_RET_PPS_INVALID;
     }
     uint8_t const t_proposed = pps0 & 0x0F;
+    if (t_proposed > 1U)
+    {
+        /* Only T=0 and T=1 are offered in the ATR. */
+        return SWICC_RET_PPS_INVALID;
+    }
 
     uint8_t buf_rx_idx_next = 2U;
     uint8_t pps_mask = 0b00010000;
@@ -0,0 +1,114 @@
+#include <string.h>
+#include <swicc/swicc.h>
+
+uint8_t swicc_t1_edc_len(swicc_t1_edc_et const edc)
+{
+    return edc == SWICC_T1_EDC_CRC ? 2U : 1U;
+}
+
+uint16_t swicc_t1_crc(uint8_t const *const buf_raw, uint16_t const buf_raw_len)
+{
+    uint16_t crc = 0xFFFF;
+    for (uint16_t buf_idx = 0U; buf_idx < buf_raw_len; ++buf_idx)
+    {
+        crc ^= buf_raw[buf_idx];
+        for (uint8_t bit_idx = 0U; bit_idx < 8U; ++bit_idx)
+        {
+            /* Safe cast since the shifted value only gets smaller. */
+            crc = (uint16_t)((crc & 1U) ? (crc >> 1U) ^ 0x8408 : crc >> 1U);
+        }
+    }
+    return crc;
+}
+
+swicc_ret_et swicc_t1_block_len(uint8_t const *const block_raw,
+                                uint16_t const block_raw_len,
+                                swicc_t1_edc_et const edc,
+                                uint16_t *const block_len_exp)
+{
+    if (block_raw_len < SWICC_T1_PROLOGUE_LEN)
+    {
+        return SWICC_RET_T1_INVALID;
+    }
+    /* Safe cast since this will be at most 3 + 255 + 2. */
+    *block_len_exp = (uint16_t)(SWICC_T1_PROLOGUE_LEN + block_raw[2U] +
+                                swicc_t1_edc_len(edc));
+    return SWICC_RET_SUCCESS;
+}
+
+swicc_ret_et swicc_t1_block_parse(uint8_t const *const block_raw,
+                                  uint16_t const block_raw_len,
+                                  swicc_t1_edc_et const edc,
+                                  swicc_t1_block_st *const block)
+{
+    uint16_t block_len_exp;
+    if (swicc_t1_block_len(block_raw, block_raw_len, edc, &block_len_exp) !=
+            SWICC_RET_SUCCESS ||
+        block_raw_len != block_len_exp || block_raw[2U] > SWICC_T1_IFS_MAX)
+    {
+        return SWICC_RET_T1_INVALID;
+    }
+
+    /* Safe cast since the block is at least as long as the EDC. */
+    uint16_t const edc_idx = (uint16_t)(block_raw_len - swicc_t1_edc_len(edc));
+    if (edc == SWICC_T1_EDC_CRC)
+    {
+        uint16_t const crc = swicc_t1_crc(block_raw, edc_idx);
+        if (block_raw[edc_idx] != (crc >> 8U) ||
+            block_raw[edc_idx + 1U] != (crc & 0xFF))
+        {
+            return SWICC_RET_T1_EDC;
+        }
+    }
+    else if (swicc_ck(block_raw, block_raw_len) != 0U)
+    {
+        /* XOR of all bytes including the LRC is 0 for a valid block. */
+        return SWICC_RET_T1_EDC;
+    }
+
+    block->nad = block_raw[0U];
+    block->pcb = block_raw[1U];
+    block->len = block_raw[2U];
+    block->inf = &block_raw[SWICC_T1_PROLOGUE_LEN];
+    return SWICC_RET_SUCCESS;
+}
+
+swicc_ret_et swicc_t1_block_deparse(swicc_t1_block_st const *const block,
+                                    swicc_t1_edc_et const edc,
+                                    uint8_t *const block_raw,
+                                    uint16_t *const block_raw_len)
+{
+    if (block->len > SWICC_T1_IFS_MAX)
+    {
+        return SWICC_RET_PARAM_BAD;
+    }
+    /* Safe cast since this will be at most 3 + 254 + 2. */
+    uint16_t const edc_idx = (uint16_t)(SWICC_T1_PROLOGUE_LEN + block->len);
+    if (edc_idx + swicc_t1_edc_len(edc) > *block_raw_len)
+    {
+        return SWICC_RET_BUFFER_TOO_SHORT;
+    }
+
+    block_raw[0U] = block->nad;
+    block_raw[1U] = block->pcb;
+    block_raw[2U] = block->len;
+    /* The INF may already be in place. */
+    if (block->len > 0U && block->inf != &block_raw[SWICC_T1_PROLOGUE_LEN])
+    {
+        memmove(&block_raw[SWICC_T1_PROLOGUE_LEN], block->inf, block->len);
+    }
+
+    if (edc == SWICC_T1_EDC_CRC)
+    {
+        uint16_t const crc = swicc_t1_crc(block_raw, edc_idx);
+        block_raw[edc_idx] = (uint8_t)(crc >> 8U);
+        block_raw[edc_idx + 1U] = (uint8_t)(crc & 0xFF);
+    }
+    else
+    {
+        block_raw[edc_idx] = swicc_ck(block_raw, edc_idx);
+    }
+    /* Safe cast since this will be at most 3 + 254 + 2. */
+    *block_raw_len = (uint16_t)(edc_idx + swicc_t1_edc_len(edc));
+    return SWICC_RET_SUCCESS;
+}
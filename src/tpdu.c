@@ -11,7 +11,6 @@ swicc_ret_et swicc_tpdu_cmd_parse(uint8_t const *const buf_raw,
     }
 
     uint16_t const hdr_len = sizeof(swicc_apdu_cmd_hdr_raw_st) + 1U;
-    memset(cmd, 0U, sizeof(swicc_tpdu_cmd_st));
     cmd->hdr.cla = swicc_apdu_cmd_cla_parse(buf_raw[0U]);
     cmd->hdr.ins = buf_raw[1U];
     cmd->hdr.p1 = buf_raw[2U];
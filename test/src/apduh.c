@@ -0,0 +1,559 @@
+#include <tau/tau.h>
+
+#include <swicc/swicc.h>
+
+/* ID and contents of a transparent EF in the MF of disk 003. */
+#define APDUH_EF_ID_HI 0x7BU
+#define APDUH_EF_ID_LO 0xD7U
+static uint8_t const apduh_ef_data[] = {0x25, 0x65, 0xF6, 0xF9, 0x8A, 0xDA,
+                                        0x9F, 0x01, 0x36, 0x86, 0xD3, 0x39,
+                                        0x11, 0x3D, 0xAC, 0xFC};
+
+/* How many times the proprietary handler was called. */
+static uint32_t apduh_pro_count = 0U;
+
+/**
+ * @brief INS 0x01 takes its data one byte at a time and echoes it back, INS
+ * 0x02 only accepts an Le of 3, INS 0x03 returns as many bytes as P3 asks for.
+ */
+static swicc_apduh_ft apduh_pro;
+static swicc_ret_et apduh_pro(swicc_st *const swicc_state,
+                              swicc_apdu_cmd_st const *const cmd,
+                              swicc_apdu_res_st *const res,
+                              uint32_t const procedure_count)
+{
+    apduh_pro_count += 1U;
+    switch (cmd->hdr->ins)
+    {
+    case 0x01:
+        if (cmd->data->len < *cmd->p3)
+        {
+            SWICC_APDUH_RES(res, SWICC_APDU_SW1_PROC_ACK_ONE, 0U, 0U);
+            return SWICC_RET_SUCCESS;
+        }
+        memcpy(res->data.b, cmd->data->b, cmd->data->len);
+        SWICC_APDUH_RES(res, SWICC_APDU_SW1_NORM_NONE, 0U, cmd->data->len);
+        return SWICC_RET_SUCCESS;
+    case 0x02:
+        if (*cmd->p3 != 3U)
+        {
+            SWICC_APDUH_RES(res, SWICC_APDU_SW1_CHER_LE, 3U, 0U);
+            return SWICC_RET_SUCCESS;
+        }
+        memset(res->data.b, 0xA5U, 3U);
+        SWICC_APDUH_RES(res, SWICC_APDU_SW1_NORM_NONE, 0U, 3U);
+        return SWICC_RET_SUCCESS;
+    case 0x03:
+        if (procedure_count == 0U)
+        {
+            SWICC_APDUH_RES(res, SWICC_APDU_SW1_PROC_ACK_ALL, 0U, 0U);
+            return SWICC_RET_SUCCESS;
+        }
+        for (uint16_t data_idx = 0U; data_idx < *cmd->p3; ++data_idx)
+        {
+            res->data.b[data_idx] = (uint8_t)data_idx;
+        }
+        SWICC_APDUH_RES(res, SWICC_APDU_SW1_NORM_NONE, 0U, *cmd->p3);
+        return SWICC_RET_SUCCESS;
+    default:
+        return SWICC_RET_APDU_UNHANDLED;
+    }
+}
+
+TEST(apduh, swicc_apdu_exec__param_check)
+{
+    static swicc_st swicc_state;
+    uint8_t const cmd_case1[] = {0x00, 0xA4, 0x00, 0x04};
+    uint8_t const cmd_lc_0[] = {0x00, 0xA4, 0x00, 0x04, 0x00, 0x3F};
+    uint8_t const cmd_lc_long[] = {0x00, 0xA4, 0x00, 0x04, 0x03, 0x3F, 0x00};
+    uint8_t const cmd_lc_short[] = {0x00, 0xA4, 0x00, 0x04,
+                                    0x01, 0x3F, 0x00, 0x00};
+    uint8_t res[SWICC_DATA_MAX + 2U];
+    uint16_t res_len = sizeof(res);
+
+    CHECK_EQ(swicc_apdu_exec(NULL, cmd_case1, sizeof(cmd_case1), res,
+                             &res_len),
+             SWICC_RET_PARAM_BAD);
+    CHECK_EQ(swicc_apdu_exec(&swicc_state, NULL, sizeof(cmd_case1), res,
+                             &res_len),
+             SWICC_RET_PARAM_BAD);
+    CHECK_EQ(swicc_apdu_exec(&swicc_state, cmd_case1, sizeof(cmd_case1), NULL,
+                             &res_len),
+             SWICC_RET_PARAM_BAD);
+    CHECK_EQ(swicc_apdu_exec(&swicc_state, cmd_case1, sizeof(cmd_case1), res,
+                             NULL),
+             SWICC_RET_PARAM_BAD);
+    /* Shorter than a header. */
+    CHECK_EQ(swicc_apdu_exec(&swicc_state, cmd_case1, 3U, res, &res_len),
+             SWICC_RET_PARAM_BAD);
+    /* Lc does not match the length of the data. */
+    CHECK_EQ(swicc_apdu_exec(&swicc_state, cmd_lc_0, sizeof(cmd_lc_0), res,
+                             &res_len),
+             SWICC_RET_PARAM_BAD);
+    CHECK_EQ(swicc_apdu_exec(&swicc_state, cmd_lc_long, sizeof(cmd_lc_long),
+                             res, &res_len),
+             SWICC_RET_PARAM_BAD);
+    CHECK_EQ(swicc_apdu_exec(&swicc_state, cmd_lc_short, sizeof(cmd_lc_short),
+                             res, &res_len),
+             SWICC_RET_PARAM_BAD);
+}
+
+/**
+ * @brief Registered for single instructions, responds with the INS unless P1
+ * is non-zero in which case the command is left unhandled.
+ */
+static swicc_apduh_ft apduh_ins;
+static swicc_ret_et apduh_ins(swicc_st *const swicc_state,
+                              swicc_apdu_cmd_st const *const cmd,
+                              swicc_apdu_res_st *const res,
+                              uint32_t const procedure_count)
+{
+    if (cmd->hdr->p1 != 0U)
+    {
+        return SWICC_RET_APDU_UNHANDLED;
+    }
+    res->data.b[0U] = cmd->hdr->ins;
+    SWICC_APDUH_RES(res, SWICC_APDU_SW1_NORM_NONE, 0U, 1U);
+    return SWICC_RET_SUCCESS;
+}
+
+TEST(apduh, swicc_apdu_cmd_len_parse)
+{
+    swicc_apdu_cmd_len_st len;
+    uint8_t cmd[4U + 3U + SWICC_DATA_MAX + 2U] = {0x00, 0xB0, 0x00, 0x00};
+
+    /* Case 1. */
+    REQUIRE_EQ(swicc_apdu_cmd_len_parse(cmd, 4U, &len), SWICC_RET_SUCCESS);
+    CHECK_EQ(len.lc, 0U);
+    CHECK_EQ(len.le_present, false);
+    CHECK_EQ(swicc_apdu_cmd_len_ne(&len), 0U);
+
+    /* Case 2S with Le of 0 meaning 256. */
+    cmd[4U] = 0x00;
+    REQUIRE_EQ(swicc_apdu_cmd_len_parse(cmd, 5U, &len), SWICC_RET_SUCCESS);
+    CHECK_EQ(len.ext, false);
+    CHECK_EQ(len.le_present, true);
+    CHECK_EQ(swicc_apdu_cmd_len_ne(&len), 256U);
+
+    /* Case 4S. */
+    cmd[4U] = 0x02;
+    REQUIRE_EQ(swicc_apdu_cmd_len_parse(cmd, 8U, &len), SWICC_RET_SUCCESS);
+    CHECK_EQ(len.lc, 2U);
+    CHECK_EQ(len.data_offset, 5U);
+    CHECK_EQ(len.le_present, true);
+
+    /* Case 2E with Le of 0 meaning 65536. */
+    cmd[4U] = 0x00;
+    cmd[5U] = 0x00;
+    cmd[6U] = 0x00;
+    REQUIRE_EQ(swicc_apdu_cmd_len_parse(cmd, 7U, &len), SWICC_RET_SUCCESS);
+    CHECK_EQ(len.ext, true);
+    CHECK_EQ(len.lc, 0U);
+    CHECK_EQ(swicc_apdu_cmd_len_ne(&len), 65536U);
+
+    /* Case 3E and 4E with the largest data supported. */
+    cmd[5U] = (uint8_t)(SWICC_DATA_MAX >> 8U);
+    cmd[6U] = (uint8_t)(SWICC_DATA_MAX & 0xFF);
+    REQUIRE_EQ(swicc_apdu_cmd_len_parse(cmd, 7U + SWICC_DATA_MAX, &len),
+               SWICC_RET_SUCCESS);
+    CHECK_EQ(len.lc, SWICC_DATA_MAX);
+    CHECK_EQ(len.data_offset, 7U);
+    CHECK_EQ(len.le_present, false);
+    cmd[7U + SWICC_DATA_MAX] = 0x01;
+    cmd[8U + SWICC_DATA_MAX] = 0x02;
+    REQUIRE_EQ(swicc_apdu_cmd_len_parse(cmd, 9U + SWICC_DATA_MAX, &len),
+               SWICC_RET_SUCCESS);
+    CHECK_EQ(swicc_apdu_cmd_len_ne(&len), 0x0102U);
+
+    /* Too short for an extended Lc, missing data, and too much data. */
+    CHECK_EQ(swicc_apdu_cmd_len_parse(cmd, 6U, &len), SWICC_RET_PARAM_BAD);
+    CHECK_EQ(swicc_apdu_cmd_len_parse(cmd, 8U, &len), SWICC_RET_PARAM_BAD);
+    cmd[5U] = (uint8_t)((SWICC_DATA_MAX + 1U) >> 8U);
+    cmd[6U] = (uint8_t)((SWICC_DATA_MAX + 1U) & 0xFF);
+    CHECK_EQ(swicc_apdu_cmd_len_parse(cmd, 8U + SWICC_DATA_MAX, &len),
+             SWICC_RET_PARAM_BAD);
+}
+
+TEST(apduh, swicc_apdu_exec__select_read)
+{
+    static swicc_st swicc_state;
+    swicc_disk_st disk = {0U};
+    REQUIRE_EQ(swicc_diskjs_disk_create(&disk, "test/data/disk/003-in.json"),
+               SWICC_RET_SUCCESS);
+    memset(&swicc_state, 0U, sizeof(swicc_state));
+    REQUIRE_EQ(swicc_fs_disk_mount(&swicc_state, &disk), SWICC_RET_SUCCESS);
+
+    uint8_t res[SWICC_DATA_MAX + 2U];
+    uint16_t res_len;
+
+    /* Without Le, only the status indicating the FCP length comes back. */
+    uint8_t const select[] = {0x00,           0xA4, 0x00, 0x04, 0x02,
+                              APDUH_EF_ID_HI, APDUH_EF_ID_LO};
+    res_len = sizeof(res);
+    CHECK_EQ(swicc_apdu_exec(&swicc_state, select, sizeof(select), res,
+                             &res_len),
+             SWICC_RET_SUCCESS);
+    REQUIRE_EQ(res_len, 2U);
+    CHECK_EQ(res[0U], 0x61U);
+    uint8_t const fcp_len = res[1U];
+
+    /* With Le, the FCP is fetched with GET RESPONSE. */
+    uint8_t const select_le[] = {0x00,           0xA4,           0x00, 0x04,
+                                 0x02,           APDUH_EF_ID_HI, APDUH_EF_ID_LO,
+                                 0x00};
+    res_len = sizeof(res);
+    CHECK_EQ(swicc_apdu_exec(&swicc_state, select_le, sizeof(select_le), res,
+                             &res_len),
+             SWICC_RET_SUCCESS);
+    REQUIRE_EQ(res_len, fcp_len + 2U);
+    CHECK_EQ(res[0U], 0x62U);
+    CHECK_EQ(res[1U], fcp_len - 2U);
+    CHECK_EQ(res[fcp_len + 0U], 0x90U);
+    CHECK_EQ(res[fcp_len + 1U], 0x00U);
+
+    /* Only as much as Le asks for and the rest stays available. */
+    uint8_t select_le_short[sizeof(select_le)];
+    memcpy(select_le_short, select_le, sizeof(select_le));
+    select_le_short[sizeof(select_le_short) - 1U] = 4U;
+    res_len = sizeof(res);
+    CHECK_EQ(swicc_apdu_exec(&swicc_state, select_le_short,
+                             sizeof(select_le_short), res, &res_len),
+             SWICC_RET_SUCCESS);
+    REQUIRE_EQ(res_len, 4U + 2U);
+    CHECK_EQ(res[0U], 0x62U);
+    CHECK_EQ(res[4U], 0x61U);
+    CHECK_EQ(res[5U], fcp_len - 4U);
+
+    /* A response which does not fit. */
+    res_len = fcp_len;
+    CHECK_EQ(swicc_apdu_exec(&swicc_state, select_le, sizeof(select_le), res,
+                             &res_len),
+             SWICC_RET_BUFFER_TOO_SHORT);
+
+    uint8_t const read[] = {0x00, 0xB0, 0x00, 0x00,
+                            sizeof(apduh_ef_data)};
+    res_len = sizeof(res);
+    CHECK_EQ(swicc_apdu_exec(&swicc_state, read, sizeof(read), res, &res_len),
+             SWICC_RET_SUCCESS);
+    REQUIRE_EQ(res_len, sizeof(apduh_ef_data) + 2U);
+    CHECK_BUF_EQ(res, apduh_ef_data, sizeof(apduh_ef_data));
+    CHECK_EQ(res[sizeof(apduh_ef_data) + 0U], 0x90U);
+    CHECK_EQ(res[sizeof(apduh_ef_data) + 1U], 0x00U);
+
+    swicc_terminate(&swicc_state);
+}
+
+TEST(apduh, swicc_apdu_exec__select_cache)
+{
+    static swicc_st swicc_state;
+    swicc_disk_st disk = {0U};
+    REQUIRE_EQ(swicc_diskjs_disk_create(&disk, "test/data/disk/003-in.json"),
+               SWICC_RET_SUCCESS);
+    memset(&swicc_state, 0U, sizeof(swicc_state));
+    REQUIRE_EQ(swicc_fs_disk_mount(&swicc_state, &disk), SWICC_RET_SUCCESS);
+
+    /* FCI (P2 = 00) and FCP (P2 = 04) of the same file. */
+    uint8_t select[] = {0x00,           0xA4,           0x00, 0x00,
+                        0x02,           APDUH_EF_ID_HI, APDUH_EF_ID_LO,
+                        0x00};
+    uint8_t res_first[2U][SWICC_DATA_MAX + 2U];
+    uint16_t res_first_len[2U];
+    uint8_t res[SWICC_DATA_MAX + 2U];
+    uint16_t res_len;
+    for (uint8_t run = 0U; run < 2U; ++run)
+    {
+        for (uint8_t req = 0U; req < 2U; ++req)
+        {
+            select[3U] = req == 0U ? 0x00 : 0x04;
+            res_len = sizeof(res);
+            REQUIRE_EQ(swicc_apdu_exec(&swicc_state, select, sizeof(select),
+                                       res, &res_len),
+                       SWICC_RET_SUCCESS);
+            if (run == 0U)
+            {
+                memcpy(res_first[req], res, res_len);
+                res_first_len[req] = res_len;
+                continue;
+            }
+            /* Responses from the cache are the same as the encoded ones. */
+            REQUIRE_EQ(res_len, res_first_len[req]);
+            CHECK_BUF_EQ(res, res_first[req], res_len);
+        }
+    }
+    CHECK_EQ(res_first[0U][0U], 0x6FU);
+    CHECK_EQ(res_first[1U][0U], 0x62U);
+
+    uint32_t fcp_count = 0U;
+    for (uint32_t fcp_idx = 0U; fcp_idx < SWICC_APDUH_FCP_CACHE_COUNT;
+         ++fcp_idx)
+    {
+        fcp_count += swicc_state.internal.apduh_fcp[fcp_idx].len > 0U;
+    }
+    CHECK_EQ(fcp_count, 2U);
+
+    swicc_terminate(&swicc_state);
+}
+
+TEST(apduh, swicc_apdu_exec__select_adf)
+{
+    static swicc_st swicc_state;
+    swicc_disk_st disk = {0U};
+    REQUIRE_EQ(swicc_diskjs_disk_create(&disk, "test/data/disk/005-in.json"),
+               SWICC_RET_SUCCESS);
+    memset(&swicc_state, 0U, sizeof(swicc_state));
+    REQUIRE_EQ(swicc_fs_disk_mount(&swicc_state, &disk), SWICC_RET_SUCCESS);
+
+    /* Right-truncated AID of the ADF with ID 75C9, no response data. */
+    uint8_t select[] = {0x00, 0xA4, 0x04, 0x0C, 0x06,
+                        0x40, 0xF1, 0xD5, 0x95, 0x6E, 0xEF};
+    uint8_t res[SWICC_DATA_MAX + 2U];
+    uint16_t res_len = sizeof(res);
+    REQUIRE_EQ(
+        swicc_apdu_exec(&swicc_state, select, sizeof(select), res, &res_len),
+        SWICC_RET_SUCCESS);
+    REQUIRE_EQ(res_len, 2U);
+    CHECK_EQ(res[0U], 0x90U);
+    CHECK_EQ(res[1U], 0x00U);
+    CHECK_EQ(swicc_state.fs.va.cur_adf.hdr_file.id, 0x75C9);
+
+    /* There is no next occurrence of this AID. */
+    select[3U] = 0x0E;
+    res_len = sizeof(res);
+    REQUIRE_EQ(
+        swicc_apdu_exec(&swicc_state, select, sizeof(select), res, &res_len),
+        SWICC_RET_SUCCESS);
+    REQUIRE_EQ(res_len, 2U);
+    CHECK_EQ(res[0U], 0x6AU);
+    CHECK_EQ(res[1U], 0x82U);
+    CHECK_EQ(swicc_state.fs.va.cur_adf.hdr_file.id, 0x75C9);
+
+    swicc_terminate(&swicc_state);
+}
+
+TEST(apduh, swicc_apdu_exec__select_path)
+{
+    static swicc_st swicc_state;
+    swicc_disk_st disk = {0U};
+    REQUIRE_EQ(swicc_diskjs_disk_create(&disk, "test/data/disk/006-in.json"),
+               SWICC_RET_SUCCESS);
+    memset(&swicc_state, 0U, sizeof(swicc_state));
+    REQUIRE_EQ(swicc_fs_disk_mount(&swicc_state, &disk), SWICC_RET_SUCCESS);
+
+    uint8_t res[SWICC_DATA_MAX + 2U];
+    uint16_t res_len = sizeof(res);
+    uint8_t const select_mf[] = {0x00, 0xA4, 0x00, 0x0C, 0x02, 0xE7, 0xC7};
+    REQUIRE_EQ(swicc_apdu_exec(&swicc_state, select_mf, sizeof(select_mf), res,
+                               &res_len),
+               SWICC_RET_SUCCESS);
+    REQUIRE_EQ(res_len, 2U);
+    CHECK_EQ(res[0U], 0x90U);
+
+    /* Path from the current DF which starts with the ID of the DF itself. */
+    uint8_t const select_path[] = {0x00, 0xA4, 0x09, 0x0C, 0x04,
+                                   0xE7, 0xC7, 0x5A, 0xBD};
+    res_len = sizeof(res);
+    REQUIRE_EQ(swicc_apdu_exec(&swicc_state, select_path, sizeof(select_path),
+                               res, &res_len),
+               SWICC_RET_SUCCESS);
+    REQUIRE_EQ(res_len, 2U);
+    CHECK_EQ(res[0U], 0x90U);
+    CHECK_EQ(swicc_state.fs.va.cur_ef.hdr_file.id, 0x5ABD);
+
+    /* A file of another tree is not on the path. */
+    uint8_t const select_path_bad[] = {0x00, 0xA4, 0x09, 0x0C, 0x02,
+                                       0x86, 0x2F};
+    res_len = sizeof(res);
+    REQUIRE_EQ(swicc_apdu_exec(&swicc_state, select_path_bad,
+                               sizeof(select_path_bad), res, &res_len),
+               SWICC_RET_SUCCESS);
+    REQUIRE_EQ(res_len, 2U);
+    CHECK_EQ(res[0U], 0x6AU);
+    CHECK_EQ(res[1U], 0x82U);
+
+    swicc_terminate(&swicc_state);
+}
+
+TEST(apduh, swicc_apdu_exec__procedure)
+{
+    static swicc_st swicc_state;
+    memset(&swicc_state, 0U, sizeof(swicc_state));
+    REQUIRE_EQ(swicc_apduh_pro_register(&swicc_state, apduh_pro),
+               SWICC_RET_SUCCESS);
+
+    uint8_t res[SWICC_DATA_MAX + 2U];
+    uint16_t res_len;
+
+    /* Data is given to the handler one byte per ACK. */
+    uint8_t const echo[] = {0x80, 0x01, 0x00, 0x00, 0x04,
+                            0x11, 0x22, 0x33, 0x44};
+    apduh_pro_count = 0U;
+    res_len = sizeof(res);
+    CHECK_EQ(swicc_apdu_exec(&swicc_state, echo, sizeof(echo), res, &res_len),
+             SWICC_RET_SUCCESS);
+    CHECK_EQ(apduh_pro_count, 5U);
+    REQUIRE_EQ(res_len, 4U + 2U);
+    CHECK_BUF_EQ(res, &echo[5U], 4U);
+    CHECK_EQ(res[4U], 0x90U);
+    CHECK_EQ(res[5U], 0x00U);
+
+    /* A wrong Le is corrected once. */
+    uint8_t const le_wrong[] = {0x80, 0x02, 0x00, 0x00, 0x10};
+    apduh_pro_count = 0U;
+    res_len = sizeof(res);
+    CHECK_EQ(swicc_apdu_exec(&swicc_state, le_wrong, sizeof(le_wrong), res,
+                             &res_len),
+             SWICC_RET_SUCCESS);
+    CHECK_EQ(apduh_pro_count, 2U);
+    REQUIRE_EQ(res_len, 3U + 2U);
+    CHECK_EQ(res[0U], 0xA5U);
+    CHECK_EQ(res[3U], 0x90U);
+
+    /* Without Le there is nothing to correct. */
+    uint8_t const le_none[] = {0x80, 0x02, 0x00, 0x00};
+    res_len = sizeof(res);
+    CHECK_EQ(swicc_apdu_exec(&swicc_state, le_none, sizeof(le_none), res,
+                             &res_len),
+             SWICC_RET_SUCCESS);
+    REQUIRE_EQ(res_len, 2U);
+    CHECK_EQ(res[0U], 0x6CU);
+    CHECK_EQ(res[1U], 0x03U);
+}
+
+TEST(apduh, swicc_apdu_exec__extended)
+{
+    static swicc_st swicc_state;
+    memset(&swicc_state, 0U, sizeof(swicc_state));
+    REQUIRE_EQ(swicc_apduh_pro_register(&swicc_state, apduh_pro),
+               SWICC_RET_SUCCESS);
+
+    static uint8_t res[SWICC_DATA_MAX + 2U];
+    uint16_t res_len;
+
+    /* More data than fits in a short Lc. */
+    static uint8_t echo[4U + 3U + 300U];
+    echo[0U] = 0x80;
+    echo[1U] = 0x01;
+    echo[5U] = (uint8_t)(300U >> 8U);
+    echo[6U] = (uint8_t)(300U & 0xFF);
+    for (uint16_t data_idx = 0U; data_idx < 300U; ++data_idx)
+    {
+        echo[7U + data_idx] = (uint8_t)(data_idx ^ 0x5A);
+    }
+    res_len = sizeof(res);
+    CHECK_EQ(swicc_apdu_exec(&swicc_state, echo, sizeof(echo), res, &res_len),
+             SWICC_RET_SUCCESS);
+    REQUIRE_EQ(res_len, 300U + 2U);
+    CHECK_BUF_EQ(res, &echo[7U], 300U);
+    CHECK_EQ(res[300U], 0x90U);
+
+    /* The whole response comes back at once with an extended Le. */
+    uint8_t const get[] = {0x80,
+                           0x03,
+                           0x00,
+                           0x00,
+                           0x00,
+                           (uint8_t)(SWICC_DATA_MAX >> 8U),
+                           (uint8_t)(SWICC_DATA_MAX & 0xFF)};
+    apduh_pro_count = 0U;
+    res_len = sizeof(res);
+    CHECK_EQ(swicc_apdu_exec(&swicc_state, get, sizeof(get), res, &res_len),
+             SWICC_RET_SUCCESS);
+    CHECK_EQ(apduh_pro_count, 2U);
+    REQUIRE_EQ(res_len, SWICC_DATA_MAX + 2U);
+    CHECK_EQ(res[0U], 0x00U);
+    CHECK_EQ(res[SWICC_DATA_MAX - 1U], (SWICC_DATA_MAX - 1U) & 0xFF);
+    CHECK_EQ(res[SWICC_DATA_MAX + 0U], 0x90U);
+    CHECK_EQ(res[SWICC_DATA_MAX + 1U], 0x00U);
+
+    /* More data than is supported. */
+    echo[5U] = (uint8_t)((SWICC_DATA_MAX + 1U) >> 8U);
+    echo[6U] = (uint8_t)((SWICC_DATA_MAX + 1U) & 0xFF);
+    res_len = sizeof(res);
+    CHECK_EQ(swicc_apdu_exec(&swicc_state, echo, sizeof(echo), res, &res_len),
+             SWICC_RET_PARAM_BAD);
+}
+
+TEST(apduh, swicc_apduh_ins_register)
+{
+    static swicc_st swicc_state;
+    swicc_disk_st disk = {0U};
+    REQUIRE_EQ(swicc_diskjs_disk_create(&disk, "test/data/disk/007-in.json"),
+               SWICC_RET_SUCCESS);
+    memset(&swicc_state, 0U, sizeof(swicc_state));
+    REQUIRE_EQ(swicc_fs_disk_mount(&swicc_state, &disk), SWICC_RET_SUCCESS);
+
+    CHECK_EQ(swicc_apduh_ins_register(NULL, SWICC_APDU_CLA_TYPE_PROPRIETARY,
+                                      0x10, apduh_ins),
+             SWICC_RET_PARAM_BAD);
+    CHECK_EQ(swicc_apduh_ins_register(&swicc_state, SWICC_APDU_CLA_TYPE_RFU,
+                                      0x10, apduh_ins),
+             SWICC_RET_PARAM_BAD);
+    REQUIRE_EQ(swicc_apduh_ins_register(&swicc_state,
+                                        SWICC_APDU_CLA_TYPE_PROPRIETARY, 0x10,
+                                        apduh_ins),
+               SWICC_RET_SUCCESS);
+    REQUIRE_EQ(swicc_apduh_ins_register(&swicc_state,
+                                        SWICC_APDU_CLA_TYPE_INTERINDUSTRY, 0xCA,
+                                        apduh_ins),
+               SWICC_RET_SUCCESS);
+
+    uint8_t res[SWICC_DATA_MAX + 2U];
+    uint16_t res_len;
+
+    /* Only the registered instruction of the registered class is handled. */
+    uint8_t cmd[] = {0x80, 0x10, 0x00, 0x00};
+    res_len = sizeof(res);
+    CHECK_EQ(swicc_apdu_exec(&swicc_state, cmd, sizeof(cmd), res, &res_len),
+             SWICC_RET_SUCCESS);
+    REQUIRE_EQ(res_len, 3U);
+    CHECK_EQ(res[0U], 0x10U);
+    CHECK_EQ(res[1U], 0x90U);
+    cmd[1U] = 0xCA;
+    res_len = sizeof(res);
+    CHECK_EQ(swicc_apdu_exec(&swicc_state, cmd, sizeof(cmd), res, &res_len),
+             SWICC_RET_SUCCESS);
+    REQUIRE_EQ(res_len, 2U);
+    CHECK_EQ(res[0U], 0x6DU);
+    cmd[0U] = 0x00;
+    res_len = sizeof(res);
+    CHECK_EQ(swicc_apdu_exec(&swicc_state, cmd, sizeof(cmd), res, &res_len),
+             SWICC_RET_SUCCESS);
+    REQUIRE_EQ(res_len, 3U);
+    CHECK_EQ(res[0U], 0xCAU);
+
+    /* Unhandled commands go to the proprietary handler. */
+    REQUIRE_EQ(swicc_apduh_pro_register(&swicc_state, apduh_pro),
+               SWICC_RET_SUCCESS);
+    uint8_t const le_wrong[] = {0x80, 0x02, 0x01, 0x00, 0x10};
+    REQUIRE_EQ(swicc_apduh_ins_register(&swicc_state,
+                                        SWICC_APDU_CLA_TYPE_PROPRIETARY, 0x02,
+                                        apduh_ins),
+               SWICC_RET_SUCCESS);
+    res_len = sizeof(res);
+    CHECK_EQ(swicc_apdu_exec(&swicc_state, le_wrong, sizeof(le_wrong), res,
+                             &res_len),
+             SWICC_RET_SUCCESS);
+    REQUIRE_EQ(res_len, 3U + 2U);
+    CHECK_EQ(res[0U], 0xA5U);
+
+    /* Registrations are kept across resets and can be removed. */
+    swicc_state.buf_tx = res;
+    REQUIRE_EQ(swicc_reset(&swicc_state), SWICC_RET_SUCCESS);
+    cmd[0U] = 0x80;
+    cmd[1U] = 0x10;
+    res_len = sizeof(res);
+    CHECK_EQ(swicc_apdu_exec(&swicc_state, cmd, sizeof(cmd), res, &res_len),
+             SWICC_RET_SUCCESS);
+    CHECK_EQ(res_len, 3U);
+    REQUIRE_EQ(swicc_apduh_ins_register(&swicc_state,
+                                        SWICC_APDU_CLA_TYPE_PROPRIETARY, 0x10,
+                                        NULL),
+               SWICC_RET_SUCCESS);
+    res_len = sizeof(res);
+    CHECK_EQ(swicc_apdu_exec(&swicc_state, cmd, sizeof(cmd), res, &res_len),
+             SWICC_RET_SUCCESS);
+    REQUIRE_EQ(res_len, 2U);
+    CHECK_EQ(res[0U], 0x6DU);
+
+    swicc_terminate(&swicc_state);
+}
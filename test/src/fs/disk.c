@@ -23,7 +23,55 @@ static int32_t filesize(char const *const path, uint32_t *const size)
 }
 
 /**
- * @warning The static function 'lut_insert' is not tested because it's static.
+ * @brief Check if two LUTs have identical contents (ignoring their capacity).
+ * @param lut_a
+ * @param lut_b
+ * @return True if equal, false otherwise.
+ */
+static bool lut_equal(swicc_disk_lut_st const *const lut_a,
+                      swicc_disk_lut_st const *const lut_b)
+{
+    return lut_a->count == lut_b->count &&
+           lut_a->size_item1 == lut_b->size_item1 &&
+           lut_a->size_item2 == lut_b->size_item2 &&
+           memcmp(lut_a->buf1, lut_b->buf1,
+                  lut_a->count * lut_a->size_item1) == 0 &&
+           memcmp(lut_a->buf2, lut_b->buf2,
+                  lut_a->count * lut_a->size_item2) == 0;
+}
+
+/**
+ * @brief Check if all LUTs of two disks have identical contents.
+ * @param disk_a
+ * @param disk_b
+ * @return True if equal, false otherwise.
+ */
+static bool disk_lut_equal(swicc_disk_st const *const disk_a,
+                           swicc_disk_st const *const disk_b)
+{
+    if (!lut_equal(&disk_a->lutid, &disk_b->lutid) ||
+        !lut_equal(&disk_a->lutname, &disk_b->lutname))
+    {
+        return false;
+    }
+    swicc_disk_tree_st const *tree_a = disk_a->root;
+    swicc_disk_tree_st const *tree_b = disk_b->root;
+    while (tree_a != NULL && tree_b != NULL)
+    {
+        if (!lut_equal(&tree_a->lutsid, &tree_b->lutsid) ||
+            !lut_equal(&tree_a->lutchild, &tree_b->lutchild))
+        {
+            return false;
+        }
+        tree_a = tree_a->next;
+        tree_b = tree_b->next;
+    }
+    return tree_a == NULL && tree_b == NULL;
+}
+
+/**
+ * @warning The static functions 'lut_append' and 'lut_sort' are not tested
+ * directly because they are static, the LUT rebuild tests cover them.
  */
 
 TEST(fs_disk, swicc_disk_save__param_check)
@@ -106,6 +154,236 @@ TEST(fs_disk, swicc_disk_load__disk)
     }
 }
 
+TEST(fs_disk, swicc_disk_load__lut)
+{
+    char const *const disk_path = "build/tmp/q8VbTz1mRkWc4HdN.swiccfs";
+    swicc_disk_st disk_json = {0U};
+    swicc_disk_st disk = {0U};
+    REQUIRE_EQ(
+        swicc_diskjs_disk_create(&disk_json, "test/data/disk/006-in.json"),
+        SWICC_RET_SUCCESS);
+    CHECK_EQ(swicc_disk_save(&disk_json, disk_path), SWICC_RET_SUCCESS);
+
+    /* The LUTs read from the LUT section must match the built ones. */
+    CHECK_EQ(swicc_disk_load(&disk, disk_path), SWICC_RET_SUCCESS);
+    CHECK_TRUE(disk_lut_equal(&disk, &disk_json));
+
+    swicc_disk_unload(&disk);
+    swicc_disk_unload(&disk_json);
+}
+
+TEST(fs_disk, swicc_disk_load__lut_stale)
+{
+    char const *const disk_path = "build/tmp/Jx3uP0cLs9eYfA7g.swiccfs";
+    swicc_disk_st disk_json = {0U};
+    swicc_disk_st disk = {0U};
+    REQUIRE_EQ(
+        swicc_diskjs_disk_create(&disk_json, "test/data/disk/006-in.json"),
+        SWICC_RET_SUCCESS);
+    CHECK_EQ(swicc_disk_save(&disk_json, disk_path), SWICC_RET_SUCCESS);
+
+    /* Corrupt the LUT section version so the section is considered stale. */
+    uint32_t trees_len = 0U;
+    swicc_disk_tree_st const *tree = disk_json.root;
+    while (tree != NULL)
+    {
+        trees_len += tree->len;
+        tree = tree->next;
+    }
+    FILE *const fdisk = fopen(disk_path, "r+b");
+    REQUIRE_NE((void *)fdisk, NULL);
+    uint32_t const version_bad = SWICC_DISK_LUT_VERSION + 1U;
+    uint32_t const version_offset =
+        SWICC_DISK_MAGIC_LEN + trees_len + SWICC_DISK_MAGIC_LEN;
+    CHECK_EQ(fseek(fdisk, version_offset, SEEK_SET), 0);
+    CHECK_EQ(fwrite(&version_bad, sizeof(version_bad), 1U, fdisk), 1U);
+    if (fclose(fdisk) != 0)
+    {
+        WARN("Disk file failed to close.");
+    }
+
+    /* The LUTs must get rebuilt instead of being read from the file. */
+    CHECK_EQ(swicc_disk_load(&disk, disk_path), SWICC_RET_SUCCESS);
+    CHECK_TRUE(disk_lut_equal(&disk, &disk_json));
+
+    swicc_disk_unload(&disk);
+    swicc_disk_unload(&disk_json);
+}
+
+TEST(fs_disk, swicc_disk_load_mmap__param_check)
+{
+    swicc_disk_st *const disk = (swicc_disk_st *)1U;
+    char const *const disk_path = "";
+    CHECK_EQ(swicc_disk_load_mmap(NULL, disk_path), SWICC_RET_PARAM_BAD);
+    CHECK_EQ(swicc_disk_load_mmap(disk, NULL), SWICC_RET_PARAM_BAD);
+}
+
+TEST(fs_disk, swicc_disk_load_mmap__disk)
+{
+    char const *const disk_path = "build/tmp/wG5nYb2KdQ8sLr0T.swiccfs";
+    swicc_disk_st disk_json = {0U};
+    swicc_disk_st disk = {0U};
+    REQUIRE_EQ(
+        swicc_diskjs_disk_create(&disk_json, "test/data/disk/006-in.json"),
+        SWICC_RET_SUCCESS);
+    CHECK_EQ(swicc_disk_save(&disk_json, disk_path), SWICC_RET_SUCCESS);
+    REQUIRE_EQ(swicc_disk_load_mmap(&disk, disk_path), SWICC_RET_SUCCESS);
+    CHECK_NE((void *)disk.map, NULL);
+
+    /* All trees must point into the mapping and equal the created ones. */
+    swicc_disk_tree_st const *tree_json = disk_json.root;
+    swicc_disk_tree_st const *tree = disk.root;
+    while (tree_json != NULL && tree != NULL)
+    {
+        CHECK_TRUE(tree->buf_mapped);
+        CHECK_TRUE(tree->buf >= disk.map &&
+                   tree->buf + tree->len <= disk.map + disk.map_len);
+        CHECK_EQ(tree->len, tree_json->len);
+        /**
+         * @note This weird casting here is to avoid triggering
+         * -Wconversion.
+         */
+        int32_t const buf_len = (int32_t)tree->len;
+        CHECK_BUF_EQ(tree->buf, tree_json->buf, (size_t)buf_len);
+        /* The decoded headers must point into the mapping too. */
+        CHECK_EQ(tree->hdrtbl.folder_count, tree_json->hdrtbl.folder_count);
+        CHECK_EQ(tree->hdrtbl.folder[0U].data,
+                 tree->buf +
+                     (tree_json->hdrtbl.folder[0U].data - tree_json->buf));
+        tree_json = tree_json->next;
+        tree = tree->next;
+    }
+    CHECK_EQ((void *)tree_json, NULL);
+    CHECK_EQ((void *)tree, NULL);
+    CHECK_TRUE(disk_lut_equal(&disk, &disk_json));
+
+    swicc_disk_st const disk_zero = {0U};
+    swicc_disk_unload(&disk);
+    CHECK_BUF_EQ(&disk, &disk_zero, sizeof(disk));
+    swicc_disk_unload(&disk_json);
+}
+
+TEST(fs_disk, swicc_disk_load_mmap__modify)
+{
+    char const *const disk_path = "build/tmp/cM7pXe4RuN1vHk9Z.swiccfs";
+    swicc_disk_st disk_json = {0U};
+    swicc_disk_st disk = {0U};
+    REQUIRE_EQ(
+        swicc_diskjs_disk_create(&disk_json, "test/data/disk/004-in.json"),
+        SWICC_RET_SUCCESS);
+    CHECK_EQ(swicc_disk_save(&disk_json, disk_path), SWICC_RET_SUCCESS);
+
+    /**
+     * Modifying a mapped disk must work but must not change the disk file
+     * (the mapping is copy-on-write).
+     */
+    REQUIRE_EQ(swicc_disk_load_mmap(&disk, disk_path), SWICC_RET_SUCCESS);
+    uint8_t const byte_old = disk.root->buf[disk.root->len - 1U];
+    disk.root->buf[disk.root->len - 1U] = (uint8_t)~byte_old;
+    swicc_disk_unload(&disk);
+
+    REQUIRE_EQ(swicc_disk_load_mmap(&disk, disk_path), SWICC_RET_SUCCESS);
+    CHECK_EQ(disk.root->buf[disk.root->len - 1U], byte_old);
+    swicc_disk_unload(&disk);
+    swicc_disk_unload(&disk_json);
+}
+
+TEST(fs_disk, swicc_disk_overlay__param_check)
+{
+    /* These are invalid pointers but they are not NULL. */
+    swicc_disk_st *const disk = (swicc_disk_st *)1U;
+    swicc_disk_st const *const disk_base = (swicc_disk_st const *)1U;
+    CHECK_EQ(swicc_disk_overlay(NULL, disk_base), SWICC_RET_PARAM_BAD);
+    CHECK_EQ(swicc_disk_overlay(disk, NULL), SWICC_RET_PARAM_BAD);
+}
+
+TEST(fs_disk, swicc_disk_overlay__disk)
+{
+    char const *const disk_path = "build/tmp/Qz8vT3mKw6bYa1Lc.swiccfs";
+    static swicc_fs_id_kt const file_id = 0xE99D;
+    static uint8_t const rcrd_old[16U] = {0xF6, 0x72, 0xFF, 0x99, 0x3B, 0x80,
+                                          0x83, 0x0F, 0xAE, 0xEE, 0xC9, 0x58,
+                                          0x84, 0xDC, 0x99, 0xE5};
+    static uint8_t const rcrd_new[16U] = {0x00, 0x01, 0x02, 0x03, 0x04, 0x05,
+                                          0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B,
+                                          0x0C, 0x0D, 0x0E, 0x0F};
+    swicc_disk_st const disk_zero = {0U};
+    swicc_disk_st disk_base = {0U};
+    swicc_disk_st disk_a = {0U};
+    swicc_disk_st disk_b = {0U};
+    REQUIRE_EQ(
+        swicc_diskjs_disk_create(&disk_base, "test/data/disk/006-in.json"),
+        SWICC_RET_SUCCESS);
+    REQUIRE_EQ(swicc_disk_overlay(&disk_a, &disk_base), SWICC_RET_SUCCESS);
+    REQUIRE_EQ(swicc_disk_overlay(&disk_b, &disk_base), SWICC_RET_SUCCESS);
+
+    /* An overlay can't be created on an overlay or on a used disk. */
+    swicc_disk_st disk_c = {0U};
+    CHECK_EQ(swicc_disk_overlay(&disk_c, &disk_a), SWICC_RET_ERROR);
+    CHECK_EQ(swicc_disk_overlay(&disk_a, &disk_base), SWICC_RET_ERROR);
+
+    /* Overlays share the trees and LUTs of the base. */
+    CHECK_EQ(disk_a.root->buf, disk_base.root->buf);
+    CHECK_EQ(disk_a.root->lutsid.buf1, disk_base.root->lutsid.buf1);
+    CHECK_EQ(disk_a.lutid.buf1, disk_base.lutid.buf1);
+    CHECK_EQ(disk_a.root->hdrtbl.folder, disk_base.root->hdrtbl.folder);
+    CHECK_EQ(swicc_disk_lutid_rebuild(&disk_a), SWICC_RET_ERROR);
+    CHECK_EQ(swicc_disk_lutsid_rebuild(&disk_a, disk_a.root), SWICC_RET_ERROR);
+    CHECK_EQ(swicc_disk_hdrtbl_rebuild(&disk_a, disk_a.root), SWICC_RET_ERROR);
+
+    swicc_disk_tree_st *tree_a;
+    swicc_disk_tree_st *tree_b;
+    swicc_disk_tree_st *tree_base;
+    swicc_fs_file_st file;
+    REQUIRE_EQ(swicc_disk_lutid_lookup(&disk_a, &tree_a, file_id, &file),
+               SWICC_RET_SUCCESS);
+    REQUIRE_EQ(swicc_disk_lutid_lookup(&disk_b, &tree_b, file_id, &file),
+               SWICC_RET_SUCCESS);
+    REQUIRE_EQ(swicc_disk_lutid_lookup(&disk_base, &tree_base, file_id, &file),
+               SWICC_RET_SUCCESS);
+    CHECK_EQ(swicc_disk_file_rcrd_write(tree_a, &file, 0U, rcrd_new,
+                                        sizeof(rcrd_new)),
+             SWICC_RET_SUCCESS);
+    CHECK_EQ(tree_a->ovl.count, 1U);
+    /* Writing the same record again must not add to the overlay. */
+    CHECK_EQ(swicc_disk_file_rcrd_write(tree_a, &file, 0U, rcrd_new,
+                                        sizeof(rcrd_new)),
+             SWICC_RET_SUCCESS);
+    CHECK_EQ(tree_a->ovl.count, 1U);
+
+    /* Only the overlay which was written to sees the modification. */
+    uint8_t *buf;
+    uint8_t len;
+    CHECK_EQ(swicc_disk_file_rcrd(tree_a, &file, 0U, &buf, &len),
+             SWICC_RET_SUCCESS);
+    CHECK_BUF_EQ(buf, rcrd_new, sizeof(rcrd_new));
+    CHECK_EQ(swicc_disk_file_rcrd(tree_b, &file, 0U, &buf, &len),
+             SWICC_RET_SUCCESS);
+    CHECK_BUF_EQ(buf, rcrd_old, sizeof(rcrd_old));
+    CHECK_EQ(swicc_disk_file_rcrd(tree_base, &file, 0U, &buf, &len),
+             SWICC_RET_SUCCESS);
+    CHECK_BUF_EQ(buf, rcrd_old, sizeof(rcrd_old));
+
+    /* Saving an overlay saves the modifications. */
+    swicc_disk_st disk_saved = {0U};
+    CHECK_EQ(swicc_disk_save(&disk_a, disk_path), SWICC_RET_SUCCESS);
+    REQUIRE_EQ(swicc_disk_load(&disk_saved, disk_path), SWICC_RET_SUCCESS);
+    CHECK_EQ(swicc_disk_lutid_lookup(&disk_saved, &tree_a, file_id, &file),
+             SWICC_RET_SUCCESS);
+    CHECK_EQ(swicc_disk_file_rcrd(tree_a, &file, 0U, &buf, &len),
+             SWICC_RET_SUCCESS);
+    CHECK_BUF_EQ(buf, rcrd_new, sizeof(rcrd_new));
+    swicc_disk_unload(&disk_saved);
+
+    /* Unloading an overlay leaves the base untouched. */
+    swicc_disk_unload(&disk_a);
+    CHECK_BUF_EQ(&disk_a, &disk_zero, sizeof(disk_a));
+    swicc_disk_unload(&disk_b);
+    CHECK_EQ(swicc_disk_lutid_lookup(&disk_base, &tree_base, file_id, &file),
+             SWICC_RET_SUCCESS);
+    swicc_disk_unload(&disk_base);
+}
+
 TEST(fs_disk, swicc_disk_unload__disk)
 {
     swicc_disk_st const disk_zero = {0U};
@@ -345,6 +623,18 @@ TEST(fs_disk, swicc_disk_lutsid_empty__disk)
     swicc_disk_unload(&disk);
 }
 
+TEST(fs_disk, swicc_disk_lutchild_empty__disk)
+{
+    swicc_disk_lut_st const lutchild_zero = {0};
+    swicc_disk_st disk = {0U};
+    REQUIRE_EQ(swicc_diskjs_disk_create(&disk, "test/data/disk/004-in.json"),
+               SWICC_RET_SUCCESS);
+    swicc_disk_lutchild_empty(disk.root);
+    CHECK_BUF_EQ((uint8_t *)&disk.root->lutchild, (uint8_t *)&lutchild_zero,
+                 sizeof(lutchild_zero));
+    swicc_disk_unload(&disk);
+}
+
 TEST(fs_disk, swicc_disk_lutid_empty__disk)
 {
     swicc_disk_lut_st const lutid_zero = {0};
@@ -396,6 +686,29 @@ TEST(fs_disk, swicc_disk_lutid_rebuild__disk)
     swicc_disk_unload(&disk);
 }
 
+TEST(fs_disk, swicc_disk_lutid_rebuild__sorted)
+{
+    swicc_disk_st disk = {0U};
+    REQUIRE_EQ(swicc_diskjs_disk_create(&disk, "test/data/disk/006-in.json"),
+               SWICC_RET_SUCCESS);
+
+    /**
+     * The LUT is built in bulk and sorted once at the end so make sure all IDs
+     * of the disk are present and strictly increasing (no duplicate IDs in
+     * this disk).
+     */
+    CHECK_EQ(disk.lutid.count, 16U);
+    CHECK_LE(disk.lutid.count, disk.lutid.count_max);
+    for (uint32_t entry_idx = 1U; entry_idx < disk.lutid.count; ++entry_idx)
+    {
+        CHECK_TRUE(memcmp(&disk.lutid.buf1[disk.lutid.size_item1 *
+                                           (entry_idx - 1U)],
+                          &disk.lutid.buf1[disk.lutid.size_item1 * entry_idx],
+                          disk.lutid.size_item1) < 0);
+    }
+    swicc_disk_unload(&disk);
+}
+
 TEST(fs_disk, swicc_disk_lutsid_rebuild__param_check)
 {
     swicc_disk_st *const disk = (swicc_disk_st *)1U;
@@ -438,6 +751,193 @@ TEST(fs_disk, swicc_disk_lutsid_rebuild__disk)
     swicc_disk_unload(&disk);
 }
 
+TEST(fs_disk, swicc_disk_lutchild_rebuild__param_check)
+{
+    swicc_disk_st *const disk = (swicc_disk_st *)1U;
+    swicc_disk_tree_st *const tree = (swicc_disk_tree_st *)1U;
+    CHECK_EQ(swicc_disk_lutchild_rebuild(NULL, tree), SWICC_RET_PARAM_BAD);
+    CHECK_EQ(swicc_disk_lutchild_rebuild(disk, NULL), SWICC_RET_PARAM_BAD);
+}
+
+TEST(fs_disk, swicc_disk_lutchild_rebuild__disk)
+{
+    swicc_disk_lut_st lutchild_copy;
+    swicc_disk_st disk = {0U};
+    REQUIRE_EQ(swicc_diskjs_disk_create(&disk, "test/data/disk/006-in.json"),
+               SWICC_RET_SUCCESS);
+
+    /* Move the child LUT out of the tree into a local var. */
+    memcpy(&lutchild_copy, &disk.root->lutchild, sizeof(swicc_disk_lut_st));
+    memset(&disk.root->lutchild, 0U, sizeof(swicc_disk_lut_st));
+
+    /* Every tree of this disk has a root with 3 EFs in it. */
+    CHECK_EQ(swicc_disk_lutchild_rebuild(&disk, disk.root), SWICC_RET_SUCCESS);
+    CHECK_EQ(disk.root->lutchild.count, 3U);
+    CHECK_TRUE(lut_equal(&disk.root->lutchild, &lutchild_copy));
+
+    swicc_disk_unload(&disk);
+    memcpy(&disk.lutid, &lutchild_copy, sizeof(swicc_disk_lut_st));
+    swicc_disk_unload(&disk);
+}
+
+TEST(fs_disk, swicc_disk_lutchild_lookup__param_check)
+{
+    swicc_disk_tree_st *const tree = (swicc_disk_tree_st *)1U;
+    swicc_fs_file_st *const file = (swicc_fs_file_st *)1U;
+    CHECK_EQ(swicc_disk_lutchild_lookup(NULL, file, 0U, file),
+             SWICC_RET_PARAM_BAD);
+    CHECK_EQ(swicc_disk_lutchild_lookup(tree, NULL, 0U, file),
+             SWICC_RET_PARAM_BAD);
+    CHECK_EQ(swicc_disk_lutchild_lookup(tree, file, 0U, NULL),
+             SWICC_RET_PARAM_BAD);
+}
+
+TEST(fs_disk, swicc_disk_lutchild_lookup__disk)
+{
+    swicc_disk_st disk = {0U};
+    REQUIRE_EQ(swicc_diskjs_disk_create(&disk, "test/data/disk/006-in.json"),
+               SWICC_RET_SUCCESS);
+
+    swicc_fs_file_st file_root;
+    swicc_fs_file_st file;
+    REQUIRE_EQ(swicc_disk_tree_file_root(disk.root, &file_root),
+               SWICC_RET_SUCCESS);
+    CHECK_EQ(swicc_disk_lutchild_lookup(disk.root, &file_root, 0xE99D, &file),
+             SWICC_RET_SUCCESS);
+    CHECK_EQ(file.hdr_file.id, 0xE99D);
+    CHECK_EQ(file.hdr_item.type, SWICC_FS_ITEM_TYPE_FILE_EF_LINEARFIXED);
+
+    /* Neither the folder itself nor files in other trees are its children. */
+    CHECK_EQ(swicc_disk_lutchild_lookup(disk.root, &file_root, 0xE7C7, &file),
+             SWICC_RET_FS_NOT_FOUND);
+    CHECK_EQ(swicc_disk_lutchild_lookup(disk.root, &file_root, 0x862F, &file),
+             SWICC_RET_FS_NOT_FOUND);
+
+    /* EFs have no children. */
+    swicc_fs_file_st file_ef;
+    REQUIRE_EQ(swicc_disk_lutchild_lookup(disk.root, &file_root, 0xF4F4,
+                                          &file_ef),
+               SWICC_RET_SUCCESS);
+    CHECK_EQ(swicc_disk_lutchild_lookup(disk.root, &file_ef, 0xE99D, &file),
+             SWICC_RET_FS_NOT_FOUND);
+    swicc_disk_unload(&disk);
+}
+
+TEST(fs_disk, swicc_disk_hdrtbl_empty__disk)
+{
+    swicc_disk_hdrtbl_st const hdrtbl_zero = {0};
+    swicc_disk_st disk = {0U};
+    REQUIRE_EQ(swicc_diskjs_disk_create(&disk, "test/data/disk/004-in.json"),
+               SWICC_RET_SUCCESS);
+    swicc_disk_hdrtbl_empty(disk.root);
+    CHECK_BUF_EQ((uint8_t *)&disk.root->hdrtbl, (uint8_t *)&hdrtbl_zero,
+                 sizeof(hdrtbl_zero));
+    swicc_disk_unload(&disk);
+}
+
+TEST(fs_disk, swicc_disk_hdrtbl_rebuild__param_check)
+{
+    swicc_disk_st *const disk = (swicc_disk_st *)1U;
+    swicc_disk_tree_st *const tree = (swicc_disk_tree_st *)1U;
+    CHECK_EQ(swicc_disk_hdrtbl_rebuild(NULL, tree), SWICC_RET_PARAM_BAD);
+    CHECK_EQ(swicc_disk_hdrtbl_rebuild(disk, NULL), SWICC_RET_PARAM_BAD);
+}
+
+TEST(fs_disk, swicc_disk_hdrtbl_rebuild__disk)
+{
+    swicc_disk_st disk = {0U};
+    REQUIRE_EQ(swicc_diskjs_disk_create(&disk, "test/data/disk/007-in.json"),
+               SWICC_RET_SUCCESS);
+
+    /* The MF of this disk has a DF in it. */
+    CHECK_EQ(swicc_disk_hdrtbl_rebuild(&disk, disk.root), SWICC_RET_SUCCESS);
+    REQUIRE_EQ(disk.root->hdrtbl.folder_count, 2U);
+    CHECK_EQ(disk.root->hdrtbl.folder[0U].hdr_item.offset_trel, 0U);
+    CHECK_EQ(disk.root->hdrtbl.folder[0U].hdr_item.type,
+             SWICC_FS_ITEM_TYPE_FILE_MF);
+    CHECK_EQ(disk.root->hdrtbl.folder[1U].hdr_item.type,
+             SWICC_FS_ITEM_TYPE_FILE_DF);
+    CHECK_LE(disk.root->hdrtbl.folder_count * 2U,
+             disk.root->hdrtbl.slot_count);
+
+    /* The decoded headers are the same as the parsed ones. */
+    swicc_disk_hdrtbl_st hdrtbl_copy;
+    memcpy(&hdrtbl_copy, &disk.root->hdrtbl, sizeof(hdrtbl_copy));
+    memset(&disk.root->hdrtbl, 0U, sizeof(disk.root->hdrtbl));
+    for (uint32_t folder_idx = 0U; folder_idx < hdrtbl_copy.folder_count;
+         ++folder_idx)
+    {
+        swicc_fs_file_st file;
+        REQUIRE_EQ(
+            swicc_fs_file_prs(
+                disk.root, hdrtbl_copy.folder[folder_idx].hdr_item.offset_trel,
+                &file),
+            SWICC_RET_SUCCESS);
+        CHECK_BUF_EQ((uint8_t *)&file,
+                     (uint8_t *)&hdrtbl_copy.folder[folder_idx], sizeof(file));
+    }
+    memcpy(&disk.root->hdrtbl, &hdrtbl_copy, sizeof(hdrtbl_copy));
+    swicc_disk_unload(&disk);
+
+    /* EFs are not in the header table. */
+    REQUIRE_EQ(swicc_diskjs_disk_create(&disk, "test/data/disk/006-in.json"),
+               SWICC_RET_SUCCESS);
+    CHECK_EQ(swicc_disk_hdrtbl_rebuild(&disk, disk.root), SWICC_RET_SUCCESS);
+    CHECK_EQ(disk.root->hdrtbl.folder_count, 1U);
+    swicc_disk_unload(&disk);
+}
+
+TEST(fs_disk, swicc_disk_hdrtbl_lookup__param_check)
+{
+    swicc_disk_tree_st *const tree = (swicc_disk_tree_st *)1U;
+    swicc_fs_file_st const *file;
+    CHECK_EQ(swicc_disk_hdrtbl_lookup(NULL, 0U, &file), SWICC_RET_PARAM_BAD);
+    CHECK_EQ(swicc_disk_hdrtbl_lookup(tree, 0U, NULL), SWICC_RET_PARAM_BAD);
+}
+
+TEST(fs_disk, swicc_disk_hdrtbl_lookup__disk)
+{
+    swicc_disk_st disk = {0U};
+    REQUIRE_EQ(swicc_diskjs_disk_create(&disk, "test/data/disk/007-in.json"),
+               SWICC_RET_SUCCESS);
+
+    /* The lookup gives a pointer into the header table. */
+    swicc_fs_file_st const *file;
+    CHECK_EQ(swicc_disk_hdrtbl_lookup(disk.root, 0U, &file),
+             SWICC_RET_SUCCESS);
+    CHECK_EQ(file, &disk.root->hdrtbl.folder[0U]);
+    uint32_t const offset_trel_df =
+        disk.root->hdrtbl.folder[1U].hdr_item.offset_trel;
+    CHECK_EQ(swicc_disk_hdrtbl_lookup(disk.root, offset_trel_df, &file),
+             SWICC_RET_SUCCESS);
+    CHECK_EQ(file->hdr_item.type, SWICC_FS_ITEM_TYPE_FILE_DF);
+    CHECK_BUF_EQ(file->hdr_spec.df.name, "TELECOM", strlen("TELECOM"));
+
+    /* Only the start of a folder can be looked up. */
+    CHECK_EQ(swicc_disk_hdrtbl_lookup(disk.root, offset_trel_df + 1U, &file),
+             SWICC_RET_FS_NOT_FOUND);
+
+    /* Without a header table, nothing can be looked up. */
+    swicc_disk_hdrtbl_empty(disk.root);
+    CHECK_EQ(swicc_disk_hdrtbl_lookup(disk.root, 0U, &file), SWICC_RET_ERROR);
+    swicc_disk_unload(&disk);
+
+    /* EFs can't be looked up. */
+    REQUIRE_EQ(swicc_diskjs_disk_create(&disk, "test/data/disk/006-in.json"),
+               SWICC_RET_SUCCESS);
+    swicc_fs_file_st file_root;
+    swicc_fs_file_st file_ef;
+    REQUIRE_EQ(swicc_disk_tree_file_root(disk.root, &file_root),
+               SWICC_RET_SUCCESS);
+    REQUIRE_EQ(swicc_disk_lutchild_lookup(disk.root, &file_root, 0xE99D,
+                                          &file_ef),
+               SWICC_RET_SUCCESS);
+    CHECK_EQ(swicc_disk_hdrtbl_lookup(disk.root, file_ef.hdr_item.offset_trel,
+                                      &file),
+             SWICC_RET_FS_NOT_FOUND);
+    swicc_disk_unload(&disk);
+}
+
 TEST(fs_disk, swicc_disk_lutsid_lookup__param_check)
 {
     swicc_disk_tree_st *const tree = (swicc_disk_tree_st *)1U;
@@ -598,6 +1098,254 @@ TEST(fs_disk, swicc_disk_lutid_lookup__disk)
     swicc_disk_unload(&disk);
 }
 
+TEST(fs_disk, swicc_disk_lutname_empty__disk)
+{
+    swicc_disk_lut_st const lutname_zero = {0};
+    swicc_disk_st disk = {0U};
+    REQUIRE_EQ(swicc_diskjs_disk_create(&disk, "test/data/disk/007-in.json"),
+               SWICC_RET_SUCCESS);
+    swicc_disk_lutname_empty(&disk);
+    CHECK_BUF_EQ((uint8_t *)&disk.lutname, (uint8_t *)&lutname_zero,
+                 sizeof(lutname_zero));
+    swicc_disk_unload(&disk);
+}
+
+TEST(fs_disk, swicc_disk_lutname_rebuild__param_check)
+{
+    CHECK_EQ(swicc_disk_lutname_rebuild(NULL), SWICC_RET_PARAM_BAD);
+}
+
+TEST(fs_disk, swicc_disk_lutname_rebuild__disk)
+{
+    swicc_disk_lut_st lutname_copy;
+    swicc_disk_st disk = {0U};
+    REQUIRE_EQ(swicc_diskjs_disk_create(&disk, "test/data/disk/007-in.json"),
+               SWICC_RET_SUCCESS);
+
+    /* Move the name LUT out of the disk into a local var. */
+    memcpy(&lutname_copy, &disk.lutname, sizeof(swicc_disk_lut_st));
+    memset(&disk.lutname, 0U, sizeof(swicc_disk_lut_st));
+
+    /* Only the MF and the DF have names. */
+    CHECK_EQ(swicc_disk_lutname_rebuild(&disk), SWICC_RET_SUCCESS);
+    CHECK_EQ(disk.lutname.count, 2U);
+    CHECK_TRUE(lut_equal(&disk.lutname, &lutname_copy));
+    CHECK_TRUE(memcmp(&disk.lutname.buf1[0U], "MF", 2U) == 0);
+
+    swicc_disk_unload(&disk);
+    memcpy(&disk.lutname, &lutname_copy, sizeof(swicc_disk_lut_st));
+    swicc_disk_unload(&disk);
+}
+
+TEST(fs_disk, swicc_disk_lutname_lookup__param_check)
+{
+    swicc_disk_st *const disk = (swicc_disk_st *)1U;
+    swicc_disk_tree_st **const tree = (swicc_disk_tree_st **)1U;
+    uint8_t const name[SWICC_FS_NAME_LEN] = {0U};
+    swicc_fs_file_st *const file = (swicc_fs_file_st *)1U;
+    CHECK_EQ(swicc_disk_lutname_lookup(NULL, tree, name, sizeof(name), file),
+             SWICC_RET_PARAM_BAD);
+    CHECK_EQ(swicc_disk_lutname_lookup(disk, NULL, name, sizeof(name), file),
+             SWICC_RET_PARAM_BAD);
+    CHECK_EQ(swicc_disk_lutname_lookup(disk, tree, NULL, sizeof(name), file),
+             SWICC_RET_PARAM_BAD);
+    CHECK_EQ(
+        swicc_disk_lutname_lookup(disk, tree, name, sizeof(name) + 1U, file),
+        SWICC_RET_PARAM_BAD);
+    CHECK_EQ(swicc_disk_lutname_lookup(disk, tree, name, sizeof(name), NULL),
+             SWICC_RET_PARAM_BAD);
+}
+
+TEST(fs_disk, swicc_disk_lutname_lookup__disk)
+{
+    swicc_disk_st disk = {0U};
+    REQUIRE_EQ(swicc_diskjs_disk_create(&disk, "test/data/disk/007-in.json"),
+               SWICC_RET_SUCCESS);
+
+    swicc_disk_tree_st *tree;
+    swicc_fs_file_st file;
+    CHECK_EQ(swicc_disk_lutname_lookup(&disk, &tree, (uint8_t *)"MF", 2U,
+                                       &file),
+             SWICC_RET_SUCCESS);
+    CHECK_EQ(file.hdr_item.type, SWICC_FS_ITEM_TYPE_FILE_MF);
+    CHECK_EQ(file.hdr_file.id, 0x3F00);
+    CHECK_EQ(swicc_disk_lutname_lookup(&disk, &tree, (uint8_t *)"TELECOM", 7U,
+                                       &file),
+             SWICC_RET_SUCCESS);
+    CHECK_EQ(file.hdr_item.type, SWICC_FS_ITEM_TYPE_FILE_DF);
+    CHECK_TRUE(memcmp(file.hdr_spec.df.name, "TELECOM", 7U) == 0);
+
+    /* The start of a name is enough. */
+    CHECK_EQ(swicc_disk_lutname_lookup(&disk, &tree, (uint8_t *)"TEL", 3U,
+                                       &file),
+             SWICC_RET_SUCCESS);
+    CHECK_EQ(file.hdr_item.type, SWICC_FS_ITEM_TYPE_FILE_DF);
+
+    CHECK_EQ(swicc_disk_lutname_lookup(&disk, &tree, (uint8_t *)"TELEX", 5U,
+                                       &file),
+             SWICC_RET_FS_NOT_FOUND);
+    CHECK_EQ(swicc_disk_lutname_lookup(&disk, &tree, (uint8_t *)"Z", 1U,
+                                       &file),
+             SWICC_RET_FS_NOT_FOUND);
+    swicc_disk_unload(&disk);
+}
+
+TEST(fs_disk, swicc_disk_lutaid_empty__disk)
+{
+    swicc_disk_lut_st const lutaid_zero = {0};
+    swicc_disk_st disk = {0U};
+    REQUIRE_EQ(swicc_diskjs_disk_create(&disk, "test/data/disk/005-in.json"),
+               SWICC_RET_SUCCESS);
+    REQUIRE_EQ(swicc_disk_lutaid_rebuild(&disk), SWICC_RET_SUCCESS);
+    swicc_disk_lutaid_empty(&disk);
+    CHECK_BUF_EQ((uint8_t *)&disk.lutaid, (uint8_t *)&lutaid_zero,
+                 sizeof(lutaid_zero));
+    swicc_disk_unload(&disk);
+}
+
+TEST(fs_disk, swicc_disk_lutaid_rebuild__param_check)
+{
+    CHECK_EQ(swicc_disk_lutaid_rebuild(NULL), SWICC_RET_PARAM_BAD);
+}
+
+TEST(fs_disk, swicc_disk_lutaid_rebuild__disk)
+{
+    swicc_disk_st disk = {0U};
+    REQUIRE_EQ(swicc_diskjs_disk_create(&disk, "test/data/disk/005-in.json"),
+               SWICC_RET_SUCCESS);
+    REQUIRE_EQ(swicc_disk_lutaid_rebuild(&disk), SWICC_RET_SUCCESS);
+
+    /* Only the ADFs are in the LUT, sorted by AID. */
+    REQUIRE_EQ(disk.lutaid.count, 3U);
+    CHECK_EQ(disk.lutaid.size_item1, SWICC_FS_ADF_AID_LEN);
+    CHECK_EQ(disk.lutaid.buf1[disk.lutaid.size_item1 * 0U], 0x17);
+    CHECK_EQ(disk.lutaid.buf1[disk.lutaid.size_item1 * 1U], 0x40);
+    CHECK_EQ(disk.lutaid.buf1[disk.lutaid.size_item1 * 2U], 0xBD);
+    swicc_disk_unload(&disk);
+}
+
+TEST(fs_disk, swicc_disk_lutaid_lookup__param_check)
+{
+    swicc_disk_st *const disk = (swicc_disk_st *)1U;
+    uint8_t const aid[SWICC_FS_ADF_AID_LEN] = {0U};
+    swicc_disk_tree_st **const tree = (swicc_disk_tree_st **)1U;
+    swicc_fs_file_st *const file = (swicc_fs_file_st *)1U;
+    CHECK_EQ(swicc_disk_lutaid_lookup(NULL, aid, sizeof(aid),
+                                      SWICC_FS_OCC_FIRST, NULL, tree, file),
+             SWICC_RET_PARAM_BAD);
+    CHECK_EQ(swicc_disk_lutaid_lookup(disk, NULL, sizeof(aid),
+                                      SWICC_FS_OCC_FIRST, NULL, tree, file),
+             SWICC_RET_PARAM_BAD);
+    CHECK_EQ(swicc_disk_lutaid_lookup(disk, aid, SWICC_FS_ADF_AID_RID_LEN - 1U,
+                                      SWICC_FS_OCC_FIRST, NULL, tree, file),
+             SWICC_RET_PARAM_BAD);
+    CHECK_EQ(swicc_disk_lutaid_lookup(disk, aid, sizeof(aid) + 1U,
+                                      SWICC_FS_OCC_FIRST, NULL, tree, file),
+             SWICC_RET_PARAM_BAD);
+    CHECK_EQ(swicc_disk_lutaid_lookup(disk, aid, sizeof(aid),
+                                      SWICC_FS_OCC_FIRST, NULL, NULL, file),
+             SWICC_RET_PARAM_BAD);
+    CHECK_EQ(swicc_disk_lutaid_lookup(disk, aid, sizeof(aid),
+                                      SWICC_FS_OCC_FIRST, NULL, tree, NULL),
+             SWICC_RET_PARAM_BAD);
+}
+
+TEST(fs_disk, swicc_disk_lutaid_lookup__disk)
+{
+    /**
+     * Give all ADFs the same RID so that a right-truncated AID matches more
+     * than one ADF. The PIXs then start with 0xE5, 0xEF, and 0xDE.
+     */
+    static uint8_t const rid[SWICC_FS_ADF_AID_RID_LEN] = {0xBD, 0x20, 0x16,
+                                                          0x32, 0xEB};
+    swicc_disk_st disk = {0U};
+    REQUIRE_EQ(swicc_diskjs_disk_create(&disk, "test/data/disk/005-in.json"),
+               SWICC_RET_SUCCESS);
+    for (swicc_disk_tree_st *tree = disk.root; tree != NULL; tree = tree->next)
+    {
+        swicc_fs_file_st file_root;
+        REQUIRE_EQ(swicc_disk_tree_file_root(tree, &file_root),
+                   SWICC_RET_SUCCESS);
+        if (file_root.hdr_item.type != SWICC_FS_ITEM_TYPE_FILE_ADF)
+        {
+            continue;
+        }
+        bool rid_found = false;
+        for (uint32_t buf_idx = 0U;
+             buf_idx + SWICC_FS_ADF_AID_RID_LEN <= tree->len; ++buf_idx)
+        {
+            if (memcmp(&tree->buf[buf_idx], file_root.hdr_spec.adf.aid.rid,
+                       SWICC_FS_ADF_AID_RID_LEN) == 0)
+            {
+                memcpy(&tree->buf[buf_idx], rid, sizeof(rid));
+                rid_found = true;
+                break;
+            }
+        }
+        REQUIRE_TRUE(rid_found);
+        /* The decoded header of the ADF still has the old RID. */
+        REQUIRE_EQ(swicc_disk_hdrtbl_rebuild(&disk, tree), SWICC_RET_SUCCESS);
+    }
+    REQUIRE_EQ(swicc_disk_lutaid_rebuild(&disk), SWICC_RET_SUCCESS);
+
+    swicc_disk_tree_st *tree;
+    swicc_disk_tree_st *tree_first;
+    swicc_fs_file_st file;
+
+    /* Lookup of a whole AID. */
+    static uint8_t const aid[SWICC_FS_ADF_AID_LEN] = {
+        0xBD, 0x20, 0x16, 0x32, 0xEB, 0xEF, 0x04, 0xE0,
+        0x56, 0x0C, 0xA8, 0x4B, 0x6A, 0xEC, 0x22, 0xD8};
+    CHECK_EQ(swicc_disk_lutaid_lookup(&disk, aid, sizeof(aid),
+                                      SWICC_FS_OCC_FIRST, NULL, &tree, &file),
+             SWICC_RET_SUCCESS);
+    CHECK_EQ(file.hdr_file.id, 0x75C9);
+
+    /* Lookup of an AID which no ADF has. */
+    static uint8_t const aid_missing[SWICC_FS_ADF_AID_RID_LEN + 1U] = {
+        0xBD, 0x20, 0x16, 0x32, 0xEB, 0x05};
+    CHECK_EQ(swicc_disk_lutaid_lookup(&disk, aid_missing, sizeof(aid_missing),
+                                      SWICC_FS_OCC_FIRST, NULL, &tree, &file),
+             SWICC_RET_FS_NOT_FOUND);
+
+    /* All occurrences of a right-truncated AID. */
+    CHECK_EQ(swicc_disk_lutaid_lookup(&disk, rid, sizeof(rid),
+                                      SWICC_FS_OCC_FIRST, NULL, &tree, &file),
+             SWICC_RET_SUCCESS);
+    CHECK_EQ(file.hdr_file.id, 0x69C9);
+    tree_first = tree;
+    CHECK_EQ(swicc_disk_lutaid_lookup(&disk, rid, sizeof(rid),
+                                      SWICC_FS_OCC_NEXT, tree, &tree, &file),
+             SWICC_RET_SUCCESS);
+    CHECK_EQ(file.hdr_file.id, 0x7675);
+    CHECK_EQ(swicc_disk_lutaid_lookup(&disk, rid, sizeof(rid),
+                                      SWICC_FS_OCC_NEXT, tree, &tree, &file),
+             SWICC_RET_SUCCESS);
+    CHECK_EQ(file.hdr_file.id, 0x75C9);
+    CHECK_EQ(swicc_disk_lutaid_lookup(&disk, rid, sizeof(rid),
+                                      SWICC_FS_OCC_NEXT, tree, &tree, &file),
+             SWICC_RET_FS_NOT_FOUND);
+    CHECK_EQ(swicc_disk_lutaid_lookup(&disk, rid, sizeof(rid),
+                                      SWICC_FS_OCC_LAST, NULL, &tree, &file),
+             SWICC_RET_SUCCESS);
+    CHECK_EQ(file.hdr_file.id, 0x75C9);
+    CHECK_EQ(swicc_disk_lutaid_lookup(&disk, rid, sizeof(rid),
+                                      SWICC_FS_OCC_PREV, tree, &tree, &file),
+             SWICC_RET_SUCCESS);
+    CHECK_EQ(file.hdr_file.id, 0x7675);
+    CHECK_EQ(swicc_disk_lutaid_lookup(&disk, rid, sizeof(rid),
+                                      SWICC_FS_OCC_PREV, tree_first, &tree,
+                                      &file),
+             SWICC_RET_FS_NOT_FOUND);
+
+    /* Without a current ADF, the next occurrence is the first one. */
+    CHECK_EQ(swicc_disk_lutaid_lookup(&disk, rid, sizeof(rid),
+                                      SWICC_FS_OCC_NEXT, NULL, &tree, &file),
+             SWICC_RET_SUCCESS);
+    CHECK_EQ(tree, tree_first);
+    swicc_disk_unload(&disk);
+}
+
 TEST(fs_disk, swicc_disk_file_rcrd__param_check)
 {
     swicc_disk_tree_st *const tree = (swicc_disk_tree_st *)1U;
@@ -781,6 +1529,55 @@ TEST(fs_disk, swicc_disk_file_rcrd__disk)
     swicc_disk_unload(&disk);
 }
 
+TEST(fs_disk, swicc_disk_file_rcrd_write__param_check)
+{
+    /* These are invalid pointers but they are not NULL. */
+    swicc_disk_tree_st *const tree = (swicc_disk_tree_st *)1U;
+    swicc_fs_file_st const *const file = (swicc_fs_file_st const *)1U;
+    uint8_t const *const buf = (uint8_t const *)1U;
+    CHECK_EQ(swicc_disk_file_rcrd_write(NULL, file, 0U, buf, 1U),
+             SWICC_RET_PARAM_BAD);
+    CHECK_EQ(swicc_disk_file_rcrd_write(tree, NULL, 0U, buf, 1U),
+             SWICC_RET_PARAM_BAD);
+    CHECK_EQ(swicc_disk_file_rcrd_write(tree, file, 0U, NULL, 1U),
+             SWICC_RET_PARAM_BAD);
+}
+
+TEST(fs_disk, swicc_disk_file_rcrd_write__disk)
+{
+    static uint8_t const rcrd_new[16U] = {0x00, 0x01, 0x02, 0x03, 0x04, 0x05,
+                                          0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B,
+                                          0x0C, 0x0D, 0x0E, 0x0F};
+    swicc_disk_st disk = {0U};
+    REQUIRE_EQ(swicc_diskjs_disk_create(&disk, "test/data/disk/006-in.json"),
+               SWICC_RET_SUCCESS);
+
+    swicc_disk_tree_st *tree;
+    swicc_fs_file_st file;
+    REQUIRE_EQ(swicc_disk_lutid_lookup(&disk, &tree, 0x5ABD, &file),
+               SWICC_RET_SUCCESS);
+    CHECK_EQ(swicc_disk_file_rcrd_write(tree, &file, 2U, rcrd_new,
+                                        sizeof(rcrd_new) - 1U),
+             SWICC_RET_PARAM_BAD);
+    CHECK_EQ(swicc_disk_file_rcrd_write(tree, &file, 3U, rcrd_new,
+                                        sizeof(rcrd_new)),
+             SWICC_RET_FS_NOT_FOUND);
+    CHECK_EQ(swicc_disk_file_rcrd_write(tree, &file, 2U, rcrd_new,
+                                        sizeof(rcrd_new)),
+             SWICC_RET_SUCCESS);
+
+    /* Trees which are not shared get modified in-place. */
+    uint8_t *buf;
+    uint8_t len;
+    CHECK_EQ(swicc_disk_file_rcrd(tree, &file, 2U, &buf, &len),
+             SWICC_RET_SUCCESS);
+    CHECK_EQ(len, sizeof(rcrd_new));
+    CHECK_BUF_EQ(buf, rcrd_new, sizeof(rcrd_new));
+    CHECK_EQ(buf, &file.data[2U * sizeof(rcrd_new)]);
+    CHECK_EQ(tree->ovl.count, 0U);
+    swicc_disk_unload(&disk);
+}
+
 TEST(fs_disk, swicc_disk_file_rcrd_cnt__param_check)
 {
     swicc_disk_tree_st *const tree = (swicc_disk_tree_st *)1U;
@@ -0,0 +1,1086 @@
+#include <tau/tau.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stddef.h>
+#include <swicc/swicc.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#define NET_MUX_CARD_COUNT 4U
+
+/* Every test of the multi-card client runs with each of the backends. */
+static swicc_net_backend_et const net_backend[] = {SWICC_NET_BACKEND_EPOLL,
+                                                   SWICC_NET_BACKEND_URING};
+#define NET_BACKEND_COUNT (sizeof(net_backend) / sizeof(net_backend[0U]))
+
+static uint32_t net_mux_card_rm_count = 0U;
+static swicc_net_mux_card_rm_ft net_mux_card_rm;
+static void net_mux_card_rm(swicc_net_mux_st *const mux,
+                            swicc_net_mux_card_st *const card)
+{
+    net_mux_card_rm_count += 1U;
+}
+
+/**
+ * @brief Send a control request to a card and receive the response.
+ * @param sock The server side of the card socket.
+ * @param ctrl The control request.
+ * @param msg Where the response will be written.
+ * @return Return code.
+ */
+static swicc_ret_et net_mux_ctrl(int32_t const sock,
+                                 swicc_net_msg_ctrl_et const ctrl,
+                                 swicc_net_msg_st *const msg)
+{
+    memset(msg, 0U, sizeof(*msg));
+    msg->hdr.size = offsetof(swicc_net_msg_data_st, buf);
+    msg->data.ctrl = (uint8_t)ctrl;
+    return swicc_net_send(sock, msg);
+}
+
+/**
+ * @brief Create a message with some data in it.
+ * @param msg Where to create the message.
+ * @return Size of the whole message (header included).
+ */
+static uint32_t net_msg_create(swicc_net_msg_st *const msg)
+{
+    memset(msg, 0U, sizeof(*msg));
+    msg->hdr.size = offsetof(swicc_net_msg_data_st, buf) + 32U;
+    msg->data.cont_state = 0x01020304U;
+    msg->data.buf_len_exp = 32U;
+    for (uint8_t buf_idx = 0U; buf_idx < 32U; ++buf_idx)
+    {
+        msg->data.buf[buf_idx] = (uint8_t)(0xA0U + buf_idx);
+    }
+    return (uint32_t)sizeof(msg->hdr) + msg->hdr.size;
+}
+
+TEST(net, swicc_net_recv_part__fragmented)
+{
+    swicc_net_msg_st msg_tx;
+    swicc_net_msg_st msg_rx;
+    uint32_t const size_msg = net_msg_create(&msg_tx);
+    uint8_t const *const msg_tx_raw = (uint8_t const *)&msg_tx;
+    uint32_t recvd_len;
+
+    int32_t sock[2U];
+    REQUIRE_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, sock), 0);
+    REQUIRE_EQ(fcntl(sock[1U], F_SETFL, O_NONBLOCK), 0);
+
+    recvd_len = 0U;
+    CHECK_EQ(swicc_net_recv_part(-1, &msg_rx, &recvd_len), SWICC_RET_PARAM_BAD);
+    CHECK_EQ(swicc_net_recv_part(sock[1U], NULL, &recvd_len),
+             SWICC_RET_PARAM_BAD);
+    CHECK_EQ(swicc_net_recv_part(sock[1U], &msg_rx, NULL),
+             SWICC_RET_PARAM_BAD);
+    /* Nothing was sent yet. */
+    CHECK_EQ(swicc_net_recv_part(sock[1U], &msg_rx, &recvd_len),
+             SWICC_RET_NET_INCOMPLETE);
+    CHECK_EQ(recvd_len, 0U);
+
+    /* Split the message in two at every possible byte boundary. */
+    for (uint32_t split = 1U; split < size_msg; ++split)
+    {
+        memset(&msg_rx, 0U, sizeof(msg_rx));
+        recvd_len = 0U;
+        REQUIRE_EQ(send(sock[0U], msg_tx_raw, split, 0), (ssize_t)split);
+        CHECK_EQ(swicc_net_recv_part(sock[1U], &msg_rx, &recvd_len),
+                 SWICC_RET_NET_INCOMPLETE);
+        CHECK_EQ(recvd_len, split);
+        REQUIRE_EQ(send(sock[0U], &msg_tx_raw[split], size_msg - split, 0),
+                   (ssize_t)(size_msg - split));
+        CHECK_EQ(swicc_net_recv_part(sock[1U], &msg_rx, &recvd_len),
+                 SWICC_RET_SUCCESS);
+        CHECK_EQ(recvd_len, size_msg);
+        CHECK_BUF_EQ((uint8_t const *)&msg_rx, msg_tx_raw, size_msg);
+    }
+
+    /* Send the message one byte at a time. */
+    memset(&msg_rx, 0U, sizeof(msg_rx));
+    recvd_len = 0U;
+    for (uint32_t byte_idx = 0U; byte_idx < size_msg; ++byte_idx)
+    {
+        REQUIRE_EQ(send(sock[0U], &msg_tx_raw[byte_idx], 1U, 0), 1);
+        CHECK_EQ(swicc_net_recv_part(sock[1U], &msg_rx, &recvd_len),
+                 byte_idx + 1U == size_msg ? SWICC_RET_SUCCESS
+                                           : SWICC_RET_NET_INCOMPLETE);
+        CHECK_EQ(recvd_len, byte_idx + 1U);
+    }
+    CHECK_BUF_EQ((uint8_t const *)&msg_rx, msg_tx_raw, size_msg);
+
+    /* Back-to-back messages are received one by one. */
+    REQUIRE_EQ(send(sock[0U], msg_tx_raw, size_msg, 0), (ssize_t)size_msg);
+    REQUIRE_EQ(send(sock[0U], msg_tx_raw, size_msg, 0), (ssize_t)size_msg);
+    for (uint32_t msg_idx = 0U; msg_idx < 2U; ++msg_idx)
+    {
+        recvd_len = 0U;
+        CHECK_EQ(swicc_net_recv_part(sock[1U], &msg_rx, &recvd_len),
+                 SWICC_RET_SUCCESS);
+        CHECK_EQ(recvd_len, size_msg);
+    }
+    recvd_len = 0U;
+    CHECK_EQ(swicc_net_recv_part(sock[1U], &msg_rx, &recvd_len),
+             SWICC_RET_NET_INCOMPLETE);
+    CHECK_EQ(recvd_len, 0U);
+
+    /* A header with an invalid size is rejected as soon as it is in. */
+    msg_tx.hdr.size = sizeof(msg_tx.data) + 1U;
+    REQUIRE_EQ(send(sock[0U], &msg_tx.hdr, sizeof(msg_tx.hdr), 0),
+               (ssize_t)sizeof(msg_tx.hdr));
+    CHECK_EQ(swicc_net_recv_part(sock[1U], &msg_rx, &recvd_len),
+             SWICC_RET_ERROR);
+
+    /* Peer going away in the middle of a message is an error. */
+    net_msg_create(&msg_tx);
+    recvd_len = 0U;
+    REQUIRE_EQ(send(sock[0U], msg_tx_raw, 3U, 0), 3);
+    close(sock[0U]);
+    CHECK_EQ(swicc_net_recv_part(sock[1U], &msg_rx, &recvd_len),
+             SWICC_RET_ERROR);
+    close(sock[1U]);
+}
+
+TEST(net, swicc_net_send_part__short)
+{
+    swicc_net_msg_st msg_tx;
+    swicc_net_msg_st msg_rx;
+    uint32_t const size_msg = net_msg_create(&msg_tx);
+    uint32_t sent_len = 0U;
+
+    int32_t sock[2U];
+    REQUIRE_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, sock), 0);
+    REQUIRE_EQ(fcntl(sock[0U], F_SETFL, O_NONBLOCK), 0);
+
+    CHECK_EQ(swicc_net_send_part(-1, &msg_tx, &sent_len), SWICC_RET_PARAM_BAD);
+    CHECK_EQ(swicc_net_send_part(sock[0U], NULL, &sent_len),
+             SWICC_RET_PARAM_BAD);
+    CHECK_EQ(swicc_net_send_part(sock[0U], &msg_tx, NULL),
+             SWICC_RET_PARAM_BAD);
+
+    /* Fill up the socket so that the message can't be sent in one go. */
+    uint8_t junk[64U];
+    memset(junk, 0xFFU, sizeof(junk));
+    uint32_t junk_len = 0U;
+    ssize_t sent_bytes;
+    while ((sent_bytes = send(sock[0U], junk, sizeof(junk), 0)) > 0)
+    {
+        junk_len += (uint32_t)sent_bytes;
+    }
+    REQUIRE_EQ(errno == EAGAIN || errno == EWOULDBLOCK, true);
+    CHECK_EQ(swicc_net_send_part(sock[0U], &msg_tx, &sent_len),
+             SWICC_RET_NET_INCOMPLETE);
+    CHECK_LT(sent_len, size_msg);
+
+    /**
+     * Make a little room at a time and keep sending the rest, the peer must
+     * get the message exactly once.
+     */
+    swicc_ret_et ret = SWICC_RET_NET_INCOMPLETE;
+    uint32_t junk_recvd_len = 0U;
+    while (ret == SWICC_RET_NET_INCOMPLETE && junk_recvd_len < junk_len)
+    {
+        uint32_t const drain_len = junk_len - junk_recvd_len < sizeof(junk)
+                                       ? junk_len - junk_recvd_len
+                                       : sizeof(junk);
+        REQUIRE_EQ(recv(sock[1U], junk, drain_len, 0), (ssize_t)drain_len);
+        junk_recvd_len += drain_len;
+        ret = swicc_net_send_part(sock[0U], &msg_tx, &sent_len);
+    }
+    CHECK_EQ(ret, SWICC_RET_SUCCESS);
+    CHECK_EQ(sent_len, size_msg);
+    while (junk_recvd_len < junk_len)
+    {
+        uint32_t const drain_len = junk_len - junk_recvd_len < sizeof(junk)
+                                       ? junk_len - junk_recvd_len
+                                       : sizeof(junk);
+        REQUIRE_EQ(recv(sock[1U], junk, drain_len, 0), (ssize_t)drain_len);
+        junk_recvd_len += drain_len;
+    }
+    CHECK_EQ(swicc_net_recv(sock[1U], &msg_rx), SWICC_RET_SUCCESS);
+    CHECK_BUF_EQ((uint8_t const *)&msg_rx, (uint8_t const *)&msg_tx, size_msg);
+
+    /* Peer going away is an error and must not raise a SIGPIPE. */
+    close(sock[1U]);
+    sent_len = 0U;
+    CHECK_EQ(swicc_net_send_part(sock[0U], &msg_tx, &sent_len),
+             SWICC_RET_ERROR);
+    close(sock[0U]);
+}
+
+/**
+ * @brief Send a message from the server to the client and back.
+ * @param sock_server The server side of the connection.
+ * @param sock_client The client side of the connection.
+ * @return Return code.
+ */
+static swicc_ret_et net_echo(int32_t const sock_server,
+                             int32_t const sock_client)
+{
+    swicc_net_msg_st msg_tx;
+    swicc_net_msg_st msg_rx;
+    uint32_t const size_msg = net_msg_create(&msg_tx);
+    if (swicc_net_send(sock_server, &msg_tx) != SWICC_RET_SUCCESS ||
+        swicc_net_recv(sock_client, &msg_rx) != SWICC_RET_SUCCESS ||
+        memcmp(&msg_rx, &msg_tx, size_msg) != 0 ||
+        swicc_net_send(sock_client, &msg_rx) != SWICC_RET_SUCCESS ||
+        swicc_net_recv(sock_server, &msg_tx) != SWICC_RET_SUCCESS ||
+        memcmp(&msg_rx, &msg_tx, size_msg) != 0)
+    {
+        return SWICC_RET_ERROR;
+    }
+    return SWICC_RET_SUCCESS;
+}
+
+TEST(net, swicc_net_unix__server_client)
+{
+    /* Both an abstract name and a socket file, twice to replace the file. */
+    static char const *const path[] = {
+        "@swicc-Rk2vQ9mTb7LxWp4e",
+        "build/tmp/Ht5rW2qNc8ZpLk0d.sock",
+        "build/tmp/Ht5rW2qNc8ZpLk0d.sock",
+    };
+    char path_long[sizeof(((struct sockaddr_un *)NULL)->sun_path) + 1U];
+    memset(path_long, 'a', sizeof(path_long) - 1U);
+    path_long[sizeof(path_long) - 1U] = '\0';
+
+    swicc_net_server_st server_ctx;
+    swicc_net_client_st client_ctx;
+    CHECK_EQ(swicc_net_server_create_unix(&server_ctx, ""),
+             SWICC_RET_PARAM_BAD);
+    CHECK_EQ(swicc_net_server_create_unix(&server_ctx, path_long),
+             SWICC_RET_PARAM_BAD);
+    CHECK_EQ(swicc_net_client_create_unix(&client_ctx, path_long),
+             SWICC_RET_PARAM_BAD);
+    /* Nobody is listening. */
+    CHECK_EQ(swicc_net_client_create_unix(&client_ctx, path[0U]),
+             SWICC_RET_ERROR);
+
+    for (uint32_t path_idx = 0U; path_idx < sizeof(path) / sizeof(path[0U]);
+         ++path_idx)
+    {
+        memset(server_ctx.sock_client, 0xFFU, sizeof(server_ctx.sock_client));
+        REQUIRE_EQ(swicc_net_server_create_unix(&server_ctx, path[path_idx]),
+                   SWICC_RET_SUCCESS);
+        CHECK_EQ(swicc_net_server_client_connect(&server_ctx, 0U),
+                 SWICC_RET_NET_CONN_QUEUE_EMPTY);
+        REQUIRE_EQ(swicc_net_client_create_unix(&client_ctx, path[path_idx]),
+                   SWICC_RET_SUCCESS);
+        REQUIRE_EQ(swicc_net_server_client_connect(&server_ctx, 0U),
+                   SWICC_RET_SUCCESS);
+        CHECK_EQ(net_echo(server_ctx.sock_client[0U], client_ctx.sock_client),
+                 SWICC_RET_SUCCESS);
+        swicc_net_client_destroy(&client_ctx);
+        swicc_net_server_destroy(&server_ctx);
+    }
+    unlink(path[1U]);
+}
+
+TEST(net, swicc_net_server_client_pair)
+{
+    swicc_net_server_st server_ctx = {.sock_server = -1};
+    swicc_net_client_st client_ctx;
+    memset(server_ctx.sock_client, 0xFFU, sizeof(server_ctx.sock_client));
+
+    CHECK_EQ(swicc_net_server_client_pair(
+                 &server_ctx, SWICC_NET_CLIENT_COUNT_MAX, &client_ctx),
+             SWICC_RET_PARAM_BAD);
+    REQUIRE_EQ(swicc_net_server_client_pair(&server_ctx, 1U, &client_ctx),
+               SWICC_RET_SUCCESS);
+    /* Slot is taken. */
+    CHECK_EQ(swicc_net_server_client_pair(&server_ctx, 1U, &client_ctx),
+             SWICC_RET_PARAM_BAD);
+    CHECK_EQ(net_echo(server_ctx.sock_client[1U], client_ctx.sock_client),
+             SWICC_RET_SUCCESS);
+
+    swicc_net_server_client_disconnect(&server_ctx, 1U);
+    CHECK_EQ(server_ctx.sock_client[1U], -1);
+    swicc_net_msg_st msg;
+    CHECK_EQ(swicc_net_recv(client_ctx.sock_client, &msg), SWICC_RET_ERROR);
+    swicc_net_client_destroy(&client_ctx);
+    swicc_net_server_destroy(&server_ctx);
+}
+
+TEST(net, swicc_net_mux__param_check)
+{
+    /* These are invalid pointers but they are not NULL. */
+    swicc_net_mux_st *const mux = (swicc_net_mux_st *)1U;
+    swicc_net_mux_card_st card = {.swicc_state = NULL,
+                                  .client_ctx.sock_client = 0};
+    CHECK_EQ(swicc_net_mux_create(NULL, SWICC_NET_BACKEND_EPOLL),
+             SWICC_RET_PARAM_BAD);
+    CHECK_EQ(swicc_net_mux_card_add(NULL, &card), SWICC_RET_PARAM_BAD);
+    CHECK_EQ(swicc_net_mux_card_add(mux, NULL), SWICC_RET_PARAM_BAD);
+    CHECK_EQ(swicc_net_mux_card_add(mux, &card), SWICC_RET_PARAM_BAD);
+    CHECK_EQ(swicc_net_mux_card_remove(NULL, &card), SWICC_RET_PARAM_BAD);
+    CHECK_EQ(swicc_net_mux_card_remove(mux, NULL), SWICC_RET_PARAM_BAD);
+    CHECK_EQ(swicc_net_mux_poll(NULL, 0), SWICC_RET_PARAM_BAD);
+    CHECK_EQ(swicc_net_mux_run(NULL), SWICC_RET_PARAM_BAD);
+}
+
+TEST(net, swicc_net_mux__cards)
+{
+    for (uint32_t backend_idx = 0U; backend_idx < NET_BACKEND_COUNT;
+         ++backend_idx)
+    {
+        swicc_net_backend_et const backend = net_backend[backend_idx];
+        static swicc_st swicc_state[NET_MUX_CARD_COUNT];
+        static swicc_net_mux_card_st card[NET_MUX_CARD_COUNT];
+        int32_t sock_server[NET_MUX_CARD_COUNT];
+        swicc_net_mux_st mux;
+        swicc_net_msg_st msg;
+
+        /* All cards run on top of the same disk (which has an MF). */
+        swicc_disk_st disk_base = {0U};
+        REQUIRE_EQ(
+            swicc_diskjs_disk_create(&disk_base, "test/data/disk/007-in.json"),
+            SWICC_RET_SUCCESS);
+        REQUIRE_EQ(swicc_net_mux_create(&mux, backend), SWICC_RET_SUCCESS);
+        /* Without io_uring, the client falls back to epoll. */
+        CHECK_EQ(mux.backend == backend ||
+                     mux.backend == SWICC_NET_BACKEND_EPOLL,
+                 true);
+        mux.card_rm_cb = net_mux_card_rm;
+        net_mux_card_rm_count = 0U;
+        for (uint32_t card_idx = 0U; card_idx < NET_MUX_CARD_COUNT; ++card_idx)
+        {
+            int32_t sock_pair[2U];
+            REQUIRE_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, sock_pair), 0);
+            sock_server[card_idx] = sock_pair[0U];
+            memset(&swicc_state[card_idx], 0U, sizeof(swicc_state[card_idx]));
+            swicc_disk_st disk = {0U};
+            REQUIRE_EQ(swicc_disk_overlay(&disk, &disk_base),
+                       SWICC_RET_SUCCESS);
+            REQUIRE_EQ(swicc_fs_disk_mount(&swicc_state[card_idx], &disk),
+                       SWICC_RET_SUCCESS);
+            card[card_idx].swicc_state = &swicc_state[card_idx];
+            card[card_idx].client_ctx.sock_client = sock_pair[1U];
+            REQUIRE_EQ(swicc_net_mux_card_add(&mux, &card[card_idx]),
+                       SWICC_RET_SUCCESS);
+        }
+
+        /* Nothing was sent so polling must not block nor fail. */
+        CHECK_EQ(swicc_net_mux_poll(&mux, 0), SWICC_RET_SUCCESS);
+
+        /* All cards get served from a single poll. */
+        for (uint32_t card_idx = 0U; card_idx < NET_MUX_CARD_COUNT; ++card_idx)
+        {
+            CHECK_EQ(net_mux_ctrl(sock_server[card_idx],
+                                  SWICC_NET_MSG_CTRL_KEEPALIVE, &msg),
+                     SWICC_RET_SUCCESS);
+        }
+        CHECK_EQ(swicc_net_mux_poll(&mux, 1000), SWICC_RET_SUCCESS);
+        for (uint32_t card_idx = 0U; card_idx < NET_MUX_CARD_COUNT; ++card_idx)
+        {
+            CHECK_EQ(swicc_net_recv(sock_server[card_idx], &msg),
+                     SWICC_RET_SUCCESS);
+            CHECK_EQ(msg.data.ctrl, SWICC_NET_MSG_CTRL_SUCCESS);
+        }
+
+        /* A reset is performed only on the card it was sent to. */
+        CHECK_EQ(net_mux_ctrl(sock_server[1U],
+                              SWICC_NET_MSG_CTRL_MOCK_RESET_COLD_PPS_N, &msg),
+                 SWICC_RET_SUCCESS);
+        CHECK_EQ(swicc_net_mux_poll(&mux, 1000), SWICC_RET_SUCCESS);
+        CHECK_EQ(swicc_net_recv(sock_server[1U], &msg), SWICC_RET_SUCCESS);
+        CHECK_EQ(msg.data.ctrl, SWICC_NET_MSG_CTRL_SUCCESS);
+        CHECK_EQ(msg.hdr.size,
+                 offsetof(swicc_net_msg_data_st, buf) + sizeof(swicc_atr));
+        CHECK_BUF_EQ(msg.data.buf, swicc_atr, sizeof(swicc_atr));
+        CHECK_NE(swicc_state[1U].internal.fsm_state,
+                 swicc_state[0U].internal.fsm_state);
+
+        /* A card which gets disconnected is removed on its own. */
+        close(sock_server[2U]);
+        CHECK_EQ(swicc_net_mux_poll(&mux, 1000), SWICC_RET_SUCCESS);
+        CHECK_EQ(net_mux_card_rm_count, 1U);
+        CHECK_EQ(card[2U].ret, SWICC_RET_NET_DISCONNECTED);
+        CHECK_EQ(mux.card_count, NET_MUX_CARD_COUNT - 1U);
+
+        /* The other cards can be removed at any time. */
+        for (uint32_t card_idx = 0U; card_idx < NET_MUX_CARD_COUNT; ++card_idx)
+        {
+            if (card_idx != 2U)
+            {
+                CHECK_EQ(swicc_net_mux_card_remove(&mux, &card[card_idx]),
+                         SWICC_RET_SUCCESS);
+                close(sock_server[card_idx]);
+            }
+            swicc_net_client_destroy(&card[card_idx].client_ctx);
+            swicc_terminate(&swicc_state[card_idx]);
+        }
+        CHECK_EQ(mux.card_count, 0U);
+        /* Without cards, the client stops right away. */
+        CHECK_EQ(swicc_net_mux_run(&mux), SWICC_RET_SUCCESS);
+        swicc_net_mux_destroy(&mux);
+        swicc_disk_unload(&disk_base);
+    }
+}
+
+TEST(net, swicc_net_mux__fragmented)
+{
+    for (uint32_t backend_idx = 0U; backend_idx < NET_BACKEND_COUNT;
+         ++backend_idx)
+    {
+        swicc_net_backend_et const backend = net_backend[backend_idx];
+        static swicc_st swicc_state[2U];
+        static swicc_net_mux_card_st card[2U];
+        int32_t sock_server[2U];
+        swicc_net_mux_st mux;
+        swicc_net_msg_st msg;
+
+        REQUIRE_EQ(swicc_net_mux_create(&mux, backend), SWICC_RET_SUCCESS);
+        for (uint32_t card_idx = 0U; card_idx < 2U; ++card_idx)
+        {
+            int32_t sock_pair[2U];
+            REQUIRE_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, sock_pair), 0);
+            sock_server[card_idx] = sock_pair[0U];
+            memset(&swicc_state[card_idx], 0U, sizeof(swicc_state[card_idx]));
+            card[card_idx].swicc_state = &swicc_state[card_idx];
+            card[card_idx].client_ctx.sock_client = sock_pair[1U];
+            REQUIRE_EQ(swicc_net_mux_card_add(&mux, &card[card_idx]),
+                       SWICC_RET_SUCCESS);
+        }
+
+        /**
+         * The request to the first card arrives one byte at a time while the
+         * second card keeps getting served in between.
+         */
+        swicc_net_msg_st msg_req;
+        memset(&msg_req, 0U, sizeof(msg_req));
+        msg_req.hdr.size = offsetof(swicc_net_msg_data_st, buf);
+        msg_req.data.ctrl = SWICC_NET_MSG_CTRL_KEEPALIVE;
+        uint8_t const *const msg_req_raw = (uint8_t const *)&msg_req;
+        uint32_t const size_msg =
+            (uint32_t)sizeof(msg_req.hdr) + msg_req.hdr.size;
+        for (uint32_t byte_idx = 0U; byte_idx < size_msg; ++byte_idx)
+        {
+            REQUIRE_EQ(send(sock_server[0U], &msg_req_raw[byte_idx], 1U, 0), 1);
+            CHECK_EQ(net_mux_ctrl(sock_server[1U], SWICC_NET_MSG_CTRL_KEEPALIVE,
+                                  &msg),
+                     SWICC_RET_SUCCESS);
+            CHECK_EQ(swicc_net_mux_poll(&mux, 1000), SWICC_RET_SUCCESS);
+            CHECK_EQ(swicc_net_recv(sock_server[1U], &msg), SWICC_RET_SUCCESS);
+            CHECK_EQ(msg.data.ctrl, SWICC_NET_MSG_CTRL_SUCCESS);
+
+            if (byte_idx + 1U < size_msg)
+            {
+                /* No response until the whole request is in. */
+                CHECK_EQ(recv(sock_server[0U], &msg, sizeof(msg), MSG_DONTWAIT),
+                         -1);
+            }
+        }
+        /* The last byte may have been handled in the last poll already. */
+        CHECK_EQ(swicc_net_mux_poll(&mux, 0), SWICC_RET_SUCCESS);
+        CHECK_EQ(swicc_net_recv(sock_server[0U], &msg), SWICC_RET_SUCCESS);
+        CHECK_EQ(msg.data.ctrl, SWICC_NET_MSG_CTRL_SUCCESS);
+
+        /* Responses pile up when the peer does not read them... */
+        REQUIRE_EQ(fcntl(sock_server[0U], F_SETFL, O_NONBLOCK), 0);
+        uint32_t req_count = 0U;
+        while (card[0U].msg_tx_pending == false && req_count < 1000000U)
+        {
+            CHECK_EQ(net_mux_ctrl(sock_server[0U], SWICC_NET_MSG_CTRL_KEEPALIVE,
+                                  &msg),
+                     SWICC_RET_SUCCESS);
+            ++req_count;
+            CHECK_EQ(swicc_net_mux_poll(&mux, 1000), SWICC_RET_SUCCESS);
+        }
+        REQUIRE_EQ(card[0U].msg_tx_pending, true);
+        /* ...and once they are read, every one of them arrives whole. */
+        uint32_t res_count = 0U;
+        uint32_t recvd_len = 0U;
+        for (uint32_t try_idx = 0U; try_idx < 1000000U && res_count < req_count;
+             ++try_idx)
+        {
+            swicc_ret_et const ret =
+                swicc_net_recv_part(sock_server[0U], &msg, &recvd_len);
+            if (ret == SWICC_RET_SUCCESS)
+            {
+                CHECK_EQ(msg.data.ctrl, SWICC_NET_MSG_CTRL_SUCCESS);
+                recvd_len = 0U;
+                ++res_count;
+            }
+            else
+            {
+                REQUIRE_EQ(ret, SWICC_RET_NET_INCOMPLETE);
+                REQUIRE_EQ(swicc_net_mux_poll(&mux, 1000), SWICC_RET_SUCCESS);
+            }
+        }
+        CHECK_EQ(res_count, req_count);
+        /* With io_uring, the send completes only by the next poll. */
+        CHECK_EQ(swicc_net_mux_poll(&mux, 0), SWICC_RET_SUCCESS);
+        CHECK_EQ(card[0U].msg_tx_pending, false);
+        CHECK_EQ(mux.card_count, 2U);
+
+        for (uint32_t card_idx = 0U; card_idx < 2U; ++card_idx)
+        {
+            CHECK_EQ(swicc_net_mux_card_remove(&mux, &card[card_idx]),
+                     SWICC_RET_SUCCESS);
+            close(sock_server[card_idx]);
+            swicc_net_client_destroy(&card[card_idx].client_ctx);
+        }
+        swicc_net_mux_destroy(&mux);
+    }
+}
+
+#define NET_BATCH_SELECT_COUNT 8U
+
+/**
+ * @brief Create the TPDUs which select the MF and get the response (FCP), in
+ * the order in which a reader would send them.
+ * @param msg Where to create the TPDUs.
+ * @param le Length of the response to get.
+ */
+static void net_batch_select_create(swicc_net_msg_st *const msg,
+                                    uint8_t const le)
+{
+    static uint8_t const tpdu_select_hdr[] = {0x00, 0xA4, 0x00, 0x04, 0x02};
+    static uint8_t const tpdu_select_data[] = {0x3F, 0x00};
+    uint8_t const tpdu_res_get_hdr[] = {0x00, 0xC0, 0x00, 0x00, le};
+    memset(msg, 0U, sizeof(*msg) * NET_BATCH_SELECT_COUNT);
+    for (uint32_t msg_idx = 0U; msg_idx < NET_BATCH_SELECT_COUNT; ++msg_idx)
+    {
+        msg[msg_idx].hdr.size = offsetof(swicc_net_msg_data_st, buf);
+    }
+    /* Header, then get the procedure byte, data, and get the status. */
+    msg[0U].hdr.size += sizeof(tpdu_select_hdr);
+    memcpy(msg[0U].data.buf, tpdu_select_hdr, sizeof(tpdu_select_hdr));
+    msg[2U].hdr.size += sizeof(tpdu_select_data);
+    memcpy(msg[2U].data.buf, tpdu_select_data, sizeof(tpdu_select_data));
+    /* Header, then get the procedure byte, and get the data. */
+    msg[4U].hdr.size += sizeof(tpdu_res_get_hdr);
+    memcpy(msg[4U].data.buf, tpdu_res_get_hdr, sizeof(tpdu_res_get_hdr));
+}
+
+/**
+ * @brief Run the single-card client.
+ * @param arg The card to serve.
+ * @return Always NULL, the result is written to the card.
+ */
+static void *net_batch_client(void *const arg)
+{
+    swicc_net_mux_card_st *const card = arg;
+    card->ret = swicc_net_client(card->swicc_state, &card->client_ctx);
+    return NULL;
+}
+
+TEST(net, swicc_net_batch__cards)
+{
+    for (uint32_t backend_idx = 0U; backend_idx < NET_BACKEND_COUNT;
+         ++backend_idx)
+    {
+        swicc_net_backend_et const backend = net_backend[backend_idx];
+        /**
+         * Card 0 gets all requests one by one, the other ones get them
+         * batched.
+         */
+        static swicc_st swicc_state[3U];
+        static swicc_net_mux_card_st card[3U];
+        int32_t sock_server[3U];
+        swicc_net_mux_st mux;
+        swicc_net_msg_st msg_ref[NET_BATCH_SELECT_COUNT];
+        swicc_net_msg_st msg[SWICC_NET_BATCH_COUNT_MAX + 1U];
+
+        swicc_disk_st disk_base = {0U};
+        REQUIRE_EQ(
+            swicc_diskjs_disk_create(&disk_base, "test/data/disk/007-in.json"),
+            SWICC_RET_SUCCESS);
+        REQUIRE_EQ(swicc_net_mux_create(&mux, backend), SWICC_RET_SUCCESS);
+        for (uint32_t card_idx = 0U; card_idx < 3U; ++card_idx)
+        {
+            int32_t sock_pair[2U];
+            REQUIRE_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, sock_pair), 0);
+            sock_server[card_idx] = sock_pair[0U];
+            memset(&swicc_state[card_idx], 0U, sizeof(swicc_state[card_idx]));
+            swicc_disk_st disk = {0U};
+            REQUIRE_EQ(swicc_disk_overlay(&disk, &disk_base),
+                       SWICC_RET_SUCCESS);
+            REQUIRE_EQ(swicc_fs_disk_mount(&swicc_state[card_idx], &disk),
+                       SWICC_RET_SUCCESS);
+            card[card_idx].swicc_state = &swicc_state[card_idx];
+            card[card_idx].client_ctx.sock_client = sock_pair[1U];
+        }
+        /* The last card is served by the single-card client. */
+        REQUIRE_EQ(swicc_net_mux_card_add(&mux, &card[0U]), SWICC_RET_SUCCESS);
+        REQUIRE_EQ(swicc_net_mux_card_add(&mux, &card[1U]), SWICC_RET_SUCCESS);
+        pthread_t client_thread;
+        REQUIRE_EQ(pthread_create(&client_thread, NULL, net_batch_client,
+                                  &card[2U]),
+                   0);
+
+        CHECK_EQ(swicc_net_batch_send(-1, msg, 1U), SWICC_RET_PARAM_BAD);
+        CHECK_EQ(swicc_net_batch_send(sock_server[1U], NULL, 1U),
+                 SWICC_RET_PARAM_BAD);
+        CHECK_EQ(swicc_net_batch_send(sock_server[1U], msg,
+                                      SWICC_NET_BATCH_COUNT_MAX + 1U),
+                 SWICC_RET_PARAM_BAD);
+        CHECK_EQ(swicc_net_batch_recv(sock_server[1U], msg,
+                                      SWICC_NET_BATCH_COUNT_MAX + 1U),
+                 SWICC_RET_PARAM_BAD);
+
+        /* Reset all cards and check that they support batches. */
+        for (uint32_t card_idx = 0U; card_idx < 3U; ++card_idx)
+        {
+            CHECK_EQ(net_mux_ctrl(sock_server[card_idx],
+                                  SWICC_NET_MSG_CTRL_MOCK_RESET_COLD_PPS_Y,
+                                  &msg[0U]),
+                     SWICC_RET_SUCCESS);
+        }
+        CHECK_EQ(swicc_net_mux_poll(&mux, 1000), SWICC_RET_SUCCESS);
+        for (uint32_t card_idx = 0U; card_idx < 3U; ++card_idx)
+        {
+            CHECK_EQ(swicc_net_recv(sock_server[card_idx], &msg[0U]),
+                     SWICC_RET_SUCCESS);
+            CHECK_EQ(msg[0U].data.ctrl, SWICC_NET_MSG_CTRL_SUCCESS);
+            CHECK_EQ(swicc_net_batch_send(sock_server[card_idx], NULL, 0U),
+                     SWICC_RET_SUCCESS);
+        }
+        CHECK_EQ(swicc_net_mux_poll(&mux, 1000), SWICC_RET_SUCCESS);
+        for (uint32_t card_idx = 0U; card_idx < 3U; ++card_idx)
+        {
+            CHECK_EQ(swicc_net_batch_recv(sock_server[card_idx], NULL, 0U),
+                     SWICC_RET_SUCCESS);
+        }
+
+        /* One round trip per request. */
+        uint8_t le = 0U;
+        for (uint32_t msg_idx = 0U; msg_idx < NET_BATCH_SELECT_COUNT; ++msg_idx)
+        {
+            if (msg_idx == 4U)
+            {
+                /* The status of the select says how long the response is. */
+                uint32_t const sw_off =
+                    msg_ref[3U].hdr.size -
+                    (uint32_t)offsetof(swicc_net_msg_data_st, buf) - 2U;
+                REQUIRE_EQ(msg_ref[3U].data.buf[sw_off], 0x61U);
+                le = msg_ref[3U].data.buf[sw_off + 1U];
+            }
+            net_batch_select_create(msg, le);
+            CHECK_EQ(swicc_net_send(sock_server[0U], &msg[msg_idx]),
+                     SWICC_RET_SUCCESS);
+            CHECK_EQ(swicc_net_mux_poll(&mux, 1000), SWICC_RET_SUCCESS);
+            CHECK_EQ(swicc_net_recv(sock_server[0U], &msg_ref[msg_idx]),
+                     SWICC_RET_SUCCESS);
+            CHECK_EQ(msg_ref[msg_idx].data.ctrl, SWICC_NET_MSG_CTRL_SUCCESS);
+        }
+        /* The last response is the FCP of the MF followed by 9000. */
+        swicc_net_msg_st const *const msg_fcp =
+            &msg_ref[NET_BATCH_SELECT_COUNT - 1U];
+        uint32_t const fcp_len =
+            msg_fcp->hdr.size - (uint32_t)offsetof(swicc_net_msg_data_st, buf);
+        REQUIRE_EQ(fcp_len, le + 2U);
+        CHECK_EQ(msg_fcp->data.buf[0U], 0x62U);
+        CHECK_EQ(msg_fcp->data.buf[fcp_len - 2U], 0x90U);
+        CHECK_EQ(msg_fcp->data.buf[fcp_len - 1U], 0x00U);
+
+        /* One round trip for all requests, with the exact same responses. */
+        for (uint32_t card_idx = 1U; card_idx < 3U; ++card_idx)
+        {
+            net_batch_select_create(msg, le);
+            CHECK_EQ(swicc_net_batch_send(sock_server[card_idx], msg,
+                                          NET_BATCH_SELECT_COUNT),
+                     SWICC_RET_SUCCESS);
+            CHECK_EQ(swicc_net_mux_poll(&mux, 1000), SWICC_RET_SUCCESS);
+            memset(msg, 0U, sizeof(msg));
+            CHECK_EQ(swicc_net_batch_recv(sock_server[card_idx], msg,
+                                          NET_BATCH_SELECT_COUNT),
+                     SWICC_RET_SUCCESS);
+            for (uint32_t msg_idx = 0U; msg_idx < NET_BATCH_SELECT_COUNT;
+                 ++msg_idx)
+            {
+                CHECK_EQ(msg[msg_idx].hdr.size, msg_ref[msg_idx].hdr.size);
+                CHECK_BUF_EQ((uint8_t const *)&msg[msg_idx],
+                             (uint8_t const *)&msg_ref[msg_idx],
+                             sizeof(msg[msg_idx].hdr) + msg[msg_idx].hdr.size);
+            }
+        }
+
+        /* A full batch arriving one byte at a time is handled the same. */
+        for (uint32_t msg_idx = 0U; msg_idx < SWICC_NET_BATCH_COUNT_MAX;
+             ++msg_idx)
+        {
+            memset(&msg[msg_idx], 0U, sizeof(msg[msg_idx]));
+            msg[msg_idx].hdr.size = offsetof(swicc_net_msg_data_st, buf);
+            msg[msg_idx].data.ctrl = SWICC_NET_MSG_CTRL_KEEPALIVE;
+        }
+        int32_t sock_split[2U];
+        REQUIRE_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, sock_split), 0);
+        CHECK_EQ(swicc_net_batch_send(sock_split[0U], msg,
+                                      SWICC_NET_BATCH_COUNT_MAX),
+                 SWICC_RET_SUCCESS);
+        uint8_t byte;
+        while (recv(sock_split[1U], &byte, 1U, MSG_DONTWAIT) == 1)
+        {
+            REQUIRE_EQ(send(sock_server[1U], &byte, 1U, 0), 1);
+            CHECK_EQ(swicc_net_mux_poll(&mux, 1000), SWICC_RET_SUCCESS);
+        }
+        close(sock_split[0U]);
+        close(sock_split[1U]);
+        memset(msg, 0U, sizeof(msg));
+        CHECK_EQ(swicc_net_batch_recv(sock_server[1U], msg,
+                                      SWICC_NET_BATCH_COUNT_MAX),
+                 SWICC_RET_SUCCESS);
+        for (uint32_t msg_idx = 0U; msg_idx < SWICC_NET_BATCH_COUNT_MAX;
+             ++msg_idx)
+        {
+            CHECK_EQ(msg[msg_idx].data.ctrl, SWICC_NET_MSG_CTRL_SUCCESS);
+        }
+
+        /* A bad batch request gets a failure response. */
+        memset(&msg[0U], 0U, sizeof(msg[0U]));
+        msg[0U].hdr.size = offsetof(swicc_net_msg_data_st, buf) + 1U;
+        msg[0U].data.ctrl = SWICC_NET_MSG_CTRL_BATCH;
+        msg[0U].data.buf[0U] = SWICC_NET_BATCH_COUNT_MAX + 1U;
+        CHECK_EQ(swicc_net_send(sock_server[1U], &msg[0U]), SWICC_RET_SUCCESS);
+        CHECK_EQ(swicc_net_mux_poll(&mux, 1000), SWICC_RET_SUCCESS);
+        CHECK_EQ(swicc_net_recv(sock_server[1U], &msg[0U]), SWICC_RET_SUCCESS);
+        CHECK_EQ(msg[0U].data.ctrl, SWICC_NET_MSG_CTRL_FAILURE);
+
+        /* Disconnecting makes the single-card client return. */
+        close(sock_server[2U]);
+        REQUIRE_EQ(pthread_join(client_thread, NULL), 0);
+        CHECK_EQ(card[2U].ret, SWICC_RET_NET_DISCONNECTED);
+        for (uint32_t card_idx = 0U; card_idx < 3U; ++card_idx)
+        {
+            if (card_idx != 2U)
+            {
+                CHECK_EQ(swicc_net_mux_card_remove(&mux, &card[card_idx]),
+                         SWICC_RET_SUCCESS);
+                close(sock_server[card_idx]);
+            }
+            swicc_net_client_destroy(&card[card_idx].client_ctx);
+            swicc_terminate(&swicc_state[card_idx]);
+        }
+        swicc_net_mux_destroy(&mux);
+        swicc_disk_unload(&disk_base);
+    }
+}
+
+/* Where the proprietary handler was told to write its response data. */
+static uint8_t const *net_res_buf;
+static uint8_t const *net_res_buf_tx;
+
+static swicc_apduh_ft net_apduh_pro;
+static swicc_ret_et net_apduh_pro(swicc_st *const swicc_state,
+                                  swicc_apdu_cmd_st const *const cmd,
+                                  swicc_apdu_res_st *const res,
+                                  uint32_t const procedure_count)
+{
+    net_res_buf = res->data.b;
+    net_res_buf_tx = swicc_state->buf_tx;
+    for (uint16_t data_idx = 0U; data_idx < *cmd->p3; ++data_idx)
+    {
+        res->data.b[data_idx] = (uint8_t)(data_idx ^ 0x5AU);
+    }
+    res->data.len = *cmd->p3;
+    res->sw1 = SWICC_APDU_SW1_NORM_NONE;
+    res->sw2 = 0U;
+    return SWICC_RET_SUCCESS;
+}
+
+TEST(net, swicc_net_client__res_in_place)
+{
+    static swicc_st swicc_state;
+    static swicc_net_mux_card_st card;
+    swicc_net_server_st server_ctx = {.sock_server = -1};
+    swicc_net_msg_st msg;
+    memset(server_ctx.sock_client, 0xFFU, sizeof(server_ctx.sock_client));
+
+    swicc_disk_st disk = {0U};
+    REQUIRE_EQ(swicc_diskjs_disk_create(&disk, "test/data/disk/007-in.json"),
+               SWICC_RET_SUCCESS);
+    memset(&swicc_state, 0U, sizeof(swicc_state));
+    REQUIRE_EQ(swicc_fs_disk_mount(&swicc_state, &disk), SWICC_RET_SUCCESS);
+    REQUIRE_EQ(swicc_apduh_pro_register(&swicc_state, net_apduh_pro),
+               SWICC_RET_SUCCESS);
+    card.swicc_state = &swicc_state;
+    REQUIRE_EQ(
+        swicc_net_server_client_pair(&server_ctx, 0U, &card.client_ctx),
+        SWICC_RET_SUCCESS);
+    int32_t const sock = server_ctx.sock_client[0U];
+    pthread_t client_thread;
+    REQUIRE_EQ(pthread_create(&client_thread, NULL, net_batch_client, &card),
+               0);
+
+    CHECK_EQ(net_mux_ctrl(sock, SWICC_NET_MSG_CTRL_MOCK_RESET_COLD_PPS_Y, &msg),
+             SWICC_RET_SUCCESS);
+    CHECK_EQ(swicc_net_recv(sock, &msg), SWICC_RET_SUCCESS);
+    CHECK_EQ(msg.data.ctrl, SWICC_NET_MSG_CTRL_SUCCESS);
+
+    /* Proprietary command of the largest size, then get its response. */
+    static uint8_t const tpdu_hdr[] = {0x80, 0xCA, 0x00, 0x00, 0xFF};
+    memset(&msg, 0U, sizeof(msg));
+    msg.hdr.size = offsetof(swicc_net_msg_data_st, buf) + sizeof(tpdu_hdr);
+    memcpy(msg.data.buf, tpdu_hdr, sizeof(tpdu_hdr));
+    CHECK_EQ(swicc_net_send(sock, &msg), SWICC_RET_SUCCESS);
+    CHECK_EQ(swicc_net_recv(sock, &msg), SWICC_RET_SUCCESS);
+    memset(&msg, 0U, sizeof(msg));
+    msg.hdr.size = offsetof(swicc_net_msg_data_st, buf);
+    CHECK_EQ(swicc_net_send(sock, &msg), SWICC_RET_SUCCESS);
+    CHECK_EQ(swicc_net_recv(sock, &msg), SWICC_RET_SUCCESS);
+    CHECK_EQ(msg.data.ctrl, SWICC_NET_MSG_CTRL_SUCCESS);
+    REQUIRE_EQ(msg.hdr.size,
+               offsetof(swicc_net_msg_data_st, buf) + 0xFFU + 2U);
+    for (uint32_t data_idx = 0U; data_idx < 0xFFU; ++data_idx)
+    {
+        CHECK_EQ(msg.data.buf[data_idx], (uint8_t)(data_idx ^ 0x5AU));
+    }
+    CHECK_EQ(msg.data.buf[0xFFU], 0x90U);
+    CHECK_EQ(msg.data.buf[0xFFU + 1U], 0x00U);
+
+    /**
+     * The handler got the message buffer that is sent, so its write was the
+     * only copy of the response data.
+     */
+    CHECK_NE(net_res_buf, NULL);
+    CHECK_EQ(net_res_buf, net_res_buf_tx);
+
+    swicc_net_server_destroy(&server_ctx);
+    REQUIRE_EQ(pthread_join(client_thread, NULL), 0);
+    CHECK_EQ(card.ret, SWICC_RET_NET_DISCONNECTED);
+    swicc_net_client_destroy(&card.client_ctx);
+    swicc_terminate(&swicc_state);
+}
+
+TEST(net, swicc_net_pool__cards)
+{
+    for (uint32_t backend_idx = 0U; backend_idx < NET_BACKEND_COUNT;
+         ++backend_idx)
+    {
+        swicc_net_backend_et const backend = net_backend[backend_idx];
+        static swicc_st swicc_state[NET_MUX_CARD_COUNT];
+        static swicc_net_mux_card_st card[NET_MUX_CARD_COUNT];
+        int32_t sock_server[NET_MUX_CARD_COUNT];
+        swicc_net_pool_st pool;
+        swicc_net_msg_st msg;
+
+        CHECK_EQ(swicc_net_pool_create(NULL, 2U, backend), SWICC_RET_PARAM_BAD);
+        REQUIRE_EQ(swicc_net_pool_create(&pool, 2U, backend),
+                   SWICC_RET_SUCCESS);
+        CHECK_EQ(pool.worker_count, 2U);
+        for (uint32_t card_idx = 0U; card_idx < NET_MUX_CARD_COUNT; ++card_idx)
+        {
+            int32_t sock_pair[2U];
+            REQUIRE_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, sock_pair), 0);
+            sock_server[card_idx] = sock_pair[0U];
+            memset(&swicc_state[card_idx], 0U, sizeof(swicc_state[card_idx]));
+            card[card_idx].swicc_state = &swicc_state[card_idx];
+            card[card_idx].client_ctx.sock_client = sock_pair[1U];
+            /* Half of the cards get added before the pool is running. */
+            if (card_idx == NET_MUX_CARD_COUNT / 2U)
+            {
+                REQUIRE_EQ(swicc_net_pool_start(&pool), SWICC_RET_SUCCESS);
+                CHECK_EQ(swicc_net_pool_start(&pool), SWICC_RET_ERROR);
+            }
+            REQUIRE_EQ(swicc_net_pool_card_add(&pool, &card[card_idx]),
+                       SWICC_RET_SUCCESS);
+        }
+        /* Cards are spread evenly over the workers. */
+        CHECK_EQ(pool.worker[0U].mux.card_count, NET_MUX_CARD_COUNT / 2U);
+        CHECK_EQ(pool.worker[1U].mux.card_count, NET_MUX_CARD_COUNT / 2U);
+
+        for (uint32_t card_idx = 0U; card_idx < NET_MUX_CARD_COUNT; ++card_idx)
+        {
+            CHECK_EQ(net_mux_ctrl(sock_server[card_idx],
+                                  SWICC_NET_MSG_CTRL_KEEPALIVE, &msg),
+                     SWICC_RET_SUCCESS);
+        }
+        for (uint32_t card_idx = 0U; card_idx < NET_MUX_CARD_COUNT; ++card_idx)
+        {
+            CHECK_EQ(swicc_net_recv(sock_server[card_idx], &msg),
+                     SWICC_RET_SUCCESS);
+            CHECK_EQ(msg.data.ctrl, SWICC_NET_MSG_CTRL_SUCCESS);
+        }
+
+        CHECK_EQ(swicc_net_pool_stop(&pool), SWICC_RET_SUCCESS);
+        swicc_net_pool_destroy(&pool);
+        for (uint32_t card_idx = 0U; card_idx < NET_MUX_CARD_COUNT; ++card_idx)
+        {
+            close(sock_server[card_idx]);
+            swicc_net_client_destroy(&card[card_idx].client_ctx);
+        }
+    }
+}
+
+#define NET_SHM_NAME "/swicc-test-Qm7vX2rT9kLw4zHc"
+
+static swicc_net_shm_st net_shm_client;
+
+/**
+ * @brief Run the single-card client over shared memory.
+ * @param arg The card to serve, only its swICC state is used.
+ * @return Always NULL, the result is written to the card.
+ */
+static void *net_shm_client_run(void *const arg)
+{
+    swicc_net_mux_card_st *const card = arg;
+    card->ret = swicc_net_client_shm(card->swicc_state, &net_shm_client);
+    return NULL;
+}
+
+TEST(net, swicc_net_shm__transport)
+{
+    swicc_net_shm_st shm_server;
+    swicc_net_msg_st msg;
+    char name_long[SWICC_NET_SHM_NAME_LEN_MAX + 1U];
+    memset(name_long, 'a', sizeof(name_long));
+    name_long[0U] = '/';
+    name_long[SWICC_NET_SHM_NAME_LEN_MAX] = '\0';
+
+    CHECK_EQ(swicc_net_shm_server_create(NULL, NET_SHM_NAME),
+             SWICC_RET_PARAM_BAD);
+    CHECK_EQ(swicc_net_shm_server_create(&shm_server, NULL),
+             SWICC_RET_PARAM_BAD);
+    CHECK_EQ(swicc_net_shm_server_create(&shm_server, name_long),
+             SWICC_RET_PARAM_BAD);
+    CHECK_EQ(swicc_net_shm_client_create(&net_shm_client, name_long),
+             SWICC_RET_PARAM_BAD);
+    CHECK_EQ(swicc_net_shm_send(NULL, &msg), SWICC_RET_PARAM_BAD);
+    CHECK_EQ(swicc_net_shm_recv(NULL, &msg), SWICC_RET_PARAM_BAD);
+    CHECK_EQ(swicc_net_client_shm(NULL, &net_shm_client),
+             SWICC_RET_PARAM_BAD);
+
+    /* Messages go both ways, as many as fit in a ring without waiting. */
+    REQUIRE_EQ(swicc_net_shm_server_create(&shm_server, NET_SHM_NAME),
+               SWICC_RET_SUCCESS);
+    REQUIRE_EQ(swicc_net_shm_client_create(&net_shm_client, NET_SHM_NAME),
+               SWICC_RET_SUCCESS);
+    CHECK_EQ(swicc_net_shm_send(&shm_server, NULL), SWICC_RET_PARAM_BAD);
+    for (uint32_t round = 0U; round < 3U; ++round)
+    {
+        for (uint32_t msg_idx = 0U; msg_idx < SWICC_NET_SHM_SLOT_COUNT;
+             ++msg_idx)
+        {
+            uint32_t const size_msg = net_msg_create(&msg);
+            msg.data.buf[0U] = (uint8_t)msg_idx;
+            CHECK_EQ(swicc_net_shm_send(round % 2U == 0U ? &shm_server
+                                                         : &net_shm_client,
+                                        &msg),
+                     SWICC_RET_SUCCESS);
+            swicc_net_msg_st msg_recvd;
+            memset(&msg_recvd, 0U, sizeof(msg_recvd));
+            if (msg_idx + 1U == SWICC_NET_SHM_SLOT_COUNT)
+            {
+                for (uint32_t recv_idx = 0U;
+                     recv_idx < SWICC_NET_SHM_SLOT_COUNT; ++recv_idx)
+                {
+                    CHECK_EQ(swicc_net_shm_recv(round % 2U == 0U
+                                                    ? &net_shm_client
+                                                    : &shm_server,
+                                                &msg_recvd),
+                             SWICC_RET_SUCCESS);
+                    msg.data.buf[0U] = (uint8_t)recv_idx;
+                    CHECK_BUF_EQ((uint8_t const *)&msg_recvd,
+                                 (uint8_t const *)&msg, size_msg);
+                }
+            }
+        }
+    }
+
+    /* Messages sent before going away are still received. */
+    net_msg_create(&msg);
+    CHECK_EQ(swicc_net_shm_send(&shm_server, &msg), SWICC_RET_SUCCESS);
+    swicc_net_shm_destroy(&shm_server);
+    CHECK_EQ(swicc_net_shm_recv(&net_shm_client, &msg), SWICC_RET_SUCCESS);
+    CHECK_EQ(swicc_net_shm_recv(&net_shm_client, &msg), SWICC_RET_ERROR);
+    CHECK_EQ(swicc_net_shm_send(&net_shm_client, &msg), SWICC_RET_ERROR);
+    swicc_net_shm_destroy(&net_shm_client);
+    /* The segment is gone with the server. */
+    CHECK_EQ(swicc_net_shm_client_create(&net_shm_client, NET_SHM_NAME),
+             SWICC_RET_ERROR);
+}
+
+TEST(net, swicc_net_shm__client)
+{
+    static swicc_st swicc_state;
+    static swicc_net_mux_card_st card;
+    swicc_net_shm_st shm_server;
+    swicc_net_msg_st msg[NET_BATCH_SELECT_COUNT];
+    swicc_net_msg_st msg_res;
+
+    swicc_disk_st disk = {0U};
+    REQUIRE_EQ(swicc_diskjs_disk_create(&disk, "test/data/disk/007-in.json"),
+               SWICC_RET_SUCCESS);
+    memset(&swicc_state, 0U, sizeof(swicc_state));
+    REQUIRE_EQ(swicc_fs_disk_mount(&swicc_state, &disk), SWICC_RET_SUCCESS);
+    card.swicc_state = &swicc_state;
+    REQUIRE_EQ(swicc_net_shm_server_create(&shm_server, NET_SHM_NAME),
+               SWICC_RET_SUCCESS);
+    REQUIRE_EQ(swicc_net_shm_client_create(&net_shm_client, NET_SHM_NAME),
+               SWICC_RET_SUCCESS);
+    /* Only the card side can serve a card. */
+    CHECK_EQ(swicc_net_client_shm(&swicc_state, &shm_server),
+             SWICC_RET_PARAM_BAD);
+    pthread_t client_thread;
+    REQUIRE_EQ(
+        pthread_create(&client_thread, NULL, net_shm_client_run, &card), 0);
+
+    memset(&msg[0U], 0U, sizeof(msg[0U]));
+    msg[0U].hdr.size = offsetof(swicc_net_msg_data_st, buf);
+    msg[0U].data.ctrl = SWICC_NET_MSG_CTRL_MOCK_RESET_COLD_PPS_Y;
+    CHECK_EQ(swicc_net_shm_send(&shm_server, &msg[0U]), SWICC_RET_SUCCESS);
+    CHECK_EQ(swicc_net_shm_recv(&shm_server, &msg_res), SWICC_RET_SUCCESS);
+    CHECK_EQ(msg_res.data.ctrl, SWICC_NET_MSG_CTRL_SUCCESS);
+    CHECK_BUF_EQ(msg_res.data.buf, swicc_atr, sizeof(swicc_atr));
+
+    /* Batches are not supported. */
+    memset(&msg[0U], 0U, sizeof(msg[0U]));
+    msg[0U].hdr.size = offsetof(swicc_net_msg_data_st, buf) + 1U;
+    msg[0U].data.ctrl = SWICC_NET_MSG_CTRL_BATCH;
+    CHECK_EQ(swicc_net_shm_send(&shm_server, &msg[0U]), SWICC_RET_SUCCESS);
+    CHECK_EQ(swicc_net_shm_recv(&shm_server, &msg_res), SWICC_RET_SUCCESS);
+    CHECK_EQ(msg_res.data.ctrl, SWICC_NET_MSG_CTRL_FAILURE);
+
+    /* Select the MF, the procedure bytes and statuses are the same. */
+    uint8_t le = 0U;
+    for (uint32_t msg_idx = 0U; msg_idx < NET_BATCH_SELECT_COUNT; ++msg_idx)
+    {
+        net_batch_select_create(msg, le);
+        CHECK_EQ(swicc_net_shm_send(&shm_server, &msg[msg_idx]),
+                 SWICC_RET_SUCCESS);
+        CHECK_EQ(swicc_net_shm_recv(&shm_server, &msg_res),
+                 SWICC_RET_SUCCESS);
+        CHECK_EQ(msg_res.data.ctrl, SWICC_NET_MSG_CTRL_SUCCESS);
+        uint32_t const res_len =
+            msg_res.hdr.size - (uint32_t)offsetof(swicc_net_msg_data_st, buf);
+        if (msg_idx == 3U)
+        {
+            REQUIRE_EQ(res_len, 2U);
+            CHECK_EQ(msg_res.data.buf[0U], 0x61U);
+            le = msg_res.data.buf[1U];
+        }
+    }
+    uint32_t const fcp_len =
+        msg_res.hdr.size - (uint32_t)offsetof(swicc_net_msg_data_st, buf);
+    REQUIRE_EQ(fcp_len, le + 2U);
+    CHECK_EQ(msg_res.data.buf[0U], 0x62U);
+    CHECK_EQ(msg_res.data.buf[fcp_len - 2U], 0x90U);
+    CHECK_EQ(msg_res.data.buf[fcp_len - 1U], 0x00U);
+
+    /* Requests can be queued up without waiting for each response. */
+    for (uint32_t msg_idx = 0U; msg_idx < SWICC_NET_SHM_SLOT_COUNT; ++msg_idx)
+    {
+        memset(&msg[msg_idx], 0U, sizeof(msg[msg_idx]));
+        msg[msg_idx].hdr.size = offsetof(swicc_net_msg_data_st, buf);
+        msg[msg_idx].data.ctrl = SWICC_NET_MSG_CTRL_KEEPALIVE;
+        CHECK_EQ(swicc_net_shm_send(&shm_server, &msg[msg_idx]),
+                 SWICC_RET_SUCCESS);
+    }
+    for (uint32_t msg_idx = 0U; msg_idx < SWICC_NET_SHM_SLOT_COUNT; ++msg_idx)
+    {
+        CHECK_EQ(swicc_net_shm_recv(&shm_server, &msg_res),
+                 SWICC_RET_SUCCESS);
+        CHECK_EQ(msg_res.data.ctrl, SWICC_NET_MSG_CTRL_SUCCESS);
+    }
+
+    /* The server going away wakes up the card and makes the client return. */
+    swicc_net_shm_destroy(&shm_server);
+    REQUIRE_EQ(pthread_join(client_thread, NULL), 0);
+    CHECK_EQ(card.ret, SWICC_RET_NET_DISCONNECTED);
+    swicc_net_shm_destroy(&net_shm_client);
+    swicc_terminate(&swicc_state);
+}
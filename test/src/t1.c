@@ -0,0 +1,361 @@
+#include <tau/tau.h>
+
+#include <swicc/swicc.h>
+
+/**
+ * @brief INS 0x01 echoes the command data back, INS 0x02 responds with as many
+ * bytes as P3 asks for.
+ */
+static swicc_apduh_ft t1_pro;
+static swicc_ret_et t1_pro(swicc_st *const swicc_state,
+                           swicc_apdu_cmd_st const *const cmd,
+                           swicc_apdu_res_st *const res,
+                           uint32_t const procedure_count)
+{
+    switch (cmd->hdr->ins)
+    {
+    case 0x01:
+        if (procedure_count == 0U)
+        {
+            SWICC_APDUH_RES(res, SWICC_APDU_SW1_PROC_ACK_ALL, 0U, *cmd->p3);
+            return SWICC_RET_SUCCESS;
+        }
+        memcpy(res->data.b, cmd->data->b, cmd->data->len);
+        SWICC_APDUH_RES(res, SWICC_APDU_SW1_NORM_NONE, 0U, cmd->data->len);
+        return SWICC_RET_SUCCESS;
+    case 0x02: {
+        uint16_t const res_len = *cmd->p3 == 0U ? 256U : *cmd->p3;
+        for (uint16_t data_idx = 0U; data_idx < res_len; ++data_idx)
+        {
+            res->data.b[data_idx] = (uint8_t)(data_idx ^ 0x5AU);
+        }
+        SWICC_APDUH_RES(res, SWICC_APDU_SW1_NORM_NONE, 0U, res_len);
+        return SWICC_RET_SUCCESS;
+    }
+    default:
+        return SWICC_RET_APDU_UNHANDLED;
+    }
+}
+
+/**
+ * @brief Give the card some bytes and get back what it sends.
+ * @param swicc_state
+ * @param rx What the card receives.
+ * @param rx_len Length of what the card receives.
+ * @param tx Where the card response is written. Must hold SWICC_DATA_MAX + 2
+ * bytes.
+ * @return Length of the response.
+ */
+static uint16_t t1_step(swicc_st *const swicc_state, uint8_t const *const rx,
+                        uint16_t const rx_len, uint8_t *const tx)
+{
+    static uint8_t buf_rx[SWICC_T1_BLOCK_MAX];
+    memcpy(buf_rx, rx, rx_len);
+    swicc_state->buf_rx = buf_rx;
+    swicc_state->buf_rx_len = rx_len;
+    swicc_state->buf_tx = tx;
+    swicc_state->buf_tx_len = SWICC_DATA_MAX + 2U;
+    swicc_io(swicc_state);
+    return swicc_state->buf_tx_len;
+}
+
+/**
+ * @brief Send a whole block to the card in one go and get the block it sends
+ * back.
+ * @param swicc_state
+ * @param pcb
+ * @param inf
+ * @param inf_len
+ * @param block Where the received block is parsed into.
+ * @param tx Where the raw received block is written.
+ * @return Return code of parsing the received block.
+ */
+static swicc_ret_et t1_xchg(swicc_st *const swicc_state, uint8_t const pcb,
+                            uint8_t const *const inf, uint8_t const inf_len,
+                            swicc_t1_block_st *const block, uint8_t *const tx)
+{
+    uint8_t block_raw[SWICC_T1_BLOCK_MAX];
+    uint16_t block_raw_len = sizeof(block_raw);
+    swicc_t1_block_st const block_cmd = {
+        .nad = 0U, .pcb = pcb, .len = inf_len, .inf = inf};
+    if (swicc_t1_block_deparse(&block_cmd, SWICC_T1_EDC, block_raw,
+                               &block_raw_len) != SWICC_RET_SUCCESS)
+    {
+        return SWICC_RET_ERROR;
+    }
+    uint16_t const tx_len = t1_step(swicc_state, block_raw, block_raw_len, tx);
+    return swicc_t1_block_parse(tx, tx_len, SWICC_T1_EDC, block);
+}
+
+/**
+ * @brief Power up the card and select T=1 with a PPS.
+ * @param swicc_state
+ * @param disk
+ * @return Return code.
+ */
+static swicc_ret_et t1_power_up(swicc_st *const swicc_state,
+                                swicc_disk_st *const disk)
+{
+    static uint8_t buf_rx[SWICC_DATA_MAX];
+    static uint8_t buf_tx[SWICC_DATA_MAX + 2U];
+    if (swicc_diskjs_disk_create(disk, "test/data/disk/007-in.json") !=
+        SWICC_RET_SUCCESS)
+    {
+        return SWICC_RET_ERROR;
+    }
+    memset(swicc_state, 0U, sizeof(*swicc_state));
+    swicc_state->buf_rx = buf_rx;
+    swicc_state->buf_tx = buf_tx;
+    if (swicc_fs_disk_mount(swicc_state, disk) != SWICC_RET_SUCCESS ||
+        swicc_apduh_pro_register(swicc_state, t1_pro) != SWICC_RET_SUCCESS ||
+        swicc_mock_reset_cold(swicc_state, false) != SWICC_RET_SUCCESS)
+    {
+        return SWICC_RET_ERROR;
+    }
+
+    /* PPSS, PPS0 (T=1), PCK. */
+    uint8_t const pps[] = {0xFF, 0x01, 0xFE};
+    t1_step(swicc_state, pps, 1U, buf_tx);
+    if (t1_step(swicc_state, &pps[1U], 2U, buf_tx) != sizeof(pps) ||
+        memcmp(buf_tx, pps, sizeof(pps)) != 0)
+    {
+        return SWICC_RET_ERROR;
+    }
+    swicc_fsm_state_et fsm_state;
+    swicc_fsm_state(swicc_state, &fsm_state);
+    return fsm_state == SWICC_FSM_STATE_T1_BLOCK ? SWICC_RET_SUCCESS
+                                                 : SWICC_RET_ERROR;
+}
+
+TEST(t1, swicc_t1_block)
+{
+    /* The check value of the ISO/IEC 13239 CRC. */
+    uint8_t const check[] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+    CHECK_EQ(swicc_t1_crc(check, sizeof(check)), 0x6F91);
+
+    uint8_t const inf[] = {0x00, 0xB0, 0x00, 0x00, 0x10};
+    swicc_t1_block_st const block = {
+        .nad = 0x00, .pcb = SWICC_T1_PCB_I_NS, .len = sizeof(inf), .inf = inf};
+    for (uint8_t edc = SWICC_T1_EDC_LRC; edc <= SWICC_T1_EDC_CRC; ++edc)
+    {
+        uint8_t block_raw[SWICC_T1_BLOCK_MAX];
+        uint16_t block_raw_len = sizeof(block_raw);
+        REQUIRE_EQ(swicc_t1_block_deparse(&block, edc, block_raw,
+                                          &block_raw_len),
+                   SWICC_RET_SUCCESS);
+        REQUIRE_EQ(block_raw_len, 3U + sizeof(inf) + swicc_t1_edc_len(edc));
+        CHECK_EQ(block_raw[1U], SWICC_T1_PCB_I_NS);
+        CHECK_EQ(block_raw[2U], sizeof(inf));
+
+        uint16_t block_len_exp;
+        CHECK_EQ(swicc_t1_block_len(block_raw, 3U, edc, &block_len_exp),
+                 SWICC_RET_SUCCESS);
+        CHECK_EQ(block_len_exp, block_raw_len);
+        CHECK_EQ(swicc_t1_block_len(block_raw, 2U, edc, &block_len_exp),
+                 SWICC_RET_T1_INVALID);
+
+        swicc_t1_block_st block_prs;
+        REQUIRE_EQ(swicc_t1_block_parse(block_raw, block_raw_len, edc,
+                                        &block_prs),
+                   SWICC_RET_SUCCESS);
+        CHECK_EQ(block_prs.pcb, block.pcb);
+        REQUIRE_EQ(block_prs.len, sizeof(inf));
+        CHECK_BUF_EQ(block_prs.inf, inf, sizeof(inf));
+
+        /* Too short, too long, and a corrupted EDC. */
+        CHECK_EQ(swicc_t1_block_parse(block_raw,
+                                      (uint16_t)(block_raw_len - 1U), edc,
+                                      &block_prs),
+                 SWICC_RET_T1_INVALID);
+        CHECK_EQ(swicc_t1_block_parse(block_raw,
+                                      (uint16_t)(block_raw_len + 1U), edc,
+                                      &block_prs),
+                 SWICC_RET_T1_INVALID);
+        block_raw[block_raw_len - 1U] ^= 0x01;
+        CHECK_EQ(swicc_t1_block_parse(block_raw, block_raw_len, edc,
+                                      &block_prs),
+                 SWICC_RET_T1_EDC);
+
+        /* The buffer can't hold the EDC. */
+        block_raw_len = 3U + sizeof(inf);
+        CHECK_EQ(swicc_t1_block_deparse(&block, edc, block_raw,
+                                        &block_raw_len),
+                 SWICC_RET_BUFFER_TOO_SHORT);
+    }
+
+    /* An R-block with an LRC. */
+    uint8_t const block_r[] = {0x00, 0x80, 0x00, 0x80};
+    swicc_t1_block_st block_prs;
+    CHECK_EQ(swicc_t1_block_parse(block_r, sizeof(block_r), SWICC_T1_EDC_LRC,
+                                  &block_prs),
+             SWICC_RET_SUCCESS);
+    CHECK_EQ(block_prs.pcb, SWICC_T1_PCB_R);
+    CHECK_EQ(block_prs.len, 0U);
+}
+
+TEST(t1, swicc_fsm__t1)
+{
+    static swicc_st swicc_state;
+    swicc_disk_st disk = {0U};
+    REQUIRE_EQ(t1_power_up(&swicc_state, &disk), SWICC_RET_SUCCESS);
+
+    uint8_t tx[SWICC_DATA_MAX + 2U];
+    swicc_t1_block_st block;
+
+    /* A whole command APDU goes in and a whole response comes back. */
+    uint8_t const select[] = {0x00, 0xA4, 0x00, 0x04, 0x02, 0x3F, 0x00};
+    REQUIRE_EQ(t1_xchg(&swicc_state, SWICC_T1_PCB_I, select, sizeof(select),
+                       &block, tx),
+               SWICC_RET_SUCCESS);
+    CHECK_EQ(block.pcb, SWICC_T1_PCB_I);
+    REQUIRE_EQ(block.len, 2U);
+    CHECK_EQ(block.inf[0U], 0x61U);
+
+    /* Prologue first then the rest, the way a byte-oriented reader would. */
+    uint8_t const echo[] = {0x80, 0x01, 0x00, 0x00, 0x04,
+                            0x11, 0x22, 0x33, 0x44};
+    uint8_t echo_block[3U + sizeof(echo) + 1U];
+    uint16_t echo_block_len = sizeof(echo_block);
+    swicc_t1_block_st const echo_cmd = {.nad = 0U,
+                                        .pcb = SWICC_T1_PCB_I_NS,
+                                        .len = sizeof(echo),
+                                        .inf = echo};
+    REQUIRE_EQ(swicc_t1_block_deparse(&echo_cmd, SWICC_T1_EDC, echo_block,
+                                      &echo_block_len),
+               SWICC_RET_SUCCESS);
+    CHECK_EQ(t1_step(&swicc_state, echo_block, 3U, tx), 0U);
+    CHECK_EQ(swicc_state.buf_rx_len, echo_block_len - 3U);
+    uint16_t const tx_len = t1_step(&swicc_state, &echo_block[3U],
+                                    (uint16_t)(echo_block_len - 3U), tx);
+    CHECK_EQ(swicc_state.buf_rx_len, SWICC_T1_PROLOGUE_LEN);
+    REQUIRE_EQ(swicc_t1_block_parse(tx, tx_len, SWICC_T1_EDC, &block),
+               SWICC_RET_SUCCESS);
+    CHECK_EQ(block.pcb, SWICC_T1_PCB_I_NS);
+    REQUIRE_EQ(block.len, 4U + 2U);
+    CHECK_BUF_EQ(block.inf, &echo[5U], 4U);
+    CHECK_EQ(block.inf[4U], 0x90U);
+
+    /* A corrupted block is asked for again. */
+    echo_block[echo_block_len - 1U] ^= 0xFF;
+    REQUIRE_EQ(swicc_t1_block_parse(
+                   tx, t1_step(&swicc_state, echo_block, echo_block_len, tx),
+                   SWICC_T1_EDC, &block),
+               SWICC_RET_SUCCESS);
+    CHECK_EQ(block.pcb, SWICC_T1_PCB_R | SWICC_T1_PCB_R_ERR_EDC);
+
+    /* The wrong sequence number. */
+    uint8_t const get[] = {0x80, 0x02, 0x00, 0x00, 0x10};
+    REQUIRE_EQ(t1_xchg(&swicc_state, SWICC_T1_PCB_I_NS, get, sizeof(get),
+                       &block, tx),
+               SWICC_RET_SUCCESS);
+    CHECK_EQ(block.pcb, SWICC_T1_PCB_R | SWICC_T1_PCB_R_ERR_OTHER);
+
+    /* A malformed APDU still gets a status word. */
+    REQUIRE_EQ(t1_xchg(&swicc_state, SWICC_T1_PCB_I, get, 3U, &block, tx),
+               SWICC_RET_SUCCESS);
+    CHECK_EQ(block.pcb, SWICC_T1_PCB_I);
+    REQUIRE_EQ(block.len, 2U);
+    CHECK_EQ(block.inf[0U], 0x67U);
+
+    /* The interface can't ask for a waiting time extension. */
+    REQUIRE_EQ(t1_xchg(&swicc_state, SWICC_T1_PCB_S | SWICC_T1_PCB_S_WTX, get,
+                       1U, &block, tx),
+               SWICC_RET_SUCCESS);
+    CHECK_EQ(block.pcb, SWICC_T1_PCB_R | SWICC_T1_PCB_R_NR |
+                            SWICC_T1_PCB_R_ERR_OTHER);
+
+    /* RESYNCH starts over from sequence number 0. */
+    REQUIRE_EQ(t1_xchg(&swicc_state, SWICC_T1_PCB_S | SWICC_T1_PCB_S_RESYNCH,
+                       NULL, 0U, &block, tx),
+               SWICC_RET_SUCCESS);
+    CHECK_EQ(block.pcb,
+             SWICC_T1_PCB_S | SWICC_T1_PCB_S_RES | SWICC_T1_PCB_S_RESYNCH);
+    REQUIRE_EQ(t1_xchg(&swicc_state, SWICC_T1_PCB_I, get, sizeof(get), &block,
+                       tx),
+               SWICC_RET_SUCCESS);
+    CHECK_EQ(block.pcb, SWICC_T1_PCB_I);
+    REQUIRE_EQ(block.len, 0x10U + 2U);
+    CHECK_EQ(block.inf[0x0FU], 0x0FU ^ 0x5AU);
+
+    swicc_terminate(&swicc_state);
+}
+
+TEST(t1, swicc_fsm__t1_chaining)
+{
+    static swicc_st swicc_state;
+    swicc_disk_st disk = {0U};
+    REQUIRE_EQ(t1_power_up(&swicc_state, &disk), SWICC_RET_SUCCESS);
+
+    uint8_t tx[SWICC_DATA_MAX + 2U];
+    swicc_t1_block_st block;
+
+    /* The interface can only take 10 bytes per block. */
+    uint8_t ifsd[] = {10U};
+    REQUIRE_EQ(t1_xchg(&swicc_state, SWICC_T1_PCB_S | SWICC_T1_PCB_S_IFS, ifsd,
+                       sizeof(ifsd), &block, tx),
+               SWICC_RET_SUCCESS);
+    CHECK_EQ(block.pcb,
+             SWICC_T1_PCB_S | SWICC_T1_PCB_S_RES | SWICC_T1_PCB_S_IFS);
+    REQUIRE_EQ(block.len, 1U);
+    CHECK_EQ(block.inf[0U], 10U);
+
+    /* The command comes in 2 chained blocks. */
+    uint8_t const echo[] = {0x80, 0x01, 0x00, 0x00, 0x0C, 0x00, 0x01, 0x02,
+                            0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A,
+                            0x0B};
+    REQUIRE_EQ(t1_xchg(&swicc_state, SWICC_T1_PCB_I | SWICC_T1_PCB_I_M, echo,
+                       10U, &block, tx),
+               SWICC_RET_SUCCESS);
+    CHECK_EQ(block.pcb, SWICC_T1_PCB_R | SWICC_T1_PCB_R_NR);
+
+    /* The response comes in 2 chained blocks of at most 10 bytes. */
+    REQUIRE_EQ(t1_xchg(&swicc_state, SWICC_T1_PCB_I_NS, &echo[10U],
+                       sizeof(echo) - 10U, &block, tx),
+               SWICC_RET_SUCCESS);
+    CHECK_EQ(block.pcb, SWICC_T1_PCB_I | SWICC_T1_PCB_I_M);
+    REQUIRE_EQ(block.len, 10U);
+    CHECK_BUF_EQ(block.inf, &echo[5U], 10U);
+
+    /* Asking for the same block again. */
+    REQUIRE_EQ(t1_xchg(&swicc_state, SWICC_T1_PCB_R, NULL, 0U, &block, tx),
+               SWICC_RET_SUCCESS);
+    CHECK_EQ(block.pcb, SWICC_T1_PCB_I | SWICC_T1_PCB_I_M);
+    CHECK_EQ(block.len, 10U);
+
+    /* Asking for the next block. */
+    REQUIRE_EQ(t1_xchg(&swicc_state, SWICC_T1_PCB_R | SWICC_T1_PCB_R_NR, NULL,
+                       0U, &block, tx),
+               SWICC_RET_SUCCESS);
+    CHECK_EQ(block.pcb, SWICC_T1_PCB_I_NS);
+    REQUIRE_EQ(block.len, 2U + 2U);
+    CHECK_BUF_EQ(block.inf, &echo[15U], 2U);
+    CHECK_EQ(block.inf[2U], 0x90U);
+
+    /* ABORT is acknowledged. */
+    REQUIRE_EQ(t1_xchg(&swicc_state, SWICC_T1_PCB_S | SWICC_T1_PCB_S_ABORT,
+                       NULL, 0U, &block, tx),
+               SWICC_RET_SUCCESS);
+    CHECK_EQ(block.pcb,
+             SWICC_T1_PCB_S | SWICC_T1_PCB_S_RES | SWICC_T1_PCB_S_ABORT);
+
+    /* The longest response takes 2 blocks even at the largest IFSD. */
+    ifsd[0U] = SWICC_T1_IFS_MAX;
+    REQUIRE_EQ(t1_xchg(&swicc_state, SWICC_T1_PCB_S | SWICC_T1_PCB_S_IFS, ifsd,
+                       sizeof(ifsd), &block, tx),
+               SWICC_RET_SUCCESS);
+    uint8_t const get[] = {0x80, 0x02, 0x00, 0x00, 0x00};
+    REQUIRE_EQ(t1_xchg(&swicc_state, SWICC_T1_PCB_I, get, sizeof(get), &block,
+                       tx),
+               SWICC_RET_SUCCESS);
+    CHECK_EQ(block.pcb, SWICC_T1_PCB_I | SWICC_T1_PCB_I_M);
+    CHECK_EQ(block.len, SWICC_T1_IFS_MAX);
+    REQUIRE_EQ(t1_xchg(&swicc_state, SWICC_T1_PCB_R | SWICC_T1_PCB_R_NR, NULL,
+                       0U, &block, tx),
+               SWICC_RET_SUCCESS);
+    CHECK_EQ(block.pcb, SWICC_T1_PCB_I_NS);
+    REQUIRE_EQ(block.len, 256U - SWICC_T1_IFS_MAX + 2U);
+    CHECK_EQ(block.inf[1U], 0xFFU ^ 0x5AU);
+    CHECK_EQ(block.inf[2U], 0x90U);
+
+    swicc_terminate(&swicc_state);
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <stdint.h>
+#include <swicc/swicc.h>
+#include <time.h>
+
+/**
+ * Where the benchmarks put any files they need to generate (e.g. disk JSON
+ * files). Relative to the directory from which the benchmark is run.
+ */
+#define BENCH_DIR_TMP "build"
+
+/* The generated benchmark disks have an MF and at most this many EFs in it. */
+#define BENCH_DISK_MF_ID 0x3F00U
+#define BENCH_DISK_EF_COUNT_MAX 0xFFFDU
+
+/**
+ * @brief A single benchmark.
+ * @return 0 on success, non-zero on failure.
+ */
+typedef int32_t bench_ft(void);
+
+/**
+ * @brief Get the current value of a monotonic clock.
+ * @return Time in nanoseconds.
+ */
+static inline uint64_t bench_time_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    /* Safe cast since a monotonic clock never goes negative. */
+    return ((uint64_t)ts.tv_sec * 1000000000U) + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief A small xorshift PRNG so that every run of a benchmark performs the
+ * exact same sequence of operations.
+ * @param[in, out] state Must be non-zero.
+ * @return A pseudo-random number.
+ */
+static inline uint32_t bench_rand(uint32_t *const state)
+{
+    uint32_t x = *state;
+    x ^= x << 13U;
+    x ^= x >> 17U;
+    x ^= x << 5U;
+    *state = x;
+    return x;
+}
+
+/**
+ * @brief Get the ID that the benchmark disk generator assigns to the n-th EF.
+ * @param[in] ef_idx Index of the EF in the MF.
+ * @return File ID.
+ * @note Multiplying by an odd constant is a bijection on 16-bit values so all
+ * EFs get unique non-zero IDs (which are also not in increasing order). The one
+ * EF that would collide with the MF ID gets the ID of the last possible EF.
+ */
+static inline swicc_fs_id_kt bench_disk_ef_id(uint32_t const ef_idx)
+{
+    /* Safe cast since the result is truncated to 16 bits intentionally. */
+    swicc_fs_id_kt const id =
+        (swicc_fs_id_kt)(((ef_idx + 1U) * 0x9E37U) & 0xFFFFU);
+    if (id == BENCH_DISK_MF_ID)
+    {
+        return bench_disk_ef_id(BENCH_DISK_EF_COUNT_MAX);
+    }
+    return id;
+}
+
+/**
+ * @brief Generate a disk with a single MF containing a given number of
+ * transparent EFs.
+ * @param[out] disk Where to create the disk.
+ * @param[in] ef_count How many EFs to create in the MF. The IDs of the EFs are
+ * given by 'bench_disk_ef_id' and the first 254 EFs get SIDs 1 to 254.
+ * @param[in] ef_size Size of the contents of each EF.
+ * @return Return code.
+ * @note The 'ef_count' must not be greater than the max EF count.
+ */
+swicc_ret_et bench_disk_create(swicc_disk_st *const disk,
+                               uint32_t const ef_count, uint32_t const ef_size);
+
+bench_ft bench_lut_lookup;
+bench_ft bench_lut_rebuild;
+bench_ft bench_disk_load;
+bench_ft bench_disk_hdr;
+bench_ft bench_net_pool;
+bench_ft bench_net_latency;
+bench_ft bench_apdu_exec;
+bench_ft bench_apdu_bulk_read;
@@ -0,0 +1,578 @@
+#include "bench.h"
+#include <stdio.h>
+#include <string.h>
+
+/* How many SELECT and READ BINARY pairs are timed for every path. */
+#define APDU_PAIR_COUNT 200000U
+
+#define APDU_EF_COUNT 256U
+#define APDU_EF_SIZE 64U
+
+/* How many times data was exchanged with the card i.e. calls to swICC IO. */
+static uint64_t xchg_count = 0U;
+
+/**
+ * @brief Pass one TPDU (part) to the card through the T=0 FSM the same way the
+ * network client does.
+ * @param swicc_state
+ * @param buf_rx What the card receives.
+ * @param buf_rx_len Length of what the card receives.
+ * @param buf_tx Where the card response is written. Must be able to hold the
+ * largest response.
+ * @return Length of the response.
+ */
+static uint16_t tpdu_step(swicc_st *const swicc_state, uint8_t *const buf_rx,
+                          uint16_t const buf_rx_len, uint8_t *const buf_tx)
+{
+    swicc_state->buf_rx = buf_rx;
+    swicc_state->buf_rx_len = buf_rx_len;
+    swicc_state->buf_tx = buf_tx;
+    swicc_state->buf_tx_len = SWICC_DATA_MAX + 2U;
+    xchg_count += 1U;
+    swicc_io(swicc_state);
+    return swicc_state->buf_tx_len;
+}
+
+/**
+ * @brief Select an EF then read all of it using T=0 TPDUs i.e. with a
+ * procedure byte for each command.
+ * @param swicc_state
+ * @param id ID of the EF.
+ * @param buf_tx Where the responses are written.
+ * @return 0 on success, non-zero on failure.
+ */
+static int32_t select_read_tpdu(swicc_st *const swicc_state,
+                                swicc_fs_id_kt const id, uint8_t *const buf_tx)
+{
+    uint8_t select_hdr[] = {0x00, 0xA4, 0x00, 0x04, 0x02};
+    uint8_t select_data[] = {(uint8_t)(id >> 8U), (uint8_t)(id & 0xFFU)};
+    uint8_t read_hdr[] = {0x00, 0xB0, 0x00, 0x00, APDU_EF_SIZE};
+
+    /* Header, then get the procedure byte, data, and get the status. */
+    tpdu_step(swicc_state, select_hdr, sizeof(select_hdr), buf_tx);
+    tpdu_step(swicc_state, NULL, 0U, buf_tx);
+    tpdu_step(swicc_state, select_data, sizeof(select_data), buf_tx);
+    if (tpdu_step(swicc_state, NULL, 0U, buf_tx) != 2U || buf_tx[0U] != 0x61U)
+    {
+        return -1;
+    }
+
+    /* Header, then get the procedure byte, no data, and get the response. */
+    tpdu_step(swicc_state, read_hdr, sizeof(read_hdr), buf_tx);
+    tpdu_step(swicc_state, NULL, 0U, buf_tx);
+    tpdu_step(swicc_state, NULL, 0U, buf_tx);
+    if (tpdu_step(swicc_state, NULL, 0U, buf_tx) != APDU_EF_SIZE + 2U ||
+        buf_tx[APDU_EF_SIZE] != 0x90U)
+    {
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Select an EF then read all of it using whole APDUs.
+ * @param swicc_state
+ * @param id ID of the EF.
+ * @param buf_tx Where the responses are written.
+ * @return 0 on success, non-zero on failure.
+ */
+static int32_t select_read_apdu(swicc_st *const swicc_state,
+                                swicc_fs_id_kt const id, uint8_t *const buf_tx)
+{
+    uint8_t const select[] = {0x00, 0xA4, 0x00, 0x04, 0x02, (uint8_t)(id >> 8U),
+                              (uint8_t)(id & 0xFFU)};
+    uint8_t const read[] = {0x00, 0xB0, 0x00, 0x00, APDU_EF_SIZE};
+
+    uint16_t buf_tx_len = SWICC_DATA_MAX + 2U;
+    if (swicc_apdu_exec(swicc_state, select, sizeof(select), buf_tx,
+                        &buf_tx_len) != SWICC_RET_SUCCESS ||
+        buf_tx_len != 2U || buf_tx[0U] != 0x61U)
+    {
+        return -1;
+    }
+    buf_tx_len = SWICC_DATA_MAX + 2U;
+    if (swicc_apdu_exec(swicc_state, read, sizeof(read), buf_tx,
+                        &buf_tx_len) != SWICC_RET_SUCCESS ||
+        buf_tx_len != APDU_EF_SIZE + 2U || buf_tx[APDU_EF_SIZE] != 0x90U)
+    {
+        return -1;
+    }
+    return 0;
+}
+
+/* Send-sequence number of the next I-block sent to the card. */
+static uint8_t t1_ns = 0U;
+
+/**
+ * @brief Send a command APDU in one I-block and check the response I-block.
+ * @param swicc_state
+ * @param cmd Command APDU.
+ * @param cmd_len Length of the command APDU.
+ * @param buf_tx Where the response is written.
+ * @param res_len_exp Expected length of the response APDU.
+ * @param sw1_exp Expected SW1.
+ * @return 0 on success, non-zero on failure.
+ */
+static int32_t t1_xchg(swicc_st *const swicc_state, uint8_t const *const cmd,
+                       uint8_t const cmd_len, uint8_t *const buf_tx,
+                       uint16_t const res_len_exp, uint8_t const sw1_exp)
+{
+    uint8_t block_raw[SWICC_T1_BLOCK_MAX];
+    uint16_t block_raw_len = sizeof(block_raw);
+    swicc_t1_block_st block = {
+        .nad = 0U,
+        .pcb = t1_ns != 0U ? SWICC_T1_PCB_I_NS : SWICC_T1_PCB_I,
+        .len = cmd_len,
+        .inf = cmd,
+    };
+    t1_ns ^= 1U;
+    if (swicc_t1_block_deparse(&block, SWICC_T1_EDC, block_raw,
+                               &block_raw_len) != SWICC_RET_SUCCESS)
+    {
+        return -1;
+    }
+    uint16_t const buf_tx_len =
+        tpdu_step(swicc_state, block_raw, block_raw_len, buf_tx);
+    if (swicc_t1_block_parse(buf_tx, buf_tx_len, SWICC_T1_EDC, &block) !=
+            SWICC_RET_SUCCESS ||
+        block.len != res_len_exp || block.inf[block.len - 2U] != sw1_exp)
+    {
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Select an EF then read all of it using T=1 blocks i.e. one block for
+ * each command and response.
+ * @param swicc_state
+ * @param id ID of the EF.
+ * @param buf_tx Where the responses are written.
+ * @return 0 on success, non-zero on failure.
+ */
+static int32_t select_read_t1(swicc_st *const swicc_state,
+                              swicc_fs_id_kt const id, uint8_t *const buf_tx)
+{
+    uint8_t const select[] = {0x00, 0xA4, 0x00, 0x04, 0x02, (uint8_t)(id >> 8U),
+                              (uint8_t)(id & 0xFFU)};
+    uint8_t const read[] = {0x00, 0xB0, 0x00, 0x00, APDU_EF_SIZE};
+    if (t1_xchg(swicc_state, select, sizeof(select), buf_tx, 2U, 0x61U) != 0 ||
+        t1_xchg(swicc_state, read, sizeof(read), buf_tx, APDU_EF_SIZE + 2U,
+                0x90U) != 0)
+    {
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Reset the card and select the transmission protocol.
+ * @param swicc_state
+ * @param t The transmission protocol.
+ * @param buf_tx Where the PPS response is written.
+ * @return 0 on success, non-zero on failure.
+ */
+static int32_t power_up(swicc_st *const swicc_state, uint8_t const t,
+                        uint8_t *const buf_tx)
+{
+    if (swicc_mock_reset_cold(swicc_state, t == 0U) != SWICC_RET_SUCCESS)
+    {
+        return -1;
+    }
+    if (t == 1U)
+    {
+        /* PPSS, PPS0 (T=1), PCK. */
+        uint8_t pps[] = {0xFF, 0x01, 0xFE};
+        tpdu_step(swicc_state, pps, 1U, buf_tx);
+        if (tpdu_step(swicc_state, &pps[1U], 2U, buf_tx) != sizeof(pps))
+        {
+            return -1;
+        }
+        t1_ns = 0U;
+
+        /* Like readers do, take blocks as large as the card can send. */
+        uint8_t const ifsd[] = {SWICC_T1_IFS_MAX};
+        swicc_t1_block_st const block = {
+            .nad = 0U,
+            .pcb = SWICC_T1_PCB_S | SWICC_T1_PCB_S_IFS,
+            .len = sizeof(ifsd),
+            .inf = ifsd,
+        };
+        uint8_t block_raw[SWICC_T1_BLOCK_MAX];
+        uint16_t block_raw_len = sizeof(block_raw);
+        if (swicc_t1_block_deparse(&block, SWICC_T1_EDC, block_raw,
+                                   &block_raw_len) != SWICC_RET_SUCCESS ||
+            tpdu_step(swicc_state, block_raw, block_raw_len, buf_tx) !=
+                block_raw_len)
+        {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int32_t bench_apdu_exec(void)
+{
+    static struct
+    {
+        char const *name;
+        uint8_t t;
+        int32_t (*select_read)(swicc_st *const swicc_state,
+                               swicc_fs_id_kt const id, uint8_t *const buf_tx);
+    } const path[] = {
+        {"tpdu", 0U, select_read_tpdu},
+        {"t1", 1U, select_read_t1},
+        {"apdu", 0U, select_read_apdu},
+    };
+
+    static swicc_st swicc_state;
+    swicc_disk_st disk;
+    if (bench_disk_create(&disk, APDU_EF_COUNT, APDU_EF_SIZE) !=
+        SWICC_RET_SUCCESS)
+    {
+        fprintf(stderr, "Failed to create the disk.\n");
+        return -1;
+    }
+    /* The mock reset needs buffers to exchange the ATR and PPS through. */
+    uint8_t buf_rx[SWICC_DATA_MAX];
+    uint8_t buf_tx[SWICC_DATA_MAX + 2U];
+    memset(&swicc_state, 0U, sizeof(swicc_state));
+    swicc_state.buf_rx = buf_rx;
+    swicc_state.buf_tx = buf_tx;
+    if (swicc_fs_disk_mount(&swicc_state, &disk) != SWICC_RET_SUCCESS)
+    {
+        fprintf(stderr, "Failed to mount the disk.\n");
+        swicc_disk_unload(&disk);
+        return -1;
+    }
+
+    int32_t ret = 0;
+    printf("%6s %14s %14s %14s\n", "path", "apdu_per_s", "ns_per_apdu",
+           "xchg_per_apdu");
+    for (uint32_t path_idx = 0U; path_idx < sizeof(path) / sizeof(path[0U]);
+         ++path_idx)
+    {
+        if (power_up(&swicc_state, path[path_idx].t, buf_tx) != 0)
+        {
+            fprintf(stderr, "Failed to power up the card for '%s'.\n",
+                    path[path_idx].name);
+            ret = -1;
+            break;
+        }
+        uint32_t rand_state = 0x5EED5EEDU;
+        xchg_count = 0U;
+        uint64_t const time_start = bench_time_ns();
+        for (uint32_t pair_idx = 0U; pair_idx < APDU_PAIR_COUNT; ++pair_idx)
+        {
+            swicc_fs_id_kt const id =
+                bench_disk_ef_id(bench_rand(&rand_state) % APDU_EF_COUNT);
+            if (path[path_idx].select_read(&swicc_state, id, buf_tx) != 0)
+            {
+                fprintf(stderr, "Unexpected response over '%s'.\n",
+                        path[path_idx].name);
+                ret = -1;
+                break;
+            }
+        }
+        uint64_t const time_ns = bench_time_ns() - time_start;
+        if (ret != 0)
+        {
+            break;
+        }
+        printf("%6s %14.0f %14.1f %14.1f\n", path[path_idx].name,
+               2.0 * APDU_PAIR_COUNT * 1e9 / (double)time_ns,
+               (double)time_ns / (2.0 * APDU_PAIR_COUNT),
+               (double)xchg_count / (2.0 * APDU_PAIR_COUNT));
+    }
+    swicc_terminate(&swicc_state);
+    return ret;
+}
+
+/* How many times all EFs are read in full for every path. */
+#define BULK_ROUND_COUNT 200U
+
+/* The EFs are read by SID so there can be at most 30 of them. */
+#define BULK_EF_COUNT 16U
+#define BULK_EF_SIZE 16384U
+
+/**
+ * Largest Le of a short READ BINARY. An Le of 0 would mean 256 but it reaches
+ * the handlers as 0 so 255 is the most a short command gets.
+ */
+#define BULK_LE_SHRT UINT8_MAX
+
+/**
+ * @brief Create a READ BINARY command. Reading at offset 0 references the EF by
+ * SID so it becomes the current EF.
+ * @param cmd Where to write the command. Must be able to hold 7 bytes.
+ * @param sid SID of the EF.
+ * @param offset Offset in the EF.
+ * @param le How much to read. Extended lengths are used when it does not fit in
+ * a short Le.
+ * @return Length of the command.
+ */
+static uint8_t bulk_read_cmd(uint8_t *const cmd, uint8_t const sid,
+                             uint16_t const offset, uint16_t const le)
+{
+    cmd[0U] = 0x00;
+    cmd[1U] = 0xB0;
+    if (offset == 0U)
+    {
+        cmd[2U] = 0x80 | sid;
+        cmd[3U] = 0x00;
+    }
+    else
+    {
+        cmd[2U] = (uint8_t)(offset >> 8U);
+        cmd[3U] = (uint8_t)(offset & 0xFFU);
+    }
+    if (le <= BULK_LE_SHRT)
+    {
+        cmd[4U] = (uint8_t)le;
+        return 5U;
+    }
+    cmd[4U] = 0x00;
+    cmd[5U] = (uint8_t)(le >> 8U);
+    cmd[6U] = (uint8_t)(le & 0xFFU);
+    return 7U;
+}
+
+/**
+ * @brief Read part of an EF using a T=0 TPDU.
+ * @param swicc_state
+ * @param sid SID of the EF.
+ * @param offset Offset in the EF.
+ * @param le How much to read, at most a short Le.
+ * @param buf_tx Where the responses are written.
+ * @return 0 on success, non-zero on failure.
+ */
+static int32_t bulk_read_tpdu(swicc_st *const swicc_state, uint8_t const sid,
+                              uint16_t const offset, uint16_t const le,
+                              uint8_t *const buf_tx)
+{
+    uint8_t read_hdr[7U];
+    if (bulk_read_cmd(read_hdr, sid, offset, le) != 5U)
+    {
+        /* There are no extended lengths in T=0. */
+        return -1;
+    }
+
+    /* Header, then get the procedure byte, no data, and get the response. */
+    tpdu_step(swicc_state, read_hdr, 5U, buf_tx);
+    tpdu_step(swicc_state, NULL, 0U, buf_tx);
+    tpdu_step(swicc_state, NULL, 0U, buf_tx);
+    if (tpdu_step(swicc_state, NULL, 0U, buf_tx) != le + 2U ||
+        buf_tx[le] != 0x90U)
+    {
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Send a command APDU in one I-block and receive the response which may
+ * be chained over many I-blocks.
+ * @param swicc_state
+ * @param cmd Command APDU.
+ * @param cmd_len Length of the command APDU.
+ * @param buf_tx Where each response block is written.
+ * @param res Where the response APDU is written.
+ * @param res_len Must contain the size of the response buffer. It will receive
+ * the length of the response APDU.
+ * @return 0 on success, non-zero on failure.
+ */
+static int32_t t1_xchg_chain(swicc_st *const swicc_state,
+                             uint8_t const *const cmd, uint8_t const cmd_len,
+                             uint8_t *const buf_tx, uint8_t *const res,
+                             uint16_t *const res_len)
+{
+    uint8_t block_raw[SWICC_T1_BLOCK_MAX];
+    swicc_t1_block_st block = {
+        .nad = 0U,
+        .pcb = t1_ns != 0U ? SWICC_T1_PCB_I_NS : SWICC_T1_PCB_I,
+        .len = cmd_len,
+        .inf = cmd,
+    };
+    t1_ns ^= 1U;
+    uint16_t len = 0U;
+    for (;;)
+    {
+        uint16_t block_raw_len = sizeof(block_raw);
+        if (swicc_t1_block_deparse(&block, SWICC_T1_EDC, block_raw,
+                                   &block_raw_len) != SWICC_RET_SUCCESS)
+        {
+            return -1;
+        }
+        uint16_t const buf_tx_len =
+            tpdu_step(swicc_state, block_raw, block_raw_len, buf_tx);
+        if (swicc_t1_block_parse(buf_tx, buf_tx_len, SWICC_T1_EDC, &block) !=
+                SWICC_RET_SUCCESS ||
+            (block.pcb & SWICC_T1_PCB_I_MASK) != SWICC_T1_PCB_I ||
+            len + block.len > *res_len)
+        {
+            return -1;
+        }
+        memcpy(&res[len], block.inf, block.len);
+        /* Safe cast since it was checked to fit in the response buffer. */
+        len = (uint16_t)(len + block.len);
+        if ((block.pcb & SWICC_T1_PCB_I_M) == 0U)
+        {
+            *res_len = len;
+            return 0;
+        }
+
+        /* Acknowledge the part and ask for the next one. */
+        block = (swicc_t1_block_st){
+            .nad = 0U,
+            .pcb = (block.pcb & SWICC_T1_PCB_I_NS) != 0U
+                       ? SWICC_T1_PCB_R
+                       : SWICC_T1_PCB_R | SWICC_T1_PCB_R_NR,
+            .len = 0U,
+            .inf = NULL,
+        };
+    }
+}
+
+/**
+ * @brief Read part of an EF using T=1 blocks.
+ * @param swicc_state
+ * @param sid SID of the EF.
+ * @param offset Offset in the EF.
+ * @param le How much to read.
+ * @param buf_tx Where the responses are written.
+ * @return 0 on success, non-zero on failure.
+ */
+static int32_t bulk_read_t1(swicc_st *const swicc_state, uint8_t const sid,
+                            uint16_t const offset, uint16_t const le,
+                            uint8_t *const buf_tx)
+{
+    static uint8_t res[SWICC_DATA_MAX + 2U];
+    uint16_t res_len = sizeof(res);
+    uint8_t read[7U];
+    uint8_t const read_len = bulk_read_cmd(read, sid, offset, le);
+    if (t1_xchg_chain(swicc_state, read, read_len, buf_tx, res, &res_len) !=
+            0 ||
+        res_len != le + 2U || res[le] != 0x90U)
+    {
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Read part of an EF using a whole APDU.
+ * @param swicc_state
+ * @param sid SID of the EF.
+ * @param offset Offset in the EF.
+ * @param le How much to read.
+ * @param buf_tx Where the responses are written.
+ * @return 0 on success, non-zero on failure.
+ */
+static int32_t bulk_read_apdu(swicc_st *const swicc_state, uint8_t const sid,
+                              uint16_t const offset, uint16_t const le,
+                              uint8_t *const buf_tx)
+{
+    uint8_t read[7U];
+    uint8_t const read_len = bulk_read_cmd(read, sid, offset, le);
+    uint16_t buf_tx_len = SWICC_DATA_MAX + 2U;
+    if (swicc_apdu_exec(swicc_state, read, read_len, buf_tx, &buf_tx_len) !=
+            SWICC_RET_SUCCESS ||
+        buf_tx_len != le + 2U || buf_tx[le] != 0x90U)
+    {
+        return -1;
+    }
+    return 0;
+}
+
+int32_t bench_apdu_bulk_read(void)
+{
+    static struct
+    {
+        char const *name;
+        uint8_t t;
+        uint16_t le_max;
+        int32_t (*read)(swicc_st *const swicc_state, uint8_t const sid,
+                        uint16_t const offset, uint16_t const le,
+                        uint8_t *const buf_tx);
+    } const path[] = {
+        {"tpdu-short", 0U, BULK_LE_SHRT, bulk_read_tpdu},
+        {"t1-short", 1U, BULK_LE_SHRT, bulk_read_t1},
+        {"t1-ext", 1U, SWICC_DATA_MAX, bulk_read_t1},
+        {"apdu-short", 0U, BULK_LE_SHRT, bulk_read_apdu},
+        {"apdu-ext", 0U, SWICC_DATA_MAX, bulk_read_apdu},
+    };
+
+    static swicc_st swicc_state;
+    swicc_disk_st disk;
+    if (bench_disk_create(&disk, BULK_EF_COUNT, BULK_EF_SIZE) !=
+        SWICC_RET_SUCCESS)
+    {
+        fprintf(stderr, "Failed to create the disk.\n");
+        return -1;
+    }
+    /* The mock reset needs buffers to exchange the ATR and PPS through. */
+    uint8_t buf_rx[SWICC_DATA_MAX];
+    uint8_t buf_tx[SWICC_DATA_MAX + 2U];
+    memset(&swicc_state, 0U, sizeof(swicc_state));
+    swicc_state.buf_rx = buf_rx;
+    swicc_state.buf_tx = buf_tx;
+    if (swicc_fs_disk_mount(&swicc_state, &disk) != SWICC_RET_SUCCESS)
+    {
+        fprintf(stderr, "Failed to mount the disk.\n");
+        swicc_disk_unload(&disk);
+        return -1;
+    }
+
+    int32_t ret = 0;
+    printf("%10s %14s %14s %14s\n", "path", "mib_per_s", "us_per_ef",
+           "xchg_per_ef");
+    for (uint32_t path_idx = 0U; path_idx < sizeof(path) / sizeof(path[0U]);
+         ++path_idx)
+    {
+        if (power_up(&swicc_state, path[path_idx].t, buf_tx) != 0)
+        {
+            fprintf(stderr, "Failed to power up the card for '%s'.\n",
+                    path[path_idx].name);
+            ret = -1;
+            break;
+        }
+        xchg_count = 0U;
+        uint64_t const time_start = bench_time_ns();
+        for (uint32_t ef_idx = 0U;
+             ef_idx < BULK_ROUND_COUNT * BULK_EF_COUNT && ret == 0; ++ef_idx)
+        {
+            /* Safe cast since SIDs start at 1 and there are few EFs. */
+            uint8_t const sid = (uint8_t)(ef_idx % BULK_EF_COUNT + 1U);
+            for (uint32_t offset = 0U; offset < BULK_EF_SIZE;
+                 offset += path[path_idx].le_max)
+            {
+                uint32_t const len_rem = BULK_EF_SIZE - offset;
+                uint32_t const le = len_rem < path[path_idx].le_max
+                                        ? len_rem
+                                        : path[path_idx].le_max;
+                /* Safe casts since the EF is smaller than 32 KiB. */
+                if (path[path_idx].read(&swicc_state, sid, (uint16_t)offset,
+                                        (uint16_t)le, buf_tx) != 0)
+                {
+                    fprintf(stderr, "Unexpected response over '%s'.\n",
+                            path[path_idx].name);
+                    ret = -1;
+                    break;
+                }
+            }
+        }
+        uint64_t const time_ns = bench_time_ns() - time_start;
+        if (ret != 0)
+        {
+            break;
+        }
+        double const ef_read_count = BULK_ROUND_COUNT * BULK_EF_COUNT;
+        printf("%10s %14.1f %14.2f %14.1f\n", path[path_idx].name,
+               ef_read_count * BULK_EF_SIZE * 1e9 / (double)time_ns /
+                   (1024.0 * 1024.0),
+               (double)time_ns / ef_read_count / 1e3,
+               (double)xchg_count / ef_read_count);
+    }
+    swicc_terminate(&swicc_state);
+    return ret;
+}
@@ -0,0 +1,53 @@
+#include "bench.h"
+#include <stdio.h>
+#include <string.h>
+
+swicc_ret_et bench_disk_create(swicc_disk_st *const disk,
+                               uint32_t const ef_count, uint32_t const ef_size)
+{
+    if (disk == NULL || ef_count > BENCH_DISK_EF_COUNT_MAX)
+    {
+        return SWICC_RET_PARAM_BAD;
+    }
+
+    char const *const path = BENCH_DIR_TMP "/bench-disk.json";
+    FILE *f = fopen(path, "w");
+    if (f == NULL)
+    {
+        return SWICC_RET_ERROR;
+    }
+
+    fprintf(f, "{\"disk\":[{\"type\":\"file_mf\",\"name\":{\"type\":\"ascii\","
+               "\"contents\":\"BENCH\"},\"id\":\"%04X\",\"contents\":[",
+            BENCH_DISK_MF_ID);
+    for (uint32_t ef_idx = 0U; ef_idx < ef_count; ++ef_idx)
+    {
+        fprintf(f, "%s{\"type\":\"file_ef_transparent\",\"id\":\"%04X\"",
+                ef_idx == 0U ? "" : ",", bench_disk_ef_id(ef_idx));
+        if (ef_idx < 254U)
+        {
+            fprintf(f, ",\"sid\":\"%02X\"", ef_idx + 1U);
+        }
+        if (ef_size == 0U)
+        {
+            fprintf(f, ",\"contents\":null}");
+        }
+        else
+        {
+            fprintf(f, ",\"contents\":{\"type\":\"hex\",\"contents\":\"");
+            for (uint32_t byte_idx = 0U; byte_idx < ef_size; ++byte_idx)
+            {
+                fprintf(f, "%02X", (byte_idx + ef_idx) & 0xFFU);
+            }
+            fprintf(f, "\"}}");
+        }
+    }
+    fprintf(f, "]}]}");
+    if (fclose(f) != 0)
+    {
+        return SWICC_RET_ERROR;
+    }
+
+    memset(disk, 0U, sizeof(*disk));
+    return swicc_diskjs_disk_create(disk, path);
+}
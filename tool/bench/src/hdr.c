@@ -0,0 +1,80 @@
+#include "bench.h"
+#include <stdio.h>
+
+/* How many files to get for every disk size. */
+#define GET_COUNT 1000000U
+
+/**
+ * @brief Time how long it takes to get random files together with their root
+ * and parent, the same way a SELECT does it.
+ * @param disk
+ * @param ef_count Number of EFs on the disk.
+ * @param get_ns Where the average time of getting a single file will be
+ * written.
+ * @return 0 on success, non-zero on failure.
+ */
+static int32_t get_time(swicc_disk_st const *const disk,
+                        uint32_t const ef_count, double *const get_ns)
+{
+    uint32_t rand_state = 0x5EED5EEDU;
+    swicc_disk_tree_st *tree;
+    swicc_fs_file_st file;
+    swicc_fs_file_st file_root;
+    swicc_fs_file_st file_parent;
+    uint64_t const get_start = bench_time_ns();
+    for (uint32_t get_idx = 0U; get_idx < GET_COUNT; ++get_idx)
+    {
+        swicc_fs_id_kt const id =
+            bench_disk_ef_id(bench_rand(&rand_state) % ef_count);
+        if (swicc_disk_lutid_lookup(disk, &tree, id, &file) !=
+                SWICC_RET_SUCCESS ||
+            swicc_disk_tree_file_root(tree, &file_root) != SWICC_RET_SUCCESS ||
+            swicc_disk_tree_file_parent(tree, &file, &file_parent) !=
+                SWICC_RET_SUCCESS)
+        {
+            fprintf(stderr, "Failed to get a file.\n");
+            return -1;
+        }
+    }
+    *get_ns = (double)(bench_time_ns() - get_start) / GET_COUNT;
+    return 0;
+}
+
+int32_t bench_disk_hdr(void)
+{
+    static uint32_t const ef_count[] = {16U, 256U, 4096U, 65000U};
+
+    printf("%8s %14s %14s\n", "files", "prs_ns", "hdrtbl_ns");
+    for (uint32_t size_idx = 0U;
+         size_idx < sizeof(ef_count) / sizeof(ef_count[0U]); ++size_idx)
+    {
+        swicc_disk_st disk;
+        if (bench_disk_create(&disk, ef_count[size_idx], 0U) !=
+            SWICC_RET_SUCCESS)
+        {
+            fprintf(stderr, "Failed to create a disk with %u EFs.\n",
+                    ef_count[size_idx]);
+            return -1;
+        }
+
+        /* Without the header table, the root and parent get parsed. */
+        double prs_ns;
+        double hdrtbl_ns;
+        swicc_disk_hdrtbl_empty(disk.root);
+        int32_t ret = get_time(&disk, ef_count[size_idx], &prs_ns);
+        if (ret == 0)
+        {
+            ret = swicc_disk_hdrtbl_rebuild(&disk, disk.root) ==
+                          SWICC_RET_SUCCESS
+                      ? get_time(&disk, ef_count[size_idx], &hdrtbl_ns)
+                      : -1;
+        }
+        swicc_disk_unload(&disk);
+        if (ret != 0)
+        {
+            return ret;
+        }
+        printf("%8u %14.1f %14.1f\n", ef_count[size_idx], prs_ns, hdrtbl_ns);
+    }
+    return 0;
+}
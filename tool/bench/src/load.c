@@ -0,0 +1,84 @@
+#include "bench.h"
+#include <stdio.h>
+#include <unistd.h>
+
+/* How many times to load the disk for every disk size. */
+#define LOAD_COUNT 16U
+
+/**
+ * @brief Time how long it takes to load a disk file.
+ * @param path Path to the disk file.
+ * @param mmap If the disk file should be mapped instead of read.
+ * @param load_ns Where the average time of a single load will be written.
+ * @return 0 on success, non-zero on failure.
+ */
+static int32_t load_time(char const *const path, bool const mmap,
+                         double *const load_ns)
+{
+    uint64_t const load_start = bench_time_ns();
+    for (uint32_t load_idx = 0U; load_idx < LOAD_COUNT; ++load_idx)
+    {
+        swicc_disk_st disk = {0U};
+        swicc_ret_et const ret_load = mmap ? swicc_disk_load_mmap(&disk, path)
+                                           : swicc_disk_load(&disk, path);
+        if (ret_load != SWICC_RET_SUCCESS)
+        {
+            fprintf(stderr, "Failed to load disk '%s'.\n", path);
+            return -1;
+        }
+        swicc_disk_unload(&disk);
+    }
+    *load_ns = (double)(bench_time_ns() - load_start) / LOAD_COUNT;
+    return 0;
+}
+
+int32_t bench_disk_load(void)
+{
+    static uint32_t const ef_count[] = {1024U, 2048U, 4096U, 8192U};
+    /* Large EFs make the difference between reading and mapping visible. */
+    static uint32_t const ef_size = 256U;
+    char const *const path_lut = BENCH_DIR_TMP "/bench-disk-lut.swiccfs";
+    char const *const path_nolut = BENCH_DIR_TMP "/bench-disk-nolut.swiccfs";
+
+    printf("%8s %14s %14s %14s %14s\n", "files", "lut_us", "nolut_us",
+           "mmap_lut_us", "mmap_nolut_us");
+    for (uint32_t size_idx = 0U;
+         size_idx < sizeof(ef_count) / sizeof(ef_count[0U]); ++size_idx)
+    {
+        swicc_disk_st disk;
+        if (bench_disk_create(&disk, ef_count[size_idx], ef_size) !=
+            SWICC_RET_SUCCESS)
+        {
+            fprintf(stderr, "Failed to create a disk with %u EFs.\n",
+                    ef_count[size_idx]);
+            return -1;
+        }
+        /* The disk file without LUTs is the same file cut after the trees. */
+        uint32_t const trees_len = disk.root->len;
+        if (swicc_disk_save(&disk, path_lut) != SWICC_RET_SUCCESS ||
+            swicc_disk_save(&disk, path_nolut) != SWICC_RET_SUCCESS ||
+            truncate(path_nolut, SWICC_DISK_MAGIC_LEN + trees_len) != 0)
+        {
+            fprintf(stderr, "Failed to save the disk.\n");
+            swicc_disk_unload(&disk);
+            return -1;
+        }
+        swicc_disk_unload(&disk);
+
+        double lut_ns;
+        double nolut_ns;
+        double mmap_lut_ns;
+        double mmap_nolut_ns;
+        if (load_time(path_lut, false, &lut_ns) != 0 ||
+            load_time(path_nolut, false, &nolut_ns) != 0 ||
+            load_time(path_lut, true, &mmap_lut_ns) != 0 ||
+            load_time(path_nolut, true, &mmap_nolut_ns) != 0)
+        {
+            return -1;
+        }
+        printf("%8u %14.1f %14.1f %14.1f %14.1f\n", ef_count[size_idx],
+               lut_ns / 1000.0, nolut_ns / 1000.0, mmap_lut_ns / 1000.0,
+               mmap_nolut_ns / 1000.0);
+    }
+    return 0;
+}
@@ -0,0 +1,145 @@
+#include "bench.h"
+#include <stdio.h>
+
+/* How many lookups to time for every LUT size. */
+#define LOOKUP_COUNT 1000000U
+
+int32_t bench_lut_lookup(void)
+{
+    static uint32_t const ef_count[] = {16U, 64U, 256U, 1024U, 4096U, 16384U};
+
+    printf("%8s %8s %14s %14s %14s\n", "files", "sids", "id_hit_ns",
+           "id_miss_ns", "sid_hit_ns");
+    for (uint32_t size_idx = 0U;
+         size_idx < sizeof(ef_count) / sizeof(ef_count[0U]); ++size_idx)
+    {
+        swicc_disk_st disk;
+        if (bench_disk_create(&disk, ef_count[size_idx], 0U) !=
+            SWICC_RET_SUCCESS)
+        {
+            fprintf(stderr, "Failed to create a disk with %u EFs.\n",
+                    ef_count[size_idx]);
+            return -1;
+        }
+        uint32_t const sid_count =
+            ef_count[size_idx] < 254U ? ef_count[size_idx] : 254U;
+
+        uint32_t rand_state = 0x5EED5EEDU;
+        uint32_t found = 0U;
+        swicc_fs_file_st file;
+        swicc_disk_tree_st *tree;
+
+        /* Lookup IDs that are present on the disk. */
+        uint64_t const id_hit_start = bench_time_ns();
+        for (uint32_t lookup_idx = 0U; lookup_idx < LOOKUP_COUNT; ++lookup_idx)
+        {
+            swicc_fs_id_kt const id = bench_disk_ef_id(
+                bench_rand(&rand_state) % ef_count[size_idx]);
+            if (swicc_disk_lutid_lookup(&disk, &tree, id, &file) ==
+                SWICC_RET_SUCCESS)
+            {
+                found += 1U;
+            }
+        }
+        uint64_t const id_hit_ns = bench_time_ns() - id_hit_start;
+
+        /* Lookup IDs that were never assigned to any EF. */
+        uint64_t const id_miss_start = bench_time_ns();
+        for (uint32_t lookup_idx = 0U; lookup_idx < LOOKUP_COUNT; ++lookup_idx)
+        {
+            swicc_fs_id_kt const id = bench_disk_ef_id(
+                BENCH_DISK_EF_COUNT_MAX - 1U -
+                (bench_rand(&rand_state) % ef_count[size_idx]));
+            if (swicc_disk_lutid_lookup(&disk, &tree, id, &file) ==
+                SWICC_RET_SUCCESS)
+            {
+                found += 1U;
+            }
+        }
+        uint64_t const id_miss_ns = bench_time_ns() - id_miss_start;
+
+        /* Lookup SIDs that are present in the MF tree. */
+        uint64_t const sid_hit_start = bench_time_ns();
+        for (uint32_t lookup_idx = 0U; lookup_idx < LOOKUP_COUNT; ++lookup_idx)
+        {
+            /* Safe cast since the SID count is at most 254. */
+            swicc_fs_sid_kt const sid =
+                (swicc_fs_sid_kt)(1U + (bench_rand(&rand_state) % sid_count));
+            if (swicc_disk_lutsid_lookup(disk.root, sid, &file) ==
+                SWICC_RET_SUCCESS)
+            {
+                found += 1U;
+            }
+        }
+        uint64_t const sid_hit_ns = bench_time_ns() - sid_hit_start;
+
+        if (found != 2U * LOOKUP_COUNT)
+        {
+            fprintf(stderr, "Expected %u lookups to succeed, got %u.\n",
+                    2U * LOOKUP_COUNT, found);
+            swicc_disk_unload(&disk);
+            return -1;
+        }
+        printf("%8u %8u %14.1f %14.1f %14.1f\n", ef_count[size_idx], sid_count,
+               (double)id_hit_ns / LOOKUP_COUNT,
+               (double)id_miss_ns / LOOKUP_COUNT,
+               (double)sid_hit_ns / LOOKUP_COUNT);
+        swicc_disk_unload(&disk);
+    }
+    return 0;
+}
+
+/* How many times to rebuild the LUTs for every disk size. */
+#define REBUILD_COUNT 16U
+
+int32_t bench_lut_rebuild(void)
+{
+    static uint32_t const ef_count[] = {1024U, 4096U, 16384U, 32768U, 65000U};
+
+    printf("%8s %14s %14s\n", "files", "lutid_us", "lutsid_us");
+    for (uint32_t size_idx = 0U;
+         size_idx < sizeof(ef_count) / sizeof(ef_count[0U]); ++size_idx)
+    {
+        swicc_disk_st disk;
+        if (bench_disk_create(&disk, ef_count[size_idx], 0U) !=
+            SWICC_RET_SUCCESS)
+        {
+            fprintf(stderr, "Failed to create a disk with %u EFs.\n",
+                    ef_count[size_idx]);
+            return -1;
+        }
+
+        uint64_t const lutid_start = bench_time_ns();
+        for (uint32_t rebuild_idx = 0U; rebuild_idx < REBUILD_COUNT;
+             ++rebuild_idx)
+        {
+            if (swicc_disk_lutid_rebuild(&disk) != SWICC_RET_SUCCESS)
+            {
+                fprintf(stderr, "Failed to rebuild the ID LUT.\n");
+                swicc_disk_unload(&disk);
+                return -1;
+            }
+        }
+        uint64_t const lutid_ns = bench_time_ns() - lutid_start;
+
+        uint64_t const lutsid_start = bench_time_ns();
+        for (uint32_t rebuild_idx = 0U; rebuild_idx < REBUILD_COUNT;
+             ++rebuild_idx)
+        {
+            if (swicc_disk_lutsid_rebuild(&disk, disk.root) !=
+                SWICC_RET_SUCCESS)
+            {
+                fprintf(stderr, "Failed to rebuild the SID LUT.\n");
+                swicc_disk_unload(&disk);
+                return -1;
+            }
+        }
+        uint64_t const lutsid_ns = bench_time_ns() - lutsid_start;
+
+        printf("%8u %14.1f %14.1f\n", ef_count[size_idx],
+               (double)lutid_ns / (REBUILD_COUNT * 1000.0),
+               (double)lutsid_ns / (REBUILD_COUNT * 1000.0));
+        swicc_disk_unload(&disk);
+    }
+    return 0;
+}
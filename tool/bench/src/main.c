@@ -0,0 +1,106 @@
+#include <stdio.h>
+#include <string.h>
+
+#define DEBUG_CLR
+#include "bench.h"
+
+typedef struct bench_s
+{
+    char const *name;
+    char const *descr;
+    bench_ft *func;
+} bench_st;
+
+static bench_st const bench_all[] = {
+    {"lut-lookup", "Latency of ID and SID LUT lookups against LUT size.",
+     bench_lut_lookup},
+    {"lut-rebuild", "Time to rebuild the ID and SID LUTs against disk size.",
+     bench_lut_rebuild},
+    {"disk-load", "Time to load a disk file with and without a LUT section.",
+     bench_disk_load},
+    {"disk-hdr",
+     "Latency of getting a file, its root, and its parent with and without a "
+     "header table.",
+     bench_disk_hdr},
+    {"net-pool", "Throughput of a card pool against its worker count.",
+     bench_net_pool},
+    {"net-latency", "Round trip time of a message against the transport.",
+     bench_net_latency},
+    {"apdu-exec", "Throughput of APDUs as T=0 TPDUs and as whole APDUs.",
+     bench_apdu_exec},
+    {"apdu-bulk-read",
+     "Throughput of reading large EFs with short and extended APDUs.",
+     bench_apdu_bulk_read},
+};
+
+static void print_usage(char const *const arg0)
+{
+    // clang-format off
+    fprintf(stderr, "Usage: %s [<"CLR_VAL("benchmark")">...]"
+        "\n"
+        "\nRuns the given benchmarks (or all of them if none are given) and"
+        "\nprints the results to stdout. Must be run from the directory of the"
+        "\nbenchmark tool since it generates some files in './" BENCH_DIR_TMP "'."
+        "\n"
+        "\nAvailable benchmarks:"
+        "\n",
+        arg0);
+    // clang-format on
+    for (uint32_t bench_idx = 0U;
+         bench_idx < sizeof(bench_all) / sizeof(bench_all[0U]); ++bench_idx)
+    {
+        fprintf(stderr, "  %-16s %s\n", bench_all[bench_idx].name,
+                bench_all[bench_idx].descr);
+    }
+}
+
+static int32_t bench_run(bench_st const *const bench)
+{
+    printf("== %s ==\n", bench->name);
+    int32_t const ret = bench->func();
+    if (ret != 0)
+    {
+        fprintf(stderr, CLR_TXT(CLR_RED, "Benchmark '%s' failed.\n"),
+                bench->name);
+    }
+    return ret;
+}
+
+int32_t main(int32_t const argc, char const *const argv[argc])
+{
+    int32_t ret = 0;
+    if (argc <= 1)
+    {
+        for (uint32_t bench_idx = 0U;
+             bench_idx < sizeof(bench_all) / sizeof(bench_all[0U]);
+             ++bench_idx)
+        {
+            ret |= bench_run(&bench_all[bench_idx]);
+        }
+        return ret;
+    }
+
+    for (int32_t arg_idx = 1; arg_idx < argc; ++arg_idx)
+    {
+        bench_st const *bench = NULL;
+        for (uint32_t bench_idx = 0U;
+             bench_idx < sizeof(bench_all) / sizeof(bench_all[0U]);
+             ++bench_idx)
+        {
+            if (strcmp(argv[arg_idx], bench_all[bench_idx].name) == 0)
+            {
+                bench = &bench_all[bench_idx];
+                break;
+            }
+        }
+        if (bench == NULL)
+        {
+            fprintf(stderr, CLR_TXT(CLR_RED, "Unknown benchmark '%s'.\n"),
+                    argv[arg_idx]);
+            print_usage(argv[0U]);
+            return -1;
+        }
+        ret |= bench_run(bench);
+    }
+    return ret;
+}
@@ -0,0 +1,258 @@
+#include "bench.h"
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* How many round trips are timed for every transport. */
+#define RTT_COUNT 20000U
+
+/* Ports tried (in order) for the TCP server until one is free. */
+#define TCP_PORT_FIRST 37390U
+#define TCP_PORT_COUNT 16U
+
+#define UNIX_PATH "@swicc-bench-net-latency"
+#define SHM_NAME "/swicc-bench-net-latency"
+
+typedef enum transport_e
+{
+    TRANSPORT_TCP,
+    TRANSPORT_UNIX,
+    TRANSPORT_PAIR,
+    TRANSPORT_SHM,
+} transport_et;
+
+/* A card served by the single-card client in its own thread. */
+typedef struct card_s
+{
+    pthread_t thread;
+    swicc_st swicc_state;
+    swicc_net_client_st client_ctx;
+    transport_et transport;
+    swicc_net_shm_st shm; /* Only used with the shared memory transport. */
+} card_st;
+
+/**
+ * @brief Serve the card until the server disconnects.
+ * @param arg The card.
+ * @return Always NULL.
+ */
+static void *card_run(void *const arg)
+{
+    card_st *const card = arg;
+    if (card->transport == TRANSPORT_SHM)
+    {
+        swicc_net_client_shm(&card->swicc_state, &card->shm);
+    }
+    else
+    {
+        swicc_net_client(&card->swicc_state, &card->client_ctx);
+    }
+    return NULL;
+}
+
+/**
+ * @brief Connect a client to a server over a given transport.
+ * @param transport
+ * @param server_ctx Server to create.
+ * @param client_ctx Client to create.
+ * @return 0 on success, non-zero on failure.
+ */
+static int32_t transport_connect(transport_et const transport,
+                                 swicc_net_server_st *const server_ctx,
+                                 swicc_net_client_st *const client_ctx)
+{
+    server_ctx->sock_server = -1;
+    memset(server_ctx->sock_client, 0xFFU, sizeof(server_ctx->sock_client));
+    switch (transport)
+    {
+    case TRANSPORT_TCP:
+        for (uint32_t port_idx = 0U; port_idx < TCP_PORT_COUNT; ++port_idx)
+        {
+            char port_str[8U];
+            snprintf(port_str, sizeof(port_str), "%u",
+                     TCP_PORT_FIRST + port_idx);
+            if (swicc_net_server_create(server_ctx, port_str) ==
+                SWICC_RET_SUCCESS)
+            {
+                if (swicc_net_client_create(client_ctx, "127.0.0.1",
+                                            port_str) != SWICC_RET_SUCCESS)
+                {
+                    return -1;
+                }
+                break;
+            }
+        }
+        break;
+    case TRANSPORT_UNIX:
+        if (swicc_net_server_create_unix(server_ctx, UNIX_PATH) !=
+                SWICC_RET_SUCCESS ||
+            swicc_net_client_create_unix(client_ctx, UNIX_PATH) !=
+                SWICC_RET_SUCCESS)
+        {
+            return -1;
+        }
+        break;
+    case TRANSPORT_PAIR:
+        return swicc_net_server_client_pair(server_ctx, 0U, client_ctx) ==
+                       SWICC_RET_SUCCESS
+                   ? 0
+                   : -1;
+    case TRANSPORT_SHM:
+        /* Not a socket transport. */
+        return -1;
+    }
+    if (server_ctx->sock_server < 0)
+    {
+        return -1;
+    }
+    /* The connection is already queued since connecting is done. */
+    return swicc_net_server_client_connect(server_ctx, 0U) ==
+                   SWICC_RET_SUCCESS
+               ? 0
+               : -1;
+}
+
+/**
+ * @brief Compare function for sorting round trip times.
+ * @param a Round trip time.
+ * @param b Round trip time.
+ * @return Negative, zero, or positive when a is less, equal, or greater.
+ */
+static int rtt_cmp(void const *const a, void const *const b)
+{
+    uint64_t const rtt_a = *(uint64_t const *)a;
+    uint64_t const rtt_b = *(uint64_t const *)b;
+    return (rtt_a > rtt_b) - (rtt_a < rtt_b);
+}
+
+/**
+ * @brief Time the round trips of keep-alive messages to a card.
+ * @param transport Over which transport the card is connected.
+ * @param rtt_ns Where the round trip times will be written (sorted).
+ * @return 0 on success, non-zero on failure.
+ */
+static int32_t rtt_time(transport_et const transport, uint64_t *const rtt_ns)
+{
+    swicc_net_server_st server_ctx;
+    swicc_net_shm_st shm_server = {.seg = NULL};
+    card_st *const card = calloc(1U, sizeof(*card));
+    if (card == NULL)
+    {
+        return -1;
+    }
+    card->client_ctx.sock_client = -1;
+    card->transport = transport;
+    server_ctx.sock_server = -1;
+    memset(server_ctx.sock_client, 0xFFU, sizeof(server_ctx.sock_client));
+    bool connected;
+    if (transport == TRANSPORT_SHM)
+    {
+        connected =
+            swicc_net_shm_server_create(&shm_server, SHM_NAME) ==
+                SWICC_RET_SUCCESS &&
+            swicc_net_shm_client_create(&card->shm, SHM_NAME) ==
+                SWICC_RET_SUCCESS;
+    }
+    else
+    {
+        connected = transport_connect(transport, &server_ctx,
+                                      &card->client_ctx) == 0;
+    }
+    if (!connected || pthread_create(&card->thread, NULL, card_run, card) != 0)
+    {
+        fprintf(stderr, "Failed to connect the card.\n");
+        swicc_net_client_destroy(&card->client_ctx);
+        swicc_net_server_destroy(&server_ctx);
+        swicc_net_shm_destroy(&card->shm);
+        swicc_net_shm_destroy(&shm_server);
+        free(card);
+        return -1;
+    }
+
+    int32_t ret = 0;
+    int32_t const sock = server_ctx.sock_client[0U];
+    swicc_net_msg_st msg;
+    for (uint32_t rtt_idx = 0U; rtt_idx < RTT_COUNT; ++rtt_idx)
+    {
+        msg.hdr.size = offsetof(swicc_net_msg_data_st, buf);
+        msg.data.ctrl = SWICC_NET_MSG_CTRL_KEEPALIVE;
+        uint64_t const time_start = bench_time_ns();
+        bool replied;
+        if (transport == TRANSPORT_SHM)
+        {
+            replied =
+                swicc_net_shm_send(&shm_server, &msg) == SWICC_RET_SUCCESS &&
+                swicc_net_shm_recv(&shm_server, &msg) == SWICC_RET_SUCCESS;
+        }
+        else
+        {
+            replied = swicc_net_send(sock, &msg) == SWICC_RET_SUCCESS &&
+                      swicc_net_recv(sock, &msg) == SWICC_RET_SUCCESS;
+        }
+        if (!replied)
+        {
+            ret = -1;
+            break;
+        }
+        rtt_ns[rtt_idx] = bench_time_ns() - time_start;
+    }
+    qsort(rtt_ns, RTT_COUNT, sizeof(rtt_ns[0U]), rtt_cmp);
+
+    /* Disconnecting makes the client return. */
+    swicc_net_server_destroy(&server_ctx);
+    swicc_net_shm_destroy(&shm_server);
+    pthread_join(card->thread, NULL);
+    swicc_net_client_destroy(&card->client_ctx);
+    swicc_net_shm_destroy(&card->shm);
+    free(card);
+    return ret;
+}
+
+int32_t bench_net_latency(void)
+{
+    static struct
+    {
+        char const *name;
+        transport_et transport;
+    } const transport[] = {
+        {"tcp", TRANSPORT_TCP},
+        {"unix", TRANSPORT_UNIX},
+        {"pair", TRANSPORT_PAIR},
+        {"shm", TRANSPORT_SHM},
+    };
+    uint64_t *const rtt_ns = malloc(sizeof(*rtt_ns) * RTT_COUNT);
+    if (rtt_ns == NULL)
+    {
+        return -1;
+    }
+
+    int32_t ret = 0;
+    printf("%10s %10s %10s %10s\n", "transport", "mean_us", "p50_us",
+           "p99_us");
+    for (uint32_t transport_idx = 0U;
+         transport_idx < sizeof(transport) / sizeof(transport[0U]);
+         ++transport_idx)
+    {
+        if (rtt_time(transport[transport_idx].transport, rtt_ns) != 0)
+        {
+            fprintf(stderr, "Failed to time round trips over '%s'.\n",
+                    transport[transport_idx].name);
+            ret = -1;
+            break;
+        }
+        uint64_t rtt_sum_ns = 0U;
+        for (uint32_t rtt_idx = 0U; rtt_idx < RTT_COUNT; ++rtt_idx)
+        {
+            rtt_sum_ns += rtt_ns[rtt_idx];
+        }
+        printf("%10s %10.2f %10.2f %10.2f\n", transport[transport_idx].name,
+               (double)rtt_sum_ns / RTT_COUNT / 1e3,
+               (double)rtt_ns[RTT_COUNT / 2U] / 1e3,
+               (double)rtt_ns[RTT_COUNT * 99U / 100U] / 1e3);
+    }
+    free(rtt_ns);
+    return ret;
+}
@@ -0,0 +1,256 @@
+#include "bench.h"
+#include <pthread.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+/* How many cards are hosted by the pool for every worker count. */
+#define CARD_COUNT 64U
+
+/* How many messages every card receives. */
+#define ROUND_COUNT 2000U
+
+/**
+ * The server side of a share of the cards. Every driver runs in its own thread
+ * and keeps all its cards busy.
+ */
+typedef struct driver_s
+{
+    pthread_t thread;
+    int32_t *sock;
+    uint32_t sock_count;
+    int32_t ret;
+} driver_st;
+
+/**
+ * @brief Send a cold reset to every card of a driver and wait for all the
+ * responses, over and over.
+ * @param arg The driver.
+ * @return Always NULL, the result is written to the driver.
+ */
+static void *driver_run(void *const arg)
+{
+    driver_st *const driver = arg;
+    swicc_net_msg_st msg;
+    driver->ret = 0;
+    for (uint32_t round_idx = 0U; round_idx < ROUND_COUNT; ++round_idx)
+    {
+        for (uint32_t sock_idx = 0U; sock_idx < driver->sock_count; ++sock_idx)
+        {
+            msg.hdr.size = offsetof(swicc_net_msg_data_st, buf);
+            msg.data.ctrl = SWICC_NET_MSG_CTRL_MOCK_RESET_COLD_PPS_Y;
+            if (swicc_net_send(driver->sock[sock_idx], &msg) !=
+                SWICC_RET_SUCCESS)
+            {
+                driver->ret = -1;
+                return NULL;
+            }
+        }
+        for (uint32_t sock_idx = 0U; sock_idx < driver->sock_count; ++sock_idx)
+        {
+            if (swicc_net_recv(driver->sock[sock_idx], &msg) !=
+                    SWICC_RET_SUCCESS ||
+                msg.data.ctrl != SWICC_NET_MSG_CTRL_SUCCESS)
+            {
+                driver->ret = -1;
+                return NULL;
+            }
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Get the CPU time used by all the workers of a pool so far.
+ * @param pool
+ * @return CPU time in nanoseconds.
+ */
+static uint64_t pool_cpu_ns(swicc_net_pool_st const *const pool)
+{
+    uint64_t cpu_ns = 0U;
+    for (uint32_t worker_idx = 0U; worker_idx < pool->worker_count;
+         ++worker_idx)
+    {
+        clockid_t clock;
+        struct timespec ts;
+        if (pthread_getcpuclockid(pool->worker[worker_idx].thread, &clock) ==
+                0 &&
+            clock_gettime(clock, &ts) == 0)
+        {
+            cpu_ns += (uint64_t)ts.tv_sec * 1000000000U + (uint64_t)ts.tv_nsec;
+        }
+    }
+    return cpu_ns;
+}
+
+/**
+ * @brief Time how long it takes a pool to serve a fixed number of messages.
+ * @param card All the cards (not added to any pool yet).
+ * @param sock_server The server sides of the card sockets.
+ * @param backend Backend of the workers.
+ * @param worker_count How many workers the pool shall have.
+ * @param msg_per_s Where the throughput will be written.
+ * @param cpu_ns_per_msg Where the CPU time the workers spent per message will
+ * be written.
+ * @return 0 on success, non-zero on failure.
+ */
+static int32_t pool_time(swicc_net_mux_card_st *const card,
+                         int32_t *const sock_server,
+                         swicc_net_backend_et const backend,
+                         uint32_t const worker_count, double *const msg_per_s,
+                         double *const cpu_ns_per_msg)
+{
+    swicc_net_pool_st pool;
+    if (swicc_net_pool_create(&pool, worker_count, backend) !=
+        SWICC_RET_SUCCESS)
+    {
+        return -1;
+    }
+    if (pool.worker[0U].mux.backend != backend)
+    {
+        fprintf(stderr, "Backend is not available.\n");
+        swicc_net_pool_destroy(&pool);
+        return -1;
+    }
+    for (uint32_t card_idx = 0U; card_idx < CARD_COUNT; ++card_idx)
+    {
+        if (swicc_net_pool_card_add(&pool, &card[card_idx]) !=
+            SWICC_RET_SUCCESS)
+        {
+            swicc_net_pool_destroy(&pool);
+            return -1;
+        }
+    }
+    if (swicc_net_pool_start(&pool) != SWICC_RET_SUCCESS)
+    {
+        swicc_net_pool_destroy(&pool);
+        return -1;
+    }
+
+    /* As many drivers as workers so that the drivers are never the limit. */
+    driver_st driver[worker_count];
+    uint32_t const card_per_driver = CARD_COUNT / worker_count;
+    int32_t ret = 0;
+    uint64_t const cpu_start = pool_cpu_ns(&pool);
+    uint64_t const time_start = bench_time_ns();
+    for (uint32_t driver_idx = 0U; driver_idx < worker_count; ++driver_idx)
+    {
+        driver[driver_idx].sock = &sock_server[driver_idx * card_per_driver];
+        driver[driver_idx].sock_count = card_per_driver;
+        if (pthread_create(&driver[driver_idx].thread, NULL, driver_run,
+                           &driver[driver_idx]) != 0)
+        {
+            /* Can't recover since the started drivers would never stop. */
+            fprintf(stderr, "Failed to start a driver thread.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    for (uint32_t driver_idx = 0U; driver_idx < worker_count; ++driver_idx)
+    {
+        pthread_join(driver[driver_idx].thread, NULL);
+        ret |= driver[driver_idx].ret;
+    }
+    uint64_t const time_ns = bench_time_ns() - time_start;
+    uint64_t const cpu_ns = pool_cpu_ns(&pool) - cpu_start;
+    double const msg_count =
+        (double)(card_per_driver * worker_count * ROUND_COUNT);
+    *msg_per_s = msg_count / ((double)time_ns / 1e9);
+    *cpu_ns_per_msg = (double)cpu_ns / msg_count;
+
+    if (swicc_net_pool_stop(&pool) != SWICC_RET_SUCCESS)
+    {
+        ret = -1;
+    }
+    swicc_net_pool_destroy(&pool);
+    return ret;
+}
+
+int32_t bench_net_pool(void)
+{
+    static uint32_t const worker_count[] = {1U, 2U, 4U, 8U};
+    static struct
+    {
+        char const *name;
+        swicc_net_backend_et backend;
+    } const backend[] = {{"epoll", SWICC_NET_BACKEND_EPOLL},
+                         {"io_uring", SWICC_NET_BACKEND_URING}};
+
+    /* All cards share one base disk. */
+    swicc_disk_st disk_base;
+    if (bench_disk_create(&disk_base, 16U, 16U) != SWICC_RET_SUCCESS)
+    {
+        fprintf(stderr, "Failed to create the base disk.\n");
+        return -1;
+    }
+    swicc_st *const swicc_state = calloc(CARD_COUNT, sizeof(*swicc_state));
+    swicc_net_mux_card_st *const card = calloc(CARD_COUNT, sizeof(*card));
+    int32_t sock_server[CARD_COUNT];
+    int32_t ret = swicc_state == NULL || card == NULL ? -1 : 0;
+    uint32_t card_count = 0U;
+    for (; ret == 0 && card_count < CARD_COUNT; ++card_count)
+    {
+        int32_t sock_pair[2U];
+        swicc_disk_st disk;
+        memset(&disk, 0U, sizeof(disk));
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, sock_pair) != 0)
+        {
+            ret = -1;
+            break;
+        }
+        sock_server[card_count] = sock_pair[0U];
+        card[card_count].swicc_state = &swicc_state[card_count];
+        card[card_count].client_ctx.sock_client = sock_pair[1U];
+        if (swicc_disk_overlay(&disk, &disk_base) != SWICC_RET_SUCCESS ||
+            swicc_fs_disk_mount(&swicc_state[card_count], &disk) !=
+                SWICC_RET_SUCCESS)
+        {
+            ret = -1;
+        }
+    }
+
+    if (ret == 0)
+    {
+        printf("%10s %8s %8s %14s %16s\n", "backend", "workers", "cards",
+               "msg_per_s", "cpu_ns_per_msg");
+    }
+    for (uint32_t backend_idx = 0U;
+         ret == 0 && backend_idx < sizeof(backend) / sizeof(backend[0U]);
+         ++backend_idx)
+    {
+        for (uint32_t size_idx = 0U;
+             size_idx < sizeof(worker_count) / sizeof(worker_count[0U]);
+             ++size_idx)
+        {
+            double msg_per_s;
+            double cpu_ns_per_msg;
+            if (pool_time(card, sock_server, backend[backend_idx].backend,
+                          worker_count[size_idx], &msg_per_s,
+                          &cpu_ns_per_msg) != 0)
+            {
+                fprintf(stderr,
+                        "Failed to run a pool with %u workers using %s.\n",
+                        worker_count[size_idx], backend[backend_idx].name);
+                ret = -1;
+                break;
+            }
+            printf("%10s %8u %8u %14.0f %16.0f\n", backend[backend_idx].name,
+                   worker_count[size_idx], CARD_COUNT, msg_per_s,
+                   cpu_ns_per_msg);
+        }
+    }
+
+    for (uint32_t card_idx = 0U; card_idx < card_count; ++card_idx)
+    {
+        close(sock_server[card_idx]);
+        swicc_net_client_destroy(&card[card_idx].client_ctx);
+        swicc_terminate(&swicc_state[card_idx]);
+    }
+    free(card);
+    free(swicc_state);
+    swicc_disk_unload(&disk_base);
+    return ret;
+}